@@ -205,4 +205,5 @@ namespace lv {
 #include "litiv/features2d/LBSP.hpp"
 #include "litiv/features2d/LSS.hpp"
 #include "litiv/features2d/MI.hpp"
-#include "litiv/features2d/SC.hpp"
\ No newline at end of file
+#include "litiv/features2d/SC.hpp"
+#include "litiv/features2d/registry.hpp"
\ No newline at end of file
@@ -130,24 +130,27 @@ protected:
     const size_t m_nLUTSize;
 
 private:
+    /// scratch buffers used by the internal impl (kept per-thread to allow concurrent description of multiple images)
+    struct Workspace {
+        cv::Mat_<float> oTempTransp,oImageLocalDiff_Y,oImageLocalDiff_X;
+        cv::Mat_<float> oRef_dVdy,oRef_dHdx,oRef_V_dHdx,oRef_V_dVdy_t;
+        cv::Mat_<float> oImage_AdaptiveMean,oImage_AdaptiveMeanSqr;
+        cv::Mat_<float> oLookupImage,oLookupImage_Sqr,oLookupImage_Mix;
+        cv::Mat_<float> oLookupImage_AdaptiveMean,oLookupImage_AdaptiveMeanSqr,oLookupImage_AdaptiveMeanMix;
+        cv::Mat_<float> oImage_SubSampl,oImage_SubSamplBlur,oImage_SubSamplVar,oImage_SubSamplBlurSqr;
+        cv::Mat_<float> oRef_SubSampl,oRef_SubSamplCross,oRef_SubSamplBlur,oRef_SubSamplCrossBlur;
+        cv::Mat_<float> oNormVarDiff,oNormVarDiff_SubSampl,oNormVarDiff_SubSamplBlur;
+        cv::Mat_<float> oNormVar,oNormVar_SubSampl,oNormVar_SubSamplBlur;
+        cv::Size oImageSize,oSubSamplSize,oBlurKernelSize;
+    };
+    /// returns the calling thread's scratch buffers (helps avoid continuous mem realloc without sharing state across threads)
+    static Workspace& getWorkspace();
     /// helper/util function for recursive filtering
-    void recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef_V_dHdx, const cv::Mat_<float>& oRef_V_dVdy_t, cv::Mat_<float>& oOutput);
+    void recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef_V_dHdx, const cv::Mat_<float>& oRef_V_dVdy_t, cv::Mat_<float>& oOutput, Workspace& oWS) const;
     /// dense recursive filtering description approach impl
-    void dasc_rf_impl(const cv::Mat& oImage, cv::Mat_<float>& oDescriptors);
+    void dasc_rf_impl(const cv::Mat& oImage, cv::Mat_<float>& oDescriptors, Workspace& oWS) const;
     /// helper/util function for dense guided filtering
-    void guidedFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef, cv::Mat_<float>& oOutput);
+    void guidedFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef, cv::Mat_<float>& oOutput, Workspace& oWS) const;
     /// dense guided filtering description approach impl
-    void dasc_gf_impl(const cv::Mat& oImage, cv::Mat_<float>& oDescriptors);
-
-    // helper variables for internal impl (helps avoid continuous mem realloc)
-    cv::Mat_<float> m_oTempTransp,m_oImageLocalDiff_Y,m_oImageLocalDiff_X;
-    cv::Mat_<float> m_oRef_dVdy,m_oRef_dHdx,m_oRef_V_dHdx,m_oRef_V_dVdy_t;
-    cv::Mat_<float> m_oImage_AdaptiveMean,m_oImage_AdaptiveMeanSqr;
-    cv::Mat_<float> m_oLookupImage,m_oLookupImage_Sqr,m_oLookupImage_Mix;
-    cv::Mat_<float> m_oLookupImage_AdaptiveMean,m_oLookupImage_AdaptiveMeanSqr,m_oLookupImage_AdaptiveMeanMix;
-    cv::Mat_<float> m_oImage_SubSampl,m_oImage_SubSamplBlur,m_oImage_SubSamplVar,m_oImage_SubSamplBlurSqr;
-    cv::Mat_<float> m_oRef_SubSampl,m_oRef_SubSamplCross,m_oRef_SubSamplBlur,m_oRef_SubSamplCrossBlur;
-    cv::Mat_<float> m_oNormVarDiff,m_oNormVarDiff_SubSampl,m_oNormVarDiff_SubSamplBlur;
-    cv::Mat_<float> m_oNormVar,m_oNormVar_SubSampl,m_oNormVar_SubSamplBlur;
-    cv::Size m_oImageSize,m_oSubSamplSize,m_oBlurKernelSize;
+    void dasc_gf_impl(const cv::Mat& oImage, cv::Mat_<float>& oDescriptors, Workspace& oWS) const;
 };
\ No newline at end of file
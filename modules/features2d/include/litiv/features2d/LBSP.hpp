@@ -86,6 +86,8 @@ public:
     static void validateROI(cv::Mat& oROI);
     /// utility function, used to calculate per-desc Hamming distance between two descriptor sets/maps
     static void calcDistances(const cv::Mat& oDescriptors1, const cv::Mat& oDescriptors2, cv::Mat_<uchar>& oDistances);
+    /// utility function, used to count per-desc matches (i.e. Hamming distance <= nMaxDist) against K reference maps, stopping once 'nRequiredMatches' are found (for sample-based models)
+    static void calcMatchCounts(const cv::Mat& oDescMap, const std::vector<cv::Mat>& voRefDescMaps, size_t nMaxDist, size_t nRequiredMatches, cv::Mat_<uchar>& oMatchCounts);
 #if HAVE_GLSL
     /// utility function, returns the glsl source code required to describe an LBSP descriptor based on the image load store
     static std::string getShaderFunctionSource(size_t nChannels, bool bUseSharedDataPreload, const glm::uvec2& vWorkGroupSize);
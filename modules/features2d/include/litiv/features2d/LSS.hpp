@@ -151,4 +151,6 @@ private:
     cv::Mat_<int> m_oDescLUMap;
     /// indices of first/last non-null map lookups
     int m_nFirstMaskIdx,m_nLastMaskIdx;
+    /// (row offset, col offset, bin index) list of all correlation window offsets used for binning (shared by both impls)
+    std::vector<std::array<int,3>> m_vCorrOffsets;
 };
\ No newline at end of file
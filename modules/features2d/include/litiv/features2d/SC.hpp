@@ -185,20 +185,33 @@ private:
     void scdesc_generate_angmask();
     /// generates EMD distance cost map using internal parameters
     void scdesc_generate_emdmask();
+    /// scratch buffers & per-image state used by the cpu impl (kept per-thread to allow concurrent description of multiple images)
+    struct Workspace {
+        cv::Mat_<cv::Point2f> oKeyPts,oContourPts;
+        cv::Mat_<uchar> oBinMask,oDistMask;
+        cv::Mat_<double> oDistMap,oAngMap;
+        std::vector<int> vContourGridOffsets;
+        std::vector<cv::Point2f> vContourGridPts;
+        cv::Size oCurrImageSize;
+        cv::Size oFullKeyPtMapSize; ///< size of the image the full key point list was built for (empty if key points were provided)
+    };
+    /// returns the calling thread's scratch buffers (helps avoid continuous mem realloc without sharing state across threads)
+    static Workspace& getWorkspace();
+    /// fills key point list with all pixel locations of the current image (if not already done for its size)
+    static void scdesc_fill_full_keypts(Workspace& oWS);
     /// fills contour point map using provided binary image
-    void scdesc_fill_contours(const cv::Mat& oImage);
-    /// fills mean-normalized dist map & angle map using internal contour/key points
-    void scdesc_fill_maps(double dMeanDist=-1.0);
-    /// fills descriptor using internal maps
-    void scdesc_fill_desc(cv::Mat_<float>& oDescriptors, bool bGenDescMap);
-    /// fills descriptor without using internal maps (only for absolute descs w/o rot inv)
-    void scdesc_fill_desc_direct(cv::Mat_<float>& oDescriptors, bool bGenDescMap);
+    void scdesc_fill_contours(const cv::Mat& oImage, Workspace& oWS);
+    /// fills mean-normalized dist map & angle map using workspace contour/key points (computes norm/atan2 for every key/contour point pair)
+    void scdesc_fill_maps(Workspace& oWS, double dMeanDist=-1.0) const;
+    /// fills descriptor using workspace maps
+    void scdesc_fill_desc(cv::Mat_<float>& oDescriptors, bool bGenDescMap, Workspace& oWS);
+    /// fills descriptor without using workspace maps (only for absolute descs w/o rot inv; contour grid pruning always applies, but lookup-based binning only with USE_LIENHART_LOOKUP_MASK)
+    void scdesc_fill_desc_direct(cv::Mat_<float>& oDescriptors, bool bGenDescMap, Workspace& oWS);
     /// descriptor normalisation approach impl
     void scdesc_norm(cv::Mat_<float>& oDescriptors) const;
 
     // helper variables for internal impl (helps avoid continuous mem realloc)
     std::vector<double> m_vAngularLimits,m_vRadialLimits;
-    cv::Mat_<double> m_oDistMap,m_oAngMap;
     cv::Mat_<float> m_oEMDCostMap;
     cv::Mat_<int> m_oAbsDescLUMap;
 #if HAVE_CUDA
@@ -208,8 +221,6 @@ private:
     unsigned long long m_pDescLUMap_tex;
     size_t m_nBlockSize;
 #endif //HAVE_CUDA
-    cv::Mat_<cv::Point2f> m_oKeyPts,m_oContourPts;
-    cv::Mat_<uchar> m_oBinMask,m_oDistMask,m_oDilateKernel;
-    cv::Size m_oCurrImageSize;
-    bool m_bUsingFullKeyPtMap;
+    cv::Mat_<uchar> m_oDilateKernel;
+    cv::Size m_oFullKeyPtMapSize_dev; ///< size of the image the full key point list on device was built for (empty if key points were provided)
 };
\ No newline at end of file
@@ -0,0 +1,90 @@
+
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2016 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "litiv/utils/opencv.hpp"
+#include <opencv2/features2d.hpp>
+#include <functional>
+#include <map>
+
+namespace lv {
+
+    /// list of cpu instruction set levels recognized by the descriptor extractor registry (ordered by increasing capability)
+    /// note: the descriptor distance kernels below are dispatched at runtime; other inlined simd code still follows the build level
+    enum CPUInstrSet {
+        CPUInstrSet_Scalar,
+        CPUInstrSet_SSE2,
+        CPUInstrSet_SSSE3,
+        CPUInstrSet_SSE4_1,
+        CPUInstrSet_AVX,
+        CPUInstrSet_AVX2,
+    };
+
+    /// returns the name of the given instruction set level (for logging purposes)
+    const char* getCPUInstrSetName(CPUInstrSet eInstrSet);
+    /// returns the highest instruction set level supported by the host cpu (detected once at runtime, then cached)
+    CPUInstrSet getHostCPUInstrSet();
+    /// returns the highest instruction set level the current build was compiled for (i.e. the one used by all inlined kernels)
+    CPUInstrSet getBuildCPUInstrSet();
+
+    /// 16-bit hamming distance kernel signature (same semantics as lv::hdist_16ui; used for LBSP descriptors)
+    using HDist16uiKernel = void(*)(const uint16_t* anBuffer1, const uint16_t* anBuffer2, uint8_t* anOutput, size_t nCount);
+    /// squared L2 distance kernel signature (same semantics as lv::L2sqrdist_32f; used for dense DASC/LSS descriptors)
+    using L2SqrDist32fKernel = float(*)(const float* a, const float* b, size_t nElements);
+    /// returns the 16-bit hamming distance kernel variant selected at runtime for the host cpu (its instruction set level is returned via the optional arg)
+    HDist16uiKernel getHDist16uiKernel(CPUInstrSet* peInstrSet=nullptr);
+    /// returns the squared L2 distance kernel variant selected at runtime for the host cpu (its instruction set level is returned via the optional arg)
+    L2SqrDist32fKernel getL2SqrDist32fKernel(CPUInstrSet* peInstrSet=nullptr);
+
+    /// parameter map used to forward named construction args to registered extractors (e.g. {{"sigma_s",2.0},{"iters",1}})
+    using DescExtractorParams = std::map<std::string,double>;
+
+    /// runtime handle on a registered descriptor extractor; exposes a common dense description interface + impl info
+    struct IDescExtractor {
+        /// required for polymorphism; releases the wrapped extractor
+        virtual ~IDescExtractor() = default;
+        /// returns the registry name of this extractor (e.g. "dasc_rf")
+        virtual const std::string& getName() const = 0;
+        /// returns the wrapped OpenCV-style extractor, for direct access to the full concrete API
+        virtual cv::Ptr<cv::DescriptorExtractor> getExtractor() const = 0;
+        /// returns the expected dense descriptor matrix output info, for a given input matrix size/type
+        virtual lv::MatInfo getOutputInfo(const lv::MatInfo& oInputInfo) const = 0;
+        /// computes the dense descriptor map of the given image (forwarded to the concrete extractor's 'compute2')
+        virtual void compute2(const cv::Mat& oImage, cv::Mat& oDescMap) = 0;
+        /// returns the instruction set level of the runtime-selected distance kernel variant (or of the build, if no kernel is dispatched)
+        virtual CPUInstrSet getInstrSet() const = 0;
+        /// returns the number of worker threads the selected implementation can spread its work over (i.e. the OpenMP max thread count)
+        virtual size_t getThreadCount() const = 0;
+        /// returns whether the selected implementation offloads its work to a GPU or not
+        virtual bool isUsingGPU() const = 0;
+        /// returns a one-line description of the selected implementation (e.g. "dasc_rf [AVX2 x 8 threads]")
+        std::string describeImplementation() const;
+    };
+
+    /// factory function signature used by the registry; params not found in the map should fall back to the extractor's defaults
+    using DescExtractorFactory = std::function<std::unique_ptr<IDescExtractor>(const DescExtractorParams&)>;
+
+    /// registers a new (or overrides an existing) descriptor extractor factory under the given name
+    void registerDescExtractor(const std::string& sName, DescExtractorFactory lFactory);
+    /// returns the list of all registered descriptor extractor names (built-ins: "dasc_rf", "dasc_gf", "lbsp", "lss", "sc")
+    std::vector<std::string> getDescExtractorNames();
+    /// creates the named descriptor extractor; distance kernels (lbsp/dasc/lss) and CUDA ('use_gpu' for sc) are selected at runtime
+    /// (throws if the host cpu lacks the instruction set the build was compiled for; affinity-only tools such as MI are not registered)
+    std::unique_ptr<IDescExtractor> createDescriptorExtractor(const std::string& sName, const DescExtractorParams& mParams=DescExtractorParams());
+
+} // namespace lv
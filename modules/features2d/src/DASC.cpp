@@ -144,9 +144,9 @@ void DASC::compute2(const cv::Mat& oImage, cv::Mat& oDescMap_) {
 
 void DASC::compute2(const cv::Mat& oImage, cv::Mat_<float>& oDescMap) {
     if(m_bUsingRF)
-        dasc_rf_impl(oImage,oDescMap);
+        dasc_rf_impl(oImage,oDescMap,getWorkspace());
     else
-        dasc_gf_impl(oImage,oDescMap);
+        dasc_gf_impl(oImage,oDescMap,getWorkspace());
 }
 
 void DASC::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoints, cv::Mat_<float>& oDescMap) {
@@ -157,23 +157,27 @@ void DASC::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoint
         for(int nColIdx=0; nColIdx<oImage.cols; ++nColIdx)
             voKeypoints.emplace_back(cv::Point2f((float)nColIdx,(float)nRowIdx),float(pretrained::nMaxPatternDiam));
     cv::KeyPointsFilter::runByImageBorder(voKeypoints,oImage.size(),pretrained::nRPAbsMax);
-    if(m_bUsingRF)
-        dasc_rf_impl(oImage,oDescMap);
-    else
-        dasc_gf_impl(oImage,oDescMap);
+    compute2(oImage,oDescMap);
 }
 
 void DASC::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],voDescMapCollection[i]);
+    // each thread describes whole images using its own scratch buffers (see DASC::getWorkspace)
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int i=0; i<(int)voImageCollection.size(); ++i)
+        compute2(voImageCollection[size_t(i)],voDescMapCollection[size_t(i)]);
 }
 
 void DASC::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<std::vector<cv::KeyPoint> >& vvoPointCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     lvAssert_(voImageCollection.size()==vvoPointCollection.size(),"number of images must match number of keypoint lists");
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],vvoPointCollection[i],voDescMapCollection[i]);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int i=0; i<(int)voImageCollection.size(); ++i)
+        compute2(voImageCollection[size_t(i)],vvoPointCollection[size_t(i)],voDescMapCollection[size_t(i)]);
 }
 
 void DASC::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMask, std::vector<cv::KeyPoint>& voKeypoints, cv::OutputArray _oDescriptors, bool bUseProvidedKeypoints) {
@@ -239,26 +243,29 @@ void DASC::calcDistances(const cv::Mat_<float>& oDescriptors1, const cv::Mat_<fl
     if(oDescriptors1.dims==2) {
         lvAssert_(oDescriptors1.cols==int(pretrained::nLUTSize),"unexpected descriptor size");
         oDistances.create(oDescriptors1.rows,1);
+        const lv::L2SqrDist32fKernel pL2SqrDistKernel = lv::getL2SqrDist32fKernel();
         for(int nDescIdx=0; nDescIdx<oDescriptors1.rows; ++nDescIdx) {
-            const cv::Mat_<float> oDesc1(1,int(pretrained::nLUTSize),const_cast<float*>(oDescriptors1.ptr<float>(nDescIdx)));
-            const cv::Mat_<float> oDesc2(1,int(pretrained::nLUTSize),const_cast<float*>(oDescriptors2.ptr<float>(nDescIdx)));
-            oDistances(nDescIdx) = (float)cv::norm(oDesc1,oDesc2,cv::NORM_L2);
+            oDistances(nDescIdx) = std::sqrt(pL2SqrDistKernel(oDescriptors1.ptr<float>(nDescIdx),oDescriptors2.ptr<float>(nDescIdx),pretrained::nLUTSize));
         }
     }
     else { //oDescriptors1.dims==3
         lvAssert_(oDescriptors1.size[2]==int(pretrained::nLUTSize),"unexpected descriptor size");
         oDistances.create(oDescriptors1.size[0],oDescriptors1.size[1]);
+        const lv::L2SqrDist32fKernel pL2SqrDistKernel = lv::getL2SqrDist32fKernel();
         for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.size[0]; ++nDescRowIdx) {
             for(int nDescColIdx=0; nDescColIdx<oDescriptors1.size[1]; ++nDescColIdx) {
-                const cv::Mat_<float> oDesc1(1,int(pretrained::nLUTSize),const_cast<float*>(oDescriptors1.ptr<float>(nDescRowIdx,nDescColIdx)));
-                const cv::Mat_<float> oDesc2(1,int(pretrained::nLUTSize),const_cast<float*>(oDescriptors2.ptr<float>(nDescRowIdx,nDescColIdx)));
-                oDistances(nDescRowIdx,nDescColIdx) = (float)cv::norm(oDesc1,oDesc2,cv::NORM_L2);
+                oDistances(nDescRowIdx,nDescColIdx) = std::sqrt(pL2SqrDistKernel(oDescriptors1.ptr<float>(nDescRowIdx,nDescColIdx),oDescriptors2.ptr<float>(nDescRowIdx,nDescColIdx),pretrained::nLUTSize));
             }
         }
     }
 }
 
-void DASC::recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef_V_dHdx, const cv::Mat_<float>& oRef_V_dVdy_t, cv::Mat_<float>& oOutput) {
+DASC::Workspace& DASC::getWorkspace() {
+    static thread_local Workspace s_oWorkspace;
+    return s_oWorkspace;
+}
+
+void DASC::recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef_V_dHdx, const cv::Mat_<float>& oRef_V_dVdy_t, cv::Mat_<float>& oOutput, Workspace& oWS) const {
     lvDbgAssert(!oImage.empty() && !oRef_V_dHdx.empty() && !oRef_V_dHdx.empty() && m_nIters>0 && oImage.dims==2 && oRef_V_dHdx.dims==3 && oRef_V_dVdy_t.dims==3);
     lvDbgAssert(oImage.rows==oRef_V_dHdx.size[1] && oImage.rows==oRef_V_dVdy_t.size[2] && oImage.cols==oRef_V_dHdx.size[2] && oImage.cols==oRef_V_dVdy_t.size[1]);
     lvDbgAssert(oRef_V_dHdx.size[0]==(int)m_nIters && oRef_V_dVdy_t.size[0]==(int)m_nIters);
@@ -275,13 +282,13 @@ void DASC::recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oR
     };
     for(int nIterIdx=0; nIterIdx<(int)m_nIters; ++nIterIdx) {
         lTransfDomRecursFilter_H(oOutput,oRef_V_dHdx,nIterIdx);
-        cv::transpose(oOutput,m_oTempTransp);
-        lTransfDomRecursFilter_H(m_oTempTransp,oRef_V_dVdy_t,nIterIdx);
-        cv::transpose(m_oTempTransp,oOutput);
+        cv::transpose(oOutput,oWS.oTempTransp);
+        lTransfDomRecursFilter_H(oWS.oTempTransp,oRef_V_dVdy_t,nIterIdx);
+        cv::transpose(oWS.oTempTransp,oOutput);
     }
 }
 
-void DASC::dasc_rf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
+void DASC::dasc_rf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors, Workspace& oWS) const {
     lvAssert_(!_oImage.empty() && (_oImage.channels()==1 || _oImage.channels()==3) && (_oImage.depth()==CV_32F || _oImage.depth()==CV_8U),"invalid input image");
     lvAssert__(pretrained::nMaxPatternDiam<=_oImage.cols && pretrained::nMaxPatternDiam<=_oImage.rows,"image is too small to compute descriptors with current pattern size -- need at least (%d,%d) and got (%d,%d)",pretrained::nMaxPatternDiam,pretrained::nMaxPatternDiam,_oImage.cols,_oImage.rows);
     cv::Mat oImageTemp;
@@ -295,31 +302,31 @@ void DASC::dasc_rf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
     cv::Mat_<float> oImage = oImageTemp;
     if(m_bPreProcess)
         cv::GaussianBlur(oImage,oImage,cv::Size(7,7),1.0);
-    m_oImageSize = oImage.size();
-    const int nRows = m_oImageSize.height;
-    const int nCols = m_oImageSize.width;
-    lv::localDiff<1,0>(oImage,m_oImageLocalDiff_Y);
-    lv::localDiff<0,1>(oImage,m_oImageLocalDiff_X);
-    m_oRef_dVdy = 1.0f + m_fSigma_s/m_fSigma_r*cv::abs(m_oImageLocalDiff_Y);
-    m_oRef_dHdx = 1.0f + m_fSigma_s/m_fSigma_r*cv::abs(m_oImageLocalDiff_X);
+    oWS.oImageSize = oImage.size();
+    const int nRows = oWS.oImageSize.height;
+    const int nCols = oWS.oImageSize.width;
+    lv::localDiff<1,0>(oImage,oWS.oImageLocalDiff_Y);
+    lv::localDiff<0,1>(oImage,oWS.oImageLocalDiff_X);
+    oWS.oRef_dVdy = 1.0f + m_fSigma_s/m_fSigma_r*cv::abs(oWS.oImageLocalDiff_Y);
+    oWS.oRef_dHdx = 1.0f + m_fSigma_s/m_fSigma_r*cv::abs(oWS.oImageLocalDiff_X);
     const std::array<int,3> anRefDims = {(int)m_nIters,nRows,nCols};
-    m_oRef_V_dHdx.create(3,anRefDims.data());
+    oWS.oRef_V_dHdx.create(3,anRefDims.data());
     const std::array<int,3> anRefDims_t = {(int)m_nIters,nCols,nRows};
-    m_oRef_V_dVdy_t.create(3,anRefDims_t.data());
+    oWS.oRef_V_dVdy_t.create(3,anRefDims_t.data());
     for(int nIterIdx=0; nIterIdx<(int)m_nIters; ++nIterIdx) {
         const float fBase = std::exp(-std::sqrt(2.0f)/(m_fSigma_s*std::sqrt(3.0f)*(float)std::pow(2.0f,(int)m_nIters-(nIterIdx+1))/std::sqrt((float)std::pow(4.0f,(int)m_nIters)-1)));
         for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
             for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
-                m_oRef_V_dHdx(nIterIdx,nRowIdx,nColIdx) = std::pow(fBase,m_oRef_dHdx(nRowIdx,nColIdx));
-                m_oRef_V_dVdy_t(nIterIdx,nColIdx,nRowIdx) = std::pow(fBase,m_oRef_dVdy(nRowIdx,nColIdx));
+                oWS.oRef_V_dHdx(nIterIdx,nRowIdx,nColIdx) = std::pow(fBase,oWS.oRef_dHdx(nRowIdx,nColIdx));
+                oWS.oRef_V_dVdy_t(nIterIdx,nColIdx,nRowIdx) = std::pow(fBase,oWS.oRef_dVdy(nRowIdx,nColIdx));
             }
         }
     }
-    recursFilter(oImage,m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oImage_AdaptiveMean);
-    recursFilter(oImage.mul(oImage),m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oImage_AdaptiveMeanSqr);
-    m_oLookupImage.create(m_oImageSize);
-    m_oLookupImage_Sqr.create(m_oImageSize);
-    m_oLookupImage_Mix.create(m_oImageSize);
+    recursFilter(oImage,oWS.oRef_V_dHdx,oWS.oRef_V_dVdy_t,oWS.oImage_AdaptiveMean,oWS);
+    recursFilter(oImage.mul(oImage),oWS.oRef_V_dHdx,oWS.oRef_V_dVdy_t,oWS.oImage_AdaptiveMeanSqr,oWS);
+    oWS.oLookupImage.create(oWS.oImageSize);
+    oWS.oLookupImage_Sqr.create(oWS.oImageSize);
+    oWS.oLookupImage_Mix.create(oWS.oImageSize);
     const std::array<int,3> anDescDims = {nRows,nCols,(int)pretrained::nLUTSize};
     oDescriptors.create(3,anDescDims.data());
     for(int nLUTIdx=0; nLUTIdx<(int)pretrained::nLUTSize; nLUTIdx++) {
@@ -328,24 +335,24 @@ void DASC::dasc_rf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
         for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
             for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
                 if(nRowIdx+nRowOffset>=0 && nRowIdx+nRowOffset<nRows && nColIdx+nColOffset>=0 && nColIdx+nColOffset<nCols) {
-                    m_oLookupImage(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
-                    m_oLookupImage_Sqr(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
-                    m_oLookupImage_Mix(nRowIdx,nColIdx) = oImage(nRowIdx,nColIdx)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
+                    oWS.oLookupImage(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
+                    oWS.oLookupImage_Sqr(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
+                    oWS.oLookupImage_Mix(nRowIdx,nColIdx) = oImage(nRowIdx,nColIdx)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
                 }
                 else
-                    m_oLookupImage(nRowIdx,nColIdx) = m_oLookupImage_Sqr(nRowIdx,nColIdx) = m_oLookupImage_Mix(nRowIdx,nColIdx) = 0.0f;
+                    oWS.oLookupImage(nRowIdx,nColIdx) = oWS.oLookupImage_Sqr(nRowIdx,nColIdx) = oWS.oLookupImage_Mix(nRowIdx,nColIdx) = 0.0f;
             }
         }
-        recursFilter(m_oLookupImage,m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oLookupImage_AdaptiveMean);
-        recursFilter(m_oLookupImage_Sqr,m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oLookupImage_AdaptiveMeanSqr);
-        recursFilter(m_oLookupImage_Mix,m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oLookupImage_AdaptiveMeanMix);
+        recursFilter(oWS.oLookupImage,oWS.oRef_V_dHdx,oWS.oRef_V_dVdy_t,oWS.oLookupImage_AdaptiveMean,oWS);
+        recursFilter(oWS.oLookupImage_Sqr,oWS.oRef_V_dHdx,oWS.oRef_V_dVdy_t,oWS.oLookupImage_AdaptiveMeanSqr,oWS);
+        recursFilter(oWS.oLookupImage_Mix,oWS.oRef_V_dHdx,oWS.oRef_V_dVdy_t,oWS.oLookupImage_AdaptiveMeanMix,oWS);
         for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
             for(int nColIdx = 0; nColIdx<nCols; ++nColIdx) {
                 const int nOffsetRowIdx = nRowIdx+pretrained::anRP1[nLUTIdx*2];
                 const int nOffsetColIdx = nColIdx+pretrained::anRP1[nLUTIdx*2+1];
                 if(nOffsetRowIdx>0 && nOffsetRowIdx<nRows && nOffsetColIdx>0 && nOffsetColIdx<nCols) {
-                    const float fCorrSurfDenom = std::sqrt((m_oImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)) * (m_oLookupImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)));
-                    const float fVisDiff = m_oLookupImage_AdaptiveMeanMix(nOffsetRowIdx,nOffsetColIdx)-m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx);
+                    const float fCorrSurfDenom = std::sqrt((oWS.oImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-oWS.oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*oWS.oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)) * (oWS.oLookupImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-oWS.oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*oWS.oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)));
+                    const float fVisDiff = oWS.oLookupImage_AdaptiveMeanMix(nOffsetRowIdx,nOffsetColIdx)-oWS.oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*oWS.oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx);
                     oDescriptors(nRowIdx,nColIdx,nLUTIdx) = fCorrSurfDenom>LOCAL_EPS?std::min(std::exp(-(1-(fVisDiff)/fCorrSurfDenom)*2),1.0f):1.0f;
                 }
                 else
@@ -365,22 +372,22 @@ void DASC::dasc_rf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
     }
 }
 
-void DASC::guidedFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef, cv::Mat_<float>& oOutput) {
+void DASC::guidedFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef, cv::Mat_<float>& oOutput, Workspace& oWS) const {
     lvDbgAssert(!oImage.empty() && !oRef.empty());
-    cv::resize(oRef,m_oRef_SubSampl,m_oSubSamplSize,0.0,0.0,cv::INTER_NEAREST);
-    m_oRef_SubSamplCross = m_oImage_SubSampl.mul(m_oRef_SubSampl);
-    cv::blur(m_oRef_SubSampl,m_oRef_SubSamplBlur,m_oBlurKernelSize);
-    cv::blur(m_oRef_SubSamplCross,m_oRef_SubSamplCrossBlur,m_oBlurKernelSize);
-    m_oNormVar_SubSampl = (m_oRef_SubSamplCrossBlur-m_oImage_SubSamplBlur.mul(m_oRef_SubSamplBlur))/m_oImage_SubSamplVar;
-    m_oNormVarDiff_SubSampl = m_oRef_SubSamplBlur - m_oNormVar_SubSampl.mul(m_oImage_SubSamplBlur);
-    cv::blur(m_oNormVar_SubSampl,m_oNormVar_SubSamplBlur,m_oBlurKernelSize);
-    cv::blur(m_oNormVarDiff_SubSampl,m_oNormVarDiff_SubSamplBlur,m_oBlurKernelSize);
-    cv::resize(m_oNormVar_SubSamplBlur,m_oNormVar,m_oImageSize,0,0,cv::INTER_LINEAR);
-    cv::resize(m_oNormVarDiff_SubSamplBlur,m_oNormVarDiff,m_oImageSize,0,0,cv::INTER_LINEAR);
-    oOutput = m_oNormVar.mul(oImage)+m_oNormVarDiff;
+    cv::resize(oRef,oWS.oRef_SubSampl,oWS.oSubSamplSize,0.0,0.0,cv::INTER_NEAREST);
+    oWS.oRef_SubSamplCross = oWS.oImage_SubSampl.mul(oWS.oRef_SubSampl);
+    cv::blur(oWS.oRef_SubSampl,oWS.oRef_SubSamplBlur,oWS.oBlurKernelSize);
+    cv::blur(oWS.oRef_SubSamplCross,oWS.oRef_SubSamplCrossBlur,oWS.oBlurKernelSize);
+    oWS.oNormVar_SubSampl = (oWS.oRef_SubSamplCrossBlur-oWS.oImage_SubSamplBlur.mul(oWS.oRef_SubSamplBlur))/oWS.oImage_SubSamplVar;
+    oWS.oNormVarDiff_SubSampl = oWS.oRef_SubSamplBlur - oWS.oNormVar_SubSampl.mul(oWS.oImage_SubSamplBlur);
+    cv::blur(oWS.oNormVar_SubSampl,oWS.oNormVar_SubSamplBlur,oWS.oBlurKernelSize);
+    cv::blur(oWS.oNormVarDiff_SubSampl,oWS.oNormVarDiff_SubSamplBlur,oWS.oBlurKernelSize);
+    cv::resize(oWS.oNormVar_SubSamplBlur,oWS.oNormVar,oWS.oImageSize,0,0,cv::INTER_LINEAR);
+    cv::resize(oWS.oNormVarDiff_SubSamplBlur,oWS.oNormVarDiff,oWS.oImageSize,0,0,cv::INTER_LINEAR);
+    oOutput = oWS.oNormVar.mul(oImage)+oWS.oNormVarDiff;
 }
 
-void DASC::dasc_gf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
+void DASC::dasc_gf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors, Workspace& oWS) const {
     lvAssert_(!_oImage.empty() && (_oImage.channels()==1 || _oImage.channels()==3) && (_oImage.depth()==CV_32F || _oImage.depth()==CV_8U),"invalid input image");
     lvAssert__(pretrained::nMaxPatternDiam<=_oImage.cols && pretrained::nMaxPatternDiam<=_oImage.rows,"image is too small to compute descriptors with current pattern size -- need at least (%d,%d) and got (%d,%d)",pretrained::nMaxPatternDiam,pretrained::nMaxPatternDiam,_oImage.cols,_oImage.rows);
     cv::Mat oImageTemp;
@@ -394,24 +401,24 @@ void DASC::dasc_gf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
     cv::Mat_<float> oImage = oImageTemp;
     if(m_bPreProcess)
         cv::GaussianBlur(oImage,oImage,cv::Size(7,7),1.0);
-    m_oImageSize = oImage.size();
-    lvAssert(m_oImageSize.area()>0);
-    m_oSubSamplSize = cv::Size(int(m_oImageSize.width/m_nSubSamplFrac),int(m_oImageSize.height/m_nSubSamplFrac));
-    lvAssert(m_oSubSamplSize.area()>0);
+    oWS.oImageSize = oImage.size();
+    lvAssert(oWS.oImageSize.area()>0);
+    oWS.oSubSamplSize = cv::Size(int(oWS.oImageSize.width/m_nSubSamplFrac),int(oWS.oImageSize.height/m_nSubSamplFrac));
+    lvAssert(oWS.oSubSamplSize.area()>0);
     const int nKernelRadius = (int)(m_nRadius/m_nSubSamplFrac);
     lvAssert(nKernelRadius>0);
-    m_oBlurKernelSize = cv::Size(2*nKernelRadius+1,2*nKernelRadius+1);
-    const int nRows = m_oImageSize.height;
-    const int nCols = m_oImageSize.width;
-    cv::resize(oImage,m_oImage_SubSampl,m_oSubSamplSize,0.0,0.0,cv::INTER_NEAREST);
-    cv::blur(m_oImage_SubSampl,m_oImage_SubSamplBlur,m_oBlurKernelSize);
-    cv::blur(m_oImage_SubSampl.mul(m_oImage_SubSampl),m_oImage_SubSamplBlurSqr,m_oBlurKernelSize);
-    m_oImage_SubSamplVar = m_oImage_SubSamplBlurSqr-m_oImage_SubSamplBlur.mul(m_oImage_SubSamplBlur)+m_fEpsilon;
-    guidedFilter(oImage,oImage,m_oImage_AdaptiveMean);
-    guidedFilter(oImage,oImage.mul(oImage),m_oImage_AdaptiveMeanSqr);
-    m_oLookupImage.create(m_oImageSize);
-    m_oLookupImage_Sqr.create(m_oImageSize);
-    m_oLookupImage_Mix.create(m_oImageSize);
+    oWS.oBlurKernelSize = cv::Size(2*nKernelRadius+1,2*nKernelRadius+1);
+    const int nRows = oWS.oImageSize.height;
+    const int nCols = oWS.oImageSize.width;
+    cv::resize(oImage,oWS.oImage_SubSampl,oWS.oSubSamplSize,0.0,0.0,cv::INTER_NEAREST);
+    cv::blur(oWS.oImage_SubSampl,oWS.oImage_SubSamplBlur,oWS.oBlurKernelSize);
+    cv::blur(oWS.oImage_SubSampl.mul(oWS.oImage_SubSampl),oWS.oImage_SubSamplBlurSqr,oWS.oBlurKernelSize);
+    oWS.oImage_SubSamplVar = oWS.oImage_SubSamplBlurSqr-oWS.oImage_SubSamplBlur.mul(oWS.oImage_SubSamplBlur)+m_fEpsilon;
+    guidedFilter(oImage,oImage,oWS.oImage_AdaptiveMean,oWS);
+    guidedFilter(oImage,oImage.mul(oImage),oWS.oImage_AdaptiveMeanSqr,oWS);
+    oWS.oLookupImage.create(oWS.oImageSize);
+    oWS.oLookupImage_Sqr.create(oWS.oImageSize);
+    oWS.oLookupImage_Mix.create(oWS.oImageSize);
     const std::array<int,3> anDescDims = {nRows,nCols,(int)pretrained::nLUTSize};
     oDescriptors.create(3,anDescDims.data());
     for(int nLUTIdx=0; nLUTIdx<(int)pretrained::nLUTSize; nLUTIdx++) {
@@ -420,24 +427,24 @@ void DASC::dasc_gf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
         for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
             for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
                 if(nRowIdx+nRowOffset>=0 && nRowIdx+nRowOffset<nRows && nColIdx+nColOffset>=0 && nColIdx+nColOffset<nCols) {
-                    m_oLookupImage(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
-                    m_oLookupImage_Sqr(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
-                    m_oLookupImage_Mix(nRowIdx,nColIdx) = oImage(nRowIdx,nColIdx)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
+                    oWS.oLookupImage(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
+                    oWS.oLookupImage_Sqr(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
+                    oWS.oLookupImage_Mix(nRowIdx,nColIdx) = oImage(nRowIdx,nColIdx)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
                 }
                 else
-                    m_oLookupImage(nRowIdx,nColIdx) = m_oLookupImage_Sqr(nRowIdx,nColIdx) = m_oLookupImage_Mix(nRowIdx,nColIdx) = 0.0f;
+                    oWS.oLookupImage(nRowIdx,nColIdx) = oWS.oLookupImage_Sqr(nRowIdx,nColIdx) = oWS.oLookupImage_Mix(nRowIdx,nColIdx) = 0.0f;
             }
         }
-        guidedFilter(oImage,m_oLookupImage,m_oLookupImage_AdaptiveMean);
-        guidedFilter(oImage,m_oLookupImage_Sqr,m_oLookupImage_AdaptiveMeanSqr);
-        guidedFilter(oImage,m_oLookupImage_Mix,m_oLookupImage_AdaptiveMeanMix);
+        guidedFilter(oImage,oWS.oLookupImage,oWS.oLookupImage_AdaptiveMean,oWS);
+        guidedFilter(oImage,oWS.oLookupImage_Sqr,oWS.oLookupImage_AdaptiveMeanSqr,oWS);
+        guidedFilter(oImage,oWS.oLookupImage_Mix,oWS.oLookupImage_AdaptiveMeanMix,oWS);
         for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
             for(int nColIdx = 0; nColIdx<nCols; ++nColIdx) {
                 const int nOffsetRowIdx = nRowIdx+pretrained::anRP1[nLUTIdx*2];
                 const int nOffsetColIdx = nColIdx+pretrained::anRP1[nLUTIdx*2+1];
                 if(nOffsetRowIdx>0 && nOffsetRowIdx<nRows && nOffsetColIdx>0 && nOffsetColIdx<nCols) {
-                    const float fCorrSurfDenom = std::sqrt((m_oImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)) * (m_oLookupImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)));
-                    const float fVisDiff = m_oLookupImage_AdaptiveMeanMix(nOffsetRowIdx,nOffsetColIdx)-m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx);
+                    const float fCorrSurfDenom = std::sqrt((oWS.oImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-oWS.oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*oWS.oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)) * (oWS.oLookupImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-oWS.oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*oWS.oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)));
+                    const float fVisDiff = oWS.oLookupImage_AdaptiveMeanMix(nOffsetRowIdx,nOffsetColIdx)-oWS.oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*oWS.oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx);
                     oDescriptors(nRowIdx,nColIdx,nLUTIdx) = fCorrSurfDenom>LOCAL_EPS?std::min(std::exp(-(1-(fVisDiff)/fCorrSurfDenom)*2),1.0f):1.0f;
                 }
                 else
@@ -16,6 +16,7 @@
 // limitations under the License.
 
 #include "litiv/features2d/LBSP.hpp"
+#include "litiv/features2d/registry.hpp"
 
 // make sure static constexpr array addresses exist
 constexpr int LBSP::s_anIdxLUT_16bitdbcross[16][2];
@@ -251,15 +252,21 @@ void LBSP::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoint
 
 void LBSP::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<cv::Mat>& voDescMapCollection) const {
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i], voDescMapCollection[i]);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int i=0; i<(int)voImageCollection.size(); ++i)
+        compute2(voImageCollection[size_t(i)], voDescMapCollection[size_t(i)]);
 }
 
 void LBSP::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<std::vector<cv::KeyPoint>>& vvoPointCollection, std::vector<cv::Mat>& voDescMapCollection) const {
     lvAssert_(voImageCollection.size()==vvoPointCollection.size(),"number of images must match number of keypoint lists");
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i], vvoPointCollection[i], voDescMapCollection[i]);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int i=0; i<(int)voImageCollection.size(); ++i)
+        compute2(voImageCollection[size_t(i)], vvoPointCollection[size_t(i)], voDescMapCollection[size_t(i)]);
 }
 
 void LBSP::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMask, std::vector<cv::KeyPoint>& voKeypoints, cv::OutputArray _oDescriptors, bool bUseProvidedKeypoints) {
@@ -322,38 +329,31 @@ void LBSP::calcDescImgDiff(const cv::Mat& oDesc1, const cv::Mat& oDesc2, cv::Mat
     lvAssert_(oDesc1.size()==oDesc2.size() && oDesc1.type()==oDesc2.type(),"size/type of descriptor mats must match");
     lvDbgAssert(oDesc1.step.p[0]==oDesc2.step.p[0] && oDesc1.step.p[1]==oDesc2.step.p[1]);
     const float fScaleFactor = (float)UCHAR_MAX/(LBSP::DESC_SIZE_BITS);
-    const size_t nChannels = CV_MAT_CN(oDesc1.type());
-    const size_t _step_row = oDesc1.step.p[0];
-    if(nChannels==1) {
+    const int nChannels = CV_MAT_CN(oDesc1.type());
+    const size_t nRowElems = size_t(oDesc1.cols*nChannels);
+    if(nChannels==1 || !bForceMergeChannels)
+        oOutput.create(oDesc1.size(),CV_MAKETYPE(CV_8U,nChannels));
+    else
         oOutput.create(oDesc1.size(),CV_8UC1);
-        oOutput = cv::Scalar(0);
-        for(int i=0; i<oDesc1.rows; ++i) {
-            const size_t idx = _step_row*i;
-            const ushort* const desc1_ptr = (ushort*)(oDesc1.data+idx);
-            const ushort* const desc2_ptr = (ushort*)(oDesc2.data+idx);
-            for(int j=0; j<oDesc1.cols; ++j)
-                oOutput.at<uchar>(i,j) = (uchar)(fScaleFactor*lv::hdist(desc1_ptr[j],desc2_ptr[j]));
+    const lv::HDist16uiKernel pHDistKernel = lv::getHDist16uiKernel();
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nRowIdx=0; nRowIdx<oDesc1.rows; ++nRowIdx) {
+        static thread_local lv::AutoBuffer<uchar> s_aDistData;
+        s_aDistData.resize(nRowElems);
+        pHDistKernel(oDesc1.ptr<ushort>(nRowIdx),oDesc2.ptr<ushort>(nRowIdx),s_aDistData.data(),nRowElems);
+        uchar* pOutputRow = oOutput.ptr<uchar>(nRowIdx);
+        if(nChannels==1 || !bForceMergeChannels) {
+            for(size_t nElemIdx=0; nElemIdx<nRowElems; ++nElemIdx)
+                pOutputRow[nElemIdx] = (uchar)(fScaleFactor*s_aDistData[nElemIdx]);
         }
-    }
-    else { //nChannels==3
-        if(bForceMergeChannels)
-            oOutput.create(oDesc1.size(),CV_8UC1);
-        else
-            oOutput.create(oDesc1.size(),CV_8UC3);
-        oOutput = cv::Scalar::all(0);
-        for(int i=0; i<oDesc1.rows; ++i) {
-            const size_t idx =  _step_row*i;
-            const ushort* const desc1_ptr = (ushort*)(oDesc1.data+idx);
-            const ushort* const desc2_ptr = (ushort*)(oDesc2.data+idx);
-            uchar* output_ptr = oOutput.data + oOutput.step.p[0]*i;
-            for(int j=0; j<oDesc1.cols; ++j) {
-                for(size_t n=0;n<3; ++n) {
-                    const size_t idx2 = 3*j+n;
-                    if(bForceMergeChannels)
-                        output_ptr[j] += (uchar)((fScaleFactor*lv::hdist(desc1_ptr[idx2],desc2_ptr[idx2]))/3);
-                    else
-                        output_ptr[idx2] = (uchar)(fScaleFactor*lv::hdist(desc1_ptr[idx2],desc2_ptr[idx2]));
-                }
+        else {
+            for(int nColIdx=0; nColIdx<oDesc1.cols; ++nColIdx) {
+                uchar nOutput = 0;
+                for(int nChIdx=0; nChIdx<nChannels; ++nChIdx)
+                    nOutput += (uchar)((fScaleFactor*s_aDistData[nColIdx*nChannels+nChIdx])/nChannels);
+                pOutputRow[nColIdx] = nOutput;
             }
         }
     }
@@ -376,23 +376,69 @@ void LBSP::calcDistances(const cv::Mat& oDescriptors1, const cv::Mat& oDescripto
     lvAssert_(oDescriptors1.dims==2 && oDescriptors2.dims==2 && oDescriptors1.size()==oDescriptors2.size(),"descriptor mat sizes mismatch");
     lvAssert_(oDescriptors1.depth()==CV_16U && oDescriptors2.depth()==CV_16U,"unexpected descriptor matrix type");
     lvAssert_(oDescriptors1.type()==oDescriptors2.type(),"descriptor mat types mismatch");
+    lvAssert_(oDescriptors1.channels()<=4,"unexpected descriptor matrix channel count");
     oDistances.create(oDescriptors1.rows,oDescriptors1.cols);
-    if(oDescriptors1.channels()==1)
-        for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
-            for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx)
-                oDistances(nDescRowIdx,nDescColIdx) = lv::hdist<ushort,uchar>(oDescriptors1.at<ushort>(nDescRowIdx,nDescColIdx),oDescriptors2.at<ushort>(nDescRowIdx,nDescColIdx));
-    else if(oDescriptors1.channels()==2)
-        for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
-            for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx)
-                oDistances(nDescRowIdx,nDescColIdx) = lv::hdist<2,ushort,uchar>(oDescriptors1.ptr<ushort>(nDescRowIdx,nDescColIdx),oDescriptors2.ptr<ushort>(nDescRowIdx,nDescColIdx));
-    else if(oDescriptors1.channels()==3)
-        for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
-            for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx)
-                oDistances(nDescRowIdx,nDescColIdx) = lv::hdist<3,ushort,uchar>(oDescriptors1.ptr<ushort>(nDescRowIdx,nDescColIdx),oDescriptors2.ptr<ushort>(nDescRowIdx,nDescColIdx));
-    else if(oDescriptors1.channels()==4)
-        for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
-            for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx)
-                oDistances(nDescRowIdx,nDescColIdx) = lv::hdist<4,ushort,uchar>(oDescriptors1.ptr<ushort>(nDescRowIdx,nDescColIdx),oDescriptors2.ptr<ushort>(nDescRowIdx,nDescColIdx));
+    const int nChannels = oDescriptors1.channels();
+    const size_t nRowElems = size_t(oDescriptors1.cols*nChannels);
+    const lv::HDist16uiKernel pHDistKernel = lv::getHDist16uiKernel();
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx) {
+        uchar* pDistRow = oDistances.ptr<uchar>(nDescRowIdx);
+        if(nChannels==1) {
+            pHDistKernel(oDescriptors1.ptr<ushort>(nDescRowIdx),oDescriptors2.ptr<ushort>(nDescRowIdx),pDistRow,nRowElems);
+            continue;
+        }
+        // multi-channel distances are summed per descriptor after the vectorized per-channel pass
+        static thread_local lv::AutoBuffer<uchar> s_aDistData;
+        s_aDistData.resize(nRowElems);
+        pHDistKernel(oDescriptors1.ptr<ushort>(nDescRowIdx),oDescriptors2.ptr<ushort>(nDescRowIdx),s_aDistData.data(),nRowElems);
+        for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx) {
+            uchar nDist = 0;
+            for(int nChIdx=0; nChIdx<nChannels; ++nChIdx)
+                nDist += s_aDistData[nDescColIdx*nChannels+nChIdx];
+            pDistRow[nDescColIdx] = nDist;
+        }
+    }
+}
+
+void LBSP::calcMatchCounts(const cv::Mat& oDescMap, const std::vector<cv::Mat>& voRefDescMaps, size_t nMaxDist, size_t nRequiredMatches, cv::Mat_<uchar>& oMatchCounts) {
+    lvAssert_(oDescMap.dims==2 && oDescMap.depth()==CV_16U && oDescMap.channels()<=4,"unexpected descriptor matrix type");
+    lvAssert_(nRequiredMatches>0 && nRequiredMatches<=UCHAR_MAX,"required match count must be in [1,255]");
+    for(const cv::Mat& oRefDescMap : voRefDescMaps)
+        lvAssert_(oRefDescMap.dims==2 && oRefDescMap.size()==oDescMap.size() && oRefDescMap.type()==oDescMap.type(),"reference descriptor map sizes/types mismatch");
+    oMatchCounts.create(oDescMap.rows,oDescMap.cols);
+    const int nChannels = oDescMap.channels();
+    constexpr int nBlockSize = 64; // pixels tested together against each reference; the block exits as soon as all of its pixels are satisfied
+    const lv::HDist16uiKernel pHDistKernel = lv::getHDist16uiKernel();
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nRowIdx=0; nRowIdx<oDescMap.rows; ++nRowIdx) {
+        std::array<uchar,nBlockSize*4> anDists;
+        uchar* pCountRow = oMatchCounts.ptr<uchar>(nRowIdx);
+        for(int nBlockColIdx=0; nBlockColIdx<oDescMap.cols; nBlockColIdx+=nBlockSize) {
+            const int nCurrBlockSize = std::min(nBlockSize,oDescMap.cols-nBlockColIdx);
+            uchar* pCounts = pCountRow+nBlockColIdx;
+            std::fill_n(pCounts,nCurrBlockSize,uchar(0));
+            int nSatisfiedCount = 0;
+            const ushort* pDescs = oDescMap.ptr<ushort>(nRowIdx)+nBlockColIdx*nChannels;
+            for(size_t nRefIdx=0; nRefIdx<voRefDescMaps.size() && nSatisfiedCount<nCurrBlockSize; ++nRefIdx) {
+                const ushort* pRefDescs = voRefDescMaps[nRefIdx].ptr<ushort>(nRowIdx)+nBlockColIdx*nChannels;
+                pHDistKernel(pDescs,pRefDescs,anDists.data(),size_t(nCurrBlockSize*nChannels));
+                for(int nColIdx=0; nColIdx<nCurrBlockSize; ++nColIdx) {
+                    if(pCounts[nColIdx]>=nRequiredMatches)
+                        continue;
+                    size_t nDist = 0;
+                    for(int nChIdx=0; nChIdx<nChannels; ++nChIdx)
+                        nDist += anDists[nColIdx*nChannels+nChIdx];
+                    if(nDist<=nMaxDist && ++pCounts[nColIdx]==nRequiredMatches)
+                        ++nSatisfiedCount;
+                }
+            }
+        }
+    }
 }
 
 #if HAVE_GLSL
@@ -48,6 +48,13 @@ LSS::LSS(int nInnerRadius, int nOuterRadius, int nDescPatchSize, int nAngularBin
     lv::getLogPolarMask(m_nCorrPatchSize,m_nRadialBins,m_nAngularBins,m_oDescLUMap,m_bUsingLienhartMask,(float)m_nInnerRadius,&m_nFirstMaskIdx,&m_nLastMaskIdx);
     lvDbgAssert(m_oDescLUMap.cols==m_nCorrPatchSize && m_oDescLUMap.rows==m_nCorrPatchSize);
     lvDbgAssert(m_nFirstMaskIdx>=0 && m_nLastMaskIdx>=m_nFirstMaskIdx);
+    for(int nLUIdx=0; nLUIdx<(int)m_oDescLUMap.total(); ++nLUIdx) {
+        const int nRowOffset = nLUIdx/m_nCorrPatchSize-m_nCorrPatchSize/2;
+        const int nColOffset = nLUIdx%m_nCorrPatchSize-m_nCorrPatchSize/2;
+        if(m_oDescLUMap(nLUIdx)!=-1 || (!USE_STATIC_VAR_NOISE && std::abs(nRowOffset)<=1 && std::abs(nColOffset)<=1))
+            m_vCorrOffsets.push_back(std::array<int,3>{nRowOffset,nColOffset,m_oDescLUMap(nLUIdx)});
+    }
+    lvDbgAssert(!m_vCorrOffsets.empty());
 }
 
 void LSS::read(const cv::FileNode& /*fn*/) {
@@ -129,15 +136,21 @@ void LSS::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoints
 
 void LSS::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],voDescMapCollection[i]);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int i=0; i<(int)voImageCollection.size(); ++i)
+        compute2(voImageCollection[size_t(i)],voDescMapCollection[size_t(i)]);
 }
 
 void LSS::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<std::vector<cv::KeyPoint> >& vvoPointCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     lvAssert_(voImageCollection.size()==vvoPointCollection.size(),"number of images must match number of keypoint lists");
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],vvoPointCollection[i],voDescMapCollection[i]);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int i=0; i<(int)voImageCollection.size(); ++i)
+        compute2(voImageCollection[size_t(i)],vvoPointCollection[size_t(i)],voDescMapCollection[size_t(i)]);
 }
 
 void LSS::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMask, std::vector<cv::KeyPoint>& voKeypoints, cv::OutputArray _oDescriptors, bool bUseProvidedKeypoints) {
@@ -191,20 +204,18 @@ void LSS::calcDistances(const cv::Mat_<float>& oDescriptors1, const cv::Mat_<flo
     if(oDescriptors1.dims==2) {
         lvAssert_(oDescriptors1.cols==m_nRadialBins*m_nAngularBins,"unexpected descriptor size");
         oDistances.create(oDescriptors1.rows,1);
+        const lv::L2SqrDist32fKernel pL2SqrDistKernel = lv::getL2SqrDist32fKernel();
         for(int nDescIdx=0; nDescIdx<oDescriptors1.rows; ++nDescIdx) {
-            const cv::Mat_<float> oDesc1(1,m_nRadialBins*m_nAngularBins,const_cast<float*>(oDescriptors1.ptr<float>(nDescIdx)));
-            const cv::Mat_<float> oDesc2(1,m_nRadialBins*m_nAngularBins,const_cast<float*>(oDescriptors2.ptr<float>(nDescIdx)));
-            oDistances(nDescIdx) = (float)cv::norm(oDesc1,oDesc2,cv::NORM_L2);
+            oDistances(nDescIdx) = std::sqrt(pL2SqrDistKernel(oDescriptors1.ptr<float>(nDescIdx),oDescriptors2.ptr<float>(nDescIdx),size_t(m_nRadialBins*m_nAngularBins)));
         }
     }
     else { //oDescriptors1.dims==3
         lvAssert_(oDescriptors1.size[2]==m_nRadialBins*m_nAngularBins,"unexpected descriptor size");
         oDistances.create(oDescriptors1.size[0],oDescriptors1.size[1]);
+        const lv::L2SqrDist32fKernel pL2SqrDistKernel = lv::getL2SqrDist32fKernel();
         for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.size[0]; ++nDescRowIdx) {
             for(int nDescColIdx=0; nDescColIdx<oDescriptors1.size[1]; ++nDescColIdx) {
-                const cv::Mat_<float> oDesc1(1,m_nRadialBins*m_nAngularBins,const_cast<float*>(oDescriptors1.ptr<float>(nDescRowIdx,nDescColIdx)));
-                const cv::Mat_<float> oDesc2(1,m_nRadialBins*m_nAngularBins,const_cast<float*>(oDescriptors2.ptr<float>(nDescRowIdx,nDescColIdx)));
-                oDistances(nDescRowIdx,nDescColIdx) = (float)cv::norm(oDesc1,oDesc2,cv::NORM_L2);
+                oDistances(nDescRowIdx,nDescColIdx) = std::sqrt(pL2SqrDistKernel(oDescriptors1.ptr<float>(nDescRowIdx,nDescColIdx),oDescriptors2.ptr<float>(nDescRowIdx,nDescColIdx),size_t(m_nRadialBins*m_nAngularBins)));
             }
         }
     }
@@ -224,12 +235,9 @@ void LSS::ssdescs_impl(const cv::Mat& _oImage, std::vector<cv::KeyPoint>& voKeyp
         cv::GaussianBlur(_oImage,oImage,cv::Size(7,7),1.0);
     else
         oImage = _oImage;
-    const int nCorrWinRadius = m_nCorrWinSize/2;
+    const int nChannels = oImage.channels();
     const int nPatchRadius = m_nPatchSize/2;
     const int nDescSize = m_nRadialBins*m_nAngularBins;
-    static thread_local lv::AutoBuffer<float> s_aCorrData;
-    s_aCorrData.resize(size_t(m_nCorrPatchSize*m_nCorrPatchSize));
-    cv::Mat_<float> oCorrMap(m_nCorrPatchSize,m_nCorrPatchSize,s_aCorrData.data());
     static thread_local lv::AutoBuffer<float> s_aTempDesc;
     s_aTempDesc.resize(((size_t)nDescSize));
     cv::Mat_<float> oTempDesc(1,nDescSize,s_aTempDesc.data());
@@ -242,22 +250,33 @@ void LSS::ssdescs_impl(const cv::Mat& _oImage, std::vector<cv::KeyPoint>& voKeyp
         const int nRowIdx = int(oCurrKeyPt.pt.y);
         const int nColIdx = int(oCurrKeyPt.pt.x);
         lvDbgAssert(nRowIdx>=0 && nColIdx>=0);
-        const cv::Mat oWindow = oImage(cv::Rect(nColIdx-nCorrWinRadius,nRowIdx-nCorrWinRadius,m_nCorrWinSize,m_nCorrWinSize));
-        const cv::Mat oTempl = oImage(cv::Rect(nColIdx-nPatchRadius,nRowIdx-nPatchRadius,m_nPatchSize,m_nPatchSize));
-        cv::matchTemplate(oWindow,oTempl,oCorrMap,cv::TM_SQDIFF);
+        oTempDesc = std::numeric_limits<float>::max();
+#if !USE_STATIC_VAR_NOISE
+        float fMaxLocalVarNoise = 1000.0f;
+#endif //!USE_STATIC_VAR_NOISE
+        for(const std::array<int,3>& anOffset : m_vCorrOffsets) {
+            // exact ssd between the keypoint's patch and the offset patch (same values as the dense impl's box-filtered maps)
+            int nSSD = 0;
+            for(int nPatchRowIdx=nRowIdx-nPatchRadius; nPatchRowIdx<=nRowIdx+nPatchRadius; ++nPatchRowIdx) {
+                const uchar* pRow = oImage.ptr<uchar>(nPatchRowIdx)+(nColIdx-nPatchRadius)*nChannels;
+                const uchar* pOffsetRow = oImage.ptr<uchar>(nPatchRowIdx+anOffset[0])+(nColIdx-nPatchRadius+anOffset[1])*nChannels;
+                for(int nElemIdx=0; nElemIdx<m_nPatchSize*nChannels; ++nElemIdx) {
+                    const int nDiff = int(pRow[nElemIdx])-int(pOffsetRow[nElemIdx]);
+                    nSSD += nDiff*nDiff;
+                }
+            }
+            if(anOffset[2]!=-1)
+                s_aTempDesc[anOffset[2]] = std::min(s_aTempDesc[anOffset[2]],(float)nSSD);
+#if !USE_STATIC_VAR_NOISE
+            if(std::abs(anOffset[0])<=1 && std::abs(anOffset[1])<=1)
+                fMaxLocalVarNoise = std::max(fMaxLocalVarNoise,(float)nSSD);
+#endif //!USE_STATIC_VAR_NOISE
+        }
 #if USE_STATIC_VAR_NOISE
         const float fVarNormFact = -1.0f/m_fStaticNoiseVar;
 #else //!USE_STATIC_VAR_NOISE
-        float fMaxLocalVarNoise = 1000.0f;
-        for(int nRowOffset=-1; nRowOffset<=1 ; ++nRowOffset)
-            for(int nColOffset=-1; nColOffset<=1; ++nColOffset)
-                fMaxLocalVarNoise = std::max(fMaxLocalVarNoise,oCorrMap(m_nCorrPatchSize/2+nRowOffset,m_nCorrPatchSize/2+nColOffset));
         const float fVarNormFact = -1.0f/fMaxLocalVarNoise;
 #endif //!USE_STATIC_VAR_NOISE
-        oTempDesc = std::numeric_limits<float>::max();
-        for(int nDescBinIdx=m_nFirstMaskIdx; nDescBinIdx<=m_nLastMaskIdx; ++nDescBinIdx)
-            if(m_oDescLUMap(nDescBinIdx)!=-1)
-                s_aTempDesc[m_oDescLUMap(nDescBinIdx)] = std::min(s_aTempDesc[m_oDescLUMap(nDescBinIdx)],((float*)oCorrMap.data)[nDescBinIdx]);
         oTempDesc *= fVarNormFact;
         cv::exp(oTempDesc,cv::Mat_<float>(1,nDescSize,bGenDescMap?oDescriptors.ptr<float>(nRowIdx,nColIdx):oDescriptors.ptr<float>(nKeyPtIdx)));
     }
@@ -276,6 +295,7 @@ void LSS::ssdescs_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
         oImage = _oImage;
     const int nRows = oImage.rows;
     const int nCols = oImage.cols;
+    const int nChannels = oImage.channels();
     const int nCorrWinRadius = m_nCorrWinSize/2;
     const int nPatchRadius = m_nPatchSize/2;
     const int nDescSize = m_nRadialBins*m_nAngularBins;
@@ -283,37 +303,94 @@ void LSS::ssdescs_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
     oDescriptors.create(3,anDescDims);
     std::fill_n(oDescriptors.ptr<float>(0,0),nDescSize*nCorrWinRadius*nCols,0.0f);
     std::fill_n(oDescriptors.ptr<float>(nRows-nCorrWinRadius,0),nDescSize*nCorrWinRadius*nCols,0.0f);
+    // instead of matching a template around each pixel (which recomputes overlapping patch ssds many times), we
+    // compute, for each correlation window offset, the full squared diff map between the image and its shifted
+    // version, and box-filter it to obtain the patch ssd of all pixels at once; the log-polar bins are then
+    // min-pooled from these shared maps (cost is O(offsets x pixels), regardless of the patch size)
+    const int nValidCols = nCols-nCorrWinRadius*2;
+    const int nDiffCols = nValidCols+nPatchRadius*2;
+    constexpr int nBandSize = 32; // rows processed together per thread (amortizes the patch overlap between bands)
+    const int nBandCount = (nRows-nCorrWinRadius*2+nBandSize-1)/nBandSize;
 #if USING_OPENMP
     #pragma omp parallel for
 #endif //USING_OPENMP
-    for(int nRowIdx=nCorrWinRadius; nRowIdx<nRows-nCorrWinRadius; ++nRowIdx) {
-        static thread_local lv::AutoBuffer<float> s_aCorrData;
-        s_aCorrData.resize(size_t(m_nCorrPatchSize*m_nCorrPatchSize));
-        cv::Mat_<float> oCorrMap(m_nCorrPatchSize,m_nCorrPatchSize,s_aCorrData.data());
-        static thread_local lv::AutoBuffer<float> s_aTempDesc;
-        s_aTempDesc.resize(size_t(nDescSize));
-        cv::Mat_<float> oTempDesc(1,nDescSize,s_aTempDesc.data());
-        std::fill_n(oDescriptors.ptr<float>(nRowIdx,0),nDescSize*nCorrWinRadius,0.0f);
-        std::fill_n(oDescriptors.ptr<float>(nRowIdx,nCols-nCorrWinRadius),nDescSize*nCorrWinRadius,0.0f);
-        for(int nColIdx=nCorrWinRadius; nColIdx<nCols-nCorrWinRadius; ++nColIdx) {
-            const cv::Mat oWindow = oImage(cv::Rect(nColIdx-nCorrWinRadius,nRowIdx-nCorrWinRadius,m_nCorrWinSize,m_nCorrWinSize));
-            const cv::Mat oTempl = oImage(cv::Rect(nColIdx-nPatchRadius,nRowIdx-nPatchRadius,m_nPatchSize,m_nPatchSize));
-            cv::matchTemplate(oWindow,oTempl,oCorrMap,cv::TM_SQDIFF);
-#if USE_STATIC_VAR_NOISE
-            const float fVarNormFact = -1.0f/m_fStaticNoiseVar;
-#else //!USE_STATIC_VAR_NOISE
-            float fMaxLocalVarNoise = 1000.0f;
-            for(int nRowOffset=-1; nRowOffset<=1 ; ++nRowOffset)
-                for(int nColOffset=-1; nColOffset<=1; ++nColOffset)
-                    fMaxLocalVarNoise = std::max(fMaxLocalVarNoise,oCorrMap(m_nCorrPatchSize/2+nRowOffset,m_nCorrPatchSize/2+nColOffset));
-            const float fVarNormFact = -1.0f/fMaxLocalVarNoise;
-#endif //!USE_STATIC_VAR_NOISE
-            oTempDesc = std::numeric_limits<float>::max();
-            for(int nDescBinIdx=m_nFirstMaskIdx; nDescBinIdx<=m_nLastMaskIdx; ++nDescBinIdx)
-                if(m_oDescLUMap(nDescBinIdx)!=-1)
-                    s_aTempDesc[m_oDescLUMap(nDescBinIdx)] = std::min(s_aTempDesc[m_oDescLUMap(nDescBinIdx)],((float*)oCorrMap.data)[nDescBinIdx]);
-            oTempDesc *= fVarNormFact;
-            cv::exp(oTempDesc,cv::Mat_<float>(1,nDescSize,oDescriptors.ptr<float>(nRowIdx,nColIdx)));
+    for(int nBandIdx=0; nBandIdx<nBandCount; ++nBandIdx) {
+        const int nBandStartRowIdx = nCorrWinRadius+nBandIdx*nBandSize;
+        const int nBandEndRowIdx = std::min(nBandStartRowIdx+nBandSize,nRows-nCorrWinRadius);
+        const int nBandRows = nBandEndRowIdx-nBandStartRowIdx;
+        const int nDiffRows = nBandRows+nPatchRadius*2;
+        static thread_local lv::AutoBuffer<int> s_aDiffData;
+        s_aDiffData.resize(size_t(nDiffRows*nDiffCols));
+        static thread_local lv::AutoBuffer<int> s_aColSums;
+        s_aColSums.resize(size_t(nDiffCols));
+    #if !USE_STATIC_VAR_NOISE
+        static thread_local lv::AutoBuffer<float> s_aMaxLocalVarNoise;
+        s_aMaxLocalVarNoise.resize(size_t(nBandRows*nValidCols));
+        std::fill_n(s_aMaxLocalVarNoise.data(),nBandRows*nValidCols,1000.0f);
+    #endif //!USE_STATIC_VAR_NOISE
+        for(int nRowIdx=nBandStartRowIdx; nRowIdx<nBandEndRowIdx; ++nRowIdx) {
+            std::fill_n(oDescriptors.ptr<float>(nRowIdx,0),nDescSize*nCorrWinRadius,0.0f);
+            std::fill_n(oDescriptors.ptr<float>(nRowIdx,nCorrWinRadius),nDescSize*nValidCols,std::numeric_limits<float>::max());
+            std::fill_n(oDescriptors.ptr<float>(nRowIdx,nCols-nCorrWinRadius),nDescSize*nCorrWinRadius,0.0f);
+        }
+        for(const std::array<int,3>& anOffset : m_vCorrOffsets) {
+            const int nRowOffset = anOffset[0], nColOffset = anOffset[1], nBinIdx = anOffset[2];
+            for(int nDiffRowIdx=0; nDiffRowIdx<nDiffRows; ++nDiffRowIdx) {
+                const int nRowIdx = nBandStartRowIdx-nPatchRadius+nDiffRowIdx;
+                const uchar* pRow = oImage.ptr<uchar>(nRowIdx)+(nCorrWinRadius-nPatchRadius)*nChannels;
+                const uchar* pOffsetRow = oImage.ptr<uchar>(nRowIdx+nRowOffset)+(nCorrWinRadius-nPatchRadius+nColOffset)*nChannels;
+                int* pDiffRow = s_aDiffData.data()+nDiffRowIdx*nDiffCols;
+                for(int nDiffColIdx=0; nDiffColIdx<nDiffCols; ++nDiffColIdx) {
+                    int nSqrDiff = 0;
+                    for(int nChIdx=0; nChIdx<nChannels; ++nChIdx) {
+                        const int nDiff = int(pRow[nDiffColIdx*nChannels+nChIdx])-int(pOffsetRow[nDiffColIdx*nChannels+nChIdx]);
+                        nSqrDiff += nDiff*nDiff;
+                    }
+                    pDiffRow[nDiffColIdx] = nSqrDiff;
+                }
+            }
+            std::fill_n(s_aColSums.data(),nDiffCols,0);
+            for(int nDiffRowIdx=0; nDiffRowIdx<m_nPatchSize; ++nDiffRowIdx)
+                for(int nDiffColIdx=0; nDiffColIdx<nDiffCols; ++nDiffColIdx)
+                    s_aColSums[nDiffColIdx] += s_aDiffData[nDiffRowIdx*nDiffCols+nDiffColIdx];
+            for(int nBandRowIdx=0; nBandRowIdx<nBandRows; ++nBandRowIdx) {
+                if(nBandRowIdx>0) {
+                    const int* pAddRow = s_aDiffData.data()+(nBandRowIdx+m_nPatchSize-1)*nDiffCols;
+                    const int* pRemRow = s_aDiffData.data()+(nBandRowIdx-1)*nDiffCols;
+                    for(int nDiffColIdx=0; nDiffColIdx<nDiffCols; ++nDiffColIdx)
+                        s_aColSums[nDiffColIdx] += pAddRow[nDiffColIdx]-pRemRow[nDiffColIdx];
+                }
+                int nSSD = 0;
+                for(int nDiffColIdx=0; nDiffColIdx<m_nPatchSize; ++nDiffColIdx)
+                    nSSD += s_aColSums[nDiffColIdx];
+                float* pDesc = oDescriptors.ptr<float>(nBandStartRowIdx+nBandRowIdx,nCorrWinRadius);
+            #if !USE_STATIC_VAR_NOISE
+                float* pMaxLocalVarNoise = s_aMaxLocalVarNoise.data()+nBandRowIdx*nValidCols;
+                const bool bNoiseOffset = std::abs(nRowOffset)<=1 && std::abs(nColOffset)<=1;
+            #endif //!USE_STATIC_VAR_NOISE
+                for(int nColIdx=0; nColIdx<nValidCols; ++nColIdx) {
+                    if(nColIdx>0)
+                        nSSD += s_aColSums[nColIdx+m_nPatchSize-1]-s_aColSums[nColIdx-1];
+                    if(nBinIdx!=-1)
+                        pDesc[nColIdx*nDescSize+nBinIdx] = std::min(pDesc[nColIdx*nDescSize+nBinIdx],(float)nSSD);
+                #if !USE_STATIC_VAR_NOISE
+                    if(bNoiseOffset)
+                        pMaxLocalVarNoise[nColIdx] = std::max(pMaxLocalVarNoise[nColIdx],(float)nSSD);
+                #endif //!USE_STATIC_VAR_NOISE
+                }
+            }
+        }
+        for(int nBandRowIdx=0; nBandRowIdx<nBandRows; ++nBandRowIdx) {
+            for(int nColIdx=0; nColIdx<nValidCols; ++nColIdx) {
+            #if USE_STATIC_VAR_NOISE
+                const float fVarNormFact = -1.0f/m_fStaticNoiseVar;
+            #else //!USE_STATIC_VAR_NOISE
+                const float fVarNormFact = -1.0f/s_aMaxLocalVarNoise[nBandRowIdx*nValidCols+nColIdx];
+            #endif //!USE_STATIC_VAR_NOISE
+                cv::Mat_<float> oCurrDesc(1,nDescSize,oDescriptors.ptr<float>(nBandStartRowIdx+nBandRowIdx,nCorrWinRadius+nColIdx));
+                oCurrDesc *= fVarNormFact;
+                cv::exp(oCurrDesc,oCurrDesc);
+            }
         }
     }
     if(m_bNormalizeBins)
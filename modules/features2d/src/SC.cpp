@@ -40,7 +40,7 @@ ShapeContext::ShapeContext(size_t nInnerRadius, size_t nOuterRadius, size_t nAng
         m_bRotationInvariant(bRotationInvariant),
         m_bNormalizeBins(bNormalizeBins),
         m_bNonZeroInitBins(bUseNonZeroInit),
-        m_bUsingFullKeyPtMap(false) {
+        m_oFullKeyPtMapSize_dev() {
     lvAssert_(m_nAngularBins>0,"invalid parameter");
     lvAssert_(m_nRadialBins>0,"invalid parameter");
     lvAssert_(m_nInnerRadius>0,"invalid parameter");
@@ -98,7 +98,7 @@ ShapeContext::ShapeContext(double dRelativeInnerRadius, double dRelativeOuterRad
         m_bRotationInvariant(bRotationInvariant),
         m_bNormalizeBins(bNormalizeBins),
         m_bNonZeroInitBins(bUseNonZeroInit),
-        m_bUsingFullKeyPtMap(false) {
+        m_oFullKeyPtMapSize_dev() {
     lvAssert_(m_nAngularBins>0,"invalid parameter");
     lvAssert_(m_nRadialBins>0,"invalid parameter");
     lvAssert_(m_dInnerRadius>0.0,"invalid parameter");
@@ -162,32 +162,28 @@ bool ShapeContext::setBlockSize(size_t nThreadCount) {
 
 void ShapeContext::compute2(const cv::Mat& oImage, cv::cuda::GpuMat& oDescMap_dev) {
     lvAssert_(m_bUseCUDA,"cuda disabled, cannot use gpumat override");
-    const cv::Size oOldImageSize = m_oCurrImageSize;
-    scdesc_fill_contours(oImage);
-    if(!m_bUsingFullKeyPtMap || oOldImageSize!=m_oCurrImageSize) {
-        m_oKeyPts.create(m_oCurrImageSize.area(),1);
-        int nKeyPtIdx = 0;
-        for(int nRowIdx=0; nRowIdx<m_oCurrImageSize.height; ++nRowIdx)
-            for(int nColIdx=0; nColIdx<m_oCurrImageSize.width; ++nColIdx)
-                m_oKeyPts(nKeyPtIdx++) = cv::Point2f((float)nColIdx,(float)nRowIdx);
-        m_bUsingFullKeyPtMap = true;
-        m_oKeyPts_dev.upload(m_oKeyPts); // blocking call
+    Workspace& oWS = getWorkspace();
+    scdesc_fill_contours(oImage,oWS);
+    scdesc_fill_full_keypts(oWS);
+    if(m_oFullKeyPtMapSize_dev!=oWS.oCurrImageSize) {
+        m_oFullKeyPtMapSize_dev = oWS.oCurrImageSize;
+        m_oKeyPts_dev.upload(oWS.oKeyPts); // blocking call
     }
     if(!m_bUseRelativeSpace && !m_bRotationInvariant) {
-        lvDbgAssert(m_oContourPts.type()==CV_32FC2 && (m_oContourPts.total()==(size_t)m_oContourPts.rows || m_oContourPts.total()==(size_t)m_oContourPts.cols));
-        lvDbgAssert(m_oKeyPts.type()==CV_32FC2 && (m_oKeyPts.total()==(size_t)m_oKeyPts.rows || m_oKeyPts.total()==(size_t)m_oKeyPts.cols));
-        lvDbgAssert(m_oKeyPts.total()>size_t(0));
-        lvDbgAssert(m_oDistMask.size()==m_oCurrImageSize);
+        lvDbgAssert(oWS.oContourPts.type()==CV_32FC2 && (oWS.oContourPts.total()==(size_t)oWS.oContourPts.rows || oWS.oContourPts.total()==(size_t)oWS.oContourPts.cols));
+        lvDbgAssert(oWS.oKeyPts.type()==CV_32FC2 && (oWS.oKeyPts.total()==(size_t)oWS.oKeyPts.rows || oWS.oKeyPts.total()==(size_t)oWS.oKeyPts.cols));
+        lvDbgAssert(oWS.oKeyPts.total()>size_t(0));
+        lvDbgAssert(oWS.oDistMask.size()==oWS.oCurrImageSize);
     #if USE_LIENHART_LOOKUP_MASK
         lvDbgAssert(!m_oAbsDescLUMap.empty() && m_oAbsDescLUMap.rows==m_nOuterRadius*2+1 && m_oAbsDescLUMap.rows==m_oAbsDescLUMap.cols);
     #endif //USE_LIENHART_LOOKUP_MASK
         lvAssert_(USE_LIENHART_LOOKUP_MASK,"only lienhart-style lookup in shapecontext impl available with cuda");
-        const int nDescCount = m_oCurrImageSize.height*m_oCurrImageSize.width;
+        const int nDescCount = oWS.oCurrImageSize.height*oWS.oCurrImageSize.width;
         oDescMap_dev.create(nDescCount,m_nDescSize,CV_32FC1);
         lv::cuda::KernelParams oParams;
         const uint nWarpSize = (uint)cv::cuda::DeviceInfo().warpSize();
         oParams.vBlockSize.x = (m_nBlockSize?(uint)m_nBlockSize:nWarpSize);
-        oParams.vGridSize = dim3((uint)m_oCurrImageSize.width,(uint)m_oCurrImageSize.height);
+        oParams.vGridSize = dim3((uint)oWS.oCurrImageSize.width,(uint)oWS.oCurrImageSize.height);
         oParams.nSharedMemSize = size_t(std::ceil(float(m_nDescSize)/nWarpSize)*nWarpSize*2)*sizeof(float);
         device::scdesc_fill_desc_direct(oParams,m_oKeyPts_dev,m_oContourPts_dev,m_oDistMask_dev,m_pDescLUMap_tex,m_oAbsDescLUMap.rows,oDescMap_dev,m_bNonZeroInitBins,true,m_bNormalizeBins);
     }
@@ -219,72 +215,78 @@ void ShapeContext::compute2(const cv::Mat& oImage, cv::Mat& oDescMap_) {
 }
 
 void ShapeContext::compute2(const cv::Mat& oImage, cv::Mat_<float>& oDescMap) {
-    const cv::Size oOldImageSize = m_oCurrImageSize;
-    scdesc_fill_contours(oImage);
-    if(!m_bUsingFullKeyPtMap || oOldImageSize!=m_oCurrImageSize) {
-        m_oKeyPts.create(m_oCurrImageSize.area(),1);
-        int nKeyPtIdx = 0;
-        for(int nRowIdx=0; nRowIdx<m_oCurrImageSize.height; ++nRowIdx)
-            for(int nColIdx=0; nColIdx<m_oCurrImageSize.width; ++nColIdx)
-                m_oKeyPts(nKeyPtIdx++) = cv::Point2f((float)nColIdx,(float)nRowIdx);
-        m_bUsingFullKeyPtMap = true;
-    #if HAVE_CUDA
-        if(m_bUseCUDA)
-            m_oKeyPts_dev.upload(m_oKeyPts); // blocking call
-    #endif //HAVE_CUDA
+    Workspace& oWS = getWorkspace();
+    scdesc_fill_contours(oImage,oWS);
+    scdesc_fill_full_keypts(oWS);
+#if HAVE_CUDA
+    if(m_bUseCUDA && m_oFullKeyPtMapSize_dev!=oWS.oCurrImageSize) {
+        m_oFullKeyPtMapSize_dev = oWS.oCurrImageSize;
+        m_oKeyPts_dev.upload(oWS.oKeyPts); // blocking call
     }
+#endif //HAVE_CUDA
     if(!m_bUseRelativeSpace && !m_bRotationInvariant)
-        scdesc_fill_desc_direct(oDescMap,true);
+        scdesc_fill_desc_direct(oDescMap,true,oWS);
     else
-        scdesc_fill_desc(oDescMap,true);
+        scdesc_fill_desc(oDescMap,true,oWS);
 }
 
 void ShapeContext::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoints, cv::Mat_<float>& oDescMap) {
-    scdesc_fill_contours(oImage);
-    m_bUsingFullKeyPtMap = false;
+    Workspace& oWS = getWorkspace();
+    scdesc_fill_contours(oImage,oWS);
+    oWS.oFullKeyPtMapSize = cv::Size();
     if(voKeypoints.empty()) {
-        voKeypoints.resize(m_oContourPts.total());
+        voKeypoints.resize(oWS.oContourPts.total());
         for(size_t nContourPtIdx=0; nContourPtIdx<voKeypoints.size(); ++nContourPtIdx)
-            voKeypoints[nContourPtIdx] = cv::KeyPoint(m_oContourPts((int)nContourPtIdx),1.0f);
-        m_oContourPts.copyTo(m_oKeyPts);
+            voKeypoints[nContourPtIdx] = cv::KeyPoint(oWS.oContourPts((int)nContourPtIdx),1.0f);
+        oWS.oContourPts.copyTo(oWS.oKeyPts);
     }
     else {
-        m_oKeyPts.create((int)voKeypoints.size(),1);
+        oWS.oKeyPts.create((int)voKeypoints.size(),1);
         for(size_t nKeyPtIdx=0; nKeyPtIdx<voKeypoints.size(); ++nKeyPtIdx)
-            m_oKeyPts((int)nKeyPtIdx) = voKeypoints[nKeyPtIdx].pt;
+            oWS.oKeyPts((int)nKeyPtIdx) = voKeypoints[nKeyPtIdx].pt;
     }
 #if HAVE_CUDA
-    if(m_bUseCUDA)
-        m_oKeyPts_dev.upload(m_oKeyPts); // blocking call
+    if(m_bUseCUDA) {
+        m_oFullKeyPtMapSize_dev = cv::Size();
+        m_oKeyPts_dev.upload(oWS.oKeyPts); // blocking call
+    }
 #endif //HAVE_CUDA
     if(!m_bUseRelativeSpace && !m_bRotationInvariant)
-        scdesc_fill_desc_direct(oDescMap,true);
+        scdesc_fill_desc_direct(oDescMap,true,oWS);
     else
-        scdesc_fill_desc(oDescMap,true);
+        scdesc_fill_desc(oDescMap,true,oWS);
 }
 
 void ShapeContext::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],voDescMapCollection[i]);
+    // cpu impl is reentrant (see ShapeContext::getWorkspace), so each thread can describe whole images on its own
+#if USING_OPENMP
+    #pragma omp parallel for if(!isParallel())
+#endif //USING_OPENMP
+    for(int i=0; i<(int)voImageCollection.size(); ++i)
+        compute2(voImageCollection[size_t(i)],voDescMapCollection[size_t(i)]);
 }
 
 void ShapeContext::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<std::vector<cv::KeyPoint> >& vvoPointCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     lvAssert_(voImageCollection.size()==vvoPointCollection.size(),"number of images must match number of keypoint lists");
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],vvoPointCollection[i],voDescMapCollection[i]);
+#if USING_OPENMP
+    #pragma omp parallel for if(!isParallel())
+#endif //USING_OPENMP
+    for(int i=0; i<(int)voImageCollection.size(); ++i)
+        compute2(voImageCollection[size_t(i)],vvoPointCollection[size_t(i)],voDescMapCollection[size_t(i)]);
 }
 
 void ShapeContext::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMask, std::vector<cv::KeyPoint>& voKeypoints, cv::OutputArray _oDescriptors, bool bUseProvidedKeypoints) {
     cv::Mat oImage = _oImage.getMat();
     cv::Mat oMask = _oMask.getMat();
     lvAssert_(oMask.empty() || (!oMask.empty() && oMask.size()==oImage.size()),"mask must be empty or of equal size to the input image");
-    scdesc_fill_contours(oImage);
+    Workspace& oWS = getWorkspace();
+    scdesc_fill_contours(oImage,oWS);
     if(!bUseProvidedKeypoints) {
-        voKeypoints.resize(m_oContourPts.total());
+        voKeypoints.resize(oWS.oContourPts.total());
         for(size_t nContourPtIdx=0; nContourPtIdx<voKeypoints.size(); ++nContourPtIdx)
-            voKeypoints[nContourPtIdx] = cv::KeyPoint(m_oContourPts((int)nContourPtIdx),1.0f);
+            voKeypoints[nContourPtIdx] = cv::KeyPoint(oWS.oContourPts((int)nContourPtIdx),1.0f);
     }
     if(!oMask.empty())
         cv::KeyPointsFilter::runByPixelsMask(voKeypoints,oMask);
@@ -292,20 +294,22 @@ void ShapeContext::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMas
         _oDescriptors.release();
         return;
     }
-    m_bUsingFullKeyPtMap = false;
-    m_oKeyPts.create((int)voKeypoints.size(),1);
+    oWS.oFullKeyPtMapSize = cv::Size();
+    oWS.oKeyPts.create((int)voKeypoints.size(),1);
     for(size_t nKeyPtIdx=0; nKeyPtIdx<voKeypoints.size(); ++nKeyPtIdx)
-        m_oKeyPts((int)nKeyPtIdx) = voKeypoints[nKeyPtIdx].pt;
+        oWS.oKeyPts((int)nKeyPtIdx) = voKeypoints[nKeyPtIdx].pt;
 #if HAVE_CUDA
-    if(m_bUseCUDA)
-        m_oKeyPts_dev.upload(m_oKeyPts); // blocking call
+    if(m_bUseCUDA) {
+        m_oFullKeyPtMapSize_dev = cv::Size();
+        m_oKeyPts_dev.upload(oWS.oKeyPts); // blocking call
+    }
 #endif //HAVE_CUDA
     _oDescriptors.create((int)voKeypoints.size(),m_nRadialBins*m_nAngularBins,CV_32FC1);
     cv::Mat_<float> oDescriptors = cv::Mat_<float>(_oDescriptors.getMat());
     if(!m_bUseRelativeSpace && !m_bRotationInvariant)
-        scdesc_fill_desc_direct(oDescriptors,false);
+        scdesc_fill_desc_direct(oDescriptors,false,oWS);
     else
-        scdesc_fill_desc(oDescriptors,false);
+        scdesc_fill_desc(oDescriptors,false,oWS);
 }
 
 void ShapeContext::reshapeDesc(cv::Size oSize, cv::Mat& oDescriptors) const {
@@ -403,106 +407,128 @@ void ShapeContext::scdesc_generate_emdmask() {
     }
 }
 
-void ShapeContext::scdesc_fill_contours(const cv::Mat& oImage) {
+ShapeContext::Workspace& ShapeContext::getWorkspace() {
+    static thread_local Workspace s_oWorkspace;
+    return s_oWorkspace;
+}
+
+void ShapeContext::scdesc_fill_full_keypts(Workspace& oWS) {
+    if(oWS.oFullKeyPtMapSize==oWS.oCurrImageSize)
+        return;
+    oWS.oKeyPts.create(oWS.oCurrImageSize.area(),1);
+    int nKeyPtIdx = 0;
+    for(int nRowIdx=0; nRowIdx<oWS.oCurrImageSize.height; ++nRowIdx)
+        for(int nColIdx=0; nColIdx<oWS.oCurrImageSize.width; ++nColIdx)
+            oWS.oKeyPts(nKeyPtIdx++) = cv::Point2f((float)nColIdx,(float)nRowIdx);
+    oWS.oFullKeyPtMapSize = oWS.oCurrImageSize;
+}
+
+void ShapeContext::scdesc_fill_contours(const cv::Mat& oImage, Workspace& oWS) {
     lvAssert_(!oImage.empty(),"input image must be non-empty");
     lvAssert_(oImage.type()==CV_8UC1,"input image type must be 8UC1");
-    m_oCurrImageSize = oImage.size();
+    oWS.oCurrImageSize = oImage.size();
     std::vector<std::vector<cv::Point>> vvContours;
-    cv::compare(oImage,0,m_oBinMask,cv::CMP_GT);
+    cv::compare(oImage,0,oWS.oBinMask,cv::CMP_GT);
     if(!m_bUseRelativeSpace && !m_bRotationInvariant)
-        cv::dilate(m_oBinMask,m_oDistMask,m_oDilateKernel);
-    cv::findContours(m_oBinMask,vvContours,cv::RETR_LIST,cv::CHAIN_APPROX_NONE);
+        cv::dilate(oWS.oBinMask,oWS.oDistMask,m_oDilateKernel);
+    cv::findContours(oWS.oBinMask,vvContours,cv::RETR_LIST,cv::CHAIN_APPROX_NONE);
     size_t nContourPtCount = size_t(0);
     for(size_t nContourIdx=0; nContourIdx<vvContours.size(); ++nContourIdx)
         nContourPtCount += vvContours[nContourIdx].size();
     if(nContourPtCount>0) {
-        m_oContourPts.create((int)nContourPtCount,1);
+        oWS.oContourPts.create((int)nContourPtCount,1);
         int nContourPtIdx = 0;
         for(size_t nContourIdx = 0; nContourIdx<vvContours.size(); ++nContourIdx)
             for(size_t nPointIdx = 0; nPointIdx<vvContours[nContourIdx].size(); ++nPointIdx)
-                m_oContourPts(nContourPtIdx++) = cv::Point2f(float(vvContours[nContourIdx][nPointIdx].x),float(vvContours[nContourIdx][nPointIdx].y));
+                oWS.oContourPts(nContourPtIdx++) = cv::Point2f(float(vvContours[nContourIdx][nPointIdx].x),float(vvContours[nContourIdx][nPointIdx].y));
     }
     else
-        m_oContourPts.release();
+        oWS.oContourPts.release();
 #if HAVE_CUDA
     if(m_bUseCUDA) {
-        m_oDistMask_dev.upload(m_oDistMask);
-        m_oContourPts_dev.upload(m_oContourPts); // blocking call
+        m_oDistMask_dev.upload(oWS.oDistMask);
+        m_oContourPts_dev.upload(oWS.oContourPts); // blocking call
     }
 #endif //HAVE_CUDA
 }
 
-void ShapeContext::scdesc_fill_maps(double dMeanDist) {
-    lvDbgAssert(m_oContourPts.type()==CV_32FC2 && (m_oContourPts.total()==(size_t)m_oContourPts.rows || m_oContourPts.total()==(size_t)m_oContourPts.cols));
-    lvDbgAssert(m_oKeyPts.type()==CV_32FC2 && (m_oKeyPts.total()==(size_t)m_oKeyPts.rows || m_oKeyPts.total()==(size_t)m_oKeyPts.cols));
-    lvDbgAssert(m_oKeyPts.total()>size_t(0));
-    if(m_oContourPts.empty())
+void ShapeContext::scdesc_fill_maps(Workspace& oWS, double dMeanDist) const {
+    lvDbgAssert(oWS.oContourPts.type()==CV_32FC2 && (oWS.oContourPts.total()==(size_t)oWS.oContourPts.rows || oWS.oContourPts.total()==(size_t)oWS.oContourPts.cols));
+    lvDbgAssert(oWS.oKeyPts.type()==CV_32FC2 && (oWS.oKeyPts.total()==(size_t)oWS.oKeyPts.rows || oWS.oKeyPts.total()==(size_t)oWS.oKeyPts.cols));
+    lvDbgAssert(oWS.oKeyPts.total()>size_t(0));
+    if(oWS.oContourPts.empty())
         return;
-    m_oDistMap.create((int)m_oKeyPts.total(),(int)m_oContourPts.total());
-    m_oAngMap.create((int)m_oKeyPts.total(),(int)m_oContourPts.total());
+    oWS.oDistMap.create((int)oWS.oKeyPts.total(),(int)oWS.oContourPts.total());
+    oWS.oAngMap.create((int)oWS.oKeyPts.total(),(int)oWS.oContourPts.total());
     cv::Point2f vMassCenter(0,0);
     if(m_bRotationInvariant) {
-        for(int nContourPtIdx=0; nContourPtIdx<(int)m_oContourPts.total(); ++nContourPtIdx)
-            vMassCenter += ((cv::Point2f*)m_oContourPts.data)[nContourPtIdx];
-        vMassCenter.x = vMassCenter.x/m_oContourPts.total();
-        vMassCenter.y = vMassCenter.y/m_oContourPts.total();
+        for(int nContourPtIdx=0; nContourPtIdx<(int)oWS.oContourPts.total(); ++nContourPtIdx)
+            vMassCenter += ((cv::Point2f*)oWS.oContourPts.data)[nContourPtIdx];
+        vMassCenter.x = vMassCenter.x/oWS.oContourPts.total();
+        vMassCenter.y = vMassCenter.y/oWS.oContourPts.total();
     }
-    cv::Matx12f vPtDiff;
-    for(int nKeyPtIdx=0; nKeyPtIdx<(int)m_oKeyPts.total(); ++nKeyPtIdx) {
-        for(int nContourPtIdx=0; nContourPtIdx<(int)m_oContourPts.total(); ++nContourPtIdx) {
-            const cv::Point2f& vKeyPt = ((cv::Point2f*)m_oKeyPts.data)[nKeyPtIdx];
-            const cv::Point2f& vContourPt = ((cv::Point2f*)m_oContourPts.data)[nContourPtIdx];
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nKeyPtIdx=0; nKeyPtIdx<(int)oWS.oKeyPts.total(); ++nKeyPtIdx) {
+        cv::Matx12f vPtDiff;
+        for(int nContourPtIdx=0; nContourPtIdx<(int)oWS.oContourPts.total(); ++nContourPtIdx) {
+            const cv::Point2f& vKeyPt = ((cv::Point2f*)oWS.oKeyPts.data)[nKeyPtIdx];
+            const cv::Point2f& vContourPt = ((cv::Point2f*)oWS.oContourPts.data)[nContourPtIdx];
             vPtDiff(0) = vKeyPt.y-vContourPt.y;
             vPtDiff(1) = vKeyPt.x-vContourPt.x;
-            m_oDistMap(nKeyPtIdx,nContourPtIdx) = cv::norm(vPtDiff,cv::NORM_L2);
-            if(m_oDistMap(nKeyPtIdx,nContourPtIdx)<0.01)
-                m_oAngMap(nKeyPtIdx,nContourPtIdx) = 0.0;
+            oWS.oDistMap(nKeyPtIdx,nContourPtIdx) = cv::norm(vPtDiff,cv::NORM_L2);
+            if(oWS.oDistMap(nKeyPtIdx,nContourPtIdx)<0.01)
+                oWS.oAngMap(nKeyPtIdx,nContourPtIdx) = 0.0;
             else {
-                m_oAngMap(nKeyPtIdx,nContourPtIdx) = std::atan2(vPtDiff(0),-vPtDiff(1));
+                oWS.oAngMap(nKeyPtIdx,nContourPtIdx) = std::atan2(vPtDiff(0),-vPtDiff(1));
                 if(m_bRotationInvariant) {
                     const cv::Point2d vRefPt = vContourPt-vMassCenter;
-                    m_oAngMap(nKeyPtIdx,nContourPtIdx) -= std::atan2(-vRefPt.y,vRefPt.x);
+                    oWS.oAngMap(nKeyPtIdx,nContourPtIdx) -= std::atan2(-vRefPt.y,vRefPt.x);
                 }
-                m_oAngMap(nKeyPtIdx,nContourPtIdx) = std::fmod(m_oAngMap(nKeyPtIdx,nContourPtIdx)+2*CV_PI+FLT_EPSILON,2*CV_PI);
+                oWS.oAngMap(nKeyPtIdx,nContourPtIdx) = std::fmod(oWS.oAngMap(nKeyPtIdx,nContourPtIdx)+2*CV_PI+FLT_EPSILON,2*CV_PI);
             }
         }
     }
     if(m_bUseRelativeSpace) {
         if(dMeanDist<0)
-            dMeanDist = cv::mean(m_oDistMap)[0];
-        m_oDistMap /= (dMeanDist+FLT_EPSILON);
+            dMeanDist = cv::mean(oWS.oDistMap)[0];
+        oWS.oDistMap /= (dMeanDist+FLT_EPSILON);
     }
 }
 
-void ShapeContext::scdesc_fill_desc(cv::Mat_<float>& oDescriptors, bool bGenDescMap) {
-    if(m_oKeyPts.empty()) {
+void ShapeContext::scdesc_fill_desc(cv::Mat_<float>& oDescriptors, bool bGenDescMap, Workspace& oWS) {
+    if(oWS.oKeyPts.empty()) {
         oDescriptors.release();
         return;
     }
     if(bGenDescMap)
-        oDescriptors.create(3,std::array<int,3>{m_oCurrImageSize.height,m_oCurrImageSize.width,m_nDescSize}.data());
+        oDescriptors.create(3,std::array<int,3>{oWS.oCurrImageSize.height,oWS.oCurrImageSize.width,m_nDescSize}.data());
     else
-        oDescriptors.create((int)m_oKeyPts.total(),m_nDescSize);
+        oDescriptors.create((int)oWS.oKeyPts.total(),m_nDescSize);
     oDescriptors = m_bNonZeroInitBins?std::max(10.0f/m_nDescSize,0.5f):0.0f;
-    scdesc_fill_maps();
-    for(int nKeyPtIdx=0; nKeyPtIdx<(int)m_oKeyPts.total(); ++nKeyPtIdx) {
-        const cv::Point2f& vKeyPt = ((cv::Point2f*)m_oKeyPts.data)[nKeyPtIdx];
+    scdesc_fill_maps(oWS);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nKeyPtIdx=0; nKeyPtIdx<(int)oWS.oKeyPts.total(); ++nKeyPtIdx) {
+        const cv::Point2f& vKeyPt = ((cv::Point2f*)oWS.oKeyPts.data)[nKeyPtIdx];
         const int nKeyPtRowIdx = (int)std::round(vKeyPt.y);
         const int nKeyPtColIdx = (int)std::round(vKeyPt.x);
         float* aDesc = bGenDescMap?oDescriptors.ptr<float>(nKeyPtRowIdx,nKeyPtColIdx):oDescriptors.ptr<float>(nKeyPtIdx);
-        for(int nContourPtIdx=0; nContourPtIdx<(int)m_oContourPts.total(); ++nContourPtIdx) {
-            const cv::Point2f& vContourPt = ((cv::Point2f*)m_oContourPts.data)[nContourPtIdx];
+        for(int nContourPtIdx=0; nContourPtIdx<(int)oWS.oContourPts.total(); ++nContourPtIdx) {
+            const cv::Point2f& vContourPt = ((cv::Point2f*)oWS.oContourPts.data)[nContourPtIdx];
             if(std::abs(vKeyPt.x-vContourPt.x)<0.01f && std::abs(vKeyPt.y-vContourPt.y)<0.01f)
                 continue;
             int nAngularBinMatch=-1,nRadialBinMatch=-1;
             for(int nRadialBinIdx=0; nRadialBinIdx<m_nRadialBins; ++nRadialBinIdx) {
-                if(m_oDistMap(nKeyPtIdx,nContourPtIdx)<m_vRadialLimits[nRadialBinIdx]) {
+                if(oWS.oDistMap(nKeyPtIdx,nContourPtIdx)<m_vRadialLimits[nRadialBinIdx]) {
                     nRadialBinMatch = nRadialBinIdx;
                     break;
                 }
             }
             for(int nAngularBinIdx=0; nAngularBinIdx<m_nAngularBins; ++nAngularBinIdx) {
-                if(m_oAngMap(nKeyPtIdx,nContourPtIdx)<m_vAngularLimits[nAngularBinIdx]) {
+                if(oWS.oAngMap(nKeyPtIdx,nContourPtIdx)<m_vAngularLimits[nAngularBinIdx]) {
                     nAngularBinMatch = nAngularBinIdx;
                     break;
                 }
@@ -515,89 +541,127 @@ void ShapeContext::scdesc_fill_desc(cv::Mat_<float>& oDescriptors, bool bGenDesc
         scdesc_norm(oDescriptors);
 }
 
-void ShapeContext::scdesc_fill_desc_direct(cv::Mat_<float>& oDescriptors, bool bGenDescMap) {
+void ShapeContext::scdesc_fill_desc_direct(cv::Mat_<float>& oDescriptors, bool bGenDescMap, Workspace& oWS) {
     lvAssert_(!m_bUseRelativeSpace && !m_bRotationInvariant,"mapless impl cannot handle relative dist space/rot inv");
     // this impl specialization will likely be faster for very large shapes, but only handles the conditions above
-    if(m_oKeyPts.empty()) {
+    if(oWS.oKeyPts.empty()) {
         oDescriptors.release();
         return;
     }
-    lvDbgAssert(m_oContourPts.type()==CV_32FC2 && (m_oContourPts.total()==(size_t)m_oContourPts.rows || m_oContourPts.total()==(size_t)m_oContourPts.cols));
-    lvDbgAssert(m_oKeyPts.type()==CV_32FC2 && (m_oKeyPts.total()==(size_t)m_oKeyPts.rows || m_oKeyPts.total()==(size_t)m_oKeyPts.cols));
-    lvDbgAssert(m_oKeyPts.total()>size_t(0));
-    lvDbgAssert(m_oDistMask.size()==m_oCurrImageSize);
+    lvDbgAssert(oWS.oContourPts.type()==CV_32FC2 && (oWS.oContourPts.total()==(size_t)oWS.oContourPts.rows || oWS.oContourPts.total()==(size_t)oWS.oContourPts.cols));
+    lvDbgAssert(oWS.oKeyPts.type()==CV_32FC2 && (oWS.oKeyPts.total()==(size_t)oWS.oKeyPts.rows || oWS.oKeyPts.total()==(size_t)oWS.oKeyPts.cols));
+    lvDbgAssert(oWS.oKeyPts.total()>size_t(0));
+    lvDbgAssert(oWS.oDistMask.size()==oWS.oCurrImageSize);
 #if USE_LIENHART_LOOKUP_MASK
     lvDbgAssert(!m_oAbsDescLUMap.empty() && m_oAbsDescLUMap.rows==m_nOuterRadius*2+1 && m_oAbsDescLUMap.rows==m_oAbsDescLUMap.cols);
 #endif //USE_LIENHART_LOOKUP_MASK
 #if HAVE_CUDA
     if(m_bUseCUDA) {
         lvAssert_(USE_LIENHART_LOOKUP_MASK,"only lienhart-style lookup in shapecontext impl available with cuda");
-        const int nDescCount = bGenDescMap?(m_oCurrImageSize.height*m_oCurrImageSize.width):((int)m_oKeyPts.total());
+        const int nDescCount = bGenDescMap?(oWS.oCurrImageSize.height*oWS.oCurrImageSize.width):((int)oWS.oKeyPts.total());
         m_oDescriptors_dev.create(nDescCount,m_nDescSize,CV_32FC1);
         oDescriptors.create(nDescCount,m_nDescSize);
         lv::cuda::KernelParams oParams;
         const uint nWarpSize = (uint)cv::cuda::DeviceInfo().warpSize();
         oParams.vBlockSize.x = (uint)(m_nBlockSize?m_nBlockSize:size_t(cv::cuda::DeviceInfo().warpSize()));
-        oParams.vGridSize = bGenDescMap?dim3((uint)m_oCurrImageSize.width,(uint)m_oCurrImageSize.height):dim3((uint)nDescCount);
+        oParams.vGridSize = bGenDescMap?dim3((uint)oWS.oCurrImageSize.width,(uint)oWS.oCurrImageSize.height):dim3((uint)nDescCount);
         oParams.nSharedMemSize = size_t(std::ceil(float(m_nDescSize)/nWarpSize)*nWarpSize*2)*sizeof(float);
         device::scdesc_fill_desc_direct(oParams,m_oKeyPts_dev,m_oContourPts_dev,m_oDistMask_dev,m_pDescLUMap_tex,m_oAbsDescLUMap.rows,m_oDescriptors_dev,m_bNonZeroInitBins,bGenDescMap,m_bNormalizeBins);
         m_oDescriptors_dev.download(oDescriptors); // blocking call
         if(bGenDescMap)
-            oDescriptors = oDescriptors.reshape(0,3,std::array<int,3>{m_oCurrImageSize.height,m_oCurrImageSize.width,m_nDescSize}.data());
+            oDescriptors = oDescriptors.reshape(0,3,std::array<int,3>{oWS.oCurrImageSize.height,oWS.oCurrImageSize.width,m_nDescSize}.data());
         return;
     }
 #endif //HAVE_CUDA
     if(bGenDescMap)
-        oDescriptors.create(3,std::array<int,3>{m_oCurrImageSize.height,m_oCurrImageSize.width,m_nDescSize}.data());
+        oDescriptors.create(3,std::array<int,3>{oWS.oCurrImageSize.height,oWS.oCurrImageSize.width,m_nDescSize}.data());
     else
-        oDescriptors.create((int)m_oKeyPts.total(),m_nDescSize);
+        oDescriptors.create((int)oWS.oKeyPts.total(),m_nDescSize);
     oDescriptors = m_bNonZeroInitBins?std::max(10.0f/m_nDescSize,0.5f):0.0f;
+    if(oWS.oContourPts.empty()) {
+        if(m_bNormalizeBins)
+            scdesc_norm(oDescriptors);
+        return;
+    }
+    // contour points are bucketed in a coarse grid (cells as large as the lookup mask) so that each keypoint
+    // only visits the points of its neighboring cells instead of the entire contour point list
+    const int nGridCellSize = m_nOuterRadius*2+1;
+    const int nGridRows = (oWS.oCurrImageSize.height+nGridCellSize-1)/nGridCellSize;
+    const int nGridCols = (oWS.oCurrImageSize.width+nGridCellSize-1)/nGridCellSize;
+    const auto lGetGridCellIdx = [&](const cv::Point2f& vPt) {
+        const int nCellRowIdx = std::min(std::max((int)std::round(vPt.y),0)/nGridCellSize,nGridRows-1);
+        const int nCellColIdx = std::min(std::max((int)std::round(vPt.x),0)/nGridCellSize,nGridCols-1);
+        return nCellRowIdx*nGridCols+nCellColIdx;
+    };
+    oWS.vContourGridOffsets.assign(size_t(nGridRows*nGridCols+1),0);
+    for(int nContourPtIdx=0; nContourPtIdx<(int)oWS.oContourPts.total(); ++nContourPtIdx)
+        ++oWS.vContourGridOffsets[lGetGridCellIdx(((cv::Point2f*)oWS.oContourPts.data)[nContourPtIdx])+1];
+    std::partial_sum(oWS.vContourGridOffsets.begin(),oWS.vContourGridOffsets.end(),oWS.vContourGridOffsets.begin());
+    oWS.vContourGridPts.resize(oWS.oContourPts.total());
+    {
+        std::vector<int> vCellFillIdxs(oWS.vContourGridOffsets.begin(),oWS.vContourGridOffsets.end()-1);
+        for(int nContourPtIdx=0; nContourPtIdx<(int)oWS.oContourPts.total(); ++nContourPtIdx) {
+            const cv::Point2f& vContourPt = ((cv::Point2f*)oWS.oContourPts.data)[nContourPtIdx];
+            oWS.vContourGridPts[vCellFillIdxs[lGetGridCellIdx(vContourPt)]++] = vContourPt;
+        }
+    }
 #if USING_OPENMP
-    #pragma omp parallel for
+    #pragma omp parallel for schedule(dynamic,256) // keypoints far from contours exit early, balance dynamically
 #endif //USING_OPENMP
-    for(int nKeyPtIdx=0; nKeyPtIdx<(int)m_oKeyPts.total(); ++nKeyPtIdx) {
-        const cv::Point2f& vKeyPt = ((cv::Point2f*)m_oKeyPts.data)[nKeyPtIdx];
+    for(int nKeyPtIdx=0; nKeyPtIdx<(int)oWS.oKeyPts.total(); ++nKeyPtIdx) {
+        const cv::Point2f& vKeyPt = ((cv::Point2f*)oWS.oKeyPts.data)[nKeyPtIdx];
         const int nKeyPtRowIdx = (int)std::round(vKeyPt.y);
         const int nKeyPtColIdx = (int)std::round(vKeyPt.x);
-        if(!m_oDistMask(nKeyPtRowIdx,nKeyPtColIdx))
+        if(!oWS.oDistMask(nKeyPtRowIdx,nKeyPtColIdx))
             continue;
         float* aDesc = bGenDescMap?oDescriptors.ptr<float>(nKeyPtRowIdx,nKeyPtColIdx):oDescriptors.ptr<float>(nKeyPtIdx);
-        for(int nContourPtIdx=0; nContourPtIdx<(int)m_oContourPts.total(); ++nContourPtIdx) {
-            const cv::Point2f& vContourPt = ((cv::Point2f*)m_oContourPts.data)[nContourPtIdx];
-        #if USE_LIENHART_LOOKUP_MASK
-            const int nLookupRow = (int)std::round(vContourPt.y-vKeyPt.y)+m_nOuterRadius;
-            const int nLookupCol = (int)std::round(vContourPt.x-vKeyPt.x)+m_nOuterRadius;
-            if(nLookupRow<0 || nLookupRow>=m_oAbsDescLUMap.rows || nLookupCol<0 || nLookupCol>=m_oAbsDescLUMap.cols || m_oAbsDescLUMap(nLookupRow,nLookupCol)==-1)
-                continue;
-            ++(aDesc[m_oAbsDescLUMap(nLookupRow,nLookupCol)]);
-        #else //!USE_LIENHART_LOOKUP_MASK
-            cv::Matx12f vPtDiff;
-            vPtDiff(0) = vKeyPt.y-vContourPt.y;
-            vPtDiff(1) = vKeyPt.x-vContourPt.x;
-            const double dCurrDist = cv::norm(vPtDiff,cv::NORM_L2);
-            if(dCurrDist<0.01 || dCurrDist>m_vRadialLimits.back())
-                continue;
-            int nRadialBinMatch=-1;
-            for(int nRadialBinIdx=0; nRadialBinIdx<m_nRadialBins; ++nRadialBinIdx) {
-                if(dCurrDist<m_vRadialLimits[nRadialBinIdx]) {
-                    nRadialBinMatch = nRadialBinIdx;
-                    break;
-                }
-            }
-            if(nRadialBinMatch<0)
-                continue;
-            int nAngularBinMatch=-1;
-            const double dCurrAng = (dCurrDist<0.01)?0.0:std::fmod(std::atan2(vPtDiff(0),-vPtDiff(1))+2*CV_PI+FLT_EPSILON,2*CV_PI);
-            for(int nAngularBinIdx=0; nAngularBinIdx<m_nAngularBins; ++nAngularBinIdx) {
-                if(dCurrAng<m_vAngularLimits[nAngularBinIdx]) {
-                    nAngularBinMatch = nAngularBinIdx;
-                    break;
+        // rounded offsets must stay within the outer radius, so contour points are at most one pixel further away from the rounded keypoint
+        const int nMinCellRowIdx = std::max(nKeyPtRowIdx-m_nOuterRadius-1,0)/nGridCellSize;
+        const int nMaxCellRowIdx = std::min(std::max(nKeyPtRowIdx+m_nOuterRadius+1,0)/nGridCellSize,nGridRows-1);
+        const int nMinCellColIdx = std::max(nKeyPtColIdx-m_nOuterRadius-1,0)/nGridCellSize;
+        const int nMaxCellColIdx = std::min(std::max(nKeyPtColIdx+m_nOuterRadius+1,0)/nGridCellSize,nGridCols-1);
+        for(int nCellRowIdx=nMinCellRowIdx; nCellRowIdx<=nMaxCellRowIdx; ++nCellRowIdx) {
+            for(int nCellColIdx=nMinCellColIdx; nCellColIdx<=nMaxCellColIdx; ++nCellColIdx) {
+                const int nCellIdx = nCellRowIdx*nGridCols+nCellColIdx;
+                for(int nContourPtIdx=oWS.vContourGridOffsets[nCellIdx]; nContourPtIdx<oWS.vContourGridOffsets[nCellIdx+1]; ++nContourPtIdx) {
+                    const cv::Point2f& vContourPt = oWS.vContourGridPts[nContourPtIdx];
+                #if USE_LIENHART_LOOKUP_MASK
+                    const int nLookupRow = (int)std::round(vContourPt.y-vKeyPt.y)+m_nOuterRadius;
+                    const int nLookupCol = (int)std::round(vContourPt.x-vKeyPt.x)+m_nOuterRadius;
+                    if(nLookupRow<0 || nLookupRow>=m_oAbsDescLUMap.rows || nLookupCol<0 || nLookupCol>=m_oAbsDescLUMap.cols || m_oAbsDescLUMap(nLookupRow,nLookupCol)==-1)
+                        continue;
+                    ++(aDesc[m_oAbsDescLUMap(nLookupRow,nLookupCol)]);
+                #else //!USE_LIENHART_LOOKUP_MASK
+                    // fallback path: only benefits from the grid pruning above, binning still needs norm/atan2 per pair
+                    cv::Matx12f vPtDiff;
+                    vPtDiff(0) = vKeyPt.y-vContourPt.y;
+                    vPtDiff(1) = vKeyPt.x-vContourPt.x;
+                    const double dCurrDist = cv::norm(vPtDiff,cv::NORM_L2);
+                    if(dCurrDist<0.01 || dCurrDist>m_vRadialLimits.back())
+                        continue;
+                    int nRadialBinMatch=-1;
+                    for(int nRadialBinIdx=0; nRadialBinIdx<m_nRadialBins; ++nRadialBinIdx) {
+                        if(dCurrDist<m_vRadialLimits[nRadialBinIdx]) {
+                            nRadialBinMatch = nRadialBinIdx;
+                            break;
+                        }
+                    }
+                    if(nRadialBinMatch<0)
+                        continue;
+                    int nAngularBinMatch=-1;
+                    const double dCurrAng = (dCurrDist<0.01)?0.0:std::fmod(std::atan2(vPtDiff(0),-vPtDiff(1))+2*CV_PI+FLT_EPSILON,2*CV_PI);
+                    for(int nAngularBinIdx=0; nAngularBinIdx<m_nAngularBins; ++nAngularBinIdx) {
+                        if(dCurrAng<m_vAngularLimits[nAngularBinIdx]) {
+                            nAngularBinMatch = nAngularBinIdx;
+                            break;
+                        }
+                    }
+                    if(nAngularBinMatch<0)
+                        continue;
+                    ++(aDesc[nAngularBinMatch+nRadialBinMatch*m_nAngularBins]);
+                #endif //!USE_LIENHART_LOOKUP_MASK
                 }
             }
-            if(nAngularBinMatch<0)
-                continue;
-            ++(aDesc[nAngularBinMatch+nRadialBinMatch*m_nAngularBins]);
-        #endif //!USE_LIENHART_LOOKUP_MASK
         }
     }
     if(m_bNormalizeBins)
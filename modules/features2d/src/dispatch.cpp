@@ -0,0 +1,165 @@
+
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2016 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "litiv/features2d.hpp"
+
+// each kernel variant below is compiled for its own instruction set via function target attributes (gcc/clang), so that
+// a single binary carries all of them regardless of the build flags; msvc exposes all intrinsics without any attribute
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__amd64__))
+#define LV_KERNEL_TARGET(isa) __attribute__((target(isa)))
+#define LV_HAVE_KERNEL_VARIANTS 1
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define LV_KERNEL_TARGET(isa)
+#define LV_HAVE_KERNEL_VARIANTS 1
+#else //!(x86 w/ gcc/clang/msvc)
+#define LV_HAVE_KERNEL_VARIANTS 0
+#endif //!(x86 w/ gcc/clang/msvc)
+
+namespace {
+
+    void hdist_16ui_scalar(const uint16_t* anBuffer1, const uint16_t* anBuffer2, uint8_t* anOutput, size_t nCount) {
+        for(size_t nIdx=0; nIdx<nCount; ++nIdx)
+            anOutput[nIdx] = lv::hdist<uint16_t,uint8_t>(anBuffer1[nIdx],anBuffer2[nIdx]);
+    }
+
+    float L2sqrdist_32f_scalar(const float* a, const float* b, size_t nElements) {
+        float fResult = 0.0f;
+        for(size_t nIdx=0; nIdx<nElements; ++nIdx)
+            fResult += lv::L2sqrdist(a[nIdx],b[nIdx]);
+        return fResult;
+    }
+
+#if LV_HAVE_KERNEL_VARIANTS
+
+    LV_KERNEL_TARGET("ssse3")
+    void hdist_16ui_ssse3(const uint16_t* anBuffer1, const uint16_t* anBuffer2, uint8_t* anOutput, size_t nCount) {
+        // per-word population counts via 4-bit nibble lookups (see lv::popcount_16ui; duplicated here to keep the target attribute)
+        const __m128i anNibbleLUT = _mm_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m128i anNibbleMask = _mm_set1_epi8(0x0F);
+        const __m128i anWordMask = _mm_set1_epi16(0x00FF);
+        size_t nIdx = 0;
+        for(; nIdx+16<=nCount; nIdx+=16) {
+            __m128i aanDists[2];
+            for(size_t nHalfIdx=0; nHalfIdx<2; ++nHalfIdx) {
+                const __m128i anXOR = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(anBuffer1+nIdx+nHalfIdx*8)),_mm_loadu_si128((const __m128i*)(anBuffer2+nIdx+nHalfIdx*8)));
+                const __m128i anLowCounts = _mm_shuffle_epi8(anNibbleLUT,_mm_and_si128(anXOR,anNibbleMask));
+                const __m128i anHighCounts = _mm_shuffle_epi8(anNibbleLUT,_mm_and_si128(_mm_srli_epi16(anXOR,4),anNibbleMask));
+                const __m128i anByteCounts = _mm_add_epi8(anLowCounts,anHighCounts);
+                aanDists[nHalfIdx] = _mm_and_si128(_mm_add_epi8(anByteCounts,_mm_srli_epi16(anByteCounts,8)),anWordMask);
+            }
+            _mm_storeu_si128((__m128i*)(anOutput+nIdx),_mm_packus_epi16(aanDists[0],aanDists[1]));
+        }
+        hdist_16ui_scalar(anBuffer1+nIdx,anBuffer2+nIdx,anOutput+nIdx,nCount-nIdx);
+    }
+
+    LV_KERNEL_TARGET("avx2")
+    void hdist_16ui_avx2(const uint16_t* anBuffer1, const uint16_t* anBuffer2, uint8_t* anOutput, size_t nCount) {
+        const __m256i anNibbleLUT = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m256i anNibbleMask = _mm256_set1_epi8(0x0F);
+        const __m256i anWordMask = _mm256_set1_epi16(0x00FF);
+        size_t nIdx = 0;
+        for(; nIdx+32<=nCount; nIdx+=32) {
+            __m256i aanDists[2];
+            for(size_t nHalfIdx=0; nHalfIdx<2; ++nHalfIdx) {
+                const __m256i anXOR = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(anBuffer1+nIdx+nHalfIdx*16)),_mm256_loadu_si256((const __m256i*)(anBuffer2+nIdx+nHalfIdx*16)));
+                const __m256i anLowCounts = _mm256_shuffle_epi8(anNibbleLUT,_mm256_and_si256(anXOR,anNibbleMask));
+                const __m256i anHighCounts = _mm256_shuffle_epi8(anNibbleLUT,_mm256_and_si256(_mm256_srli_epi16(anXOR,4),anNibbleMask));
+                const __m256i anByteCounts = _mm256_add_epi8(anLowCounts,anHighCounts);
+                aanDists[nHalfIdx] = _mm256_and_si256(_mm256_add_epi8(anByteCounts,_mm256_srli_epi16(anByteCounts,8)),anWordMask);
+            }
+            // packus works within 128-bit lanes, so the 64-bit quarters must be reordered after packing
+            _mm256_storeu_si256((__m256i*)(anOutput+nIdx),_mm256_permute4x64_epi64(_mm256_packus_epi16(aanDists[0],aanDists[1]),_MM_SHUFFLE(3,1,2,0)));
+        }
+        hdist_16ui_scalar(anBuffer1+nIdx,anBuffer2+nIdx,anOutput+nIdx,nCount-nIdx);
+    }
+
+    LV_KERNEL_TARGET("sse2")
+    float L2sqrdist_32f_sse2(const float* a, const float* b, size_t nElements) {
+        size_t nIdx = 0;
+        float fResult = 0.0f;
+        if(nElements>=4) {
+            __m128 afAccum = _mm_setzero_ps();
+            for(; nIdx+4<=nElements; nIdx+=4) {
+                const __m128 afDiff = _mm_sub_ps(_mm_loadu_ps(a+nIdx),_mm_loadu_ps(b+nIdx));
+                afAccum = _mm_add_ps(afAccum,_mm_mul_ps(afDiff,afDiff));
+            }
+            const __m128 afAccum2 = _mm_add_ps(afAccum,_mm_movehl_ps(afAccum,afAccum));
+            fResult = _mm_cvtss_f32(_mm_add_ss(afAccum2,_mm_shuffle_ps(afAccum2,afAccum2,1)));
+        }
+        return fResult+L2sqrdist_32f_scalar(a+nIdx,b+nIdx,nElements-nIdx);
+    }
+
+    LV_KERNEL_TARGET("avx")
+    float L2sqrdist_32f_avx(const float* a, const float* b, size_t nElements) {
+        // note: fma is not part of the avx level reported by the host check, so products & sums stay separate here
+        size_t nIdx = 0;
+        float fResult = 0.0f;
+        if(nElements>=8) {
+            __m256 afAccum = _mm256_setzero_ps();
+            for(; nIdx+8<=nElements; nIdx+=8) {
+                const __m256 afDiff = _mm256_sub_ps(_mm256_loadu_ps(a+nIdx),_mm256_loadu_ps(b+nIdx));
+                afAccum = _mm256_add_ps(afAccum,_mm256_mul_ps(afDiff,afDiff));
+            }
+            const __m128 afAccum4 = _mm_add_ps(_mm256_castps256_ps128(afAccum),_mm256_extractf128_ps(afAccum,1));
+            const __m128 afAccum2 = _mm_add_ps(afAccum4,_mm_movehl_ps(afAccum4,afAccum4));
+            fResult = _mm_cvtss_f32(_mm_add_ss(afAccum2,_mm_shuffle_ps(afAccum2,afAccum2,1)));
+        }
+        return fResult+L2sqrdist_32f_scalar(a+nIdx,b+nIdx,nElements-nIdx);
+    }
+
+#endif //LV_HAVE_KERNEL_VARIANTS
+
+    /// kernel variant selected for the host, along with the instruction set level it was compiled for
+    template<typename TKernel>
+    struct KernelVariant {
+        TKernel pKernel;
+        lv::CPUInstrSet eInstrSet;
+    };
+
+} // anonymous namespace
+
+lv::HDist16uiKernel lv::getHDist16uiKernel(CPUInstrSet* peInstrSet) {
+    static const KernelVariant<HDist16uiKernel> s_oVariant = []() -> KernelVariant<HDist16uiKernel> {
+    #if LV_HAVE_KERNEL_VARIANTS
+        const CPUInstrSet eHostInstrSet = getHostCPUInstrSet();
+        if(eHostInstrSet>=CPUInstrSet_AVX2)
+            return {&hdist_16ui_avx2,CPUInstrSet_AVX2};
+        if(eHostInstrSet>=CPUInstrSet_SSSE3)
+            return {&hdist_16ui_ssse3,CPUInstrSet_SSSE3};
+    #endif //LV_HAVE_KERNEL_VARIANTS
+        return {&hdist_16ui_scalar,CPUInstrSet_Scalar};
+    }();
+    if(peInstrSet)
+        *peInstrSet = s_oVariant.eInstrSet;
+    return s_oVariant.pKernel;
+}
+
+lv::L2SqrDist32fKernel lv::getL2SqrDist32fKernel(CPUInstrSet* peInstrSet) {
+    static const KernelVariant<L2SqrDist32fKernel> s_oVariant = []() -> KernelVariant<L2SqrDist32fKernel> {
+    #if LV_HAVE_KERNEL_VARIANTS
+        const CPUInstrSet eHostInstrSet = getHostCPUInstrSet();
+        if(eHostInstrSet>=CPUInstrSet_AVX)
+            return {&L2sqrdist_32f_avx,CPUInstrSet_AVX};
+        if(eHostInstrSet>=CPUInstrSet_SSE2)
+            return {&L2sqrdist_32f_sse2,CPUInstrSet_SSE2};
+    #endif //LV_HAVE_KERNEL_VARIANTS
+        return {&L2sqrdist_32f_scalar,CPUInstrSet_Scalar};
+    }();
+    if(peInstrSet)
+        *peInstrSet = s_oVariant.eInstrSet;
+    return s_oVariant.pKernel;
+}
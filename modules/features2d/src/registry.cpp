@@ -0,0 +1,235 @@
+
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2016 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "litiv/features2d.hpp"
+#if USING_OPENMP
+#include <omp.h>
+#endif //USING_OPENMP
+
+namespace {
+
+    /// returns the value of a named param if found in the map, or the provided default otherwise
+    template<typename T>
+    T getParam(const lv::DescExtractorParams& mParams, const char* sKey, T tDefault) {
+        const auto pIter = mParams.find(sKey);
+        return (pIter==mParams.end())?tDefault:(T)pIter->second;
+    }
+
+    /// specialization for booleans (any non-null value toggles the flag on)
+    template<>
+    bool getParam<bool>(const lv::DescExtractorParams& mParams, const char* sKey, bool bDefault) {
+        const auto pIter = mParams.find(sKey);
+        return (pIter==mParams.end())?bDefault:(pIter->second!=0.0);
+    }
+
+    /// generic wrapper used for all built-in extractors (which all share the same dense 'compute2' signature)
+    template<typename TExtractor>
+    struct DescExtractorWrapper : public lv::IDescExtractor {
+        DescExtractorWrapper(const std::string& sName, cv::Ptr<TExtractor> pExtractor, lv::CPUInstrSet eInstrSet, bool bMultiThreaded, bool bUsingGPU=false) :
+                m_sName(sName),m_pExtractor(pExtractor),m_eInstrSet(bUsingGPU?lv::CPUInstrSet_Scalar:eInstrSet),m_nThreads(1),m_bUsingGPU(bUsingGPU) {
+            lvAssert_(m_pExtractor,"extractor must be non-null");
+        #if USING_OPENMP
+            if(bMultiThreaded && !m_bUsingGPU)
+                m_nThreads = std::max(size_t(omp_get_max_threads()),size_t(1));
+        #else //!USING_OPENMP
+            lvIgnore(bMultiThreaded);
+        #endif //!USING_OPENMP
+        }
+        virtual const std::string& getName() const override {return m_sName;}
+        virtual cv::Ptr<cv::DescriptorExtractor> getExtractor() const override {return m_pExtractor;}
+        virtual lv::MatInfo getOutputInfo(const lv::MatInfo& oInputInfo) const override {return m_pExtractor->getOutputInfo(oInputInfo);}
+        virtual void compute2(const cv::Mat& oImage, cv::Mat& oDescMap) override {m_pExtractor->compute2(oImage,oDescMap);}
+        virtual lv::CPUInstrSet getInstrSet() const override {return m_eInstrSet;}
+        virtual size_t getThreadCount() const override {return m_nThreads;}
+        virtual bool isUsingGPU() const override {return m_bUsingGPU;}
+    protected:
+        const std::string m_sName;
+        const cv::Ptr<TExtractor> m_pExtractor;
+        const lv::CPUInstrSet m_eInstrSet; ///< level of the distance kernel variant picked for the host (or of the build, if none is dispatched)
+        size_t m_nThreads;
+        const bool m_bUsingGPU;
+    };
+
+    /// returns the instruction set level of the hamming distance kernel variant selected for the host
+    lv::CPUInstrSet getHDist16uiKernelInstrSet() {
+        lv::CPUInstrSet eInstrSet;
+        lv::getHDist16uiKernel(&eInstrSet);
+        return eInstrSet;
+    }
+
+    /// returns the instruction set level of the squared L2 distance kernel variant selected for the host
+    lv::CPUInstrSet getL2SqrDist32fKernelInstrSet() {
+        lv::CPUInstrSet eInstrSet;
+        lv::getL2SqrDist32fKernel(&eInstrSet);
+        return eInstrSet;
+    }
+
+    /// returns the global registry map, pre-filled with all built-in extractors on first use
+    std::map<std::string,lv::DescExtractorFactory>& getRegistry() {
+        static std::map<std::string,lv::DescExtractorFactory> s_mRegistry = {
+            {"dasc_rf",[](const lv::DescExtractorParams& mParams) -> std::unique_ptr<lv::IDescExtractor> {
+                return std::make_unique<DescExtractorWrapper<DASC>>("dasc_rf",cv::makePtr<DASC>(
+                    getParam(mParams,"sigma_s",DASC_DEFAULT_RF_SIGMAS),
+                    getParam(mParams,"sigma_r",DASC_DEFAULT_RF_SIGMAR),
+                    getParam(mParams,"iters",DASC_DEFAULT_RF_ITERS),
+                    getParam(mParams,"preprocess",DASC_DEFAULT_PREPROCESS)
+                ),getL2SqrDist32fKernelInstrSet(),false);
+            }},
+            {"dasc_gf",[](const lv::DescExtractorParams& mParams) -> std::unique_ptr<lv::IDescExtractor> {
+                return std::make_unique<DescExtractorWrapper<DASC>>("dasc_gf",cv::makePtr<DASC>(
+                    getParam(mParams,"radius",DASC_DEFAULT_GF_RADIUS),
+                    getParam(mParams,"eps",DASC_DEFAULT_GF_EPS),
+                    getParam(mParams,"subspl",DASC_DEFAULT_GF_SUBSPL),
+                    getParam(mParams,"preprocess",DASC_DEFAULT_PREPROCESS)
+                ),getL2SqrDist32fKernelInstrSet(),false);
+            }},
+            {"lbsp",[](const lv::DescExtractorParams& mParams) -> std::unique_ptr<lv::IDescExtractor> {
+                // absolute threshold takes precedence if provided; relative threshold is used otherwise
+                if(mParams.find("threshold")!=mParams.end())
+                    return std::make_unique<DescExtractorWrapper<LBSP>>("lbsp",cv::makePtr<LBSP>(getParam(mParams,"threshold",size_t(0))),getHDist16uiKernelInstrSet(),false);
+                return std::make_unique<DescExtractorWrapper<LBSP>>("lbsp",cv::makePtr<LBSP>(
+                    getParam(mParams,"rel_threshold",0.333f),
+                    getParam(mParams,"threshold_offset",size_t(0))
+                ),getHDist16uiKernelInstrSet(),false);
+            }},
+            {"lss",[](const lv::DescExtractorParams& mParams) -> std::unique_ptr<lv::IDescExtractor> {
+                return std::make_unique<DescExtractorWrapper<LSS>>("lss",cv::makePtr<LSS>(
+                    getParam(mParams,"inner_radius",LSS_DEFAULT_INNER_RADIUS),
+                    getParam(mParams,"outer_radius",LSS_DEFAULT_OUTER_RADIUS),
+                    getParam(mParams,"patch_size",LSS_DEFAULT_PATCH_SIZE),
+                    getParam(mParams,"angular_bins",LSS_DEFAULT_ANGULAR_BINS),
+                    getParam(mParams,"radial_bins",LSS_DEFAULT_RADIAL_BINS),
+                    getParam(mParams,"static_noise_var",LSS_DEFAULT_STATNOISE_VAR),
+                    getParam(mParams,"normalize_bins",LSS_DEFAULT_NORM_BINS),
+                    getParam(mParams,"preprocess",LSS_DEFAULT_PREPROCESS),
+                    getParam(mParams,"lienhart_mask",LSS_DEFAULT_USE_LIENH_MASK)
+                ),getL2SqrDist32fKernelInstrSet(),true);
+            }},
+            {"sc",[](const lv::DescExtractorParams& mParams) -> std::unique_ptr<lv::IDescExtractor> {
+                // absolute radii are used only if both are provided; mean-normalized radii are used otherwise
+                const bool bUseAbsRadii = mParams.find("inner_radius")!=mParams.end() && mParams.find("outer_radius")!=mParams.end();
+                const size_t nAngularBins = getParam(mParams,"angular_bins",size_t(SHAPECONTEXT_DEFAULT_ANG_BINS));
+                const size_t nRadialBins = getParam(mParams,"radial_bins",size_t(SHAPECONTEXT_DEFAULT_RAD_BINS));
+                const bool bRotationInvariant = getParam(mParams,"rot_invariant",sHAPECONTEXT_DEFAULT_ROT_INVAR);
+                const bool bNormalizeBins = getParam(mParams,"normalize_bins",SHAPECONTEXT_DEFAULT_NORM_BINS);
+                const bool bUseNonZeroInit = getParam(mParams,"nonzero_init",SHAPECONTEXT_DEFAULT_USE_NZ_INIT);
+                cv::Ptr<ShapeContext> pExtractor = bUseAbsRadii?
+                    cv::makePtr<ShapeContext>(getParam(mParams,"inner_radius",size_t(0)),getParam(mParams,"outer_radius",size_t(0)),nAngularBins,nRadialBins,bRotationInvariant,bNormalizeBins,bUseNonZeroInit):
+                    cv::makePtr<ShapeContext>(getParam(mParams,"rel_inner_radius",SHAPECONTEXT_DEFAULT_INNER_RAD),getParam(mParams,"rel_outer_radius",SHAPECONTEXT_DEFAULT_OUTER_RAD),nAngularBins,nRadialBins,bRotationInvariant,bNormalizeBins,bUseNonZeroInit);
+            #if HAVE_CUDA
+                // the gpu impl is enabled by default when a device could be initialized; it can be turned off via params
+                if(!getParam(mParams,"use_gpu",true))
+                    pExtractor->enableCUDA(false);
+            #endif //HAVE_CUDA
+                const bool bUsingGPU = pExtractor->isParallel();
+                return std::make_unique<DescExtractorWrapper<ShapeContext>>("sc",pExtractor,lv::getBuildCPUInstrSet(),true,bUsingGPU);
+            }},
+        };
+        return s_mRegistry;
+    }
+
+    /// mutex used to protect the registry in case of concurrent registrations
+    std::mutex& getRegistryMutex() {
+        static std::mutex s_oMutex;
+        return s_oMutex;
+    }
+
+} // anonymous namespace
+
+const char* lv::getCPUInstrSetName(CPUInstrSet eInstrSet) {
+    switch(eInstrSet) {
+        case CPUInstrSet_Scalar: return "Scalar";
+        case CPUInstrSet_SSE2: return "SSE2";
+        case CPUInstrSet_SSSE3: return "SSSE3";
+        case CPUInstrSet_SSE4_1: return "SSE4.1";
+        case CPUInstrSet_AVX: return "AVX";
+        case CPUInstrSet_AVX2: return "AVX2";
+        default: lvError("unknown instruction set");
+    }
+}
+
+lv::CPUInstrSet lv::getHostCPUInstrSet() {
+    static const CPUInstrSet s_eHostInstrSet = []() {
+        // levels are cumulative here; a missing lower level caps the result even if a higher one is reported
+        if(!cv::checkHardwareSupport(CV_CPU_SSE2))
+            return CPUInstrSet_Scalar;
+        if(!cv::checkHardwareSupport(CV_CPU_SSSE3))
+            return CPUInstrSet_SSE2;
+        if(!cv::checkHardwareSupport(CV_CPU_SSE4_1))
+            return CPUInstrSet_SSSE3;
+        if(!cv::checkHardwareSupport(CV_CPU_AVX))
+            return CPUInstrSet_SSE4_1;
+        if(!cv::checkHardwareSupport(CV_CPU_AVX2))
+            return CPUInstrSet_AVX;
+        return CPUInstrSet_AVX2;
+    }();
+    return s_eHostInstrSet;
+}
+
+lv::CPUInstrSet lv::getBuildCPUInstrSet() {
+#if HAVE_AVX2
+    return CPUInstrSet_AVX2;
+#elif HAVE_AVX
+    return CPUInstrSet_AVX;
+#elif HAVE_SSE4_1
+    return CPUInstrSet_SSE4_1;
+#elif HAVE_SSSE3
+    return CPUInstrSet_SSSE3;
+#elif HAVE_SSE2
+    return CPUInstrSet_SSE2;
+#else //!HAVE_SSE2
+    return CPUInstrSet_Scalar;
+#endif //!HAVE_SSE2
+}
+
+std::string lv::IDescExtractor::describeImplementation() const {
+    if(isUsingGPU())
+        return lv::putf("%s [CUDA]",getName().c_str());
+    const size_t nThreads = getThreadCount();
+    return lv::putf("%s [%s x %d thread%s]",getName().c_str(),getCPUInstrSetName(getInstrSet()),(int)nThreads,nThreads>1?"s":"");
+}
+
+void lv::registerDescExtractor(const std::string& sName, DescExtractorFactory lFactory) {
+    lvAssert_(!sName.empty(),"extractor name must be non-empty");
+    lvAssert_(lFactory,"extractor factory must be non-null");
+    std::lock_guard<std::mutex> oLock(getRegistryMutex());
+    getRegistry()[sName] = std::move(lFactory);
+}
+
+std::vector<std::string> lv::getDescExtractorNames() {
+    std::lock_guard<std::mutex> oLock(getRegistryMutex());
+    std::vector<std::string> vsNames;
+    for(const auto& oPair : getRegistry())
+        vsNames.push_back(oPair.first);
+    return vsNames;
+}
+
+std::unique_ptr<lv::IDescExtractor> lv::createDescriptorExtractor(const std::string& sName, const DescExtractorParams& mParams) {
+    // distance kernels are dispatched per host isa (see dispatch.cpp), but all other cpu code is still inlined for the build level; make sure the host can run it
+    lvAssert__(getBuildCPUInstrSet()<=getHostCPUInstrSet(),"current build requires %s instructions, but host only supports %s",getCPUInstrSetName(getBuildCPUInstrSet()),getCPUInstrSetName(getHostCPUInstrSet()));
+    DescExtractorFactory lFactory;
+    {
+        std::lock_guard<std::mutex> oLock(getRegistryMutex());
+        const auto pIter = getRegistry().find(sName);
+        lvAssert__(pIter!=getRegistry().end(),"unknown descriptor extractor name '%s'",sName.c_str());
+        lFactory = pIter->second;
+    }
+    std::unique_ptr<IDescExtractor> pExtractor = lFactory(mParams);
+    lvAssert_(pExtractor,"extractor factory returned null object");
+    lvDbgLog_(1,"created descriptor extractor: %s",pExtractor->describeImplementation().c_str());
+    return pExtractor;
+}
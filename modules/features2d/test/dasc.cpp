@@ -144,6 +144,25 @@ TEST(dasc_rf,regression_large_compute) {
 #endif //ndef(_MSC_VER)
 }
 
+TEST(dasc_rf,regression_batch_compute) {
+    std::unique_ptr<DASC> pDASC = std::make_unique<DASC>(DASC_DEFAULT_RF_SIGMAS,DASC_DEFAULT_RF_SIGMAR);
+    const cv::Mat oInput = cv::imread(SAMPLES_DATA_ROOT "/108073.jpg");
+    ASSERT_TRUE(!oInput.empty());
+    // batch images of different sizes/contents should be described independently, in parallel, with a single extractor
+    std::vector<cv::Mat> vInputs;
+    for(int nImageIdx=0; nImageIdx<4; ++nImageIdx)
+        vInputs.push_back(oInput(cv::Rect(nImageIdx*20,nImageIdx*10,80+nImageIdx*10,60+nImageIdx*5)).clone());
+    std::vector<cv::Mat_<float>> vOutputDescMaps;
+    pDASC->compute2(vInputs,vOutputDescMaps);
+    ASSERT_EQ(vOutputDescMaps.size(),vInputs.size());
+    for(size_t nImageIdx=0; nImageIdx<vInputs.size(); ++nImageIdx) {
+        cv::Mat_<float> oOutputDescMap;
+        pDASC->compute2(vInputs[nImageIdx],oOutputDescMap);
+        ASSERT_EQ(lv::MatInfo(oOutputDescMap),lv::MatInfo(vOutputDescMaps[nImageIdx]));
+        ASSERT_TRUE(lv::isEqual<float>(oOutputDescMap,vOutputDescMaps[nImageIdx]));
+    }
+}
+
 TEST(dasc_gf,regression_constr) {
     EXPECT_THROW_LV_QUIET(lv::doNotOptimize(std::make_unique<DASC>(size_t(0),0.05f)));
     EXPECT_THROW_LV_QUIET(lv::doNotOptimize(std::make_unique<DASC>(size_t(1),0.0f)));
@@ -77,4 +77,46 @@ TEST(lbsp,regression_compute) {
             ++nKeyPointIdx;
         }
     }
-}
\ No newline at end of file
+}
+
+TEST(lbsp,regression_match_counts) {
+    cv::RNG oRNG(42);
+    for(int nChannels : {1,3}) {
+        cv::Mat oDescMap(37,101,CV_16UC(nChannels));
+        oRNG.fill(oDescMap,cv::RNG::UNIFORM,0,65536);
+        std::vector<cv::Mat> voRefDescMaps(20);
+        for(cv::Mat& oRefDescMap : voRefDescMaps) {
+            // flip a few random bits in the reference map so that a part of the pixels match
+            cv::Mat oNoise(oDescMap.size(),oDescMap.type());
+            oRNG.fill(oNoise,cv::RNG::UNIFORM,0,65536);
+            cv::Mat oNoiseMask(oDescMap.size(),oDescMap.type());
+            oRNG.fill(oNoiseMask,cv::RNG::UNIFORM,0,65536);
+            cv::bitwise_and(oNoise,oNoiseMask,oNoise);
+            cv::bitwise_and(oNoise,cv::Scalar::all(oRNG.uniform(0,65536)),oNoise);
+            cv::bitwise_xor(oDescMap,oNoise,oRefDescMap);
+        }
+        const size_t nMaxDist = size_t(3*nChannels), nRequiredMatches = 2;
+        cv::Mat_<uchar> oMatchCounts;
+        LBSP::calcMatchCounts(oDescMap,voRefDescMaps,nMaxDist,nRequiredMatches,oMatchCounts);
+        ASSERT_EQ(oMatchCounts.size(),oDescMap.size());
+        std::vector<cv::Mat_<uchar>> voDistMaps(voRefDescMaps.size());
+        for(size_t nRefIdx=0; nRefIdx<voRefDescMaps.size(); ++nRefIdx)
+            LBSP::calcDistances(oDescMap,voRefDescMaps[nRefIdx],voDistMaps[nRefIdx]);
+        for(int nRowIdx=0; nRowIdx<oDescMap.rows; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<oDescMap.cols; ++nColIdx) {
+                size_t nExpectedCount = 0;
+                for(size_t nRefIdx=0; nRefIdx<voRefDescMaps.size() && nExpectedCount<nRequiredMatches; ++nRefIdx) {
+                    size_t nExpectedDist = 0;
+                    for(int nChIdx=0; nChIdx<nChannels; ++nChIdx)
+                        nExpectedDist += lv::hdist(oDescMap.ptr<ushort>(nRowIdx,nColIdx)[nChIdx],voRefDescMaps[nRefIdx].ptr<ushort>(nRowIdx,nColIdx)[nChIdx]);
+                    ASSERT_EQ(size_t(voDistMaps[nRefIdx](nRowIdx,nColIdx)),nExpectedDist);
+                    if(nExpectedDist<=nMaxDist)
+                        ++nExpectedCount;
+                }
+                ASSERT_EQ(size_t(oMatchCounts(nRowIdx,nColIdx)),nExpectedCount);
+            }
+        }
+    }
+    cv::Mat_<uchar> oInvalidCounts;
+    EXPECT_THROW_LV_QUIET(LBSP::calcMatchCounts(cv::Mat(10,10,CV_16UC1),std::vector<cv::Mat>{cv::Mat(10,11,CV_16UC1)},1,1,oInvalidCounts));
+}
@@ -206,4 +206,101 @@ TEST(lss,regression_large_transl_invert_compute) {
     const cv::Mat_<float> oOutputKPDesc2(3,std::array<int,3>{1,1,oOutputDescMap2.size[2]}.data(),oOutputDescMap2.ptr<float>(oTargetPt_new.y,oTargetPt_new.x));
     ASSERT_FLOAT_EQ((float)cv::norm(oOutputKPDesc2,cv::NORM_L2),1.0f);
     ASSERT_NEAR(float(pLSS->calcDistance(oOutputKPDesc1,oOutputKPDesc2)),0.0f,(float)1e-5);
-}
\ No newline at end of file
+}
+
+TEST(lss,regression_dense_vs_bruteforce) {
+    const cv::Mat oInput = cv::imread(SAMPLES_DATA_ROOT "/108073.jpg");
+    ASSERT_TRUE(!oInput.empty());
+    const cv::Mat oInputCrop = oInput(cv::Rect(300,100,72,80)).clone();
+    // {outer radius, patch size, lienhart mask, normalize bins}
+    for(const std::array<int,4>& anParams : std::vector<std::array<int,4>>{{8,3,0,0},{10,5,1,0},{12,7,1,1},{9,9,0,1}}) {
+        const int nOuterRadius=anParams[0],nPatchSize=anParams[1];
+        const bool bUseLienhartMask=anParams[2]!=0,bNormalizeBins=anParams[3]!=0;
+        const int nRadialBins=3,nAngularBins=12;
+        const float fStaticNoiseVar = 300000.f;
+        std::unique_ptr<LSS> pLSS = std::make_unique<LSS>(0,nOuterRadius,nPatchSize,nAngularBins,nRadialBins,fStaticNoiseVar,bNormalizeBins,false,bUseLienhartMask);
+        const int nBorderSize = pLSS->borderSize();
+        const int nDescSize = nRadialBins*nAngularBins;
+        cv::Mat_<float> oDenseDescMap;
+        pLSS->compute2(oInputCrop,oDenseDescMap);
+        ASSERT_EQ(oDenseDescMap.size[0],oInputCrop.rows);
+        ASSERT_EQ(oDenseDescMap.size[1],oInputCrop.cols);
+        ASSERT_EQ(oDenseDescMap.size[2],nDescSize);
+        // brute-force reference: min patch ssd over each log-polar bin of the correlation window, then exp-scaled
+        const int nCorrPatchSize = nOuterRadius*2+1;
+        cv::Mat_<int> oDescLUMap;
+        lv::getLogPolarMask(nCorrPatchSize,nRadialBins,nAngularBins,oDescLUMap,bUseLienhartMask,0.0f);
+        const auto lCalcRefDesc = [&](int nRowIdx, int nColIdx) {
+            std::vector<float> vfDesc(size_t(nDescSize),std::numeric_limits<float>::max());
+            for(int nLUIdx=0; nLUIdx<(int)oDescLUMap.total(); ++nLUIdx) {
+                const int nBinIdx = oDescLUMap(nLUIdx);
+                if(nBinIdx==-1)
+                    continue;
+                const int nRowOffset = nLUIdx/nCorrPatchSize-nCorrPatchSize/2, nColOffset = nLUIdx%nCorrPatchSize-nCorrPatchSize/2;
+                int nSSD = 0;
+                for(int nPatchRowIdx=-nPatchSize/2; nPatchRowIdx<=nPatchSize/2; ++nPatchRowIdx) {
+                    for(int nPatchColIdx=-nPatchSize/2; nPatchColIdx<=nPatchSize/2; ++nPatchColIdx) {
+                        const cv::Vec3b& vPx = oInputCrop.at<cv::Vec3b>(nRowIdx+nPatchRowIdx,nColIdx+nPatchColIdx);
+                        const cv::Vec3b& vOffsetPx = oInputCrop.at<cv::Vec3b>(nRowIdx+nPatchRowIdx+nRowOffset,nColIdx+nPatchColIdx+nColOffset);
+                        for(int nChIdx=0; nChIdx<3; ++nChIdx)
+                            nSSD += (int(vPx[nChIdx])-int(vOffsetPx[nChIdx]))*(int(vPx[nChIdx])-int(vOffsetPx[nChIdx]));
+                    }
+                }
+                vfDesc[nBinIdx] = std::min(vfDesc[nBinIdx],(float)nSSD);
+            }
+            for(float& fBin : vfDesc)
+                fBin = std::exp(-fBin/fStaticNoiseVar);
+            if(bNormalizeBins) {
+                const double dNorm = cv::norm(vfDesc,cv::NORM_L2);
+                for(float& fBin : vfDesc)
+                    fBin = (dNorm>1e-6)?float(fBin/dNorm):std::sqrt(1.0f/nDescSize);
+            }
+            return vfDesc;
+        };
+        // valid region corners/edges, band boundaries (dense impl splits rows in bands of 32), and center
+        const int nLastRowIdx=oInputCrop.rows-nBorderSize-1,nLastColIdx=oInputCrop.cols-nBorderSize-1;
+        std::vector<cv::Point> voTestPts = {
+            {nBorderSize,nBorderSize},{nLastColIdx,nBorderSize},{nBorderSize,nLastRowIdx},{nLastColIdx,nLastRowIdx},
+            {oInputCrop.cols/2,nBorderSize},{nBorderSize,oInputCrop.rows/2},{oInputCrop.cols/2,oInputCrop.rows/2},
+        };
+        for(int nBandRowIdx : {nBorderSize+31,nBorderSize+32})
+            if(nBandRowIdx<=nLastRowIdx)
+                voTestPts.emplace_back(nBorderSize+1,nBandRowIdx);
+        std::vector<cv::KeyPoint> vKeyPoints;
+        for(const cv::Point& oPt : voTestPts)
+            vKeyPoints.emplace_back(cv::Point2f(float(oPt.x),float(oPt.y)),float(pLSS->windowSize().width));
+        cv::Mat_<float> oKeyPtDescs;
+        pLSS->compute(oInputCrop,vKeyPoints,oKeyPtDescs);
+        ASSERT_EQ(vKeyPoints.size(),voTestPts.size());
+        for(size_t nPtIdx=0; nPtIdx<voTestPts.size(); ++nPtIdx) {
+            const cv::Point& oPt = voTestPts[nPtIdx];
+            const std::vector<float> vfRefDesc = lCalcRefDesc(oPt.y,oPt.x);
+            for(int nDescIdx=0; nDescIdx<nDescSize; ++nDescIdx) {
+                ASSERT_NEAR(oDenseDescMap(oPt.y,oPt.x,nDescIdx),vfRefDesc[nDescIdx],1e-5f) << "outer=" << nOuterRadius << ", patch=" << nPatchSize << ", pt=" << oPt << ", bin=" << nDescIdx;
+                ASSERT_NEAR(oKeyPtDescs(int(nPtIdx),nDescIdx),vfRefDesc[nDescIdx],1e-5f) << "outer=" << nOuterRadius << ", patch=" << nPatchSize << ", pt=" << oPt << ", bin=" << nDescIdx;
+            }
+        }
+        // descriptors in the invalid border are zeroed
+        for(const cv::Point& oPt : {cv::Point(nBorderSize-1,nBorderSize),cv::Point(nBorderSize,nBorderSize-1),cv::Point(nLastColIdx+1,nLastRowIdx),cv::Point(nLastColIdx,nLastRowIdx+1)})
+            for(int nDescIdx=0; nDescIdx<nDescSize; ++nDescIdx)
+                ASSERT_EQ(oDenseDescMap(oPt.y,oPt.x,nDescIdx),0.0f) << "pt=" << oPt;
+    }
+}
+
+namespace {
+
+    void lss_dense_perftest(benchmark::State& state) {
+        std::unique_ptr<LSS> pLSS = std::make_unique<LSS>(0,int(state.range(0)),int(state.range(1)));
+        const cv::Mat oInput = cv::imread(SAMPLES_DATA_ROOT "/108073.jpg");
+        lvAssert(!oInput.empty());
+        cv::Mat_<float> oOutputDescMap;
+        while (state.KeepRunning()) {
+            pLSS->compute2(oInput,oOutputDescMap);
+            lvDbgAssert(oInput.size[0]==oOutputDescMap.size[0]);
+            lvDbgAssert(oInput.size[1]==oOutputDescMap.size[1]);
+            benchmark::DoNotOptimize(oOutputDescMap);
+        }
+    }
+}
+
+BENCHMARK(lss_dense_perftest)->Args({10,3})->Args({20,5})->Args({20,9})->Args({40,5})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
@@ -0,0 +1,77 @@
+
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2016 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "litiv/features2d.hpp"
+#include "litiv/test.hpp"
+
+TEST(desc_extractor_registry,regression_names) {
+    const std::vector<std::string> vsNames = lv::getDescExtractorNames();
+    for(const char* sName : {"dasc_rf","dasc_gf","lbsp","lss","sc"})
+        EXPECT_TRUE(std::find(vsNames.begin(),vsNames.end(),sName)!=vsNames.end()) << "missing: " << sName;
+    EXPECT_THROW_LV_QUIET(lv::createDescriptorExtractor("not_an_extractor"));
+}
+
+TEST(desc_extractor_registry,regression_instr_set) {
+    EXPECT_LE(lv::getBuildCPUInstrSet(),lv::getHostCPUInstrSet());
+    EXPECT_EQ(lv::getHostCPUInstrSet(),lv::getHostCPUInstrSet());
+    EXPECT_STRNE(lv::getCPUInstrSetName(lv::getBuildCPUInstrSet()),"");
+}
+
+TEST(desc_extractor_registry,regression_compute) {
+    const cv::Mat oInput = cv::imread(SAMPLES_DATA_ROOT "/108073.jpg");
+    ASSERT_TRUE(!oInput.empty());
+    std::unique_ptr<lv::IDescExtractor> pExtractor = lv::createDescriptorExtractor("dasc_rf",{{"sigma_s",DASC_DEFAULT_RF_SIGMAS},{"sigma_r",DASC_DEFAULT_RF_SIGMAR}});
+    ASSERT_TRUE(pExtractor!=nullptr);
+    EXPECT_EQ(pExtractor->getName(),std::string("dasc_rf"));
+    EXPECT_GE(pExtractor->getThreadCount(),size_t(1));
+    EXPECT_EQ(pExtractor->describeImplementation().find("dasc_rf"),size_t(0));
+    cv::Mat oDescMap1,oDescMap2;
+    pExtractor->compute2(oInput,oDescMap1);
+    DASC(DASC_DEFAULT_RF_SIGMAS,DASC_DEFAULT_RF_SIGMAR).compute2(oInput,oDescMap2);
+    ASSERT_EQ(lv::MatInfo(oDescMap1),pExtractor->getOutputInfo(lv::MatInfo(oInput)));
+    ASSERT_TRUE(lv::isEqual<float>(oDescMap1,oDescMap2));
+}
+
+TEST(desc_extractor_registry,regression_dispatched_kernels) {
+    lv::CPUInstrSet eHDistInstrSet,eL2InstrSet;
+    const lv::HDist16uiKernel pHDistKernel = lv::getHDist16uiKernel(&eHDistInstrSet);
+    const lv::L2SqrDist32fKernel pL2SqrDistKernel = lv::getL2SqrDist32fKernel(&eL2InstrSet);
+    ASSERT_TRUE(pHDistKernel!=nullptr && pL2SqrDistKernel!=nullptr);
+    EXPECT_LE(eHDistInstrSet,lv::getHostCPUInstrSet());
+    EXPECT_LE(eL2InstrSet,lv::getHostCPUInstrSet());
+    EXPECT_EQ(lv::getHDist16uiKernel(),pHDistKernel);
+    srand(0);
+    for(size_t nCount : {size_t(1),size_t(7),size_t(16),size_t(31),size_t(32),size_t(127)}) {
+        std::vector<uint16_t> vnBuffer1(nCount),vnBuffer2(nCount);
+        std::vector<float> vfBuffer1(nCount),vfBuffer2(nCount);
+        for(size_t nIdx=0; nIdx<nCount; ++nIdx) {
+            vnBuffer1[nIdx] = uint16_t(rand()%65536);
+            vnBuffer2[nIdx] = uint16_t(rand()%65536);
+            vfBuffer1[nIdx] = float(rand()%1000)/100.0f;
+            vfBuffer2[nIdx] = float(rand()%1000)/100.0f;
+        }
+        std::vector<uint8_t> vnOutput(nCount),vnOutputRef(nCount);
+        pHDistKernel(vnBuffer1.data(),vnBuffer2.data(),vnOutput.data(),nCount);
+        lv::hdist_16ui(vnBuffer1.data(),vnBuffer2.data(),vnOutputRef.data(),nCount);
+        EXPECT_EQ(vnOutput,vnOutputRef) << "nCount = " << nCount;
+        const float fL2SqrDistRef = lv::L2sqrdist_32f(vfBuffer1.data(),vfBuffer2.data(),nCount);
+        EXPECT_NEAR(pL2SqrDistKernel(vfBuffer1.data(),vfBuffer2.data(),nCount),fL2SqrDistRef,fL2SqrDistRef*1e-5f) << "nCount = " << nCount;
+    }
+    std::unique_ptr<lv::IDescExtractor> pExtractor = lv::createDescriptorExtractor("lbsp");
+    EXPECT_EQ(pExtractor->getInstrSet(),eHDistInstrSet);
+    EXPECT_NE(pExtractor->describeImplementation().find(lv::getCPUInstrSetName(eHDistInstrSet)),std::string::npos);
+}
@@ -87,6 +87,68 @@ TEST(sc,regression_full_compute_abs_nogpu) {
     ASSERT_EQ(oOutputDescs.cols,oOutputDescMap.size[2]);
 }
 
+TEST(sc,regression_batch_compute_abs_nogpu) {
+    std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(2),size_t(40),12,5);
+#if HAVE_CUDA
+    pShapeContext->enableCUDA(false);
+#endif //HAVE_CUDA
+    std::vector<cv::Mat> vInputs;
+    for(int nImageIdx=0; nImageIdx<4; ++nImageIdx) {
+        cv::Mat oInput(257+nImageIdx*16,257,CV_8UC1);
+        oInput = 0;
+        cv::circle(oInput,cv::Point(128,128+nImageIdx*8),7+nImageIdx,cv::Scalar_<uchar>(255),-1);
+        cv::rectangle(oInput,cv::Point(180,180),cv::Point(190+nImageIdx*4,190),cv::Scalar_<uchar>(255),-1);
+        vInputs.push_back(oInput>0);
+    }
+    std::vector<cv::Mat_<float>> vOutputDescMaps;
+    pShapeContext->compute2(vInputs,vOutputDescMaps);
+    ASSERT_EQ(vOutputDescMaps.size(),vInputs.size());
+    for(size_t nImageIdx=0; nImageIdx<vInputs.size(); ++nImageIdx) {
+        cv::Mat_<float> oOutputDescMap;
+        pShapeContext->compute2(vInputs[nImageIdx],oOutputDescMap);
+        ASSERT_EQ(lv::MatInfo(oOutputDescMap),lv::MatInfo(vOutputDescMaps[nImageIdx]));
+        ASSERT_TRUE(lv::isEqual<float>(oOutputDescMap,vOutputDescMaps[nImageIdx]));
+    }
+}
+
+TEST(sc,regression_transposed_sizes) {
+    // dense key point lists are cached per thread; same-area images with different sizes must not reuse them
+    std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(2),size_t(20),12,5);
+    const std::vector<cv::Size> voSizes = {cv::Size(60,40),cv::Size(40,60),cv::Size(60,40)};
+    std::vector<cv::Mat> vInputs;
+    std::vector<cv::Mat_<float>> vOutputDescMaps(voSizes.size());
+    for(size_t nImageIdx=0; nImageIdx<voSizes.size(); ++nImageIdx) {
+        const cv::Size& oSize = voSizes[nImageIdx];
+        cv::Mat oInput(oSize,CV_8UC1,cv::Scalar_<uchar>(0));
+        cv::circle(oInput,cv::Point(oSize.width/3,oSize.height/2),6,cv::Scalar_<uchar>(255),-1);
+        cv::rectangle(oInput,cv::Point(oSize.width/2,oSize.height/4),cv::Point(oSize.width/2+8,oSize.height/4+5),cv::Scalar_<uchar>(255),-1);
+        vInputs.push_back(oInput);
+        // dense maps are all computed back-to-back first, so that nothing resets the cached key points in between
+        pShapeContext->compute2(oInput,vOutputDescMaps[nImageIdx]);
+    }
+    for(size_t nImageIdx=0; nImageIdx<voSizes.size(); ++nImageIdx) {
+        const cv::Size& oSize = voSizes[nImageIdx];
+        const cv::Mat_<float>& oOutputDescMap = vOutputDescMaps[nImageIdx];
+        ASSERT_EQ(oOutputDescMap.dims,3);
+        ASSERT_EQ(oOutputDescMap.size[0],oSize.height);
+        ASSERT_EQ(oOutputDescMap.size[1],oSize.width);
+        std::vector<cv::KeyPoint> vTargetPts;
+        for(int nRowIdx=0; nRowIdx<oSize.height; ++nRowIdx)
+            for(int nColIdx=0; nColIdx<oSize.width; ++nColIdx)
+                vTargetPts.emplace_back(cv::Point2f(float(nColIdx),float(nRowIdx)),1.0f);
+        cv::Mat_<float> oOutputDescs;
+        pShapeContext->compute2(vInputs[nImageIdx],vTargetPts,oOutputDescs);
+        ASSERT_EQ(oOutputDescs.rows,oSize.area());
+        const int nDescSize = oOutputDescMap.size[2];
+        for(int i=0; i<(int)vTargetPts.size(); ++i) {
+            const float* aDesc1 = oOutputDescs.ptr<float>(i);
+            const float* aDesc2 = oOutputDescMap.ptr<float>(int(vTargetPts[i].pt.y),int(vTargetPts[i].pt.x));
+            for(int j=0; j<nDescSize; ++j)
+                ASSERT_FLOAT_EQ(aDesc1[j],aDesc2[j]) << "size=" << oSize << ", i=" << i << ", j=" << j;
+        }
+    }
+}
+
 TEST(sc,regression_full_compute_abs) {
     std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(2),size_t(40),12,5);
     cv::Mat oInput(257,257,CV_8UC1);
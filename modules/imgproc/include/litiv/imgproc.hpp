@@ -35,11 +35,13 @@ namespace lv {
         ThinningMode_LamLeeSuen
     };
 
+    /// possible distance types for lv::computeImageAffinity and lv::computeDescriptorAffinity
     enum AffinityDistType {
         AffinityDist_L2=0,
-        AffinityDist_EMD,
+        AffinityDist_EMD, ///< exact EMD via cv::EMD using the given ground-distance cost map (slow, fails on null descriptors)
         AffinityDist_MI,
-        AffinityDist_SSD
+        AffinityDist_SSD,
+        AffinityDist_EMDTree ///< closed-form EMD over the minimum spanning tree of the given cost map (upper bound of exact EMD, handles null descriptors)
     };
 
     /// 'thins' the provided image (currently only works on 1ch 8UC1 images, treated as binary)
@@ -72,6 +74,10 @@ namespace lv {
                                    cv::Mat_<float>& oAffinityMap, const std::vector<int>& vDispRange, AffinityDistType eDist,
                                    const cv::Mat_<uchar>& oROI1=cv::Mat(), const cv::Mat_<uchar>& oROI2=cv::Mat(),
                                    const cv::Mat_<float>& oEMDCostMap=cv::Mat(), bool bAllowCUDA=true);
+
+    /// computes a 3d disparity-major (i.e. offsets x rows x cols) raw L2 affinity map from two 2d descriptor maps, without patch aggregation (OOB/masked pairs set to -1)
+    void computeDescriptorRawAffinity(const cv::Mat_<float>& oDescMap1, const cv::Mat_<float>& oDescMap2, cv::Mat_<float>& oRawAffinityMap,
+                                      const std::vector<int>& vDispRange, const cv::Mat_<uchar>& oROI1=cv::Mat(), const cv::Mat_<uchar>& oROI2=cv::Mat());
 #if HAVE_CUDA
     /// computes a 3d affinity map from two 2d descriptor maps by matching them in patches across a given stereo disparity range
     /// note: expects descriptor maps to have 2d size (nxm)xd, where nxm is the map size, and d is the desc length
@@ -80,7 +86,7 @@ namespace lv {
                                    const cv::cuda::GpuMat& oROI1=cv::cuda::GpuMat(), const cv::cuda::GpuMat& oROI2=cv::cuda::GpuMat());
 #endif //HAVE_CUDA
 
-    /// computes a 2d integral image; will redirect to opencv implementation unless NEON is available
+    /// computes a 2d integral image (8U input, 32S/32F output, 1 to 4 channels; redirects to opencv implementation otherwise)
     void integral(const cv::Mat& oInput, cv::Mat& oIntegralImg, int nOutDepth=-1);
     /// computes a 2d integral image with an optional mask argument (invalid pixels are considered zero-valued)
     void integral(const cv::Mat& oInput, cv::Mat& oIntegralImg, const cv::Mat_<uchar>& oMask, int nOutDepth=-1);
@@ -115,6 +121,9 @@ namespace lv {
     /// learns the ideal foreground and background GMM parameters to fit the components assigned to the pixels of the input image
     template<size_t nC1, size_t nC2, size_t nD>
     void learnGaussianMixtureParams(const cv::Mat& oInput, const cv::Mat& oMask, const cv::Mat& oAssignMap, lv::GMM<nC1,nD>& oBGModel, lv::GMM<nC2,nD>& oFGModel, const cv::Mat& oROI=cv::Mat());
+    /// updates the foreground and background GMM parameters learned from the previous mask/assignment maps by only revisiting pixels whose label or component changed (ROI must stay identical)
+    template<size_t nC1, size_t nC2, size_t nD>
+    void updateGaussianMixtureParams(const cv::Mat& oInput, const cv::Mat& oMask, const cv::Mat& oAssignMap, const cv::Mat& oPrevMask, const cv::Mat& oPrevAssignMap, lv::GMM<nC1,nD>& oBGModel, lv::GMM<nC2,nD>& oFGModel, const cv::Mat& oROI=cv::Mat());
 
 } // namespace lv
 
@@ -265,15 +274,30 @@ void lv::assignGaussianMixtureComponents(const cv::Mat& oInput, const cv::Mat& o
     oAssignMap.create(oInput.dims,oInput.size,CV_32SC1);
     lvAssert_(oAssignMap.isContinuous(),"need continuous mats (raw indexing in impl)");
     lvAssert_(oROI.empty() || (oROI.size==oInput.size && oROI.isContinuous() && oROI.type()==CV_8UC1),"bad ROI size/type");
-    std::array<double,nD> aSample;
+    constexpr size_t nChunkSize = 4096;
     const size_t nTotSamples = oInput.total();
+    const size_t nChunks = (nTotSamples+nChunkSize-1)/nChunkSize;
     const uchar* pROI = oROI.empty()?nullptr:oROI.data;
-    for(size_t nSampleIdx=0; nSampleIdx<nTotSamples; ++nSampleIdx) {
-        if(!pROI || pROI[nSampleIdx]) {
-            const uchar* pPixelData = oInput.data+nSampleIdx*nD;
-            lv::unroll<nD>([&](size_t nDimIdx){aSample[nDimIdx] = double(pPixelData[nDimIdx]);});
-            ((int*)oAssignMap.data)[nSampleIdx] = int(oMask.data[nSampleIdx]?oFGModel.getBestComponent(aSample):oBGModel.getBestComponent(aSample));
+    int* pAssignMap = (int*)oAssignMap.data;
+#if USING_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif //USING_OPENMP
+    for(int nChunkIdx=0; nChunkIdx<int(nChunks); ++nChunkIdx) {
+        // pixels are first split by model, and each model then evaluates all its components over whole sample blocks
+        std::array<uint32_t,nChunkSize> anBGSampleIdxs,anFGSampleIdxs;
+        size_t nBGSamples=0,nFGSamples=0;
+        const size_t nChunkStartIdx = size_t(nChunkIdx)*nChunkSize;
+        const size_t nChunkEndIdx = std::min(nChunkStartIdx+nChunkSize,nTotSamples);
+        for(size_t nSampleIdx=nChunkStartIdx; nSampleIdx<nChunkEndIdx; ++nSampleIdx) {
+            if(!pROI || pROI[nSampleIdx]) {
+                if(oMask.data[nSampleIdx])
+                    anFGSampleIdxs[nFGSamples++] = uint32_t(nSampleIdx);
+                else
+                    anBGSampleIdxs[nBGSamples++] = uint32_t(nSampleIdx);
+            }
         }
+        oBGModel.getBestComponents(oInput.data,anBGSampleIdxs.data(),nBGSamples,pAssignMap);
+        oFGModel.getBestComponents(oInput.data,anFGSampleIdxs.data(),nFGSamples,pAssignMap);
     }
 }
 
@@ -286,25 +310,112 @@ void lv::learnGaussianMixtureParams(const cv::Mat& oInput, const cv::Mat& oMask,
     lvAssert_(oMask.type()==CV_8UC1,"input mask type must be 8UC1 (where all values >0 are considered foreground)");
     lvAssert_(oAssignMap.type()==CV_32SC1,"input component assignment map must be 32SC1 (see 'assignGaussianMixtureComponents')");
     lvAssert_(oROI.empty() || (oROI.size==oInput.size && oROI.isContinuous() && oROI.type()==CV_8UC1),"bad ROI size/type");
+    constexpr size_t nChunkSize = 4096;
+    const size_t nTotSamples = oInput.total();
+    const size_t nChunks = (nTotSamples+nChunkSize-1)/nChunkSize;
+    const uchar* pROI = oROI.empty()?nullptr:oROI.data;
+    const int* pAssignMap = (const int*)oAssignMap.data;
+    // per-chunk stats are merged in chunk order; 8U sample sums/products are integers, so results stay exact
+    static thread_local std::vector<typename lv::GMM<nC1,nD>::SampleStats> s_voBGStats;
+    static thread_local std::vector<typename lv::GMM<nC2,nD>::SampleStats> s_voFGStats;
+    s_voBGStats.resize(nChunks);
+    s_voFGStats.resize(nChunks);
+    auto& voBGStats = s_voBGStats; // thread_local vars must be shared with workers via reference
+    auto& voFGStats = s_voFGStats;
+#if USING_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif //USING_OPENMP
+    for(int nChunkIdx=0; nChunkIdx<int(nChunks); ++nChunkIdx) {
+        auto& oBGStats = voBGStats[nChunkIdx];
+        auto& oFGStats = voFGStats[nChunkIdx];
+        oBGStats.reset();
+        oFGStats.reset();
+        const size_t nChunkStartIdx = size_t(nChunkIdx)*nChunkSize;
+        const size_t nChunkEndIdx = std::min(nChunkStartIdx+nChunkSize,nTotSamples);
+        for(size_t nSampleIdx=nChunkStartIdx; nSampleIdx<nChunkEndIdx; ++nSampleIdx) {
+            if(!pROI || pROI[nSampleIdx]) {
+                const int nCompLabel = pAssignMap[nSampleIdx];
+                const bool bForeground = (oMask.data[nSampleIdx])!=0;
+                if(nCompLabel>=0 && nCompLabel<int(bForeground?nC2:nC1)) {
+                    const uchar* pPixelData = oInput.data+nSampleIdx*nD;
+                    if(bForeground)
+                        oFGStats.add(size_t(nCompLabel),pPixelData);
+                    else
+                        oBGStats.add(size_t(nCompLabel),pPixelData);
+                }
+            }
+        }
+    }
     oBGModel.initLearning();
     oFGModel.initLearning();
-    std::array<double,nD> aSample;
+    for(size_t nChunkIdx=0; nChunkIdx<nChunks; ++nChunkIdx) {
+        oBGModel.addSampleStats(voBGStats[nChunkIdx]);
+        oFGModel.addSampleStats(voFGStats[nChunkIdx]);
+    }
+    oBGModel.endLearning();
+    oFGModel.endLearning();
+}
+
+template<size_t nC1, size_t nC2, size_t nD>
+void lv::updateGaussianMixtureParams(const cv::Mat& oInput, const cv::Mat& oMask, const cv::Mat& oAssignMap, const cv::Mat& oPrevMask, const cv::Mat& oPrevAssignMap, lv::GMM<nC1,nD>& oBGModel, lv::GMM<nC2,nD>& oFGModel, const cv::Mat& oROI) {
+    lvAssert_(!oInput.empty() && !oMask.empty() && !oAssignMap.empty() && oInput.size==oMask.size && oInput.size==oAssignMap.size,"bad input image/mask/assignmap size");
+    lvAssert_(oPrevMask.size==oMask.size && oPrevAssignMap.size==oAssignMap.size,"bad previous mask/assignmap size");
+    lvAssert_(oInput.isContinuous() && oMask.isContinuous() && oAssignMap.isContinuous() && oPrevMask.isContinuous() && oPrevAssignMap.isContinuous(),"need continuous mats (raw indexing in impl)");
+    lvAssert_(oInput.depth()==CV_8U,"input image type should be 8U (only supported for now)");
+    lvAssert_(oInput.channels()==int(nD),"input image channel count must match gmm sample dims");
+    lvAssert_(oMask.type()==CV_8UC1 && oPrevMask.type()==CV_8UC1,"input mask types must be 8UC1 (where all values >0 are considered foreground)");
+    lvAssert_(oAssignMap.type()==CV_32SC1 && oPrevAssignMap.type()==CV_32SC1,"input component assignment maps must be 32SC1 (see 'assignGaussianMixtureComponents')");
+    lvAssert_(oROI.empty() || (oROI.size==oInput.size && oROI.isContinuous() && oROI.type()==CV_8UC1),"bad ROI size/type");
+    constexpr size_t nChunkSize = 4096;
     const size_t nTotSamples = oInput.total();
+    const size_t nChunks = (nTotSamples+nChunkSize-1)/nChunkSize;
     const uchar* pROI = oROI.empty()?nullptr:oROI.data;
-    for(size_t nSampleIdx=0; nSampleIdx<nTotSamples; ++nSampleIdx) {
-        if(!pROI || pROI[nSampleIdx]) {
-            const int nCompLabel = ((const int*)oAssignMap.data)[nSampleIdx];
-            const bool bForeground = (oMask.data[nSampleIdx])!=0;
-            if(nCompLabel>=0 && nCompLabel<int(bForeground?nC2:nC1)) {
+    const int* pAssignMap = (const int*)oAssignMap.data;
+    const int* pPrevAssignMap = (const int*)oPrevAssignMap.data;
+    static thread_local std::vector<typename lv::GMM<nC1,nD>::SampleStats> s_voBGStats;
+    static thread_local std::vector<typename lv::GMM<nC2,nD>::SampleStats> s_voFGStats;
+    s_voBGStats.resize(nChunks);
+    s_voFGStats.resize(nChunks);
+    auto& voBGStats = s_voBGStats; // thread_local vars must be shared with workers via reference
+    auto& voFGStats = s_voFGStats;
+#if USING_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif //USING_OPENMP
+    for(int nChunkIdx=0; nChunkIdx<int(nChunks); ++nChunkIdx) {
+        auto& oBGStats = voBGStats[nChunkIdx];
+        auto& oFGStats = voFGStats[nChunkIdx];
+        oBGStats.reset();
+        oFGStats.reset();
+        const size_t nChunkStartIdx = size_t(nChunkIdx)*nChunkSize;
+        const size_t nChunkEndIdx = std::min(nChunkStartIdx+nChunkSize,nTotSamples);
+        for(size_t nSampleIdx=nChunkStartIdx; nSampleIdx<nChunkEndIdx; ++nSampleIdx) {
+            if(!pROI || pROI[nSampleIdx]) {
+                const int nCompLabel = pAssignMap[nSampleIdx], nPrevCompLabel = pPrevAssignMap[nSampleIdx];
+                const bool bForeground = (oMask.data[nSampleIdx])!=0, bPrevForeground = (oPrevMask.data[nSampleIdx])!=0;
+                if(nCompLabel==nPrevCompLabel && bForeground==bPrevForeground)
+                    continue;
                 const uchar* pPixelData = oInput.data+nSampleIdx*nD;
-                lv::unroll<nD>([&](size_t nDimIdx){aSample[nDimIdx] = double(pPixelData[nDimIdx]);});
-                if(bForeground)
-                    oFGModel.addSample(size_t(nCompLabel),aSample);
-                else
-                    oBGModel.addSample(size_t(nCompLabel),aSample);
+                if(nPrevCompLabel>=0 && nPrevCompLabel<int(bPrevForeground?nC2:nC1)) {
+                    if(bPrevForeground)
+                        oFGStats.remove(size_t(nPrevCompLabel),pPixelData);
+                    else
+                        oBGStats.remove(size_t(nPrevCompLabel),pPixelData);
+                }
+                if(nCompLabel>=0 && nCompLabel<int(bForeground?nC2:nC1)) {
+                    if(bForeground)
+                        oFGStats.add(size_t(nCompLabel),pPixelData);
+                    else
+                        oBGStats.add(size_t(nCompLabel),pPixelData);
+                }
             }
         }
     }
+    oBGModel.initLearning(false);
+    oFGModel.initLearning(false);
+    for(size_t nChunkIdx=0; nChunkIdx<nChunks; ++nChunkIdx) {
+        oBGModel.addSampleStats(voBGStats[nChunkIdx]);
+        oFGModel.addSampleStats(voFGStats[nChunkIdx]);
+    }
     oBGModel.endLearning();
     oFGModel.endLearning();
 }
\ No newline at end of file
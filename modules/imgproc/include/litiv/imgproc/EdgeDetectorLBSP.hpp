@@ -60,6 +60,8 @@ protected:
     lv::aligned_vector<uchar,32> m_vuLBSPGradMapData;
     /// pre-allocated image edge reconstruction map
     lv::aligned_vector<uchar,32> m_vuEdgeTempMaskData;
+    /// pre-allocated image edge candidate level map (used for single-pass multi-threshold detection)
+    lv::aligned_vector<uchar,32> m_vuEdgeLevelMapData;
     /// multi-level image map size lookup list
     std::vector<cv::Size> m_voMapSizeList;
     /// hysteresis recursive search stack
@@ -69,8 +71,16 @@ protected:
     template<size_t nChannels>
     void apply_internal_lookup(const cv::Mat& oInputImg);
     void apply_internal_lookup(const cv::Mat& oInputImg, size_t nChannels);
+    /// internal gradient map reconstruction function (from LUT maps) w/ explicit definitions for 1 to 4 channels
+    template<size_t nChannels>
+    void apply_internal_gradient(const cv::Mat& oInputImg);
+    void apply_internal_gradient(const cv::Mat& oInputImg, size_t nChannels);
     /// internal thresholding function w/ explicit definitions for 1 to 4 channels
     template<size_t nChannels>
     void apply_internal_threshold(const cv::Mat& oInputImg, cv::Mat& oEdgeMask, uchar nDetThreshold);
     void apply_internal_threshold(const cv::Mat& oInputImg, cv::Mat& oEdgeMask, uchar nDetThreshold, size_t nChannels);
+    /// internal confidence map function (all thresholds resolved in a single hysteresis pass) w/ explicit definitions for 1 to 4 channels
+    template<size_t nChannels>
+    void apply_internal_multithreshold(const cv::Mat& oInputImg, cv::Mat& oEdgeMask);
+    void apply_internal_multithreshold(const cv::Mat& oInputImg, cv::Mat& oEdgeMask, size_t nChannels);
 };
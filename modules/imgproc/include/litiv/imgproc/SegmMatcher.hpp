@@ -75,13 +75,68 @@ struct SegmMatcher : ICosegmentor<int32_t,4> { // camera count could be template
         OutputPackOffset_Mask=1,
     };
 
+    /// image affinity map computation approaches that can be selected at runtime
+    enum ImgAffinityType {
+        ImgAffinity_DASCGF, ///< L2 distances between dense adaptive self-correlation descriptors (guided filtering)
+        ImgAffinity_DASCRF, ///< L2 distances between dense adaptive self-correlation descriptors (recursive filtering)
+        ImgAffinity_LSS, ///< L2 distances between local self-similarity descriptors
+        ImgAffinity_MI, ///< windowed mutual information
+        ImgAffinity_SSQDiff, ///< windowed sum of squared differences
+    };
+
+    /// graph inference (energy minimization) approaches that can be selected at runtime
+    enum InferenceType {
+        Inference_FGBZ, ///< fusion moves w/ higher-order reduction + QPBO; see Fix et al., "A Graph Cut Algorithm for Higher-order Markov Random Fields" (ICCV2011)
+        Inference_SOSPD, ///< sum-of-submodular primal-dual moves; see Fix et al., "A Primal-Dual Algorithm for Higher-Order Multilabel Markov Random Fields" (CVPR2014)
+    };
+
+    /// runtime pipeline configuration; epipolar/temporal connectivity and the FastPD stereo inference backend are NOT covered here, and remain build-time defines (they fix clique orders & static array sizes)
+    struct Params {
+        /// default constructor; initializes all parameters to the build defaults (i.e. the SEGMMATCH_CONFIG_* defines of the impl)
+        Params();
+        ImgAffinityType eImgAffinity; ///< image affinity map computation approach
+        InferenceType eStereoInference; ///< stereo graph inference approach (ignored if the impl was built with FastPD)
+        InferenceType eResegmInference; ///< resegmentation graph inference approach
+        bool bUseRootSIFTDescs; ///< defines whether descriptors are root-SIFT-normalized before computing affinities
+        bool bUseShapeEMDAffinity; ///< defines whether shape affinity uses EMD instead of L2 distances
+        bool bUseApproxShapeEMD; ///< defines whether shape EMD affinity uses the spanning-tree approximation instead of exact EMD (only used with EMD affinity)
+        bool bUseSalientMapBorder; ///< defines whether image saliency is attenuated outside the descriptor ROIs
+        bool bUseLastStereoInit; ///< defines whether the last stereo labeling is warped via optical flow to initialize the next one
+        bool bUseCoarseMoveRestriction; ///< defines whether stereo moves are restricted per node to candidate labels found via a coarse-grid solution (speed only; unaries stay dense, so memory use is unchanged)
+        bool bUseTemporalWarmStart; ///< defines whether resegm labelings & stereo label ordering are warm-started from the last frame
+        bool bUseIncrementalUpdates; ///< defines whether frame-invariant graph factors are only refreshed where the features they read changed since the last frame
+        size_t nMaxStereoMoveCount; ///< max stereo move-making iteration count per frame
+        size_t nMaxResegmMoveCount; ///< max resegm move-making iteration count per resegm pass
+    };
+
+    /// per-frame inference telemetry, filled by 'apply' (all timings are in seconds; value-initialized = all zeros)
+    struct FrameTelemetry {
+        size_t nFrameIdx; ///< index of the frame in the current temporal sequence (resets with the temporal model)
+        double dFeaturesTime; ///< time spent computing (or swapping in precomputed) features for the new frame
+        double dStereoUpdateTime; ///< time spent updating the stereo graph model & resetting its labelings (incl. post-resegm refreshes)
+        double dResegmUpdateTime; ///< time spent updating the resegm graph model & its shape features
+        double dStereoInfTime; ///< time spent setting up & solving stereo moves
+        double dResegmInfTime; ///< time spent setting up & solving resegm moves
+        double dTotalTime; ///< total time spent in 'apply'
+        size_t nStereoMoveCount; ///< number of stereo moves performed
+        size_t nResegmMoveCount; ///< number of resegm moves performed (over all passes)
+        size_t nResegmPassCount; ///< number of resegm passes interleaved with stereo moves
+        size_t nChangedStereoLabels; ///< number of stereo node labels flipped over all moves
+        size_t nChangedResegmLabels; ///< number of resegm node labels flipped over all moves (excluding the first move of each pass)
+        size_t nUnlabeledNodeCount; ///< number of nodes left unlabeled by QPBO over all moves (fgbz inference only)
+        size_t nSkippedMoveCount; ///< number of moves skipped since no label could be flipped (sospd inference only)
+        size_t nModelBytes; ///< approximate byte count allocated for graph functions, node maps, cost/labeling maps & features
+        std::vector<ValueType> vStereoEnergies; ///< stereo graph energy after each stereo move
+        std::vector<ValueType> vResegmEnergies; ///< resegm graph energy after each resegm move
+    };
+
     // interface forward declarations for pimpl helpers
     struct GraphModelData;
     struct StereoGraphInference;
     struct ResegmGraphInference;
 
     /// full stereo graph matcher constructor; only takes parameters to ready graphical model base initialization
-    SegmMatcher(size_t nMinDispOffset, size_t nMaxDispOffset);
+    SegmMatcher(size_t nMinDispOffset, size_t nMaxDispOffset, const Params& oParams=Params());
     /// default (empty) destructor (required explicitly here due to pimpl idiom and unique_ptr usage)
     ~SegmMatcher();
     /// stereo graph matcher initialization function; will allocate & initialize graph model using provided ROI data (one ROI per camera head)
@@ -94,8 +149,18 @@ struct SegmMatcher : ICosegmentor<int32_t,4> { // camera count could be template
     virtual void calcFeatures(const MatArrayIn& aInputs, cv::Mat* pFeaturesPacket=nullptr);
     /// sets a previously precalculated initial features packet to be used in the next 'apply' call (do not modify its data before that!)
     virtual void setNextFeatures(const cv::Mat& oPackedFeatures);
+    /// queues inputs for pipelined processing; their features are computed in the background while 'applyQueued' runs inference on older frames (blocks while 'nMaxQueueSize' frames are pending)
+    virtual void queueInputs(const MatArrayIn& aInputs, size_t nMaxQueueSize=2);
+    /// stereo matcher function for pipelined processing; runs 'apply' on the oldest queued inputs once their features are ready (returns false if the queue is empty)
+    virtual bool applyQueued(MatArrayOut& aOutputs);
     /// reinitializes internal model by resetting the internal frame counter, essentially breaking future temporal links until enough new frames have been processed
     virtual void resetTemporalModel();
+    /// returns the runtime pipeline configuration used by this matcher
+    const Params& getParams() const {return m_oParams;}
+    /// returns the inference telemetry of the last processed frame (the model must be initialized first)
+    const FrameTelemetry& getLastFrameTelemetry() const;
+    /// sets the path of a CSV file to which the telemetry of each processed frame will be appended (truncated & headed here; empty = disabled)
+    void setTelemetryOutputPath(const std::string& sFilePath);
     /// returns the (friendly) name of the input image feature extractor that will be used internally
     virtual std::string getFeatureExtractorName() const;
     /// returns the (maximum) number of stereo disparity labels used in the output masks
@@ -110,6 +175,10 @@ struct SegmMatcher : ICosegmentor<int32_t,4> { // camera count could be template
     cv::Mat getAssocCountsMapDisplay() const;
 
 protected:
+    /// runtime pipeline configuration (will be passed to model constr)
+    Params m_oParams;
+    /// path of the CSV file to which per-frame telemetry is appended (disabled if empty)
+    std::string m_sTelemetryFilePath;
     /// disparity label step size (will be passed to model constr)
     size_t m_nDispStep;
     /// output disparity label set (will be passed to model constr)
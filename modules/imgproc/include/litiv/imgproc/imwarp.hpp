@@ -41,6 +41,9 @@ struct ImageWarper : public cv::Algorithm {
                     int nGridSize=5, WarpModes eMode=RIGID);
     /// computes the warp result for an input image, given the current model paramters, and the warp strength ratio (1=full warp, 0=none)
     void warp(const cv::Mat& oInput, cv::Mat& oOutput, double dRatio=1.0);
+    /// computes the warp result for several input images sharing the same transformation model (see 'warp' for more info)
+    /// note: both 'warp' overloads update the cached remap table, so a single warper must not be used by several threads at once
+    void warp(const std::vector<cv::Mat>& voInputs, std::vector<cv::Mat>& voOutputs, double dRatio=1.0);
     /// required for derived class destruction from this interface
     virtual ~ImageWarper() = default;
     /// returns whether the algo is initialized or not
@@ -48,12 +51,21 @@ struct ImageWarper : public cv::Algorithm {
 protected:
     /// computes the internal transformation used in the warping step
     virtual bool computeTransform();
+    /// bakes the dense (per-pixel) deformation maps from the transformation grid
+    void computeDenseDeltas();
+    /// updates the fixed-point remap table for the given warp strength ratio, if it differs from the cached one
+    void updateRemapTable(double dRatio);
     bool m_bInitialized;
     int m_nGridSize;
     WarpModes m_eWarpMode;
     cv::Size m_oSourceSize,m_oDestSize;
     std::vector<cv::Point2d> m_vSourcePts,m_vDestPts;
     cv::Mat_<double> m_oDeltaX,m_oDeltaY;
+    /// dense deformation maps, bilinearly interpolated from the transformation grid
+    cv::Mat_<float> m_oDenseDeltaX,m_oDenseDeltaY;
+    /// cached fixed-point remap table (integer coords + interpolation coeffs, see cv::convertMaps) and its warp strength ratio
+    cv::Mat m_oRemapCoordMap,m_oRemapCoeffMap;
+    double m_dRemapRatio;
 };
 
 
@@ -160,29 +160,59 @@ void EdgeDetectorLBSP::apply_internal_lookup(const cv::Mat& oInputImg, size_t nC
         CV_Error(-1,"Unexpected channel count");
 }
 
+namespace {
+
+    constexpr size_t s_nNMSWinSize = USE_5x5_NON_MAX_SUPP?LBSP::PATCH_SIZE:3;
+    constexpr size_t s_nNMSHalfWinSize = s_nNMSWinSize>>1;
+    constexpr size_t s_nGradMapColStep = 4; // 4ch (gradx, grady, gradmag, 'dont care')
+    constexpr size_t s_nEdgeMapColStep = 1; // 1ch (label)
+
+    /// returns whether the gradient magnitude at the given (4ch) gradient map location is a local maximum along its orientation
+    inline bool isGradLocalMaximum(const uchar* anGrad, size_t nGradMapRowStep) {
+        constexpr size_t nNMSHalfWinSize = s_nNMSHalfWinSize;
+        constexpr size_t nGradMapColStep = s_nGradMapColStep;
+#if USE_3_AXIS_ORIENT
+        const char nGradX = ((const char*)anGrad)[0];
+        const char nGradY = ((const char*)anGrad)[1];
+        const uint nShift_FPA = 15;
+        constexpr uint nTG22deg_FPA = (int)(0.4142135623730950488016887242097*(1<<nShift_FPA)+0.5); // == tan(pi/8)
+        const uint nGradX_abs = (uint)std::abs(nGradX);
+        const uint nGradY_abs = (uint)std::abs(nGradY)<<nShift_FPA;
+        uint nTG22GradX_FPA = nGradX_abs*nTG22deg_FPA; // == 0.4142135623730950488016887242097*nGradX_abs
+        if(nGradY_abs<nTG22GradX_FPA) // if(nGradX_abs<0.4142135623730950488016887242097*nGradX_abs) == flat gradient (sector 0)
+            return lv::isLocalMaximum_Horizontal<nNMSHalfWinSize>(anGrad+2,nGradMapColStep,nGradMapRowStep);
+        // else(nGradX_abs>=0.4142135623730950488016887242097*nGradX_abs) == not a flat gradient (sectors 1, 2 or 3)
+        uint nTG67GradX_FPA = nTG22GradX_FPA+(nGradX_abs<<(nShift_FPA+1)); // == 2.4142135623730950488016887242097*nGradX_abs == tan(3*pi/8)*nGradX_abs
+        if(nGradY_abs>nTG67GradX_FPA) // if(nGradX_abs>2.4142135623730950488016887242097*nGradX_abs == vertical gradient (sector 2)
+            return lv::isLocalMaximum_Vertical<nNMSHalfWinSize>(anGrad+2,nGradMapColStep,nGradMapRowStep);
+        // else(nGradX_abs<=2.4142135623730950488016887242097*nGradX_abs == diagonal gradient (sector 1 or 3, depending on grad sign diff)
+        if(nGradX || nGradY)
+            return lv::isLocalMaximum_Diagonal<nNMSHalfWinSize>(anGrad+2,nGradMapColStep,nGradMapRowStep,(nGradX^nGradY)>=0);
+        return lv::isLocalMaximum_Diagonal<nNMSHalfWinSize,true>(anGrad+2,nGradMapColStep,nGradMapRowStep) ||
+               lv::isLocalMaximum_Diagonal<nNMSHalfWinSize,false>(anGrad+2,nGradMapColStep,nGradMapRowStep);
+#else //(!USE_3_AXIS_ORIENT)
+        const uint nGradX_abs = (uint)std::abs(((const char*)anGrad)[0]);
+        const uint nGradY_abs = (uint)std::abs(((const char*)anGrad)[1]);
+        return (nGradY_abs<=nGradX_abs && lv::isLocalMaximum_Horizontal<nNMSHalfWinSize>(anGrad+2,nGradMapColStep,nGradMapRowStep)) ||
+               (nGradY_abs>nGradX_abs && lv::isLocalMaximum_Vertical<nNMSHalfWinSize>(anGrad+2,nGradMapColStep,nGradMapRowStep));
+#endif //(!USE_3_AXIS_ORIENT)
+    }
+
+} // anonymous namespace
+
 template<size_t nChannels>
-void EdgeDetectorLBSP::apply_internal_threshold(const cv::Mat& oInputImg, cv::Mat& oEdgeMask, uchar nDetThreshold) {
+void EdgeDetectorLBSP::apply_internal_gradient(const cv::Mat& oInputImg) {
     lvAssert_(!oInputImg.empty() && oInputImg.isContinuous(),"input image must be non-empty and continuous");
-    lvAssert_(!oEdgeMask.empty() && oEdgeMask.isContinuous(),"output mask must be non-empty and continuous");
     const int nOrigType = CV_8UC(int(nChannels));
     const size_t nColLUTStep = LBSP::DESC_SIZE_BITS*nChannels;
-    const uchar nHystHighThreshold = nDetThreshold;
-    const uchar nHystLowThreshold = (uchar)(nDetThreshold*m_dHystLowThrshFactor);
-    constexpr size_t nNMSWinSize = USE_5x5_NON_MAX_SUPP?LBSP::PATCH_SIZE:3;
-    constexpr size_t nNMSHalfWinSize = nNMSWinSize>>1;
+    constexpr size_t nNMSHalfWinSize = s_nNMSHalfWinSize;
     const cv::Size oMapSize(oInputImg.cols+nNMSHalfWinSize*2,oInputImg.rows+nNMSHalfWinSize*2);
-    constexpr size_t nGradMapColStep = 4; // 4ch (gradx, grady, gradmag, 'dont care')
+    constexpr size_t nGradMapColStep = s_nGradMapColStep;
     const size_t nGradMapRowStep = oMapSize.width*nGradMapColStep;
-    constexpr size_t nEdgeMapColStep = 1; // 1ch (label)
-    const size_t nEdgeMapRowStep = oMapSize.width*nEdgeMapColStep;
     m_vuLBSPGradMapData.resize(oMapSize.height*nGradMapRowStep);
-    m_vuEdgeTempMaskData.resize(oMapSize.height*nEdgeMapRowStep);
     cv::Mat oGradMap(oMapSize,CV_8UC4,m_vuLBSPGradMapData.data());
-    cv::Mat oEdgeTempMask(oMapSize,CV_8UC1,m_vuEdgeTempMaskData.data());
     std::fill(m_vuLBSPGradMapData.data(),m_vuLBSPGradMapData.data()+nGradMapRowStep*nNMSHalfWinSize,0);
     std::fill(m_vuLBSPGradMapData.data()+(oMapSize.height-nNMSHalfWinSize)*nGradMapRowStep,m_vuLBSPGradMapData.data()+oMapSize.height*nGradMapRowStep,0);
-    std::fill(m_vuEdgeTempMaskData.data(),m_vuEdgeTempMaskData.data()+nEdgeMapRowStep*nNMSHalfWinSize,1);
-    std::fill(m_vuEdgeTempMaskData.data()+(oMapSize.height-nNMSHalfWinSize)*nEdgeMapRowStep,m_vuEdgeTempMaskData.data()+oMapSize.height*nEdgeMapRowStep,1);
 #if USE_MIN_GRAD_ORIENT
     static_assert(nGradMapColStep==4,"Need 32-bit chunks to copy (see lines with uint32_t)");
     constexpr uint32_t nDefaultGradMapVal4Ch = (CHAR_MAX<<24)|(CHAR_MAX<<16)|(UCHAR_MAX)<<8;
@@ -191,28 +221,6 @@ void EdgeDetectorLBSP::apply_internal_threshold(const cv::Mat& oInputImg, cv::Ma
 #else //(!USE_MIN_GRAD_ORIENT)
     oGradMap(cv::Rect(nNMSHalfWinSize,nNMSHalfWinSize,m_voMapSizeList.back().width,m_voMapSizeList.back().height)) = cv::Scalar_<uchar>(0,0,UCHAR_MAX,0);
 #endif //(!USE_MIN_GRAD_ORIENT)
-    size_t nCurrHystStackSize = std::max(std::max((size_t)1<<10,(size_t)oMapSize.area()/8),m_vuHystStack.size());
-    m_vuHystStack.resize(nCurrHystStackSize);
-    uchar** pauHystStack_top = &m_vuHystStack[0];
-    uchar** pauHystStack_bottom = &m_vuHystStack[0];
-    auto stack_push = [&](uchar* pAddr) {
-        lvDbgAssert(pAddr>=oEdgeTempMask.datastart+nEdgeMapRowStep*nNMSHalfWinSize);
-        lvDbgAssert(pAddr<oEdgeTempMask.dataend-nEdgeMapRowStep*nNMSHalfWinSize);
-        *pAddr = 2, *pauHystStack_top++ = pAddr;
-    };
-    auto stack_pop = [&]() -> uchar* {
-        lvDbgAssert(pauHystStack_top>pauHystStack_bottom);
-        return *--pauHystStack_top;
-    };
-    auto stack_check_size = [&](size_t nPotentialSize) {
-        if(ptrdiff_t(pauHystStack_top-pauHystStack_bottom)+nPotentialSize>nCurrHystStackSize) {
-            const ptrdiff_t nUsedHystStackSize = pauHystStack_top-pauHystStack_bottom;
-            nCurrHystStackSize = std::max(nCurrHystStackSize*2,nUsedHystStackSize+nPotentialSize);
-            m_vuHystStack.resize(nCurrHystStackSize);
-            pauHystStack_bottom = &m_vuHystStack[0];
-            pauHystStack_top = pauHystStack_bottom+nUsedHystStackSize;
-        }
-    };
     for(int nLevelIter = (int)m_nLevels-1; nLevelIter>=0; --nLevelIter) {
         const cv::Size& oCurrScaleSize = m_voMapSizeList[nLevelIter];
         const cv::Mat& oPyrMap = (!nLevelIter)?oInputImg:cv::Mat(oCurrScaleSize,nOrigType,m_vvuInputPyrMaps[nLevelIter-1].data());
@@ -257,74 +265,95 @@ void EdgeDetectorLBSP::apply_internal_threshold(const cv::Mat& oInputImg, cv::Ma
             if(nLevelIter==0) {
                 std::fill(anGradRow-nGradMapColStep*nNMSHalfWinSize,anGradRow,0); // remove if init'd at top
                 std::fill(anGradRow+oInputImg.cols*nGradMapColStep,anGradRow+(oInputImg.cols+nNMSHalfWinSize)*nGradMapColStep,0);
-                if(nRowIter<oCurrScaleSize.height-int(nNMSHalfWinSize)) {
-                    anGradRow += nGradMapRowStep*nNMSHalfWinSize; // offset by nNMSHalfWinSize rows
-                    uchar* anEdgeMapRow = oEdgeTempMask.ptr<uchar>(nRowIter+nNMSHalfWinSize)+nNMSHalfWinSize*nEdgeMapColStep;
-                    std::fill(anEdgeMapRow-nEdgeMapColStep*nNMSHalfWinSize,anEdgeMapRow,1);
-                    std::fill(anEdgeMapRow+oInputImg.cols*nEdgeMapColStep,anEdgeMapRow+(oInputImg.cols+nNMSHalfWinSize)*nEdgeMapColStep,1);
-                    stack_check_size(oInputImg.cols);
-                    bool nNeighbMax = false;
-                    for(size_t nColIter = 0; nColIter<(size_t)oInputImg.cols; ++nColIter) {
-                        // make sure all 'quick-idx' lookups are at the right positions...
-                        lvDbgAssert(anGradRow[nColIter*nGradMapColStep]==oGradMap.at<cv::Vec4b>(int(nRowIter+(nNMSHalfWinSize*2)),int(nColIter+nNMSHalfWinSize))[0]);
-                        lvDbgAssert(anGradRow[nColIter*nGradMapColStep+1]==oGradMap.at<cv::Vec4b>(int(nRowIter+(nNMSHalfWinSize*2)),int(nColIter+nNMSHalfWinSize))[1]);
-                        for(int nNMSWinIter=-(int)nNMSHalfWinSize; nNMSWinIter<=(int)nNMSHalfWinSize; ++nNMSWinIter)
-                            lvDbgAssert(anGradRow[nColIter*nGradMapColStep+nGradMapRowStep*nNMSWinIter+2]==oGradMap.at<cv::Vec4b>(int(nRowIter+nNMSWinIter+(nNMSHalfWinSize*2)),int(nColIter+nNMSHalfWinSize))[2]);
-                        const uchar nGradMag = anGradRow[nColIter*nGradMapColStep+2];
-                        if(nGradMag>=nHystLowThreshold) {
-#if USE_3_AXIS_ORIENT
-                            const char nGradX = ((char*)anGradRow)[nColIter*nGradMapColStep];
-                            const char nGradY = ((char*)anGradRow)[nColIter*nGradMapColStep+1];
-                            const uint nShift_FPA = 15;
-                            constexpr uint nTG22deg_FPA = (int)(0.4142135623730950488016887242097*(1<<nShift_FPA)+0.5); // == tan(pi/8)
-                            const uint nGradX_abs = (uint)std::abs(nGradX);
-                            const uint nGradY_abs = (uint)std::abs(nGradY)<<nShift_FPA;
-                            uint nTG22GradX_FPA = nGradX_abs*nTG22deg_FPA; // == 0.4142135623730950488016887242097*nGradX_abs
-                            if(nGradY_abs<nTG22GradX_FPA) { // if(nGradX_abs<0.4142135623730950488016887242097*nGradX_abs) == flat gradient (sector 0)
-                                if(lv::isLocalMaximum_Horizontal<nNMSHalfWinSize>(anGradRow+nColIter*nGradMapColStep+2,nGradMapColStep,nGradMapRowStep))
-                                    goto _edge_good; // push as 'edge'
-                            }
-                            else { // else(nGradX_abs>=0.4142135623730950488016887242097*nGradX_abs) == not a flat gradient (sectors 1, 2 or 3)
-                                uint nTG67GradX_FPA = nTG22GradX_FPA+(nGradX_abs<<(nShift_FPA+1)); // == 2.4142135623730950488016887242097*nGradX_abs == tan(3*pi/8)*nGradX_abs
-                                if(nGradY_abs>nTG67GradX_FPA) { // if(nGradX_abs>2.4142135623730950488016887242097*nGradX_abs == vertical gradient (sector 2)
-                                    if(lv::isLocalMaximum_Vertical<nNMSHalfWinSize>(anGradRow+nColIter*nGradMapColStep+2,nGradMapColStep,nGradMapRowStep))
-                                        goto _edge_good;
-                                }
-                                else { // else(nGradX_abs<=2.4142135623730950488016887242097*nGradX_abs == diagonal gradient (sector 1 or 3, depending on grad sign diff)
-                                    if(nGradX || nGradY) {
-                                        if(lv::isLocalMaximum_Diagonal<nNMSHalfWinSize>(anGradRow+nColIter*nGradMapColStep+2,nGradMapColStep,nGradMapRowStep,(nGradX^nGradY)>=0))
-                                            goto _edge_good;
-                                    }
-                                    else {
-                                        if(lv::isLocalMaximum_Diagonal<nNMSHalfWinSize,true>(anGradRow+nColIter*nGradMapColStep+2,nGradMapColStep,nGradMapRowStep) ||
-                                           lv::isLocalMaximum_Diagonal<nNMSHalfWinSize,false>(anGradRow+nColIter*nGradMapColStep+2,nGradMapColStep,nGradMapRowStep))
-                                            goto _edge_good;
-                                    }
-                                }
-                            }
-#else //(!USE_3_AXIS_ORIENT)
-                            const uint nGradX_abs = (uint)std::abs(anGradRow[nColIter*nGradMapColStep]);
-                            const uint nGradY_abs = (uint)std::abs(anGradRow[nColIter*nGradMapColStep+1]);
-                            if((nGradY_abs<=nGradX_abs && isLocalMaximum_Horizontal<nNMSHalfWinSize>(anGradRow+nColIter*nGradMapColStep+2,nGradMapColStep,nGradMapRowStep)) ||
-                               (nGradY_abs>nGradX_abs && isLocalMaximum_Vertical<nNMSHalfWinSize>(anGradRow+nColIter*nGradMapColStep+2,nGradMapColStep,nGradMapRowStep)))
-                                goto _edge_good;
-#endif //(!USE_3_AXIS_ORIENT)
-                        }
-                        nNeighbMax = false;
-                        anEdgeMapRow[nColIter*nEdgeMapColStep] = 1; // not an edge
-                        continue;
-                        _edge_good:
-                        // if not neighbor to previously identified edge, and gradmag above max threshold
-                        if(!nNeighbMax && nGradMag>=nHystHighThreshold && anEdgeMapRow[nColIter*nEdgeMapColStep+nEdgeMapRowStep]!=2) {
-                            stack_push(anEdgeMapRow+nColIter);
-                            nNeighbMax = true;
-                            continue;
-                        }
-                        //_edge_maybe:
-                        anEdgeMapRow[nColIter*nEdgeMapColStep] = 0; // might belong to an edge
-                    }
+            }
+        }
+    }
+}
+
+template void EdgeDetectorLBSP::apply_internal_gradient<1>(const cv::Mat&);
+template void EdgeDetectorLBSP::apply_internal_gradient<2>(const cv::Mat&);
+template void EdgeDetectorLBSP::apply_internal_gradient<3>(const cv::Mat&);
+template void EdgeDetectorLBSP::apply_internal_gradient<4>(const cv::Mat&);
+
+void EdgeDetectorLBSP::apply_internal_gradient(const cv::Mat& oInputImg, size_t nChannels) {
+    if(nChannels==1)
+        apply_internal_gradient<1>(oInputImg);
+    else if(nChannels==2)
+        apply_internal_gradient<2>(oInputImg);
+    else if(nChannels==3)
+        apply_internal_gradient<3>(oInputImg);
+    else if(nChannels==4)
+        apply_internal_gradient<4>(oInputImg);
+    else
+        CV_Error(-1,"Unexpected channel count");
+}
+
+template<size_t nChannels>
+void EdgeDetectorLBSP::apply_internal_threshold(const cv::Mat& oInputImg, cv::Mat& oEdgeMask, uchar nDetThreshold) {
+    lvAssert_(!oInputImg.empty() && oInputImg.isContinuous(),"input image must be non-empty and continuous");
+    lvAssert_(!oEdgeMask.empty() && oEdgeMask.isContinuous(),"output mask must be non-empty and continuous");
+    apply_internal_gradient<nChannels>(oInputImg);
+    const uchar nHystHighThreshold = nDetThreshold;
+    const uchar nHystLowThreshold = (uchar)(nDetThreshold*m_dHystLowThrshFactor);
+    constexpr size_t nNMSHalfWinSize = s_nNMSHalfWinSize;
+    const cv::Size oMapSize(oInputImg.cols+nNMSHalfWinSize*2,oInputImg.rows+nNMSHalfWinSize*2);
+    constexpr size_t nGradMapColStep = s_nGradMapColStep;
+    const size_t nGradMapRowStep = oMapSize.width*nGradMapColStep;
+    constexpr size_t nEdgeMapColStep = s_nEdgeMapColStep;
+    const size_t nEdgeMapRowStep = oMapSize.width*nEdgeMapColStep;
+    cv::Mat oGradMap(oMapSize,CV_8UC4,m_vuLBSPGradMapData.data());
+    m_vuEdgeTempMaskData.resize(oMapSize.height*nEdgeMapRowStep);
+    cv::Mat oEdgeTempMask(oMapSize,CV_8UC1,m_vuEdgeTempMaskData.data());
+    std::fill(m_vuEdgeTempMaskData.data(),m_vuEdgeTempMaskData.data()+nEdgeMapRowStep*nNMSHalfWinSize,1);
+    std::fill(m_vuEdgeTempMaskData.data()+(oMapSize.height-nNMSHalfWinSize)*nEdgeMapRowStep,m_vuEdgeTempMaskData.data()+oMapSize.height*nEdgeMapRowStep,1);
+    size_t nCurrHystStackSize = std::max(std::max((size_t)1<<10,(size_t)oMapSize.area()/8),m_vuHystStack.size());
+    m_vuHystStack.resize(nCurrHystStackSize);
+    uchar** pauHystStack_top = &m_vuHystStack[0];
+    uchar** pauHystStack_bottom = &m_vuHystStack[0];
+    auto stack_push = [&](uchar* pAddr) {
+        lvDbgAssert(pAddr>=oEdgeTempMask.datastart+nEdgeMapRowStep*nNMSHalfWinSize);
+        lvDbgAssert(pAddr<oEdgeTempMask.dataend-nEdgeMapRowStep*nNMSHalfWinSize);
+        *pAddr = 2, *pauHystStack_top++ = pAddr;
+    };
+    auto stack_pop = [&]() -> uchar* {
+        lvDbgAssert(pauHystStack_top>pauHystStack_bottom);
+        return *--pauHystStack_top;
+    };
+    auto stack_check_size = [&](size_t nPotentialSize) {
+        if(ptrdiff_t(pauHystStack_top-pauHystStack_bottom)+nPotentialSize>nCurrHystStackSize) {
+            const ptrdiff_t nUsedHystStackSize = pauHystStack_top-pauHystStack_bottom;
+            nCurrHystStackSize = std::max(nCurrHystStackSize*2,nUsedHystStackSize+nPotentialSize);
+            m_vuHystStack.resize(nCurrHystStackSize);
+            pauHystStack_bottom = &m_vuHystStack[0];
+            pauHystStack_top = pauHystStack_bottom+nUsedHystStackSize;
+        }
+    };
+    for(int nRowIter = oInputImg.rows-int(nNMSHalfWinSize)-1; nRowIter>=-(int)nNMSHalfWinSize; --nRowIter) {
+        const uchar* anGradRow = oGradMap.data+(nRowIter+nNMSHalfWinSize*2)*nGradMapRowStep+nGradMapColStep*nNMSHalfWinSize; // offset by nNMSHalfWinSize rows
+        uchar* anEdgeMapRow = oEdgeTempMask.ptr<uchar>(nRowIter+nNMSHalfWinSize)+nNMSHalfWinSize*nEdgeMapColStep;
+        std::fill(anEdgeMapRow-nEdgeMapColStep*nNMSHalfWinSize,anEdgeMapRow,1);
+        std::fill(anEdgeMapRow+oInputImg.cols*nEdgeMapColStep,anEdgeMapRow+(oInputImg.cols+nNMSHalfWinSize)*nEdgeMapColStep,1);
+        stack_check_size(oInputImg.cols);
+        bool nNeighbMax = false;
+        for(size_t nColIter = 0; nColIter<(size_t)oInputImg.cols; ++nColIter) {
+            // make sure all 'quick-idx' lookups are at the right positions...
+            lvDbgAssert(anGradRow[nColIter*nGradMapColStep]==oGradMap.at<cv::Vec4b>(int(nRowIter+(nNMSHalfWinSize*2)),int(nColIter+nNMSHalfWinSize))[0]);
+            lvDbgAssert(anGradRow[nColIter*nGradMapColStep+1]==oGradMap.at<cv::Vec4b>(int(nRowIter+(nNMSHalfWinSize*2)),int(nColIter+nNMSHalfWinSize))[1]);
+            for(int nNMSWinIter=-(int)nNMSHalfWinSize; nNMSWinIter<=(int)nNMSHalfWinSize; ++nNMSWinIter)
+                lvDbgAssert(anGradRow[nColIter*nGradMapColStep+nGradMapRowStep*nNMSWinIter+2]==oGradMap.at<cv::Vec4b>(int(nRowIter+nNMSWinIter+(nNMSHalfWinSize*2)),int(nColIter+nNMSHalfWinSize))[2]);
+            const uchar nGradMag = anGradRow[nColIter*nGradMapColStep+2];
+            if(nGradMag>=nHystLowThreshold && isGradLocalMaximum(anGradRow+nColIter*nGradMapColStep,nGradMapRowStep)) {
+                // if not neighbor to previously identified edge, and gradmag above max threshold
+                if(!nNeighbMax && nGradMag>=nHystHighThreshold && anEdgeMapRow[nColIter*nEdgeMapColStep+nEdgeMapRowStep]!=2) {
+                    stack_push(anEdgeMapRow+nColIter);
+                    nNeighbMax = true;
+                    continue;
                 }
+                anEdgeMapRow[nColIter*nEdgeMapColStep] = 0; // might belong to an edge
+                continue;
             }
+            nNeighbMax = false;
+            anEdgeMapRow[nColIter*nEdgeMapColStep] = 1; // not an edge
         }
     }
     lvDbgAssert(oEdgeTempMask.step.p[0]==nEdgeMapRowStep);
@@ -374,6 +403,121 @@ void EdgeDetectorLBSP::apply_internal_threshold(const cv::Mat& oInputImg, cv::Ma
         CV_Error(-1,"Unexpected channel count");
 }
 
+template<size_t nChannels>
+void EdgeDetectorLBSP::apply_internal_multithreshold(const cv::Mat& oInputImg, cv::Mat& oEdgeMask) {
+    lvAssert_(!oInputImg.empty() && oInputImg.isContinuous(),"input image must be non-empty and continuous");
+    lvAssert_(!oEdgeMask.empty() && oEdgeMask.isContinuous(),"output mask must be non-empty and continuous");
+    apply_internal_gradient<nChannels>(oInputImg);
+    constexpr size_t nThresholdCount = LBSP::MAX_GRAD_MAG;
+    static_assert(nThresholdCount<UCHAR_MAX,"edge level map labels must fit in 8 bits");
+    // for each gradient magnitude, find the highest threshold for which it passes the lower hysteresis bound
+    std::array<uchar,LBSP::MAX_GRAD_MAG+1> anMaxLowThresholdLUT;
+    for(size_t nGradMag=0; nGradMag<=LBSP::MAX_GRAD_MAG; ++nGradMag) {
+        anMaxLowThresholdLUT[nGradMag] = 0;
+        for(size_t nThreshold=0; nThreshold<nThresholdCount; ++nThreshold)
+            if((uchar)(nThreshold*m_dHystLowThrshFactor)<=nGradMag)
+                anMaxLowThresholdLUT[nGradMag] = uchar(nThreshold);
+    }
+    constexpr size_t nNMSHalfWinSize = s_nNMSHalfWinSize;
+    const cv::Size oMapSize(oInputImg.cols+nNMSHalfWinSize*2,oInputImg.rows+nNMSHalfWinSize*2);
+    constexpr size_t nGradMapColStep = s_nGradMapColStep;
+    const size_t nGradMapRowStep = oMapSize.width*nGradMapColStep;
+    constexpr size_t nEdgeMapColStep = s_nEdgeMapColStep;
+    const size_t nEdgeMapRowStep = oMapSize.width*nEdgeMapColStep;
+    const cv::Mat oGradMap(oMapSize,CV_8UC4,m_vuLBSPGradMapData.data());
+    // level map = highest 'low' threshold passed by each NMS-surviving pixel (+1, 0 = not an edge candidate); one guard row on each side
+    m_vuEdgeLevelMapData.resize((oMapSize.height+2)*nEdgeMapRowStep);
+    uchar* const aEdgeLevelMap = m_vuEdgeLevelMapData.data()+nEdgeMapRowStep;
+    std::fill(m_vuEdgeLevelMapData.begin(),m_vuEdgeLevelMapData.begin()+nEdgeMapRowStep,0);
+    std::fill(aEdgeLevelMap+oInputImg.rows*nEdgeMapRowStep,aEdgeLevelMap+(oMapSize.height+1)*nEdgeMapRowStep,0);
+    // edge label map = highest threshold (+1) for which each pixel is part of a hysteresis-connected edge (0 = never an edge)
+    m_vuEdgeTempMaskData.resize(oMapSize.height*nEdgeMapRowStep);
+    uchar* const aEdgeLabelMap = m_vuEdgeTempMaskData.data();
+    std::fill(m_vuEdgeTempMaskData.begin(),m_vuEdgeTempMaskData.end(),0);
+    // classification is independent for each row, as it only reads the gradient map (same row offsets as 'apply_internal_threshold')
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nRowIter=0; nRowIter<oInputImg.rows; ++nRowIter) {
+        const uchar* anGradRow = oGradMap.data+(nRowIter+nNMSHalfWinSize)*nGradMapRowStep+nGradMapColStep*nNMSHalfWinSize;
+        uchar* anEdgeLevelRow = aEdgeLevelMap+nRowIter*nEdgeMapRowStep;
+        std::fill(anEdgeLevelRow,anEdgeLevelRow+nEdgeMapColStep*nNMSHalfWinSize,0);
+        std::fill(anEdgeLevelRow+(oInputImg.cols+nNMSHalfWinSize)*nEdgeMapColStep,anEdgeLevelRow+nEdgeMapRowStep,0);
+        anEdgeLevelRow += nNMSHalfWinSize*nEdgeMapColStep;
+        for(size_t nColIter = 0; nColIter<(size_t)oInputImg.cols; ++nColIter) {
+            const uchar nGradMag = anGradRow[nColIter*nGradMapColStep+2];
+            lvDbgAssert(nGradMag<=LBSP::MAX_GRAD_MAG);
+            anEdgeLevelRow[nColIter*nEdgeMapColStep] = isGradLocalMaximum(anGradRow+nColIter*nGradMapColStep,nGradMapRowStep)?uchar(anMaxLowThresholdLUT[nGradMag]+1):uchar(0);
+        }
+    }
+    // edges are propagated from seeds (whose magnitude passes the upper threshold) in decreasing threshold order; each
+    // pixel thus receives the maximum over all seed paths of the minimum threshold allowed along them (i.e. a widest path)
+    static thread_local std::array<std::vector<size_t>,nThresholdCount> s_avnThresholdBuckets;
+    for(auto& vnBucket : s_avnThresholdBuckets)
+        vnBucket.clear();
+    for(size_t nRowIter=0; nRowIter<(size_t)oInputImg.rows; ++nRowIter) {
+        const uchar* anGradRow = oGradMap.data+(nRowIter+nNMSHalfWinSize)*nGradMapRowStep+nGradMapColStep*nNMSHalfWinSize;
+        const size_t nEdgeRowIdx = nRowIter*nEdgeMapRowStep+nNMSHalfWinSize*nEdgeMapColStep;
+        for(size_t nColIter = 0; nColIter<(size_t)oInputImg.cols; ++nColIter) {
+            const size_t nEdgeIdx = nEdgeRowIdx+nColIter*nEdgeMapColStep;
+            if(aEdgeLevelMap[nEdgeIdx]) {
+                const uchar nSeedThreshold = std::min(uchar(aEdgeLevelMap[nEdgeIdx]-1),std::min(anGradRow[nColIter*nGradMapColStep+2],uchar(nThresholdCount-1)));
+                s_avnThresholdBuckets[nSeedThreshold].push_back(nEdgeIdx);
+            }
+        }
+    }
+    const std::array<ptrdiff_t,8> anNeighbOffsets = {
+        -ptrdiff_t(nEdgeMapColStep),ptrdiff_t(nEdgeMapColStep),
+        -ptrdiff_t(nEdgeMapRowStep+nEdgeMapColStep),-ptrdiff_t(nEdgeMapRowStep),-ptrdiff_t(nEdgeMapRowStep)+ptrdiff_t(nEdgeMapColStep),
+        ptrdiff_t(nEdgeMapRowStep)-ptrdiff_t(nEdgeMapColStep),ptrdiff_t(nEdgeMapRowStep),ptrdiff_t(nEdgeMapRowStep+nEdgeMapColStep),
+    };
+    for(int nThreshold=int(nThresholdCount)-1; nThreshold>=0; --nThreshold) {
+        std::vector<size_t>& vnBucket = s_avnThresholdBuckets[nThreshold];
+        while(!vnBucket.empty()) {
+            const size_t nEdgeIdx = vnBucket.back();
+            vnBucket.pop_back();
+            if(aEdgeLabelMap[nEdgeIdx])
+                continue;
+            aEdgeLabelMap[nEdgeIdx] = uchar(nThreshold+1);
+            for(const ptrdiff_t nOffset : anNeighbOffsets) {
+                // signed offset from the level map base; first/last row neighbors land in the zeroed guard rows
+                const ptrdiff_t nNeighbIdx = ptrdiff_t(nEdgeIdx)+nOffset;
+                lvDbgAssert(nNeighbIdx>=-ptrdiff_t(nEdgeMapRowStep) && nNeighbIdx<ptrdiff_t((oMapSize.height+1)*nEdgeMapRowStep));
+                const uchar nNeighbLevel = aEdgeLevelMap[nNeighbIdx];
+                if(nNeighbLevel && !aEdgeLabelMap[nNeighbIdx]) {
+                    lvDbgAssert(nNeighbIdx>=0);
+                    s_avnThresholdBuckets[std::min(nThreshold,int(nNeighbLevel)-1)].push_back(size_t(nNeighbIdx));
+                }
+            }
+        }
+    }
+    // accumulate as if each of the thresholded edge masks had been added with a 1/MAX_GRAD_MAG weight
+    constexpr uchar nEdgeWeight = uchar(UCHAR_MAX/double(nThresholdCount)+0.5);
+    const uchar* anEdgeLabelData = aEdgeLabelMap+nEdgeMapRowStep*nNMSHalfWinSize+nEdgeMapColStep*nNMSHalfWinSize;
+    uchar* oEdgeMaskData = oEdgeMask.data;
+    for(int nRowIter=0; nRowIter<oInputImg.rows; ++nRowIter, anEdgeLabelData+=nEdgeMapRowStep, oEdgeMaskData+=oEdgeMask.step)
+        for(int nColIter=0; nColIter<oInputImg.cols; ++nColIter)
+            oEdgeMaskData[nColIter] = (uchar)std::min(int(anEdgeLabelData[nColIter*nEdgeMapColStep])*nEdgeWeight,UCHAR_MAX);
+}
+
+template void EdgeDetectorLBSP::apply_internal_multithreshold<1>(const cv::Mat&, cv::Mat&);
+template void EdgeDetectorLBSP::apply_internal_multithreshold<2>(const cv::Mat&, cv::Mat&);
+template void EdgeDetectorLBSP::apply_internal_multithreshold<3>(const cv::Mat&, cv::Mat&);
+template void EdgeDetectorLBSP::apply_internal_multithreshold<4>(const cv::Mat&, cv::Mat&);
+
+void EdgeDetectorLBSP::apply_internal_multithreshold(const cv::Mat& oInputImg, cv::Mat& oEdgeMask, size_t nChannels) {
+    if(nChannels==1)
+        apply_internal_multithreshold<1>(oInputImg,oEdgeMask);
+    else if(nChannels==2)
+        apply_internal_multithreshold<2>(oInputImg,oEdgeMask);
+    else if(nChannels==3)
+        apply_internal_multithreshold<3>(oInputImg,oEdgeMask);
+    else if(nChannels==4)
+        apply_internal_multithreshold<4>(oInputImg,oEdgeMask);
+    else
+        CV_Error(-1,"Unexpected channel count");
+}
+
 void EdgeDetectorLBSP::apply_threshold(cv::InputArray _oInputImage, cv::OutputArray _oEdgeMask, double dDetThreshold) {
     cv::Mat oInputImg = _oInputImage.getMat();
     lvAssert_(!oInputImg.empty() && oInputImg.isContinuous(),"input image must be non-empty and continuous");
@@ -406,12 +550,7 @@ void EdgeDetectorLBSP::apply(cv::InputArray _oInputImage, cv::OutputArray _oEdge
     apply_internal_lookup(oInputImg,oInputImg.channels());
     _oEdgeMask.create(oInputImg.size(),CV_8UC1);
     cv::Mat oEdgeMask = _oEdgeMask.getMat();
-    oEdgeMask = cv::Scalar_<uchar>(0);
-    cv::Mat oTempEdgeMask = oEdgeMask.clone();
-    for(size_t nCurrThreshold=0; nCurrThreshold<LBSP::MAX_GRAD_MAG; ++nCurrThreshold) {
-        apply_internal_threshold(oInputImg,oTempEdgeMask,uchar(nCurrThreshold),oInputImg.channels());
-        oEdgeMask += oTempEdgeMask/double(LBSP::MAX_GRAD_MAG);
-    }
+    apply_internal_multithreshold(oInputImg,oEdgeMask,oInputImg.channels());
     if(m_bNormalizeOutput)
         cv::normalize(oEdgeMask,oEdgeMask,0,UCHAR_MAX,cv::NORM_MINMAX);
 }
@@ -17,6 +17,7 @@
 
 #include "litiv/imgproc/SegmMatcher.hpp"
 #include "litiv/3rdparty/ofdis/ofdis.hpp"
+#include <fstream>
 
 // config options
 #define SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY   0
@@ -25,6 +26,7 @@
 #define SEGMMATCH_CONFIG_USE_MI_AFFINITY       0
 #define SEGMMATCH_CONFIG_USE_SSQDIFF_AFFINITY  0
 #define SEGMMATCH_CONFIG_USE_SHAPE_EMD_AFFIN   0
+#define SEGMMATCH_CONFIG_USE_APPROX_SHAPE_EMD  0
 #define SEGMMATCH_CONFIG_USE_SALIENT_MAP_BORDR 1
 #define SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS   0
 #define SEGMMATCH_CONFIG_USE_DISP_BG_HRST      0
@@ -44,6 +46,9 @@
 #define SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST    0
 #define SEGMMATCH_CONFIG_USE_SQR_LBL_DIFF_DIST 1
 #define SEGMMATCH_CONFIG_USE_LAST_STEREO_INIT  1
+#define SEGMMATCH_CONFIG_USE_COARSE_MOVE_RESTR 0
+#define SEGMMATCH_CONFIG_USE_TEMPORAL_WARM_START 0
+#define SEGMMATCH_CONFIG_USE_INCR_MODEL_UPDT   0
 
 // default param values
 #define SEGMMATCH_DEFAULT_TEMPORAL_DEPTH       (size_t(1))
@@ -67,6 +72,12 @@
 #define SEGMMATCH_DEFAULT_BG_ZONE_SIZE         (45)
 #define SEGMMATCH_DEFAULT_GMM_3CH_COMPONENTS   (6)
 #define SEGMMATCH_DEFAULT_GMM_1CH_COMPONENTS   (3)
+#define SEGMMATCH_DEFAULT_COARSE_GRID_SCALE    (size_t(4))
+#define SEGMMATCH_DEFAULT_COARSE_LBL_RADIUS    (size_t(2))
+#define SEGMMATCH_DEFAULT_COARSE_ICM_ITER      (size_t(5))
+#define SEGMMATCH_DEFAULT_WARM_START_DECAY     (0.5f)
+#define SEGMMATCH_DEFAULT_WARM_START_MIN_SCORE (1e-3f)
+#define SEGMMATCH_DEFAULT_WARM_START_MIN_MOVES (size_t(4))
 
 // unary costs params
 #define SEGMMATCH_UNARY_COST_TEMPORAL_CST      (ValueType(200))
@@ -91,14 +102,13 @@
 #define SEGMMATCH_UNIQUE_COST_INCR_REL(n)      (float((n)*3)/((n)+2))
 #define SEGMMATCH_UNIQUE_COST_ZERO_COUNT       (1)
 
-#if (SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF)
+// note: FGBZ and SoSPD inference impls are always built, as they can be selected at runtime (the defines below only pick the defaults)
 #if !HAVE_OPENGM_EXTLIB
 #error "SegmMatcher config requires OpenGM external lib w/ QPBO for inference."
 #endif //!HAVE_OPENGM_EXTLIB
 #if !HAVE_OPENGM_EXTLIB_QPBO
 #error "SegmMatcher config requires OpenGM external lib w/ QPBO for inference."
 #endif //!HAVE_OPENGM_EXTLIB_QPBO
-#endif //(SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF)
 #if SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
 #if !HAVE_OPENGM_EXTLIB
 #error "SegmMatcher config requires OpenGM external lib w/ FastPD for inference."
@@ -107,31 +117,28 @@
 #error "SegmMatcher config requires OpenGM external lib w/ FastPD for inference."
 #endif //!HAVE_OPENGM_EXTLIB_FASTPD
 #endif //SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
-#if (SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
 #if !HAVE_BOOST
 #error "SegmMatcher config requires boost due to 3rdparty sospd module for inference."
 #endif //!HAVE_BOOST
 #define SEGMMATCH_CONFIG_USE_SOSPD_ALPHA_HEIGHTS_LABEL_ORDERING 0
-#endif //(SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
 #if (SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY+\
      SEGMMATCH_CONFIG_USE_DASCRF_AFFINITY+\
      SEGMMATCH_CONFIG_USE_LSS_AFFINITY+\
      SEGMMATCH_CONFIG_USE_MI_AFFINITY+\
      SEGMMATCH_CONFIG_USE_SSQDIFF_AFFINITY/*+...*/\
     )!=1
-#error "Must specify only one image affinity map computation approach to use."
+#error "Must specify only one default image affinity map computation approach to use."
 #endif //(features config ...)!=1
-#define SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY (SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY||SEGMMATCH_CONFIG_USE_DASCRF_AFFINITY||SEGMMATCH_CONFIG_USE_LSS_AFFINITY)
 #if (SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF+\
      SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF+\
      SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF/*+...*/\
     )!=1
-#error "Must specify only one stereo inference approach to use."
+#error "Must specify only one default stereo inference approach to use."
 #endif //(stereo inf config ...)!=1
 #if (SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF+\
      SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF/*+...*/\
     )!=1
-#error "Must specify only one resegm inference approach to use."
+#error "Must specify only one default resegm inference approach to use."
 #endif //(resegm inf config ...)!=1
 
 namespace {
@@ -253,6 +260,8 @@ namespace {
         size_t nStackedIdx;
         /// temporal clique owned by this node as 1st member (evaluates to true only if valid)
         TemporalClique oTemporalClique;
+        /// temporal diffs (one per clique edge, newest first) used when the energy terms of the temporal clique were last filled
+        std::array<uchar,s_nTemporalCliqueEdges> anTemporalCliqueDiffs;
     };
 
 } // anonymous namespace
@@ -260,11 +269,57 @@ namespace {
 /// holds graph model data for both stereo and resegmentation models
 struct SegmMatcher::GraphModelData {
     /// default constructor; receives model construction data from algo constructor
-    GraphModelData(const CamArray<cv::Mat>& aROIs, const std::vector<OutputLabelType>& vRealStereoLabels, size_t nStereoLabelStep, size_t nPrimaryCamIdx);
+    GraphModelData(const CamArray<cv::Mat>& aROIs, const std::vector<OutputLabelType>& vRealStereoLabels, size_t nStereoLabelStep, size_t nPrimaryCamIdx, const Params& oParams);
+    /// holds the per-camera feature extractors & worker pool used by a single feature computation thread
+    struct FeatureExtractionContext {
+        /// creates one extractor of each type per camera (extractors keep internal scratch state, and cannot be shared across threads)
+        FeatureExtractionContext(const Params& oParams, bool bAllowDisplay);
+        /// image affinity map computation strategy; owns the per-camera extractors & preprocessed inputs of a single approach
+        struct ImgAffinityStrategy {
+            /// default virtual destructor (impls are owned via base pointer)
+            virtual ~ImgAffinityStrategy() = default;
+            /// returns the window size required around each pixel to compute its affinity
+            virtual cv::Size getWindowSize() const = 0;
+            /// returns the border size required around the input images to compute their affinity
+            virtual int getBorderSize() const = 0;
+            /// preprocesses the input image of a camera (enlarged by the border size) for later affinity computation; called concurrently for each camera
+            virtual void prepare(size_t nCamIdx, const cv::Mat& oInput, const cv::Mat_<uchar>& oROI) = 0;
+            /// computes the dense affinity map of the first camera w.r.t. the second one using the prepared data
+            virtual void computeAffinity(const std::vector<int>& vDispOffsets, const CamArray<cv::Mat_<uchar>>& aROIs, cv::Mat_<float>& oAffinity) = 0;
+            /// returns the prepared (non-enlarged) descriptor map of a camera for saliency computation, or an empty map if not desc-based
+            virtual cv::Mat_<float> getDescs(size_t /*nCamIdx*/) const {return cv::Mat_<float>();}
+        };
+        /// desc-based image affinity strategy (L2 distances between aggregated dense descriptors)
+        template<typename TExtractor>
+        struct DescImgAffinity;
+        /// windowed mutual information image affinity strategy
+        struct MIImgAffinity;
+        /// windowed sum of squared differences image affinity strategy
+        struct SSQDiffImgAffinity;
+        /// holds the image affinity strategy selected via the runtime params (fixed for the lifetime of the context)
+        std::unique_ptr<ImgAffinityStrategy> pImgAffinity;
+        /// holds the feature extractors to use on input shapes
+        CamArray<std::unique_ptr<ShapeContext>> apShpDescExtractors;
+        /// worker pool used to process per-camera tasks concurrently (the first camera always runs on the calling thread)
+        lv::WorkerPool<getCameraCount()-1> oCamWorkerPool;
+        /// defines whether debug display calls are allowed (only true for the main thread)
+        const bool bAllowDisplay;
+    };
+    /// holds the inputs & features of a frame queued for pipelined processing
+    struct QueuedFrame {
+        MatArrayIn aInputs;
+        std::vector<cv::Mat> vFeatures;
+        std::future<void> oFeaturesReady;
+    };
+
     /// (pre)calculates features required for model updates, and optionally returns them in packet format
     void calcFeatures(const MatArrayIn& aInputs, cv::Mat* pFeaturesPacket=nullptr);
     /// sets a previously precalculated features packet to be used in the next model updates (do not modify it before that!)
     void setNextFeatures(const cv::Mat& oPackedFeatures);
+    /// queues inputs for background feature computation (blocks while 'nMaxQueueSize' frames are already pending)
+    void queueInputs(const MatArrayIn& aInputs, size_t nMaxQueueSize);
+    /// pops the oldest queued frame once its features are ready (returns false if the queue is empty)
+    bool popQueuedFrame(MatArrayIn& aInputs, std::vector<cv::Mat>& vFeatures);
     /// performs the actual bi-model, bi-spectral inference
     opengm::InferenceTermination infer();
     /// translate an internal graph label to a real disparity offset label
@@ -290,6 +345,8 @@ struct SegmMatcher::GraphModelData {
     /// helper func to display scaled assoc count maps (for primary cam only)
     cv::Mat getAssocCountsMapDisplay() const;
 
+    /// runtime pipeline configuration (fixed for the lifetime of the model)
+    const Params m_oParams;
     /// number of frame sets processed so far (used to toggle temporal links on/off)
     size_t m_nFramesProcessed;
     /// max move making iteration count allowed during stereo/resegm inference
@@ -298,6 +355,18 @@ struct SegmMatcher::GraphModelData {
     size_t m_nStereoLabelOrderRandomSeed,m_nStereoLabelingRandomSeed;
     /// contains the (internal) stereo label ordering to use for each iteration
     std::vector<InternalLabelType> m_vStereoLabelOrdering;
+    /// sparse per-node candidate (real) stereo label lists, in graph node order (csr layout: labels of node 'n' are in [offsets[n],offsets[n+1]))
+    std::vector<size_t> m_vStereoCandLabelOffsets;
+    /// sparse per-node candidate (real) stereo label lists, sorted for each node (see offsets above)
+    std::vector<InternalLabelType> m_vStereoCandLabels;
+    /// decayed fraction of stereo nodes flipped by each label's moves over previous frames (used for warm-start label ordering)
+    std::vector<float> m_vStereoLabelChangeScores;
+    /// per-camera masks of grid nodes whose gradient features changed since the last frame (all set if no history is available)
+    CamArray<cv::Mat_<uchar>> m_aDirtyNodeMaps;
+    /// index of the frame for which the resegm temporal cliques were last built (SIZE_MAX if they all need to be rebuilt)
+    size_t m_nTemporalCliquesFrameIdx;
+    /// holds the inference telemetry of the last (or current) processed frame
+    FrameTelemetry m_oTelemetry;
     /// holds the set of features to use (or used) during the next (or past) inference (mutable, as shape features will change during inference)
     mutable TemporalArray<std::vector<cv::Mat>> m_avFeatures;
     /// contains the (internal) labelings of the stereo/resegm graph (mutable for inference)
@@ -312,6 +381,8 @@ struct SegmMatcher::GraphModelData {
     mutable cv::Mat_<AssocIdxType> m_oAssocMap;
     /// 2d map which contains transient unary factor labeling costs for all stereo/resegm graph nodes (mutable for inference)
     mutable cv::Mat_<ValueType> m_oStereoUnaryCosts,m_oResegmUnaryCosts;
+    /// 2d map which flags stereo graph nodes allowed to take part in the current move (fixed nodes keep their label; only filled with coarse move restriction)
+    mutable cv::Mat_<uchar> m_oStereoMoveMask;
     /// contains the ROIs used for grid setup passed in the constructor
     const CamArray<cv::Mat_<uchar>> m_aROIs;
     /// contains the predetermined (max) 2D grid size for the graph models
@@ -389,16 +460,8 @@ struct SegmMatcher::GraphModelData {
     /// inter-cam vote map used for parallel ops (large prealloc)
     cv::Mat_<int> m_oStereoVoteMap;
 
-    /// holds the feature extractor to use on input images
-#if SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY || SEGMMATCH_CONFIG_USE_DASCRF_AFFINITY
-    std::unique_ptr<DASC> m_pImgDescExtractor;
-#elif SEGMMATCH_CONFIG_USE_LSS_AFFINITY
-    std::unique_ptr<LSS> m_pImgDescExtractor;
-#elif SEGMMATCH_CONFIG_USE_MI_AFFINITY
-    std::unique_ptr<MutualInfo> m_pImgDescExtractor; // although not really a 'descriptor' extractor...
-#endif //SEGMMATCH_CONFIG_USE_..._AFFINITY
-    /// holds the feature extractor to use on input shapes
-    std::unique_ptr<ShapeContext> m_pShpDescExtractor;
+    /// holds the feature extractors used by the calling (inference) thread
+    std::unique_ptr<FeatureExtractionContext> m_pFeatExtractionCtx;
     /// defines the minimum grid border size based on the feature extractors used
     size_t m_nGridBorderSize;
     /// holds the last/next features packet info vector
@@ -411,6 +474,17 @@ struct SegmMatcher::GraphModelData {
     bool m_bUsePrecalcFeaturesNext;
     /// used for debug only; passed from top-level algo when available
     lv::DisplayHelperPtr m_pDisplayHelper;
+    /// holds the frames queued for pipelined processing (features may still be in progress)
+    std::deque<QueuedFrame> m_qQueuedFrames;
+    /// holds the latest queued inputs (used as the previous frame for temporal features of the next queued one)
+    MatArrayIn m_aLastQueuedInputs;
+    /// sync objects used to guard the frame queue and apply back-pressure on producers
+    std::mutex m_oQueueMutex;
+    std::condition_variable m_oQueueSyncVar;
+    /// holds the feature extractors used by the background (pipeline) thread
+    std::unique_ptr<FeatureExtractionContext> m_pPipelineFeatExtractionCtx;
+    /// background worker used for pipelined feature computation (declared last, so it is joined before the data it uses is destroyed)
+    std::unique_ptr<lv::WorkerPool<1>> m_pPipelineWorker;
 
 protected:
     /// adds a stereo association for a given node coord set & origin column idx
@@ -423,21 +497,38 @@ protected:
     void updateStereoModel(bool bInit);
     /// resets primary+secondary stereo graph labelings using current model data
     void resetStereoLabelings();
+    /// warps the previous converged resegm labelings through the optical flow to initialize the current ones (warm start)
+    void resetResegmLabelingsByWarping();
+    /// updates the per-camera dirty node masks using the temporal differences & input mask changes of the latest frame
+    void updateDirtyNodeMaps();
     /// resets a secondary stereo graph labeling by projecting the primary disparity map data
     void resetStereoLabelingByProjection(size_t nCamIdx);
+    /// runs a coarse stereo inference pass on a downsampled grid, and restricts the full-res move candidate labels of each node around its solution
+    void computeStereoCandidateLabels();
     /// computes the median labelings for each foreground shape in the disparity maps
     void computeMedianLabelings(size_t nTargetCamIdx=SIZE_MAX/*do both by default*/);
     /// computes the occlusion maps for a target camera (or both)
     void computeOcclusionMaps(size_t nTargetCamIdx=SIZE_MAX/*do both by default*/);
+    /// returns the approximate byte count allocated for graph functions, node maps, cost/labeling maps & features
+    size_t calcModelByteCount() const;
 
     /// builds a resegm graph model using ROI information
     void buildResegmModel();
     /// updates a shape graph model using new features data
     void updateResegmModel(bool bInit);
-    /// calculates image features required for model updates using the provided input image array
-    void calcImageFeatures(const CamArray<cv::Mat>& aInputImages, std::vector<cv::Mat>& vFeatures);
+    /// executes a task for each camera index concurrently, and returns once all are done (rethrows the exception of the lowest failed camera index, if any)
+    template<typename TCamTask>
+    void execPerCamera(FeatureExtractionContext& oCtx, TCamTask&& lCamTask);
+    /// calculates all features required for model updates using the provided input array & previous input images (empty if unavailable)
+    void calcFeatures(FeatureExtractionContext& oCtx, const MatArrayIn& aInputs, const CamArray<cv::Mat>& aPrevInputImages, std::vector<cv::Mat>& vFeatures);
+    /// calculates image features required for model updates using the provided input image array & previous input images (empty if unavailable)
+    void calcImageFeatures(FeatureExtractionContext& oCtx, const CamArray<cv::Mat>& aInputImages, const CamArray<cv::Mat>& aPrevInputImages, std::vector<cv::Mat>& vFeatures);
     /// calculates shape features required for model updates using the provided input mask array
-    void calcShapeFeatures(const CamArray<cv::Mat_<InternalLabelType>>& aInputMasks, std::vector<cv::Mat>& vFeatures);
+    void calcShapeFeatures(FeatureExtractionContext& oCtx, const CamArray<cv::Mat_<InternalLabelType>>& aInputMasks, std::vector<cv::Mat>& vFeatures);
+    /// fills the primary saliency map using the sparseness of each node's valid affinities & descriptor (optional), and min-max normalizes it over the ROI
+    void calcSaliencyMap(const cv::Mat_<float>& oAffinity, const cv::Mat_<float>& oDescs, const cv::Mat_<float>& oFGDist, cv::Mat_<float>& oSaliency) const;
+    /// applies the 'root-sift' descriptor value adjustment to all descriptors of a (continuous) dense descriptor map
+    static void applyRootSIFT(cv::Mat_<float>& oDescs);
     /// calculates shape mask distance features required for model updates using the provided input mask & camera index
     void calcShapeDistFeatures(const cv::Mat_<InternalLabelType>& oInputMask, size_t nCamIdx, std::vector<cv::Mat>& vFeatures);
     /// initializes foreground and background GMM parameters via KNN using the given image and mask (where all values >0 are considered foreground)
@@ -456,7 +547,6 @@ protected:
     void calcStereoMoveCosts(InternalLabelType nNewLabel) const;
     /// fill internal temporary energy cost mats for the given resegm move operation
     void calcResegmMoveCosts(InternalLabelType nNewLabel) const;
-#if (SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
     /// init minimizer for later inference using SoSPD (returns active clique count)
     template<typename TNode>
     size_t initMinimizer(sospd::SubmodularIBFS<ValueType,IndexType>& oMinimizer,
@@ -482,9 +572,28 @@ protected:
                          InternalLabelType nAlphaLabel,
                          size_t nTotLabels,
                          bool bUpdateAssocs,
-                         TemporalArray<CamArray<size_t>>& aanChangedLabels);
+                         TemporalArray<CamArray<size_t>>& aanChangedLabels,
+                         const uchar* pMoveMask=nullptr);
     cv::Mat_<ValueType> m_oStereoDualMap,m_oStereoHeightMap,m_oResegmDualMap,m_oResegmHeightMap;
-#endif //(SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
+    /// holds the minimizers & scratch labelings reused across inferences (only energies are reset for each frame)
+    struct InferenceWorkspace {
+        /// stereo graph minimizer for FGBZ inference (node/edge arenas are kept across 'Reset' calls)
+        std::unique_ptr<kolmogorov::qpbo::QPBO<ValueType>> pStereoFGBZMinimizer;
+        /// stereo graph higher-order energy reducer for FGBZ inference (cleared before each move)
+        HigherOrderEnergy<ValueType,s_nMaxOrder> oStereoReducer;
+        /// stereo graph minimizer for SoSPD inference (clique topology is fixed at model build time, so it is only initialized once)
+        std::unique_ptr<sospd::SubmodularIBFS<ValueType,IndexType>> pStereoSOSPDMinimizer;
+        /// resegm graph minimizer for FGBZ inference (node/edge arenas are kept across 'Reset' calls)
+        std::unique_ptr<kolmogorov::qpbo::QPBO<ValueType>> pResegmFGBZMinimizer;
+        /// resegm graph higher-order energy reducer for FGBZ inference (cleared before each move)
+        HigherOrderEnergy<ValueType,s_nMaxOrder> oResegmReducer;
+        /// resegm labelings used to detect local minima across stereo/resegm passes
+        cv::Mat_<InternalLabelType> oPreStereoUpdateLabeling,oPreResegmUpdateLabeling;
+        /// last frame's resegm labeling warped via optical flow, used to warm-start the current one
+        cv::Mat_<InternalLabelType> oWarpedResegmLabeling;
+    };
+    /// holds the inference workspace (persistent across frames)
+    InferenceWorkspace m_oInfWorkspace;
     /// holds stereo disparity graph inference algorithm interface (redirects for bi-model inference)
     std::unique_ptr<StereoGraphInference> m_pStereoInf;
     /// holds resegmentation graph inference algorithm interface (redirects for bi-model inference)
@@ -703,10 +812,34 @@ constexpr size_t SegmMatcher::s_nCameraCount;
 
 size_t SegmMatcher::getTemporalDepth() {return s_nTemporalCliqueDepth;}
 
-SegmMatcher::SegmMatcher(size_t nMinDispOffset, size_t nMaxDispOffset) {
+SegmMatcher::Params::Params() :
+        eImgAffinity(SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY?ImgAffinity_DASCGF:
+                     SEGMMATCH_CONFIG_USE_DASCRF_AFFINITY?ImgAffinity_DASCRF:
+                     SEGMMATCH_CONFIG_USE_LSS_AFFINITY?ImgAffinity_LSS:
+                     SEGMMATCH_CONFIG_USE_MI_AFFINITY?ImgAffinity_MI:
+                     ImgAffinity_SSQDiff),
+        eStereoInference(SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF?Inference_SOSPD:Inference_FGBZ),
+        eResegmInference(SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF?Inference_FGBZ:Inference_SOSPD),
+        bUseRootSIFTDescs(SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS),
+        bUseShapeEMDAffinity(SEGMMATCH_CONFIG_USE_SHAPE_EMD_AFFIN),
+        bUseApproxShapeEMD(SEGMMATCH_CONFIG_USE_APPROX_SHAPE_EMD),
+        bUseSalientMapBorder(SEGMMATCH_CONFIG_USE_SALIENT_MAP_BORDR),
+        bUseLastStereoInit(SEGMMATCH_CONFIG_USE_LAST_STEREO_INIT),
+        bUseCoarseMoveRestriction(SEGMMATCH_CONFIG_USE_COARSE_MOVE_RESTR),
+        bUseTemporalWarmStart(SEGMMATCH_CONFIG_USE_TEMPORAL_WARM_START),
+        bUseIncrementalUpdates(SEGMMATCH_CONFIG_USE_INCR_MODEL_UPDT),
+        nMaxStereoMoveCount(SEGMMATCH_DEFAULT_MAX_STEREO_ITER),
+        nMaxResegmMoveCount(SEGMMATCH_DEFAULT_MAX_RESEGM_ITER) {}
+
+SegmMatcher::SegmMatcher(size_t nMinDispOffset, size_t nMaxDispOffset, const Params& oParams) :
+        m_oParams(oParams) {
     static_assert(getInputStreamCount()==4 && getOutputStreamCount()==4 && getCameraCount()==2,"i/o stream must be two image-mask pairs");
     static_assert(getInputStreamCount()==InputPackSize && getOutputStreamCount()==OutputPackSize,"bad i/o internal enum mapping");
     lvDbgExceptionWatch;
+    lvAssert_(m_oParams.eImgAffinity>=ImgAffinity_DASCGF && m_oParams.eImgAffinity<=ImgAffinity_SSQDiff,"unknown image affinity type");
+    lvAssert_(m_oParams.eStereoInference==Inference_FGBZ || m_oParams.eStereoInference==Inference_SOSPD,"unknown stereo inference type");
+    lvAssert_(m_oParams.eResegmInference==Inference_FGBZ || m_oParams.eResegmInference==Inference_SOSPD,"unknown resegm inference type");
+    lvAssert_(m_oParams.nMaxStereoMoveCount>0u && m_oParams.nMaxResegmMoveCount>0u,"max iter counts must be strictly positive");
     m_nDispStep = SEGMMATCH_DEFAULT_DISPARITY_STEP;
     lvAssert_(m_nDispStep>0,"specified disparity offset step size must be strictly positive");
     if(nMaxDispOffset<nMinDispOffset)
@@ -733,7 +866,7 @@ void SegmMatcher::initialize(const std::array<cv::Mat,s_nCameraCount>& aROIs, si
     lvAssert_(m_nDispStep>0,"specified disparity offset step size must be strictly positive");
     lvAssert_(m_vStereoLabels.size()>1,"graph must have at least two possible output labels, beyond reserved ones");
     lvAssert_(nPrimaryCamIdx<getCameraCount(),"primary camera idx is out of range");
-    m_pModelData = std::make_unique<GraphModelData>(aROIs,m_vStereoLabels,m_nDispStep,nPrimaryCamIdx);
+    m_pModelData = std::make_unique<GraphModelData>(aROIs,m_vStereoLabels,m_nDispStep,nPrimaryCamIdx,m_oParams);
     if(m_pDisplayHelper)
         m_pModelData->m_pDisplayHelper = m_pDisplayHelper;
 }
@@ -742,6 +875,10 @@ void SegmMatcher::apply(const MatArrayIn& aInputs, MatArrayOut& aOutputs) {
     static_assert(s_nInputArraySize==4 && getCameraCount()==2,"lots of hardcoded indices below");
     lvDbgExceptionWatch;
     lvAssert_(m_pModelData,"model must be initialized first");
+    lv::StopWatch oApplyTimer;
+    FrameTelemetry& oTelemetry = m_pModelData->m_oTelemetry;
+    oTelemetry = FrameTelemetry();
+    oTelemetry.nFrameIdx = m_pModelData->m_nFramesProcessed;
     const size_t nLayerSize = m_pModelData->m_oGridSize.total();
     for(size_t nInputIdx=0u; nInputIdx<aInputs.size(); ++nInputIdx)
         lvAssert__(m_pModelData->m_oGridSize==aInputs[nInputIdx].size,"input in array at index=%d had the wrong size",(int)nInputIdx);
@@ -770,6 +907,7 @@ void SegmMatcher::apply(const MatArrayIn& aInputs, MatArrayOut& aOutputs) {
     }
     for(size_t nInputIdx=0u; nInputIdx<aInputs.size(); ++nInputIdx) // copy new inputs to first layer
         aInputs[nInputIdx].copyTo(m_pModelData->m_aaInputs[0][nInputIdx]);
+    lv::StopWatch oFeaturesTimer;
     if(m_pModelData->m_bUsePrecalcFeaturesNext) {
         m_pModelData->m_bUsePrecalcFeaturesNext = false;
         lvDbgAssert(m_pModelData->m_vLoadedFeatures.size()==FeatPackSize);
@@ -780,8 +918,11 @@ void SegmMatcher::apply(const MatArrayIn& aInputs, MatArrayOut& aOutputs) {
         lvDbgAssert(m_pModelData->m_vTempFeatures.size()==FeatPackSize);
         std::swap(m_pModelData->m_vTempFeatures,m_pModelData->m_avFeatures[0]);
     }
+    oTelemetry.dFeaturesTime = oFeaturesTimer.elapsed();
     for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) // only overwrite current resegm labeling temporal layer
         cv::Mat(((m_pModelData->m_aaInputs[0][nCamIdx*InputPackOffset+InputPackOffset_Mask]>0)&m_pModelData->m_aROIs[nCamIdx])&s_nForegroundLabelIdx).copyTo(m_pModelData->m_aaResegmLabelings[0][nCamIdx]);
+    if(m_oParams.bUseTemporalWarmStart && m_pModelData->m_nFramesProcessed>0u && getTemporalLayerCount()>1u)
+        m_pModelData->resetResegmLabelingsByWarping(); // input masks are only kept where the flow points outside the previous frame
     if(m_pModelData->m_nFramesProcessed==0u) {
         for(size_t nLayerIdx=1u; nLayerIdx<getTemporalLayerCount(); ++nLayerIdx) {
             for(size_t nInputIdx=0u; nInputIdx<aInputs.size(); ++nInputIdx) // copy initial inputs to all layers
@@ -799,6 +940,27 @@ void SegmMatcher::apply(const MatArrayIn& aInputs, MatArrayOut& aOutputs) {
         m_pModelData->m_aaStereoLabelings[0][nCamIdx].copyTo(aOutputs[nCamIdx*OutputPackOffset+OutputPackOffset_Disp]);
         m_pModelData->m_aaResegmLabelings[0][nCamIdx].copyTo(aOutputs[nCamIdx*OutputPackOffset+OutputPackOffset_Mask]);
     }
+    oTelemetry.dTotalTime = oApplyTimer.elapsed();
+    if(!m_sTelemetryFilePath.empty()) {
+        std::ofstream oTelemetryOutput(m_sTelemetryFilePath,std::ios::app);
+        lvAssert__(oTelemetryOutput.is_open(),"could not open telemetry output file at '%s'",m_sTelemetryFilePath.c_str());
+        oTelemetryOutput << cv::format("%d,%f,%f,%f,%f,%f,%f,%d,%d,%d,%d,%d,%d,%d,%zu,",(int)oTelemetry.nFrameIdx,oTelemetry.dFeaturesTime,
+                                       oTelemetry.dStereoUpdateTime,oTelemetry.dResegmUpdateTime,oTelemetry.dStereoInfTime,oTelemetry.dResegmInfTime,oTelemetry.dTotalTime,
+                                       (int)oTelemetry.nStereoMoveCount,(int)oTelemetry.nResegmMoveCount,(int)oTelemetry.nResegmPassCount,
+                                       (int)oTelemetry.nChangedStereoLabels,(int)oTelemetry.nChangedResegmLabels,
+                                       (int)oTelemetry.nUnlabeledNodeCount,(int)oTelemetry.nSkippedMoveCount,oTelemetry.nModelBytes);
+        // per-move energies are packed as space-separated lists in quoted fields
+        const auto lWriteEnergies = [&](const std::vector<ValueType>& vEnergies) {
+            oTelemetryOutput << '"';
+            for(size_t nMoveIdx=0; nMoveIdx<vEnergies.size(); ++nMoveIdx)
+                oTelemetryOutput << (nMoveIdx?" ":"") << (int64_t)vEnergies[nMoveIdx];
+            oTelemetryOutput << '"';
+        };
+        lWriteEnergies(oTelemetry.vStereoEnergies);
+        oTelemetryOutput << ',';
+        lWriteEnergies(oTelemetry.vResegmEnergies);
+        oTelemetryOutput << std::endl;
+    }
 }
 
 void SegmMatcher::getOutput(size_t nTemporalLayerIdx, MatArrayOut& aOutputs) const {
@@ -824,23 +986,58 @@ void SegmMatcher::setNextFeatures(const cv::Mat& oPackedFeatures) {
     m_pModelData->setNextFeatures(oPackedFeatures);
 }
 
+void SegmMatcher::queueInputs(const MatArrayIn& aInputs, size_t nMaxQueueSize) {
+    lvDbgExceptionWatch;
+    lvAssert_(m_pModelData,"model must be initialized first");
+    m_pModelData->queueInputs(aInputs,nMaxQueueSize);
+}
+
+bool SegmMatcher::applyQueued(MatArrayOut& aOutputs) {
+    lvDbgExceptionWatch;
+    lvAssert_(m_pModelData,"model must be initialized first");
+    MatArrayIn aInputs;
+    if(!m_pModelData->popQueuedFrame(aInputs,m_pModelData->m_vLoadedFeatures))
+        return false;
+    m_pModelData->m_bUsePrecalcFeaturesNext = true;
+    apply(aInputs,aOutputs);
+    return true;
+}
+
 void SegmMatcher::resetTemporalModel() {
     lvDbgExceptionWatch;
     m_pModelData->m_nFramesProcessed = 0u;
+    m_pModelData->m_vStereoLabelChangeScores.clear();
+    m_pModelData->m_nTemporalCliquesFrameIdx = SIZE_MAX;
+    lv::mutex_lock_guard sync_lock(m_pModelData->m_oQueueMutex);
+    m_pModelData->m_aLastQueuedInputs = MatArrayIn(); // next queued frame will also start a new temporal sequence
+}
+
+const SegmMatcher::FrameTelemetry& SegmMatcher::getLastFrameTelemetry() const {
+    lvAssert_(m_pModelData,"model must be initialized first");
+    return m_pModelData->m_oTelemetry;
+}
+
+void SegmMatcher::setTelemetryOutputPath(const std::string& sFilePath) {
+    lvDbgExceptionWatch;
+    m_sTelemetryFilePath = sFilePath;
+    if(m_sTelemetryFilePath.empty())
+        return;
+    std::ofstream oTelemetryOutput(m_sTelemetryFilePath,std::ios::trunc);
+    lvAssert__(oTelemetryOutput.is_open(),"could not open telemetry output file at '%s'",m_sTelemetryFilePath.c_str());
+    oTelemetryOutput << "frame_idx,features_time,stereo_update_time,resegm_update_time,stereo_inf_time,resegm_inf_time,total_time,"
+                        "stereo_moves,resegm_moves,resegm_passes,changed_stereo_labels,changed_resegm_labels,"
+                        "unlabeled_nodes,skipped_moves,model_bytes,stereo_energies,resegm_energies" << std::endl;
 }
 
 std::string SegmMatcher::getFeatureExtractorName() const {
-#if SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY
-    return "sc-dasc-gf";
-#elif SEGMMATCH_CONFIG_USE_DASCRF_AFFINITY
-    return "sc-dasc-rf";
-#elif SEGMMATCH_CONFIG_USE_LSS_AFFINITY
-    return "sc-lss";
-#elif SEGMMATCH_CONFIG_USE_MI_AFFINITY
-    return "sc-mi";
-#elif SEGMMATCH_CONFIG_USE_SSQDIFF_AFFINITY
-    return "sc-ssqrdiff";
-#endif //SEGMMATCH_CONFIG_USE_..._AFFINITY
+    switch(m_oParams.eImgAffinity) {
+        case ImgAffinity_DASCGF: return "sc-dasc-gf";
+        case ImgAffinity_DASCRF: return "sc-dasc-rf";
+        case ImgAffinity_LSS: return "sc-lss";
+        case ImgAffinity_MI: return "sc-mi";
+        case ImgAffinity_SSQDiff: return "sc-ssqrdiff";
+        default: lvError("unknown image affinity type");
+    }
 }
 
 size_t SegmMatcher::getMaxLabelCount() const {
@@ -877,12 +1074,149 @@ cv::Mat SegmMatcher::getAssocCountsMapDisplay() const {
 
 constexpr size_t SegmMatcher::GraphModelData::s_nResegmLabels;
 
-SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, const std::vector<OutputLabelType>& vRealStereoLabels, size_t nStereoLabelStep, size_t nPrimaryCamIdx) :
+template<typename TExtractor>
+struct SegmMatcher::GraphModelData::FeatureExtractionContext::DescImgAffinity : ImgAffinityStrategy {
+    /// creates one descriptor extractor per camera using the given constructor args
+    template<typename... TArgs>
+    DescImgAffinity(bool bUseRootSIFT_, const TArgs&... args) : bUseRootSIFT(bUseRootSIFT_) {
+        for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+            apExtractors[nCamIdx] = std::make_unique<TExtractor>(args...);
+    }
+    virtual cv::Size getWindowSize() const override {
+        return apExtractors[0]->windowSize();
+    }
+    virtual int getBorderSize() const override {
+        return std::max(apExtractors[0]->borderSize(0),apExtractors[0]->borderSize(1));
+    }
+    virtual void prepare(size_t nCamIdx, const cv::Mat& oInput, const cv::Mat_<uchar>& /*oROI*/) override {
+        lvDbgAssert(nCamIdx<getCameraCount());
+        const int nBorderSize = getBorderSize();
+        cv::copyMakeBorder(oInput,aEnlargedInputs[nCamIdx],nBorderSize,nBorderSize,nBorderSize,nBorderSize,cv::BORDER_DEFAULT);
+        apExtractors[nCamIdx]->compute2(aEnlargedInputs[nCamIdx],aEnlargedDescs[nCamIdx]);
+        lvDbgAssert(aEnlargedDescs[nCamIdx].dims==3 && aEnlargedDescs[nCamIdx].size[0]==oInput.rows+nBorderSize*2 && aEnlargedDescs[nCamIdx].size[1]==oInput.cols+nBorderSize*2);
+        std::vector<cv::Range> vRanges(size_t(3),cv::Range::all());
+        vRanges[0] = cv::Range(nBorderSize,oInput.rows+nBorderSize);
+        vRanges[1] = cv::Range(nBorderSize,oInput.cols+nBorderSize);
+        aEnlargedDescs[nCamIdx](vRanges.data()).copyTo(aDescs[nCamIdx]); // copy to avoid bugs when reshaping non-continuous data
+        lvDbgAssert(aDescs[nCamIdx].dims==3 && aDescs[nCamIdx].size[0]==oInput.rows && aDescs[nCamIdx].size[1]==oInput.cols);
+        lvDbgAssert(std::equal(aDescs[nCamIdx].ptr<float>(0,0),aDescs[nCamIdx].ptr<float>(0,0)+aDescs[nCamIdx].size[2],aEnlargedDescs[nCamIdx].ptr<float>(nBorderSize,nBorderSize)));
+        if(bUseRootSIFT)
+            applyRootSIFT(aDescs[nCamIdx]);
+    }
+    virtual void computeAffinity(const std::vector<int>& vDispOffsets, const CamArray<cv::Mat_<uchar>>& aROIs, cv::Mat_<float>& oAffinity) override {
+        static_assert((SEGMMATCH_DEFAULT_DESC_PATCH_SIZE%2)==1,"patch sizes must be odd");
+        lv::computeDescriptorAffinity(aDescs[0],aDescs[1],SEGMMATCH_DEFAULT_DESC_PATCH_SIZE,oAffinity,vDispOffsets,lv::AffinityDist_L2,aROIs[0],aROIs[1]);
+        /*cv::Mat_<float> tmp;
+        lv::computeDescriptorAffinity(aDescs[0],aDescs[1],SEGMMATCH_DEFAULT_DESC_PATCH_SIZE,tmp,vDispOffsets,lv::AffinityDist_L2,aROIs[0],aROIs[1],cv::Mat_<float>(),false);
+        lvAssert(lv::MatInfo(tmp)==lv::MatInfo(oAffinity));
+        for(int i=0; i<oAffinity.size[0]; ++i)
+            for(int j=0; j<oAffinity.size[1]; ++j)
+                for(int k=0; k<oAffinity.size[2]; ++k)
+                        lvAssert__(std::abs(tmp(i,j,k)-oAffinity(i,j,k))<0.0001f," %d,%d,%d =  %f vs %f,   w/ roi0 = %d",i,j,k,tmp(i,j,k),oAffinity(i,j,k),(int)aROIs[0](i,j));*/
+    }
+    virtual cv::Mat_<float> getDescs(size_t nCamIdx) const override {
+        lvDbgAssert(nCamIdx<getCameraCount());
+        return aDescs[nCamIdx];
+    }
+    const bool bUseRootSIFT;
+    CamArray<std::unique_ptr<TExtractor>> apExtractors;
+    CamArray<cv::Mat> aEnlargedInputs;
+    CamArray<cv::Mat_<float>> aEnlargedDescs,aDescs;
+};
+
+struct SegmMatcher::GraphModelData::FeatureExtractionContext::MIImgAffinity : ImgAffinityStrategy {
+    virtual cv::Size getWindowSize() const override {
+        return cv::Size(int(SEGMMATCH_DEFAULT_MI_WINDOW_RAD*2+1),int(SEGMMATCH_DEFAULT_MI_WINDOW_RAD*2+1));
+    }
+    virtual int getBorderSize() const override {
+        return int(SEGMMATCH_DEFAULT_MI_WINDOW_RAD);
+    }
+    virtual void prepare(size_t nCamIdx, const cv::Mat& oInput, const cv::Mat_<uchar>& oROI) override {
+        lvDbgAssert(nCamIdx<getCameraCount());
+        const int nBorderSize = getBorderSize();
+        cv::copyMakeBorder(oInput,aEnlargedInputs[nCamIdx],nBorderSize,nBorderSize,nBorderSize,nBorderSize,cv::BORDER_DEFAULT);
+        if(aEnlargedInputs[nCamIdx].channels()==3)
+            cv::cvtColor(aEnlargedInputs[nCamIdx],aEnlargedInputs[nCamIdx],cv::COLOR_BGR2GRAY);
+        cv::copyMakeBorder(oROI,aEnlargedROIs[nCamIdx],nBorderSize,nBorderSize,nBorderSize,nBorderSize,cv::BORDER_CONSTANT,cv::Scalar(0));
+    }
+    virtual void computeAffinity(const std::vector<int>& vDispOffsets, const CamArray<cv::Mat_<uchar>>& /*aROIs*/, cv::Mat_<float>& oAffinity) override {
+        lv::computeImageAffinity(aEnlargedInputs[0],aEnlargedInputs[1],getWindowSize().width,oAffinity,vDispOffsets,lv::AffinityDist_MI,aEnlargedROIs[0],aEnlargedROIs[1]);
+    }
+    CamArray<cv::Mat> aEnlargedInputs;
+    CamArray<cv::Mat_<uchar>> aEnlargedROIs;
+};
+
+struct SegmMatcher::GraphModelData::FeatureExtractionContext::SSQDiffImgAffinity : ImgAffinityStrategy {
+    virtual cv::Size getWindowSize() const override {
+        return cv::Size(int(SEGMMATCH_DEFAULT_SSQDIFF_PATCH),int(SEGMMATCH_DEFAULT_SSQDIFF_PATCH));
+    }
+    virtual int getBorderSize() const override {
+        return int(SEGMMATCH_DEFAULT_SSQDIFF_PATCH)/2;
+    }
+    virtual void prepare(size_t nCamIdx, const cv::Mat& oInput, const cv::Mat_<uchar>& oROI) override {
+        lvDbgAssert(nCamIdx<getCameraCount());
+        const int nBorderSize = getBorderSize();
+        const int nWinSize = nBorderSize*2+1;
+        cv::copyMakeBorder(oInput,aEnlargedInputs[nCamIdx],nBorderSize,nBorderSize,nBorderSize,nBorderSize,cv::BORDER_DEFAULT);
+        if(aEnlargedInputs[nCamIdx].channels()==3)
+            cv::cvtColor(aEnlargedInputs[nCamIdx],aEnlargedInputs[nCamIdx],cv::COLOR_BGR2GRAY);
+        aEnlargedInputs[nCamIdx].convertTo(aEnlargedInputs[nCamIdx],CV_64F,(1.0/UCHAR_MAX)/nWinSize);
+        aEnlargedInputs[nCamIdx] -= cv::mean(aEnlargedInputs[nCamIdx])[0];
+        cv::copyMakeBorder(oROI,aEnlargedROIs[nCamIdx],nBorderSize,nBorderSize,nBorderSize,nBorderSize,cv::BORDER_CONSTANT,cv::Scalar(0));
+    }
+    virtual void computeAffinity(const std::vector<int>& vDispOffsets, const CamArray<cv::Mat_<uchar>>& /*aROIs*/, cv::Mat_<float>& oAffinity) override {
+        lv::computeImageAffinity(aEnlargedInputs[0],aEnlargedInputs[1],getBorderSize()*2+1,oAffinity,vDispOffsets,lv::AffinityDist_SSD,aEnlargedROIs[0],aEnlargedROIs[1]);
+    }
+    CamArray<cv::Mat> aEnlargedInputs;
+    CamArray<cv::Mat_<uchar>> aEnlargedROIs;
+};
+
+SegmMatcher::GraphModelData::FeatureExtractionContext::FeatureExtractionContext(const Params& oParams, bool bAllowDisplay_) :
+        bAllowDisplay(bAllowDisplay_) {
+    lvDbgExceptionWatch;
+    // the affinity approach is only resolved here; feature computation then goes through the strategy without re-checking params
+    switch(oParams.eImgAffinity) {
+        case ImgAffinity_DASCGF:
+            pImgAffinity = std::make_unique<DescImgAffinity<DASC>>(oParams.bUseRootSIFTDescs,DASC_DEFAULT_GF_RADIUS,DASC_DEFAULT_GF_EPS,DASC_DEFAULT_GF_SUBSPL,DASC_DEFAULT_PREPROCESS);
+            break;
+        case ImgAffinity_DASCRF:
+            pImgAffinity = std::make_unique<DescImgAffinity<DASC>>(oParams.bUseRootSIFTDescs,DASC_DEFAULT_RF_SIGMAS,DASC_DEFAULT_RF_SIGMAR,DASC_DEFAULT_RF_ITERS,DASC_DEFAULT_PREPROCESS);
+            break;
+        case ImgAffinity_LSS: {
+            const int nLSSInnerRadius = 0;
+            const int nLSSOuterRadius = (int)SEGMMATCH_DEFAULT_LSSDESC_RAD;
+            const int nLSSPatchSize = (int)SEGMMATCH_DEFAULT_LSSDESC_PATCH;
+            const int nLSSAngBins = (int)SEGMMATCH_DEFAULT_LSSDESC_ANG_BINS;
+            const int nLSSRadBins = (int)SEGMMATCH_DEFAULT_LSSDESC_RAD_BINS;
+            pImgAffinity = std::make_unique<DescImgAffinity<LSS>>(oParams.bUseRootSIFTDescs,nLSSInnerRadius,nLSSOuterRadius,nLSSPatchSize,nLSSAngBins,nLSSRadBins);
+            break;
+        }
+        case ImgAffinity_MI:
+            pImgAffinity = std::make_unique<MIImgAffinity>();
+            break;
+        case ImgAffinity_SSQDiff:
+            pImgAffinity = std::make_unique<SSQDiffImgAffinity>();
+            break;
+        default:
+            lvError("unknown image affinity type");
+    }
+    const size_t nShapeContextInnerRadius = 2;
+    const size_t nShapeContextOuterRadius = SEGMMATCH_DEFAULT_SCDESC_WIN_RAD;
+    const size_t nShapeContextAngBins = SEGMMATCH_DEFAULT_SCDESC_ANG_BINS;
+    const size_t nShapeContextRadBins = SEGMMATCH_DEFAULT_SCDESC_RAD_BINS;
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+        apShpDescExtractors[nCamIdx] = std::make_unique<ShapeContext>(nShapeContextInnerRadius,nShapeContextOuterRadius,nShapeContextAngBins,nShapeContextRadBins);
+}
+
+SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, const std::vector<OutputLabelType>& vRealStereoLabels, size_t nStereoLabelStep, size_t nPrimaryCamIdx, const Params& oParams) :
+        m_oParams(oParams),
         m_nFramesProcessed(0u),
-        m_nMaxStereoMoveCount(SEGMMATCH_DEFAULT_MAX_STEREO_ITER),
-        m_nMaxResegmMoveCount(SEGMMATCH_DEFAULT_MAX_RESEGM_ITER),
+        m_nMaxStereoMoveCount(oParams.nMaxStereoMoveCount),
+        m_nMaxResegmMoveCount(oParams.nMaxResegmMoveCount),
         m_nStereoLabelOrderRandomSeed(0u),
         m_nStereoLabelingRandomSeed(0u),
+        m_nTemporalCliquesFrameIdx(SIZE_MAX),
+        m_oTelemetry(),
         m_aROIs(CamArray<cv::Mat_<uchar>>{aROIs[0]>0,aROIs[1]>0}),
         m_oGridSize(m_aROIs[0].size()),
         m_vStereoLabels(lv::concat<OutputLabelType>(vRealStereoLabels,std::vector<OutputLabelType>{s_nDontCareLabel,s_nOccludedLabel})),
@@ -894,6 +1228,7 @@ SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, cons
         m_nPrimaryCamIdx(nPrimaryCamIdx),
         m_nDontCareLabelIdx(InternalLabelType(m_vStereoLabels.size()-2u)),
         m_nOccludedLabelIdx(InternalLabelType(m_vStereoLabels.size()-1u)),
+        m_pFeatExtractionCtx(std::make_unique<FeatureExtractionContext>(oParams,true)),
         m_bUsePrecalcFeaturesNext(false) {
     static_assert(getCameraCount()==2,"bad static array size, hardcoded stuff in constr init list and below will break");
     lvDbgExceptionWatch;
@@ -914,41 +1249,12 @@ SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, cons
     lvAssert_(m_nMinDispOffset<m_nMaxDispOffset,"min/max disp offsets mismatch");
     lvAssert_(m_nPrimaryCamIdx<getCameraCount(),"bad primary camera index");
     lvDbgAssert_(std::numeric_limits<AssocCountType>::max()>m_oGridSize[1],"grid width is too large for association counter type");
-#if SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY
-    m_pImgDescExtractor = std::make_unique<DASC>(DASC_DEFAULT_GF_RADIUS,DASC_DEFAULT_GF_EPS,DASC_DEFAULT_GF_SUBSPL,DASC_DEFAULT_PREPROCESS);
-    const cv::Size oDescWinSize = m_pImgDescExtractor->windowSize();
-    m_nGridBorderSize = (size_t)std::max(m_pImgDescExtractor->borderSize(0),m_pImgDescExtractor->borderSize(1));
-#elif SEGMMATCH_CONFIG_USE_DASCRF_AFFINITY
-    m_pImgDescExtractor = std::make_unique<DASC>(DASC_DEFAULT_RF_SIGMAS,DASC_DEFAULT_RF_SIGMAR,DASC_DEFAULT_RF_ITERS,DASC_DEFAULT_PREPROCESS);
-    const cv::Size oDescWinSize = m_pImgDescExtractor->windowSize();
-    m_nGridBorderSize = (size_t)std::max(m_pImgDescExtractor->borderSize(0),m_pImgDescExtractor->borderSize(1));
-#elif SEGMMATCH_CONFIG_USE_LSS_AFFINITY
-    const int nLSSInnerRadius = 0;
-    const int nLSSOuterRadius = (int)SEGMMATCH_DEFAULT_LSSDESC_RAD;
-    const int nLSSPatchSize = (int)SEGMMATCH_DEFAULT_LSSDESC_PATCH;
-    const int nLSSAngBins = (int)SEGMMATCH_DEFAULT_LSSDESC_ANG_BINS;
-    const int nLSSRadBins = (int)SEGMMATCH_DEFAULT_LSSDESC_RAD_BINS;
-    m_pImgDescExtractor = std::make_unique<LSS>(nLSSInnerRadius,nLSSOuterRadius,nLSSPatchSize,nLSSAngBins,nLSSRadBins);
-    const cv::Size oDescWinSize = m_pImgDescExtractor->windowSize();
-    m_nGridBorderSize = (size_t)std::max(m_pImgDescExtractor->borderSize(0),m_pImgDescExtractor->borderSize(1));
-#elif SEGMMATCH_CONFIG_USE_MI_AFFINITY
-    const int nWindowSize = int(SEGMMATCH_DEFAULT_MI_WINDOW_RAD*2+1);
-    const cv::Size oDescWinSize = cv::Size(nWindowSize,nWindowSize);
-    m_nGridBorderSize = SEGMMATCH_DEFAULT_MI_WINDOW_RAD;
-#elif SEGMMATCH_CONFIG_USE_SSQDIFF_AFFINITY
-    constexpr int nSSqrDiffKernelSize = int(SEGMMATCH_DEFAULT_SSQDIFF_PATCH);
-    const cv::Size oDescWinSize(nSSqrDiffKernelSize,nSSqrDiffKernelSize);
-    m_nGridBorderSize = size_t(nSSqrDiffKernelSize/2);
-#endif //SEGMMATCH_CONFIG_USE_..._AFFINITY
-    const size_t nShapeContextInnerRadius = 2;
-    const size_t nShapeContextOuterRadius = SEGMMATCH_DEFAULT_SCDESC_WIN_RAD;
-    const size_t nShapeContextAngBins = SEGMMATCH_DEFAULT_SCDESC_ANG_BINS;
-    const size_t nShapeContextRadBins = SEGMMATCH_DEFAULT_SCDESC_RAD_BINS;
-    m_pShpDescExtractor = std::make_unique<ShapeContext>(nShapeContextInnerRadius,nShapeContextOuterRadius,nShapeContextAngBins,nShapeContextRadBins);
+    const cv::Size oDescWinSize = m_pFeatExtractionCtx->pImgAffinity->getWindowSize();
+    m_nGridBorderSize = (size_t)m_pFeatExtractionCtx->pImgAffinity->getBorderSize();
     lvAssert__(oDescWinSize.width<=(int)m_oGridSize[1] && oDescWinSize.height<=(int)m_oGridSize[0],"image is too small to compute descriptors with current pattern size -- need at least (%d,%d) and got (%d,%d)",oDescWinSize.width,oDescWinSize.height,(int)m_oGridSize[1],(int)m_oGridSize[0]);
     lvDbgAssert(m_nGridBorderSize<m_oGridSize[0] && m_nGridBorderSize<m_oGridSize[1]);
     lvDbgAssert(m_nGridBorderSize<(size_t)oDescWinSize.width && m_nGridBorderSize<(size_t)oDescWinSize.height);
-    lvDbgAssert((size_t)std::max(m_pShpDescExtractor->borderSize(0),m_pShpDescExtractor->borderSize(1))<=m_nGridBorderSize);
+    lvDbgAssert((size_t)std::max(m_pFeatExtractionCtx->apShpDescExtractors[0]->borderSize(0),m_pFeatExtractionCtx->apShpDescExtractors[0]->borderSize(1))<=m_nGridBorderSize);
     m_aAssocCostRealAddLUT.resize_static();
     m_aAssocCostRealRemLUT.resize_static();
     m_aAssocCostRealSumLUT.resize_static();
@@ -1029,11 +1335,13 @@ SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, cons
     const std::array<int,3> anAssocMapDims{int(m_oGridSize[0]),int((m_oGridSize[1]+m_nMaxDispOffset/*for oob usage*/)/m_nDispOffsetStep),int(m_nRealStereoLabels*m_nDispOffsetStep)};
     m_oAssocCounts.create(2,anAssocMapDims.data());
     m_oAssocMap.create(3,anAssocMapDims.data());
-#if SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF
+#if !SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
     m_oStereoUnaryCosts.create(m_oGridSize);
-#elif SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
+    if(m_oParams.bUseCoarseMoveRestriction)
+        m_oStereoMoveMask.create(m_oGridSize);
+#else //SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
     m_oStereoUnaryCosts.create(int(m_nStereoLabels),int(anValidGraphNodes[m_nPrimaryCamIdx])); // flip for optim?
-#endif //SEGMMATCH_CONFIG_USE_..._STEREO_INF
+#endif //SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
     m_oResegmUnaryCosts.create(int(m_oGridSize[0]*nTemporalLayerCount*nCameraCount),int(m_oGridSize[1]));
     m_vStereoGraphIdxToMapIdxLUT.reserve(anValidGraphNodes[m_nPrimaryCamIdx]);
     m_vResegmGraphIdxToMapIdxLUT.reserve(nTotValidNodes*nTemporalLayerCount);
@@ -1296,6 +1604,8 @@ void SegmMatcher::GraphModelData::updateStereoModel(bool bInit) {
             m_avMedianShapeLabels[nCamIdx].resize(1u,0u);
         }
     }
+    const cv::Mat_<uchar>& oDirtyNodeMap = m_aDirtyNodeMaps[m_nPrimaryCamIdx];
+    lvDbgAssert(m_oGridSize==oDirtyNodeMap.size && oDirtyNodeMap.isContinuous());
     lvLog(4,"Updating stereo graph model energy terms based on new features...");
     lv::StopWatch oLocalTimer;
 #if SEGMMATCH_CONFIG_USE_PROGRESS_BARS
@@ -1356,7 +1666,8 @@ void SegmMatcher::GraphModelData::updateStereoModel(bool bInit) {
     #else //!SEGMMATCH_CONFIG_USE_OCCLUDED_LABELS
         vUnaryStereoLUT(m_nOccludedLabelIdx) = cost_cast(10000);
     #endif //!SEGMMATCH_CONFIG_USE_OCCLUDED_LABELS
-        if(bInit) { // inter-spectral pairwise/epipolar term updates do not change w.r.t. segm or stereo updates
+        // inter-spectral pairwise/epipolar term updates do not change w.r.t. segm or stereo updates, and only need a refresh where inputs changed
+        if(bInit && oDirtyNodeMap.data[oNode.nMapIdx]) {
             for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx) {
                 PairwClique& oPairwClique = oNode.aPairwCliques[nOrientIdx];
                 if(oPairwClique) {
@@ -1410,8 +1721,7 @@ void SegmMatcher::GraphModelData::resetStereoLabelings() {
     lvDbgAssert(m_nValidStereoGraphNodes==m_vStereoGraphIdxToMapIdxLUT.size());
     cv::Mat_<InternalLabelType>& oPrimaryLabeling = m_aaStereoLabelings[0][m_nPrimaryCamIdx];
     std::fill(oPrimaryLabeling.begin(),oPrimaryLabeling.end(),m_nDontCareLabelIdx);
-#if SEGMMATCH_CONFIG_USE_LAST_STEREO_INIT
-    if(m_nFramesProcessed>0u) {
+    if(m_oParams.bUseLastStereoInit && m_nFramesProcessed>0u) {
         //cv::Mat oCurrLabelingDisplay = getStereoDispMapDisplay(1,m_nPrimaryCamIdx);
         //if(oCurrLabelingDisplay.size().area()<640*480)
         //    cv::resize(oCurrLabelingDisplay,oCurrLabelingDisplay,cv::Size(),2,2,cv::INTER_NEAREST);
@@ -1428,7 +1738,6 @@ void SegmMatcher::GraphModelData::resetStereoLabelings() {
         //cv::waitKey(1);
         lvLog(4,"stereo-warp-init");
     }
-#endif //SEGMMATCH_CONFIG_USE_LAST_STEREO_INIT
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
         const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
         const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
@@ -1461,6 +1770,53 @@ void SegmMatcher::GraphModelData::resetStereoLabelings() {
     resetStereoLabelingByProjection(m_nPrimaryCamIdx^1u);
 }
 
+void SegmMatcher::GraphModelData::resetResegmLabelingsByWarping() {
+    lvDbgExceptionWatch;
+    lvDbgAssert(getTemporalLayerCount()>1u && m_nFramesProcessed>0u);
+    constexpr InternalLabelType nInvalidLabel = std::numeric_limits<InternalLabelType>::max();
+    cv::Mat_<InternalLabelType>& oWarpedLabeling = m_oInfWorkspace.oWarpedResegmLabeling;
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        cv::Mat_<InternalLabelType>& oCurrLabeling = m_aaResegmLabelings[0][nCamIdx];
+        lv::remap_offset(m_aaResegmLabelings[1][nCamIdx],oWarpedLabeling,m_avFeatures[0][FeatPackOffset*nCamIdx+FeatPackOffset_OptFlow],cv::INTER_NEAREST,cv::BORDER_CONSTANT,cv::Scalar::all(nInvalidLabel));
+        lvDbgAssert(oWarpedLabeling.isContinuous() && oCurrLabeling.isContinuous() && oWarpedLabeling.total()==oCurrLabeling.total());
+        for(size_t nNodeIdx=0; nNodeIdx<oCurrLabeling.total(); ++nNodeIdx) {
+            const InternalLabelType nWarpedLabel = ((InternalLabelType*)oWarpedLabeling.data)[nNodeIdx];
+            if(nWarpedLabel!=nInvalidLabel)
+                ((InternalLabelType*)oCurrLabeling.data)[nNodeIdx] = nWarpedLabel;
+        }
+        oCurrLabeling.setTo(s_nBackgroundLabelIdx,m_aROIs[nCamIdx]==0u);
+    }
+    lvLog(4,"resegm-warp-init");
+}
+
+void SegmMatcher::GraphModelData::updateDirtyNodeMaps() {
+    lvDbgExceptionWatch;
+    const bool bFullRefresh = !m_oParams.bUseIncrementalUpdates || m_nFramesProcessed==0u || getTemporalLayerCount()<2u;
+    size_t nDirtyNodes=0u,nTotNodes=0u;
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        cv::Mat_<uchar>& oDirtyMap = m_aDirtyNodeMaps[nCamIdx];
+        if(bFullRefresh) {
+            oDirtyMap.create(m_oGridSize);
+            oDirtyMap = uchar(255);
+            continue;
+        }
+        // pairwise weights are pixel-indexed (not flow-compensated), so they only change where the gradients at the same pixel changed
+        oDirtyMap.create(m_oGridSize);
+        oDirtyMap = uchar(0);
+        for(int nFeatOffset : {FeatPackOffset_GradY,FeatPackOffset_GradX,FeatPackOffset_GradMag}) {
+            const cv::Mat& oCurrGrad = m_avFeatures[0][FeatPackOffset*nCamIdx+nFeatOffset];
+            const cv::Mat& oPrevGrad = m_avFeatures[1][FeatPackOffset*nCamIdx+nFeatOffset];
+            lvDbgAssert(m_oGridSize==oCurrGrad.size && lv::MatInfo(oCurrGrad)==lv::MatInfo(oPrevGrad) && oCurrGrad.type()==CV_8UC1);
+            oDirtyMap |= (oCurrGrad!=oPrevGrad);
+        }
+        oDirtyMap &= m_aROIs[nCamIdx];
+        nDirtyNodes += (size_t)cv::countNonZero(oDirtyMap);
+        nTotNodes += (size_t)cv::countNonZero(m_aROIs[nCamIdx]);
+    }
+    if(!bFullRefresh)
+        lvLog_(3,"Incremental model update will refresh %d/%d dirty nodes.",(int)nDirtyNodes,(int)nTotNodes);
+}
+
 void SegmMatcher::GraphModelData::resetStereoLabelingByProjection(size_t nCamIdx) {
     lvDbgExceptionWatch;
     lvDbgAssert_(nCamIdx<getCameraCount(),"bad input cam index");
@@ -1548,6 +1904,161 @@ void SegmMatcher::GraphModelData::resetStereoLabelingByProjection(size_t nCamIdx
     }
 }
 
+void SegmMatcher::GraphModelData::computeStereoCandidateLabels() {
+    lvDbgExceptionWatch;
+    lvDbgAssert_(m_pStereoModel,"model must be initialized first!");
+    lvDbgAssert(m_nValidStereoGraphNodes==m_vStereoGraphIdxToMapIdxLUT.size());
+    lvDbgAssert((int)m_nRealStereoLabels==(int)m_nDontCareLabelIdx);
+    const int nRows=(int)m_oGridSize(0),nCols=(int)m_oGridSize(1);
+    const int nScale = (int)SEGMMATCH_DEFAULT_COARSE_GRID_SCALE;
+    const int nCoarseRows=(nRows+nScale-1)/nScale,nCoarseCols=(nCols+nScale-1)/nScale;
+    const size_t nCoarseNodes = size_t(nCoarseRows*nCoarseCols);
+    const size_t nRealLabels = m_nRealStereoLabels;
+    const size_t nStereoLabels = m_nStereoLabels;
+    lvAssert_(nScale>0 && SEGMMATCH_DEFAULT_COARSE_ICM_ITER>0u,"bad coarse inference params");
+    lvLog(4,"Running coarse stereo inference for move restriction...");
+    lv::StopWatch oLocalTimer;
+    // coarse unary costs are averaged over all valid nodes of each block, so they keep the same scale as full-res ones
+    std::vector<ValueType> vCoarseUnaryCosts(nCoarseNodes*nRealLabels,cost_cast(0));
+    std::vector<InternalLabelType> vCoarseLabeling(nCoarseNodes,m_nDontCareLabelIdx); // blocks without valid nodes keep the 'dont care' label
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nCoarseRowIdx=0; nCoarseRowIdx<nCoarseRows; ++nCoarseRowIdx) {
+        std::vector<int64_t> vCostSums(nRealLabels);
+        for(int nCoarseColIdx=0; nCoarseColIdx<nCoarseCols; ++nCoarseColIdx) {
+            std::fill(vCostSums.begin(),vCostSums.end(),int64_t(0));
+            int nValidNodes = 0;
+            for(int nRowIdx=nCoarseRowIdx*nScale; nRowIdx<std::min((nCoarseRowIdx+1)*nScale,nRows); ++nRowIdx) {
+                for(int nColIdx=nCoarseColIdx*nScale; nColIdx<std::min((nCoarseColIdx+1)*nScale,nCols); ++nColIdx) {
+                    const StereoNodeInfo& oNode = m_vStereoNodeMap[nRowIdx*nCols+nColIdx];
+                    if(oNode.bValidGraphNode) {
+                        const ValueType* pUnaryFuncData = m_pStereoUnaryFuncsDataBase+oNode.nGraphNodeIdx*nStereoLabels;
+                        for(size_t nLabelIdx=0; nLabelIdx<nRealLabels; ++nLabelIdx)
+                            vCostSums[nLabelIdx] += pUnaryFuncData[nLabelIdx];
+                        ++nValidNodes;
+                    }
+                }
+            }
+            if(nValidNodes>0) {
+                const size_t nCoarseNodeIdx = size_t(nCoarseRowIdx*nCoarseCols+nCoarseColIdx);
+                ValueType* pCoarseUnaryCosts = vCoarseUnaryCosts.data()+nCoarseNodeIdx*nRealLabels;
+                for(size_t nLabelIdx=0; nLabelIdx<nRealLabels; ++nLabelIdx)
+                    pCoarseUnaryCosts[nLabelIdx] = cost_cast(vCostSums[nLabelIdx]/nValidNodes);
+                vCoarseLabeling[nCoarseNodeIdx] = InternalLabelType(std::min_element(pCoarseUnaryCosts,pCoarseUnaryCosts+nRealLabels)-pCoarseUnaryCosts);
+            }
+        }
+    }
+    // coarse pairwise costs use the same (unweighted) label distance as the full-res base pairwise function
+    const int nMaxLabelDiff = SEGMMATCH_LBLSIM_STEREO_MAXDIFF_CST;
+    std::vector<ValueType> vCoarsePairwCosts(nRealLabels*nRealLabels);
+    for(size_t nLabelIdx1=0; nLabelIdx1<nRealLabels; ++nLabelIdx1) {
+        for(size_t nLabelIdx2=0; nLabelIdx2<nRealLabels; ++nLabelIdx2) {
+            const int nRealLabelDiff = std::min(std::abs((int)getRealLabel(InternalLabelType(nLabelIdx1))-(int)getRealLabel(InternalLabelType(nLabelIdx2))),nMaxLabelDiff);
+        #if SEGMMATCH_CONFIG_USE_SQR_LBL_DIFF_DIST
+            vCoarsePairwCosts[nLabelIdx1*nRealLabels+nLabelIdx2] = cost_cast(nRealLabelDiff*nRealLabelDiff*SEGMMATCH_LBLSIM_STEREO_SCALE_CST);
+        #else //!SEGMMATCH_CONFIG_USE_SQR_LBL_DIFF_DIST
+            vCoarsePairwCosts[nLabelIdx1*nRealLabels+nLabelIdx2] = cost_cast(nRealLabelDiff*SEGMMATCH_LBLSIM_STEREO_SCALE_CST);
+        #endif //!SEGMMATCH_CONFIG_USE_SQR_LBL_DIFF_DIST
+        }
+    }
+    // coarse grid is small enough for a few ICM sweeps (starting from the block-wise WTA solution) to converge
+    for(size_t nIterIdx=0; nIterIdx<SEGMMATCH_DEFAULT_COARSE_ICM_ITER; ++nIterIdx) {
+        size_t nChangedLabels = 0;
+        for(int nCoarseRowIdx=0; nCoarseRowIdx<nCoarseRows; ++nCoarseRowIdx) {
+            for(int nCoarseColIdx=0; nCoarseColIdx<nCoarseCols; ++nCoarseColIdx) {
+                const size_t nCoarseNodeIdx = size_t(nCoarseRowIdx*nCoarseCols+nCoarseColIdx);
+                if(vCoarseLabeling[nCoarseNodeIdx]>=nRealLabels)
+                    continue;
+                std::array<size_t,4> anNeighbLabels;
+                size_t nNeighbCount = 0;
+                if(nCoarseRowIdx>0 && vCoarseLabeling[nCoarseNodeIdx-nCoarseCols]<nRealLabels)
+                    anNeighbLabels[nNeighbCount++] = vCoarseLabeling[nCoarseNodeIdx-nCoarseCols];
+                if(nCoarseRowIdx<nCoarseRows-1 && vCoarseLabeling[nCoarseNodeIdx+nCoarseCols]<nRealLabels)
+                    anNeighbLabels[nNeighbCount++] = vCoarseLabeling[nCoarseNodeIdx+nCoarseCols];
+                if(nCoarseColIdx>0 && vCoarseLabeling[nCoarseNodeIdx-1]<nRealLabels)
+                    anNeighbLabels[nNeighbCount++] = vCoarseLabeling[nCoarseNodeIdx-1];
+                if(nCoarseColIdx<nCoarseCols-1 && vCoarseLabeling[nCoarseNodeIdx+1]<nRealLabels)
+                    anNeighbLabels[nNeighbCount++] = vCoarseLabeling[nCoarseNodeIdx+1];
+                const ValueType* pCoarseUnaryCosts = vCoarseUnaryCosts.data()+nCoarseNodeIdx*nRealLabels;
+                InternalLabelType nBestLabel = vCoarseLabeling[nCoarseNodeIdx];
+                int64_t nBestEnergy = std::numeric_limits<int64_t>::max();
+                for(size_t nLabelIdx=0; nLabelIdx<nRealLabels; ++nLabelIdx) {
+                    int64_t nCurrEnergy = pCoarseUnaryCosts[nLabelIdx];
+                    for(size_t nNeighbIdx=0; nNeighbIdx<nNeighbCount; ++nNeighbIdx)
+                        nCurrEnergy += vCoarsePairwCosts[nLabelIdx*nRealLabels+anNeighbLabels[nNeighbIdx]];
+                    if(nCurrEnergy<nBestEnergy || (nCurrEnergy==nBestEnergy && nLabelIdx==vCoarseLabeling[nCoarseNodeIdx])) {
+                        nBestEnergy = nCurrEnergy;
+                        nBestLabel = InternalLabelType(nLabelIdx);
+                    }
+                }
+                if(nBestLabel!=vCoarseLabeling[nCoarseNodeIdx]) {
+                    vCoarseLabeling[nCoarseNodeIdx] = nBestLabel;
+                    ++nChangedLabels;
+                }
+            }
+        }
+        if(nChangedLabels==0u)
+            break;
+    }
+    // full-res candidates are all labels within radius of the coarse solution in the node's block & its 8-connected neighbors (covers block-border discontinuities)
+    const int nLabelRadius = (int)SEGMMATCH_DEFAULT_COARSE_LBL_RADIUS;
+    const auto lCandLabelsMask = [&](const StereoNodeInfo& oNode, std::vector<uchar>& vbCandLabels) {
+        std::fill(vbCandLabels.begin(),vbCandLabels.end(),uchar(0));
+        const int nCoarseRowIdx=oNode.nRowIdx/nScale,nCoarseColIdx=oNode.nColIdx/nScale;
+        for(int nOffsetRowIdx=std::max(nCoarseRowIdx-1,0); nOffsetRowIdx<=std::min(nCoarseRowIdx+1,nCoarseRows-1); ++nOffsetRowIdx) {
+            for(int nOffsetColIdx=std::max(nCoarseColIdx-1,0); nOffsetColIdx<=std::min(nCoarseColIdx+1,nCoarseCols-1); ++nOffsetColIdx) {
+                const InternalLabelType nCoarseLabel = vCoarseLabeling[nOffsetRowIdx*nCoarseCols+nOffsetColIdx];
+                if(nCoarseLabel<nRealLabels)
+                    std::fill(vbCandLabels.begin()+std::max((int)nCoarseLabel-nLabelRadius,0),vbCandLabels.begin()+std::min((int)nCoarseLabel+nLabelRadius+1,(int)nRealLabels),uchar(1));
+            }
+        }
+    };
+    m_vStereoCandLabelOffsets.resize(m_nValidStereoGraphNodes+1u);
+    m_vStereoCandLabelOffsets[0] = 0u;
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+        static thread_local std::vector<uchar> s_vbCandLabels;
+        s_vbCandLabels.resize(nRealLabels);
+        lCandLabelsMask(m_vStereoNodeMap[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]],s_vbCandLabels);
+        m_vStereoCandLabelOffsets[nGraphNodeIdx+1u] = (size_t)std::count(s_vbCandLabels.begin(),s_vbCandLabels.end(),uchar(1));
+    }
+    std::partial_sum(m_vStereoCandLabelOffsets.begin(),m_vStereoCandLabelOffsets.end(),m_vStereoCandLabelOffsets.begin());
+    m_vStereoCandLabels.resize(m_vStereoCandLabelOffsets.back());
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+        static thread_local std::vector<uchar> s_vbCandLabels;
+        s_vbCandLabels.resize(nRealLabels);
+        lCandLabelsMask(m_vStereoNodeMap[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]],s_vbCandLabels);
+        InternalLabelType* pCandLabels = m_vStereoCandLabels.data()+m_vStereoCandLabelOffsets[nGraphNodeIdx];
+        for(size_t nLabelIdx=0; nLabelIdx<nRealLabels; ++nLabelIdx)
+            if(s_vbCandLabels[nLabelIdx])
+                *pCandLabels++ = InternalLabelType(nLabelIdx);
+        lvDbgAssert(pCandLabels==m_vStereoCandLabels.data()+m_vStereoCandLabelOffsets[nGraphNodeIdx+1u]);
+    }
+    // initial real labels outside the candidate set are snapped to the closest candidate, as moves only ever expand candidate labels (assocs are not thread-safe)
+    cv::Mat_<InternalLabelType>& oCurrStereoLabeling = m_aaStereoLabelings[0][m_nPrimaryCamIdx];
+    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+        const StereoNodeInfo& oNode = m_vStereoNodeMap[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]];
+        const InternalLabelType nOldLabel = oCurrStereoLabeling(oNode.nRowIdx,oNode.nColIdx);
+        const InternalLabelType* const pCandLabelsBeg = m_vStereoCandLabels.data()+m_vStereoCandLabelOffsets[nGraphNodeIdx];
+        const InternalLabelType* const pCandLabelsEnd = m_vStereoCandLabels.data()+m_vStereoCandLabelOffsets[nGraphNodeIdx+1u];
+        if(nOldLabel>=nRealLabels || pCandLabelsBeg==pCandLabelsEnd || std::binary_search(pCandLabelsBeg,pCandLabelsEnd,nOldLabel))
+            continue;
+        const InternalLabelType nNewLabel = *std::min_element(pCandLabelsBeg,pCandLabelsEnd,[&](InternalLabelType a, InternalLabelType b) {
+            return std::abs((int)a-(int)nOldLabel)<std::abs((int)b-(int)nOldLabel);
+        });
+        removeAssoc(oNode.nRowIdx,oNode.nColIdx,nOldLabel);
+        oCurrStereoLabeling(oNode.nRowIdx,oNode.nColIdx) = nNewLabel;
+        addAssoc(oNode.nRowIdx,oNode.nColIdx,nNewLabel);
+    }
+    lvLog_(4,"Coarse stereo inference & move restriction completed in %f second(s).",oLocalTimer.tock());
+}
+
 void SegmMatcher::GraphModelData::computeMedianLabelings(size_t nTargetCamIdx) {
     lvDbgExceptionWatch;
     lvDbgAssert_(m_pStereoModel,"model must be initialized first!");
@@ -1634,6 +2145,29 @@ void SegmMatcher::GraphModelData::computeOcclusionMaps(size_t nTargetCamIdx) {
     }
 }
 
+size_t SegmMatcher::GraphModelData::calcModelByteCount() const {
+    lvDbgExceptionWatch;
+    // note: solver-internal arenas (qpbo/ibfs) are not included, as they are not exposed by their interfaces
+    size_t nBytes = size_t(m_pStereoFuncsDataEnd-m_aStereoFuncsData.get())*sizeof(ValueType)+size_t(m_pResegmFuncsDataEnd-m_aResegmFuncsData.get())*sizeof(ValueType);
+    nBytes += m_vStereoNodeMap.capacity()*sizeof(StereoNodeInfo)+m_vResegmNodeMap.capacity()*sizeof(ResegmNodeInfo);
+    nBytes += (m_vStereoGraphIdxToMapIdxLUT.capacity()+m_vResegmGraphIdxToMapIdxLUT.capacity()+m_vStereoCandLabelOffsets.capacity())*sizeof(size_t);
+    nBytes += m_vStereoCandLabels.capacity()*sizeof(InternalLabelType);
+    const auto lMatBytes = [](const cv::Mat& oMat) {
+        return oMat.empty()?size_t(0):oMat.total()*oMat.elemSize();
+    };
+    for(const cv::Mat& oMat : std::initializer_list<cv::Mat>{m_oSuperStackedStereoLabeling,m_oSuperStackedResegmLabeling,m_oInitSuperStackedResegmLabeling,
+                                                            m_oAssocCounts,m_oAssocMap,m_oStereoUnaryCosts,m_oResegmUnaryCosts,m_oStereoMoveMask,m_oStereoVoteMap,
+                                                            m_oStereoDualMap,m_oStereoHeightMap,m_oResegmDualMap,m_oResegmHeightMap,
+                                                            m_oInfWorkspace.oPreStereoUpdateLabeling,m_oInfWorkspace.oPreResegmUpdateLabeling,m_oInfWorkspace.oWarpedResegmLabeling})
+        nBytes += lMatBytes(oMat);
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+        nBytes += lMatBytes(m_aStackedInputImages[nCamIdx])+lMatBytes(m_aStackedInputMasks[nCamIdx])+lMatBytes(m_aGMMCompAssignMap[nCamIdx])+lMatBytes(m_aDirtyNodeMaps[nCamIdx]);
+    for(size_t nLayerIdx=0; nLayerIdx<getTemporalLayerCount(); ++nLayerIdx)
+        for(const cv::Mat& oFeature : m_avFeatures[nLayerIdx])
+            nBytes += lMatBytes(oFeature);
+    return nBytes;
+}
+
 void SegmMatcher::GraphModelData::buildResegmModel() {
     lvLog(2,"\tadding base functions to resegm graph...");
     // reserves on graph created below need to be accurate (or larger than needed), otherwise function vectors will be reallocated, and pointers will be bad
@@ -1727,6 +2261,7 @@ void SegmMatcher::GraphModelData::buildResegmModel() {
             ResegmNodeInfo& oBaseNode = m_vResegmNodeMap[nBaseLUTNodeIdx];
             lvDbgAssert(oBaseNode.bValidGraphNode);
             oBaseNode.oTemporalClique = {};
+            oBaseNode.anTemporalCliqueDiffs.fill(uchar(0));
             if(oBaseNode.nLayerIdx!=(nTemporalLayerCount-1u) || (oBaseNode.nRowIdx%s_nTemporalCliqueStride) || (oBaseNode.nColIdx%s_nTemporalCliqueStride))
                 continue;
             std::vector<size_t> vnLUTNodeIdxs(1,nBaseLUTNodeIdx),vnGraphNodeIdxs(1,nGraphNodeIdx);
@@ -1954,7 +2489,6 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
             ((double*)aBGDistMap[nCamIdx].data)[nStackedIdx] = fCurrBGDist;
         }
     }
-    std::atomic_size_t nCliqueIdx{0};
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
         const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
         ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
@@ -1998,17 +2532,8 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
                             vPairwResegmLUT(nLabelIdx1,nLabelIdx2) = cost_cast((nLabelIdx1^nLabelIdx2)*fScaleFact*SEGMMATCH_LBLSIM_RESEGM_SCALE_CST);
                         }
                     }
-                    if(bInit) {
-                        oNode.vpCliques.push_back(&oPairwClique);
-                    #if USING_OPENMP
-                        #pragma omp critical
-                    #endif //USING_OPENMP
-                        {
-                            const size_t nCurrCliqueIdx = nCliqueIdx++;
-                            for(size_t nPairIdx=0; nPairIdx<2u; ++nPairIdx)
-                                m_vResegmNodeMap[oPairwClique.m_anLUTNodeIdxs[nPairIdx]].vCliqueMemberLUT.push_back(std::make_pair(nCurrCliqueIdx,nPairIdx));
-                        }
-                    }
+                    if(bInit)
+                        oNode.vpCliques.push_back(&oPairwClique); // member LUTs are rebuilt below once all cliques are known
                 }
             }
         }
@@ -2032,25 +2557,19 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
                             vPairwResegmLUT(nLabelIdx1,nLabelIdx2) = cost_cast((nLabelIdx1^nLabelIdx2)*fLocalScaleFact*SEGMMATCH_LBLSIM_RESEGM_SCALE_CST);
                         }
                     }
-                    if(bInit) {
-                        oNode.vpCliques.push_back(&oPairwClique);
-                    #if USING_OPENMP
-                        #pragma omp critical
-                    #endif //USING_OPENMP
-                        {
-                            const size_t nCurrCliqueIdx = nCliqueIdx++;
-                            for(size_t nPairIdx=0; nPairIdx<2u; ++nPairIdx)
-                                m_vResegmNodeMap[oPairwClique.m_anLUTNodeIdxs[nPairIdx]].vCliqueMemberLUT.push_back(std::make_pair(nCurrCliqueIdx,nPairIdx));
-                        }
-                    }
+                    if(bInit)
+                        oNode.vpCliques.push_back(&oPairwClique); // member LUTs are rebuilt below once all cliques are known
                 }
             }
         }
     }
 #if SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
     if(bInit && nTemporalLayerCount>1u && m_nFramesProcessed>=(nTemporalLayerCount-1u)) {
+        // flow & temporal diff features do not change within a frame, so cliques built in an earlier resegm pass can be kept as-is
+        const bool bTemporalCliquesUpToDate = (m_nTemporalCliquesFrameIdx==m_nFramesProcessed);
+        size_t nRefreshedTemporalCliques = 0u;
     #if USING_OPENMP
-        #pragma omp parallel for
+        #pragma omp parallel for reduction(+:nRefreshedTemporalCliques)
     #endif //USING_OPENMP
         for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
             const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
@@ -2070,6 +2589,7 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
                 lvDbgAssert(nLUTNodeIdx>=(nCamIdx*nTemporalLayerCount+nTemporalLayerCount-1)*nLayerSize);
                 lvDbgAssert(nRowIdx*nCols+nColIdx+int(((nCamIdx+1)*nTemporalLayerCount-1)*nLayerSize)==int(nLUTNodeIdx));
                 lvDbgAssert(s_nTemporalCliqueEdges==nTemporalLayerCount-1u);
+                const bool bWasValid = oTemporalClique.m_bValid;
                 oTemporalClique.m_bValid = true; // temporary assignment, may be revoked by checks below
                 const size_t nOldestLayer = nTemporalLayerCount-1u;
                 for(size_t nOffsetLayerIdx=1; nOffsetLayerIdx<nTemporalLayerCount; ++nOffsetLayerIdx) {
@@ -2106,20 +2626,24 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
                     }
                 }
                 if(oTemporalClique.m_bValid) {
+                    oNode.vpCliques.push_back(&oTemporalClique); // member LUTs are rebuilt below once all cliques are known
                     std::reverse(vnMapIdxs.begin(),vnMapIdxs.end());
-                    std::reverse_copy(vnLUTNodeIdxs.begin(),vnLUTNodeIdxs.end(),oTemporalClique.m_anLUTNodeIdxs.begin());
-                    std::reverse_copy(vnGraphNodeIdxs.begin(),vnGraphNodeIdxs.end(),oTemporalClique.m_anGraphNodeIdxs.begin());
+                    std::reverse(vnLUTNodeIdxs.begin(),vnLUTNodeIdxs.end());
+                    std::reverse(vnGraphNodeIdxs.begin(),vnGraphNodeIdxs.end());
+                    const bool bSameCliqueNodes = bWasValid && std::equal(vnLUTNodeIdxs.begin(),vnLUTNodeIdxs.end(),oTemporalClique.m_anLUTNodeIdxs.begin());
+                    std::array<uchar,s_nTemporalCliqueEdges> anCurrTemporalDiffs;
+                    for(size_t nOffsetLayerIdx=1; nOffsetLayerIdx<nTemporalLayerCount; ++nOffsetLayerIdx)
+                        anCurrTemporalDiffs[nOffsetLayerIdx-1u] = aaTempDiff[nCamIdx][nOffsetLayerIdx-1u].data[vnMapIdxs[nOffsetLayerIdx]];
+                    // cliques linking the same nodes keep their energy terms unless the temporal diffs they were filled with have changed
+                    const bool bSameCliqueDiffs = bSameCliqueNodes && anCurrTemporalDiffs==oNode.anTemporalCliqueDiffs;
+                    if(bSameCliqueNodes && !bDisplayDbgMaps && (bTemporalCliquesUpToDate || (m_oParams.bUseIncrementalUpdates && bSameCliqueDiffs)))
+                        continue;
+                    oNode.anTemporalCliqueDiffs = anCurrTemporalDiffs;
+                    ++nRefreshedTemporalCliques;
+                    std::copy(vnLUTNodeIdxs.begin(),vnLUTNodeIdxs.end(),oTemporalClique.m_anLUTNodeIdxs.begin());
+                    std::copy(vnGraphNodeIdxs.begin(),vnGraphNodeIdxs.end(),oTemporalClique.m_anGraphNodeIdxs.begin());
                     m_pResegmModel->setFactorVariables(oTemporalClique.m_nGraphFactorId,oTemporalClique.m_anGraphNodeIdxs.begin(),oTemporalClique.m_anGraphNodeIdxs.end());
                     lvDbgAssert(m_pResegmModel->operator[](oTemporalClique.m_nGraphFactorId).numberOfVariables()==nTemporalLayerCount);
-                    oNode.vpCliques.push_back(&oTemporalClique);
-                #if USING_OPENMP
-                    #pragma omp critical
-                #endif //USING_OPENMP
-                    {
-                        const size_t nCurrCliqueIdx = nCliqueIdx++;
-                        for(size_t nOffsetLayerIdx=0; nOffsetLayerIdx<nTemporalLayerCount; ++nOffsetLayerIdx)
-                            m_vResegmNodeMap[vnLUTNodeIdxs[nOffsetLayerIdx]].vCliqueMemberLUT.push_back(std::make_pair(nCurrCliqueIdx,nOffsetLayerIdx));
-                    }
                     ExplicitFunction& vTemporalResegmLUT = *(ExplicitFunction*)oTemporalClique.m_pGraphFunctionPtr;
                     lvDbgAssert(vTemporalResegmLUT.dimension()==oTemporalClique.getSize() && vTemporalResegmLUT.size()==std::pow(s_nResegmLabels,oTemporalClique.getSize()));
                     lvDbgAssert(&vTemporalResegmLUT(0)<m_pResegmFuncsDataEnd && vTemporalResegmLUT.strides(0)==1 && vTemporalResegmLUT.strides(1)==s_nResegmLabels); // expect last-idx-major
@@ -2156,10 +2680,27 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
                 }
             }
         }
-        m_pResegmModel->finalize(); // needed due to possible temporal clique updates
+        if(nRefreshedTemporalCliques>0u)
+            m_pResegmModel->finalize(); // needed due to possible temporal clique updates
+        m_nTemporalCliquesFrameIdx = m_nFramesProcessed;
+        lvLog_(4,"Refreshed %d resegm temporal cliques.",(int)nRefreshedTemporalCliques);
     }
 #endif //SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
-    lvDbgAssert(nCliqueIdx<=m_nResegmCliqueCount);
+    if(bInit) {
+        // clique membership is assigned serially in the same node-major order used to index cliques in the primal-dual setup
+        size_t nCliqueIdx = 0u;
+        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
+            const ResegmNodeInfo& oNode = m_vResegmNodeMap[m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx]];
+            for(const Clique* pClique : oNode.vpCliques) {
+                const IndexType nCliqueSize = pClique->getSize();
+                const IndexType* aLUTNodeIdxs = pClique->getLUTNodeIter();
+                for(IndexType nDimIdx=0; nDimIdx<nCliqueSize; ++nDimIdx)
+                    m_vResegmNodeMap[aLUTNodeIdxs[nDimIdx]].vCliqueMemberLUT.push_back(std::make_pair(IndexType(nCliqueIdx),nDimIdx));
+                ++nCliqueIdx;
+            }
+        }
+        lvDbgAssert(nCliqueIdx<=m_nResegmCliqueCount);
+    }
     if(bDisplayDbgMaps) {
         for(size_t nCamIdx=0; nCamIdx<nCameraCount; ++nCamIdx) {
             cv::normalize(aFGLogProbMap[nCamIdx],aFGLogProbMap[nCamIdx],1,0,cv::NORM_MINMAX);
@@ -2219,11 +2760,15 @@ void SegmMatcher::GraphModelData::calcFeatures(const MatArrayIn& aInputs, cv::Ma
         lvAssert__(oInputMask.dims==2 && m_oGridSize==oInputMask.size(),"input mask in array at index=%d had the wrong size",(int)nCamIdx);
         lvAssert_(oInputMask.type()==CV_8UC1,"unexpected input mask type");
     }
-    m_vTempFeatures.resize(FeatPackSize); // if this function was not called externally, features will be swapped from this temporary to the internal array
-    calcImageFeatures(CamArray<cv::Mat>{aInputs[InputPack_LeftImg],aInputs[InputPack_RightImg]},m_vTempFeatures);
-    calcShapeFeatures(CamArray<cv::Mat_<InternalLabelType>>{aInputs[InputPack_LeftMask],aInputs[InputPack_RightMask]},m_vTempFeatures);
-    for(cv::Mat& oFeatMap : m_vTempFeatures)
-        lvAssert_(oFeatMap.isContinuous(),"internal func used non-continuous data block for feature maps");
+    CamArray<cv::Mat> aPrevInputImages;
+    if(getTemporalLayerCount()>1u && m_nFramesProcessed>0u) {
+        for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+            const size_t nInputImgIdx = nCamIdx*InputPackOffset+InputPackOffset_Img;
+            // if called from 'apply', inputs were already slid into the latest temporal layer
+            aPrevInputImages[nCamIdx] = m_aaInputs[(aInputs[nInputImgIdx].data==m_aaInputs[0][nInputImgIdx].data)?1:0][nInputImgIdx];
+        }
+    }
+    calcFeatures(*m_pFeatExtractionCtx,aInputs,aPrevInputImages,m_vTempFeatures); // if this function was not called externally, features will be swapped from this temporary to the internal array
     if(pFeaturesPacket)
         *pFeaturesPacket = lv::packData(m_vTempFeatures,&m_vLatestFeatPackInfo);
     else { // fill pack info manually
@@ -2236,7 +2781,43 @@ void SegmMatcher::GraphModelData::calcFeatures(const MatArrayIn& aInputs, cv::Ma
     lvAssert_(m_vLatestFeatPackInfo==m_vExpectedFeatPackInfo,"packed features info mismatch (should stay constant for all inputs)");
 }
 
-void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aInputImages, std::vector<cv::Mat>& vFeatures) {
+void SegmMatcher::GraphModelData::calcFeatures(FeatureExtractionContext& oCtx, const MatArrayIn& aInputs, const CamArray<cv::Mat>& aPrevInputImages, std::vector<cv::Mat>& vFeatures) {
+    lvDbgExceptionWatch;
+    vFeatures.resize(FeatPackSize);
+    calcImageFeatures(oCtx,CamArray<cv::Mat>{aInputs[InputPack_LeftImg],aInputs[InputPack_RightImg]},aPrevInputImages,vFeatures);
+    calcShapeFeatures(oCtx,CamArray<cv::Mat_<InternalLabelType>>{aInputs[InputPack_LeftMask],aInputs[InputPack_RightMask]},vFeatures);
+    for(cv::Mat& oFeatMap : vFeatures)
+        lvAssert_(oFeatMap.isContinuous(),"internal func used non-continuous data block for feature maps");
+}
+
+template<typename TCamTask>
+void SegmMatcher::GraphModelData::execPerCamera(FeatureExtractionContext& oCtx, TCamTask&& lCamTask) {
+    if(lv::getVerbosity()>=4 && oCtx.bAllowDisplay) {
+        // display calls (cv::imshow & co.) must stay on the calling thread
+        for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+            lCamTask(nCamIdx);
+        return;
+    }
+    // pool workers are not part of any OpenMP team, so extractors keep their inner parallel loops
+    std::array<std::future<void>,getCameraCount()-1> afCamTasks;
+    for(size_t nCamIdx=1; nCamIdx<getCameraCount(); ++nCamIdx)
+        afCamTasks[nCamIdx-1] = oCtx.oCamWorkerPool.queueTask(lCamTask,nCamIdx);
+    try {
+        lCamTask(size_t(0));
+    }
+    catch(...) {
+        // tasks still reference the caller's stack; wait for them before unwinding
+        for(std::future<void>& fCamTask : afCamTasks)
+            fCamTask.wait();
+        throw;
+    }
+    for(std::future<void>& fCamTask : afCamTasks)
+        fCamTask.wait();
+    for(std::future<void>& fCamTask : afCamTasks)
+        fCamTask.get();
+}
+
+void SegmMatcher::GraphModelData::calcImageFeatures(FeatureExtractionContext& oCtx, const CamArray<cv::Mat>& aInputImages, const CamArray<cv::Mat>& aPrevInputImages, std::vector<cv::Mat>& vFeatures) {
     static_assert(getCameraCount()==2,"bad input image array size");
     lvDbgExceptionWatch;
     for(size_t nInputIdx=0; nInputIdx<aInputImages.size(); ++nInputIdx) {
@@ -2246,51 +2827,12 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
     lvDbgAssert_(vFeatures.size()==FeatPackSize,"unexpected feat vec size");
     const int nRows=(int)m_oGridSize(0),nCols=(int)m_oGridSize(1);
     lvLog(3,"Calculating image features maps...");
-    const int nWinRadius = (int)m_nGridBorderSize;
-    const int nWinSize = nWinRadius*2+1;
-    CamArray<cv::Mat> aEnlargedInput;
-#if SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-    lvIgnore(nWinSize);
-    CamArray<cv::Mat_<float>> aEnlargedDescs,aDescs;
-    const int nPatchSize = SEGMMATCH_DEFAULT_DESC_PATCH_SIZE;
-#else //!SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-    CamArray<cv::Mat_<uchar>> aEnlargedROIs;
-    const int nPatchSize = nWinSize;
-#endif //SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-    lvAssert_((nPatchSize%2)==1,"patch sizes must be odd");
+    lvDbgAssert(oCtx.pImgAffinity && size_t(oCtx.pImgAffinity->getBorderSize())==m_nGridBorderSize);
     lv::StopWatch oLocalTimer;
-#if USING_OPENMP
-    //#pragma omp parallel for num_threads(getCameraCount())
-#endif //USING_OPENMP
-    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
-        cv::copyMakeBorder(aInputImages[nCamIdx],aEnlargedInput[nCamIdx],nWinRadius,nWinRadius,nWinRadius,nWinRadius,cv::BORDER_DEFAULT);
-    #if SEGMMATCH_CONFIG_USE_MI_AFFINITY
-        if(aEnlargedInput[nCamIdx].channels()==3)
-            cv::cvtColor(aEnlargedInput[nCamIdx],aEnlargedInput[nCamIdx],cv::COLOR_BGR2GRAY);
-        cv::copyMakeBorder(m_aROIs[nCamIdx],aEnlargedROIs[nCamIdx],nWinRadius,nWinRadius,nWinRadius,nWinRadius,cv::BORDER_CONSTANT,cv::Scalar(0));
-    #elif SEGMMATCH_CONFIG_USE_SSQDIFF_AFFINITY
-        if(aEnlargedInput[nCamIdx].channels()==3)
-            cv::cvtColor(aEnlargedInput[nCamIdx],aEnlargedInput[nCamIdx],cv::COLOR_BGR2GRAY);
-        aEnlargedInput[nCamIdx].convertTo(aEnlargedInput[nCamIdx],CV_64F,(1.0/UCHAR_MAX)/nWinSize);
-        aEnlargedInput[nCamIdx] -= cv::mean(aEnlargedInput[nCamIdx])[0];
-        cv::copyMakeBorder(m_aROIs[nCamIdx],aEnlargedROIs[nCamIdx],nWinRadius,nWinRadius,nWinRadius,nWinRadius,cv::BORDER_CONSTANT,cv::Scalar(0));
-    #elif SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-        lvLog_(3,"\tcam[%d] image descriptors...",(int)nCamIdx);
-        m_pImgDescExtractor->compute2(aEnlargedInput[nCamIdx],aEnlargedDescs[nCamIdx]);
-        lvDbgAssert(aEnlargedDescs[nCamIdx].dims==3 && aEnlargedDescs[nCamIdx].size[0]==nRows+nWinRadius*2 && aEnlargedDescs[nCamIdx].size[1]==nCols+nWinRadius*2);
-        std::vector<cv::Range> vRanges(size_t(3),cv::Range::all());
-        vRanges[0] = cv::Range(nWinRadius,nRows+nWinRadius);
-        vRanges[1] = cv::Range(nWinRadius,nCols+nWinRadius);
-        aEnlargedDescs[nCamIdx](vRanges.data()).copyTo(aDescs[nCamIdx]); // copy to avoid bugs when reshaping non-continuous data
-        lvDbgAssert(aDescs[nCamIdx].dims==3 && aDescs[nCamIdx].size[0]==nRows && aDescs[nCamIdx].size[1]==nCols);
-        lvDbgAssert(std::equal(aDescs[nCamIdx].ptr<float>(0,0),aDescs[nCamIdx].ptr<float>(0,0)+aDescs[nCamIdx].size[2],aEnlargedDescs[nCamIdx].ptr<float>(nWinRadius,nWinRadius)));
-    #if SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS
-        const size_t nDescSize = size_t(aDescs[nCamIdx].size[2]);
-        for(size_t nDescIdx=0; nDescIdx<aDescs[nCamIdx].total(); nDescIdx+=nDescSize)
-            lv::rootSIFT(((float*)aDescs[nCamIdx].data)+nDescIdx,nDescSize);
-    #endif //SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS
-    #endif //SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-        lvLog_(3,"\tcam[%d] image gradient magnitudes...",(int)nCamIdx);
+    CamArray<double> adCamFeatTimes;
+    execPerCamera(oCtx,[&](size_t nCamIdx) {
+        lv::StopWatch oCamTimer;
+        oCtx.pImgAffinity->prepare(nCamIdx,aInputImages[nCamIdx],m_aROIs[nCamIdx]);
         cv::Mat oBlurredInput,oGrayInput;
         cv::GaussianBlur(aInputImages[nCamIdx],oBlurredInput,cv::Size(3,3),0);
         cv::Mat oBlurredGrayInput;
@@ -2322,12 +2864,8 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
         cv::Mat& oTempDiff = vFeatures[nCamIdx*FeatPackOffset+FeatPackOffset_TempDiff];
         oOptFlow.create(m_oGridSize,CV_32FC2);
         oTempDiff.create(m_oGridSize,CV_8UC1);
-        if(getTemporalLayerCount()>1u && m_nFramesProcessed>0u) {
-            cv::Mat oPreviousInput;
-            if(aInputImages[nCamIdx].data==m_aaInputs[0][nCamIdx*InputPackOffset+InputPackOffset_Img].data)
-                oPreviousInput = m_aaInputs[1][nCamIdx*InputPackOffset+InputPackOffset_Img];
-            else
-                oPreviousInput = m_aaInputs[0][nCamIdx*InputPackOffset+InputPackOffset_Img];
+        if(!aPrevInputImages[nCamIdx].empty()) {
+            const cv::Mat& oPreviousInput = aPrevInputImages[nCamIdx];
             lvDbgAssert(lv::MatInfo(aInputImages[nCamIdx])==lv::MatInfo(oPreviousInput));
             ofdis::computeFlow(oPreviousInput,aInputImages[nCamIdx],oOptFlow);
             lvDbgAssert(m_oGridSize==oOptFlow.size && oOptFlow.type()==CV_32FC2);
@@ -2341,7 +2879,7 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
             lv::computeTemporalAbsDiff(oPreviousGrayInput,oGrayInput,oOptFlow,oTempDiff_32f);
             oTempDiff_32f.convertTo(oTempDiff,CV_8U);
             lvDbgAssert(m_oGridSize==oTempDiff.size && oTempDiff.data==vFeatures[nCamIdx*FeatPackOffset+FeatPackOffset_TempDiff].data);
-            if(lv::getVerbosity()>=4) {
+            if(lv::getVerbosity()>=4 && oCtx.bAllowDisplay) {
                 cv::imshow(std::string("oOptFlow-")+std::to_string(nCamIdx),lv::getFlowColorMap(oOptFlow));
                 cv::imshow(std::string("oTempDiff-")+std::to_string(nCamIdx),oTempDiff);
                 cv::Mat oInputRemap;
@@ -2354,7 +2892,10 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
             oOptFlow = cv::Vec2f(0.0f,0.0f);
             oTempDiff = 0u;
         }
-    }
+        adCamFeatTimes[nCamIdx] = oCamTimer.tock();
+    });
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) // logged after the join to keep output order deterministic
+        lvLog_(3,"\tcam[%d] image descriptors/gradients/flow computed in %f second(s).",(int)nCamIdx,adCamFeatTimes[nCamIdx]);
     lvLog_(3,"Image features maps computed in %f second(s).",oLocalTimer.tock());
     lvLog(3,"Calculating image affinity map...");
     const std::array<int,3> anAffinityMapDims = {nRows,nCols,(int)m_nRealStereoLabels};
@@ -2364,56 +2905,20 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
     for(InternalLabelType nLabelIdx = 0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx)
         vDisparityOffsets.push_back(getOffsetValue(0,nLabelIdx));
     // note: we only create the dense affinity map for 1st cam here; affinity for 2nd cam will be deduced from it
-#if SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-    lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oAffinity,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1]);
-    /*cv::Mat_<float> tmp;
-    lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,tmp,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1],cv::Mat_<float>(),false);
-    lvAssert(lv::MatInfo(tmp)==lv::MatInfo(oAffinity));
-    for(int i=0; i<nRows; ++i)
-        for(int j=0; j<nCols; ++j)
-            for(int k=0; k<anAffinityMapDims[2]; ++k)
-                    lvAssert__(std::abs(tmp(i,j,k)-oAffinity(i,j,k))<0.0001f," %d,%d,%d =  %f vs %f,   w/ roi0 = %d",i,j,k,tmp(i,j,k),oAffinity(i,j,k),(int)m_aROIs[0](i,j));*/
-#elif SEGMMATCH_CONFIG_USE_MI_AFFINITY
-    lv::computeImageAffinity(aEnlargedInput[0],aEnlargedInput[1],nWinSize,oAffinity,vDisparityOffsets,lv::AffinityDist_MI,aEnlargedROIs[0],aEnlargedROIs[1]);
-#elif SEGMMATCH_CONFIG_USE_SSQDIFF_AFFINITY
-    lv::computeImageAffinity(aEnlargedInput[0],aEnlargedInput[1],nWinSize,oAffinity,vDisparityOffsets,lv::AffinityDist_SSD,aEnlargedROIs[0],aEnlargedROIs[1]);
-#endif //SEGMMATCH_CONFIG_USE_..._AFFINITY
+    oCtx.pImgAffinity->computeAffinity(vDisparityOffsets,m_aROIs,oAffinity);
     lvDbgAssert(lv::MatInfo(oAffinity)==lv::MatInfo(lv::MatSize(3,anAffinityMapDims.data()),CV_32FC1));
     lvDbgAssert(vFeatures[FeatPack_ImgAffinity].data==oAffinity.data);
     lvLog_(3,"Image affinity map computed in %f second(s).",oLocalTimer.tock());
     lvLog(3,"Calculating image saliency map...");
     vFeatures[FeatPack_ImgSaliency].create(2,anAffinityMapDims.data(),CV_32FC1);
     cv::Mat_<float> oSaliency = vFeatures[FeatPack_ImgSaliency];
-    oSaliency = 0.0f; // default value for OOB pixels
-    std::vector<float> vValidAffinityVals;
-    vValidAffinityVals.reserve(m_nRealStereoLabels);
-    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
-        const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
-        const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
-        const int nRowIdx = oNode.nRowIdx;
-        const int nColIdx = oNode.nColIdx;
-        lvDbgAssert(oNode.bValidGraphNode && m_aROIs[m_nPrimaryCamIdx](nRowIdx,nColIdx)>0);
-        vValidAffinityVals.resize(0);
-        const float* pAffinityPtr = oAffinity.ptr<float>(nRowIdx,nColIdx);
-        std::copy_if(pAffinityPtr,pAffinityPtr+m_nRealStereoLabels,std::back_inserter(vValidAffinityVals),[](float v){return v>=0.0f;});
-        const float fCurrDistSparseness = vValidAffinityVals.size()>1?(float)lv::sparseness(vValidAffinityVals.data(),vValidAffinityVals.size()):0.0f;
-#if SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-        const float fCurrDescSparseness = (float)lv::sparseness(aDescs[m_nPrimaryCamIdx].ptr<float>(nRowIdx,nColIdx),size_t(aDescs[m_nPrimaryCamIdx].size[2]));
-        oSaliency.at<float>(nRowIdx,nColIdx) = std::max(fCurrDescSparseness,fCurrDistSparseness);
-#else //!SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-        oSaliency.at<float>(nRowIdx,nColIdx) = fCurrDistSparseness;
-#endif //!SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-    }
-    cv::normalize(oSaliency,oSaliency,1,0,cv::NORM_MINMAX,-1,m_aROIs[m_nPrimaryCamIdx]);
-    lvDbgExec( // cv::normalize leftover fp errors are sometimes awful; need to 0-max when using map
+    calcSaliencyMap(oAffinity,oCtx.pImgAffinity->getDescs(m_nPrimaryCamIdx),cv::Mat_<float>(),oSaliency);
+    lvDbgExec( // normalization leftover fp errors might still be present; need to 0-max when using map
         for(int nRowIdx=0; nRowIdx<oSaliency.rows; ++nRowIdx)
             for(int nColIdx=0; nColIdx<oSaliency.cols; ++nColIdx)
                 lvDbgAssert((oSaliency.at<float>(nRowIdx,nColIdx)>=-1e-6f && oSaliency.at<float>(nRowIdx,nColIdx)<=1.0f+1e-6f) || m_aROIs[m_nPrimaryCamIdx](nRowIdx,nColIdx)==0);
     );
-#if SEGMMATCH_CONFIG_USE_SALIENT_MAP_BORDR
-    cv::multiply(oSaliency,cv::Mat_<float>(oSaliency.size(),1.0f).setTo(0.5f,m_aDescROIs[m_nPrimaryCamIdx]==0),oSaliency);
-#endif //SEGMMATCH_CONFIG_USE_SALIENT_MAP_BORDR
-    if(lv::getVerbosity()>=4) {
+    if(lv::getVerbosity()>=4 && oCtx.bAllowDisplay) {
         cv::imshow("oSaliency_img",oSaliency);
         cv::waitKey(1);
     }
@@ -2426,7 +2931,7 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
     }*/
 }
 
-void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<InternalLabelType>>& aInputMasks, std::vector<cv::Mat>& vFeatures) {
+void SegmMatcher::GraphModelData::calcShapeFeatures(FeatureExtractionContext& oCtx, const CamArray<cv::Mat_<InternalLabelType>>& aInputMasks, std::vector<cv::Mat>& vFeatures) {
     static_assert(getCameraCount()==2,"bad input mask array size");
     lvDbgExceptionWatch;
     for(size_t nInputIdx=0; nInputIdx<aInputMasks.size(); ++nInputIdx) {
@@ -2440,22 +2945,19 @@ void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<Inte
     const int nPatchSize = SEGMMATCH_DEFAULT_DESC_PATCH_SIZE;
     lvAssert_((nPatchSize%2)==1,"patch sizes must be odd");
     lv::StopWatch oLocalTimer;
-#if USING_OPENMP
-    //#pragma omp parallel for num_threads(getCameraCount())
-#endif //USING_OPENMP
-    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+    CamArray<double> adCamFeatTimes;
+    execPerCamera(oCtx,[&](size_t nCamIdx) {
+        lv::StopWatch oCamTimer;
         const cv::Mat& oInputMask = aInputMasks[nCamIdx];
-        lvLog_(3,"\tcam[%d] shape descriptors...",(int)nCamIdx);
-        m_pShpDescExtractor->compute2(oInputMask,aDescs[nCamIdx]);
+        oCtx.apShpDescExtractors[nCamIdx]->compute2(oInputMask,aDescs[nCamIdx]);
         lvDbgAssert(aDescs[nCamIdx].dims==3 && aDescs[nCamIdx].size[0]==nRows && aDescs[nCamIdx].size[1]==nCols);
-    #if SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS
-        const size_t nDescSize = size_t(aDescs[nCamIdx].size[2]);
-        for(size_t nDescIdx=0; nDescIdx<aDescs[nCamIdx].total(); nDescIdx+=nDescSize)
-            lv::rootSIFT(((float*)aDescs[nCamIdx].data)+nDescIdx,nDescSize);
-    #endif //SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS
-        lvLog_(3,"\tcam[%d] shape distance fields...",(int)nCamIdx);
+        if(m_oParams.bUseRootSIFTDescs)
+            applyRootSIFT(aDescs[nCamIdx]);
         calcShapeDistFeatures(aInputMasks[nCamIdx],nCamIdx,vFeatures);
-    }
+        adCamFeatTimes[nCamIdx] = oCamTimer.tock();
+    });
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) // logged after the join to keep output order deterministic
+        lvLog_(3,"\tcam[%d] shape descriptors/distance fields computed in %f second(s).",(int)nCamIdx,adCamFeatTimes[nCamIdx]);
     lvLog_(3,"Shape features maps computed in %f second(s).",oLocalTimer.tock());
     lvLog(3,"Calculating shape affinity map...");
     const std::array<int,3> anAffinityMapDims = {nRows,nCols,(int)m_nRealStereoLabels};
@@ -2464,48 +2966,28 @@ void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<Inte
     std::vector<int> vDisparityOffsets;
     for(InternalLabelType nLabelIdx = 0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx)
         vDisparityOffsets.push_back(getOffsetValue(0,nLabelIdx));
-#if SEGMMATCH_CONFIG_USE_SHAPE_EMD_AFFIN
-    lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oAffinity,vDisparityOffsets,lv::AffinityDist_EMD,m_aROIs[0],m_aROIs[1],m_pShpDescExtractor->getEMDCostMap());
-#else //!SEGMMATCH_CONFIG_USE_SHAPE_EMD_AFFIN
-    lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oAffinity,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1]);
-#endif //!SEGMMATCH_CONFIG_USE_SHAPE_EMD_AFFIN
+    if(m_oParams.bUseShapeEMDAffinity)
+        lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oAffinity,vDisparityOffsets,m_oParams.bUseApproxShapeEMD?lv::AffinityDist_EMDTree:lv::AffinityDist_EMD,m_aROIs[0],m_aROIs[1],oCtx.apShpDescExtractors[0]->getEMDCostMap());
+    else
+        lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oAffinity,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1]);
     lvDbgAssert(lv::MatInfo(oAffinity)==lv::MatInfo(lv::MatSize(3,anAffinityMapDims.data()),CV_32FC1));
     lvDbgAssert(vFeatures[FeatPack_ShpAffinity].data==oAffinity.data);
     lvLog_(3,"Shape affinity map computed in %f second(s).",oLocalTimer.tock());
     lvLog(3,"Calculating shape saliency map...");
     vFeatures[FeatPack_ShpSaliency].create(2,anAffinityMapDims.data(),CV_32FC1);
     cv::Mat_<float> oSaliency = vFeatures[FeatPack_ShpSaliency];
-    oSaliency = 0.0f; // default value for OOB pixels
-    std::vector<float> vValidAffinityVals;
-    vValidAffinityVals.reserve(m_nRealStereoLabels);
-    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
-        const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
-        const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
-        lvDbgAssert(oNode.bValidGraphNode);
-        const int nRowIdx = oNode.nRowIdx;
-        const int nColIdx = oNode.nColIdx;
-        vValidAffinityVals.resize(0);
-        const float* pAffinityPtr = oAffinity.ptr<float>(nRowIdx,nColIdx);
-        std::copy_if(pAffinityPtr,pAffinityPtr+m_nRealStereoLabels,std::back_inserter(vValidAffinityVals),[](float v){return v>=0.0f;});
-        const float fCurrDistSparseness = vValidAffinityVals.size()>1?(float)lv::sparseness(vValidAffinityVals.data(),vValidAffinityVals.size()):0.0f;
-        const float fCurrDescSparseness = (float)lv::sparseness(aDescs[m_nPrimaryCamIdx].ptr<float>(nRowIdx,nColIdx),size_t(aDescs[m_nPrimaryCamIdx].size[2]));
-        oSaliency.at<float>(nRowIdx,nColIdx) = std::max(fCurrDescSparseness,fCurrDistSparseness);
-    #if SEGMMATCH_DEFAULT_SALIENT_SHP_RAD>0
-        const cv::Mat& oFGDist = vFeatures[m_nPrimaryCamIdx*FeatPackOffset+FeatPackOffset_FGDist];
-        const float fCurrFGDist = oFGDist.at<float>(nRowIdx,nColIdx);
-        oSaliency.at<float>(nRowIdx,nColIdx) *= std::max(1-fCurrFGDist/SEGMMATCH_DEFAULT_SALIENT_SHP_RAD,0.0f);
-    #endif //SEGMMATCH_DEFAULT_SALIENT_SHP_RAD>0
-    }
-    cv::normalize(oSaliency,oSaliency,1,0,cv::NORM_MINMAX,-1,m_aROIs[m_nPrimaryCamIdx]);
-    lvDbgExec( // cv::normalize leftover fp errors are sometimes awful; need to 0-max when using map
+#if SEGMMATCH_DEFAULT_SALIENT_SHP_RAD>0
+    const cv::Mat_<float> oFGDist = vFeatures[m_nPrimaryCamIdx*FeatPackOffset+FeatPackOffset_FGDist];
+#else //!(SEGMMATCH_DEFAULT_SALIENT_SHP_RAD>0)
+    const cv::Mat_<float> oFGDist;
+#endif //!(SEGMMATCH_DEFAULT_SALIENT_SHP_RAD>0)
+    calcSaliencyMap(oAffinity,aDescs[m_nPrimaryCamIdx],oFGDist,oSaliency);
+    lvDbgExec( // normalization leftover fp errors might still be present; need to 0-max when using map
         for(int nRowIdx=0; nRowIdx<oSaliency.rows; ++nRowIdx)
             for(int nColIdx=0; nColIdx<oSaliency.cols; ++nColIdx)
                 lvDbgAssert((oSaliency.at<float>(nRowIdx,nColIdx)>=-1e-6f && oSaliency.at<float>(nRowIdx,nColIdx)<=1.0f+1e-6f) || m_aROIs[m_nPrimaryCamIdx](nRowIdx,nColIdx)==0);
     );
-#if SEGMMATCH_CONFIG_USE_SALIENT_MAP_BORDR
-    cv::multiply(oSaliency,cv::Mat_<float>(oSaliency.size(),1.0f).setTo(0.5f,m_aDescROIs[m_nPrimaryCamIdx]==0),oSaliency);
-#endif //SEGMMATCH_CONFIG_USE_SALIENT_MAP_BORDR
-    if(lv::getVerbosity()>=4) {
+    if(lv::getVerbosity()>=4 && oCtx.bAllowDisplay) {
         cv::imshow("oSaliency_shp",oSaliency);
         cv::waitKey(1);
     }
@@ -2518,6 +3000,67 @@ void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<Inte
     }*/
 }
 
+void SegmMatcher::GraphModelData::calcSaliencyMap(const cv::Mat_<float>& oAffinity, const cv::Mat_<float>& oDescs, const cv::Mat_<float>& oFGDist, cv::Mat_<float>& oSaliency) const {
+    lvDbgExceptionWatch;
+    lvDbgAssert(oAffinity.dims==3 && oAffinity.size[0]==(int)m_oGridSize[0] && oAffinity.size[1]==(int)m_oGridSize[1] && oAffinity.size[2]==(int)m_nRealStereoLabels && oAffinity.isContinuous());
+    lvDbgAssert(oDescs.empty() || (oDescs.dims==3 && oDescs.size[0]==(int)m_oGridSize[0] && oDescs.size[1]==(int)m_oGridSize[1] && oDescs.isContinuous()));
+    lvDbgAssert(oFGDist.empty() || (m_oGridSize==oFGDist.size && oFGDist.isContinuous()));
+    lvDbgAssert(m_oGridSize==oSaliency.size && oSaliency.isContinuous());
+    const size_t nDescSize = oDescs.empty()?size_t(0):size_t(oDescs.size[2]);
+    static thread_local std::vector<float> s_vNodeSaliency;
+    std::vector<float>& vNodeSaliency = s_vNodeSaliency; // thread-local instance of the calling thread, shared with omp workers below
+    vNodeSaliency.resize(m_nValidStereoGraphNodes);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+        const StereoNodeInfo& oNode = m_vStereoNodeMap[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]];
+        lvDbgAssert(oNode.bValidGraphNode && m_aROIs[m_nPrimaryCamIdx](oNode.nRowIdx,oNode.nColIdx)>0);
+        // invalid (oob) affinities are negative, and are skipped by the masked norm reductions
+        float fSaliency = lv::sparseness_32f<true>(((const float*)oAffinity.data)+oNode.nMapIdx*m_nRealStereoLabels,m_nRealStereoLabels);
+        if(nDescSize>0u)
+            fSaliency = std::max(fSaliency,lv::sparseness_32f(((const float*)oDescs.data)+oNode.nMapIdx*nDescSize,nDescSize));
+    #if SEGMMATCH_DEFAULT_SALIENT_SHP_RAD>0
+        if(!oFGDist.empty())
+            fSaliency *= std::max(1.0f-((const float*)oFGDist.data)[oNode.nMapIdx]/SEGMMATCH_DEFAULT_SALIENT_SHP_RAD,0.0f);
+    #endif //SEGMMATCH_DEFAULT_SALIENT_SHP_RAD>0
+        vNodeSaliency[nGraphNodeIdx] = fSaliency;
+    }
+    // graph nodes cover the whole ROI, so this matches 'cv::normalize' w/ NORM_MINMAX in [0,1] over the ROI (and leaves OOB pixels at 0)
+    float fMinSaliency=0.0f,fMaxSaliency=0.0f;
+    if(!vNodeSaliency.empty()) {
+        const auto pMinMaxSaliency = std::minmax_element(vNodeSaliency.begin(),vNodeSaliency.end());
+        fMinSaliency = *pMinMaxSaliency.first;
+        fMaxSaliency = *pMinMaxSaliency.second;
+    }
+    const float fSaliencyScale = (fMaxSaliency>fMinSaliency)?1.0f/(fMaxSaliency-fMinSaliency):0.0f;
+    const bool bUseSalientMapBorder = m_oParams.bUseSalientMapBorder;
+    const cv::Mat_<uchar>& oDescROI = m_aDescROIs[m_nPrimaryCamIdx];
+    oSaliency = 0.0f;
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+        const StereoNodeInfo& oNode = m_vStereoNodeMap[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]];
+        float fSaliency = (vNodeSaliency[nGraphNodeIdx]-fMinSaliency)*fSaliencyScale;
+        if(bUseSalientMapBorder && !oDescROI(oNode.nRowIdx,oNode.nColIdx))
+            fSaliency *= 0.5f; // attenuates saliency where descriptors are unreliable
+        ((float*)oSaliency.data)[oNode.nMapIdx] = fSaliency;
+    }
+}
+
+void SegmMatcher::GraphModelData::applyRootSIFT(cv::Mat_<float>& oDescs) {
+    lvDbgExceptionWatch;
+    lvAssert_(oDescs.dims==3 && oDescs.isContinuous(),"bad descriptor map layout");
+    const size_t nDescSize = size_t(oDescs.size[2]);
+    const int nDescCount = int(oDescs.total()/nDescSize);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nDescIdx=0; nDescIdx<nDescCount; ++nDescIdx)
+        lv::rootSIFT_32f(((float*)oDescs.data)+size_t(nDescIdx)*nDescSize,nDescSize);
+}
+
 void SegmMatcher::GraphModelData::calcShapeDistFeatures(const cv::Mat_<InternalLabelType>& oInputMask, size_t nCamIdx, std::vector<cv::Mat>& vFeatures) {
     lvDbgExceptionWatch;
     lvDbgAssert_(nCamIdx<getCameraCount(),"bad input cam index");
@@ -2604,6 +3147,67 @@ void SegmMatcher::GraphModelData::setNextFeatures(const cv::Mat& oPackedFeatures
     m_bUsePrecalcFeaturesNext = true;
 }
 
+void SegmMatcher::GraphModelData::queueInputs(const MatArrayIn& aInputs, size_t nMaxQueueSize) {
+    static_assert(s_nInputArraySize==4 && getCameraCount()==2,"lots of hardcoded indices below");
+    lvDbgExceptionWatch;
+    lvAssert_(nMaxQueueSize>0u,"max queue size must be strictly positive");
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        const cv::Mat& oInputImg = aInputs[nCamIdx*InputPackOffset+InputPackOffset_Img];
+        lvAssert__(oInputImg.dims==2 && m_oGridSize==oInputImg.size(),"input image in array at index=%d had the wrong size",(int)nCamIdx);
+        lvAssert_(oInputImg.type()==CV_8UC1 || oInputImg.type()==CV_8UC3,"unexpected input image type");
+        const cv::Mat& oInputMask = aInputs[nCamIdx*InputPackOffset+InputPackOffset_Mask];
+        lvAssert__(oInputMask.dims==2 && m_oGridSize==oInputMask.size(),"input mask in array at index=%d had the wrong size",(int)nCamIdx);
+        lvAssert_(oInputMask.type()==CV_8UC1,"unexpected input mask type");
+    }
+    lv::mutex_unique_lock sync_lock(m_oQueueMutex);
+    m_oQueueSyncVar.wait(sync_lock,[&](){return m_qQueuedFrames.size()<nMaxQueueSize;}); // back-pressure: wait for the consumer to catch up
+    if(!m_pPipelineWorker) {
+        m_pPipelineFeatExtractionCtx = std::make_unique<FeatureExtractionContext>(m_oParams,false);
+        m_pPipelineWorker = std::make_unique<lv::WorkerPool<1>>();
+    }
+    m_qQueuedFrames.emplace_back();
+    QueuedFrame& oFrame = m_qQueuedFrames.back(); // deque refs stay valid until this frame is popped (after its task is done)
+    for(size_t nInputIdx=0u; nInputIdx<aInputs.size(); ++nInputIdx)
+        oFrame.aInputs[nInputIdx] = aInputs[nInputIdx].clone(); // makes internal copy, user can reuse buffers right away
+    CamArray<cv::Mat> aPrevInputImages;
+    if(getTemporalLayerCount()>1u && !m_aLastQueuedInputs[0].empty())
+        for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+            aPrevInputImages[nCamIdx] = m_aLastQueuedInputs[nCamIdx*InputPackOffset+InputPackOffset_Img];
+    m_aLastQueuedInputs = oFrame.aInputs; // shallow copy; queued inputs are never modified
+    oFrame.oFeaturesReady = m_pPipelineWorker->queueTask([this,&oFrame,aPrevInputImages]() {
+        calcFeatures(*m_pPipelineFeatExtractionCtx,oFrame.aInputs,aPrevInputImages,oFrame.vFeatures);
+    });
+}
+
+bool SegmMatcher::GraphModelData::popQueuedFrame(MatArrayIn& aInputs, std::vector<cv::Mat>& vFeatures) {
+    lvDbgExceptionWatch;
+    std::future<void> oFeaturesReady;
+    {
+        lv::mutex_unique_lock sync_lock(m_oQueueMutex);
+        if(m_qQueuedFrames.empty())
+            return false;
+        // deque refs stay valid on push, and only this consumer pops, so the front frame can be fetched once under lock
+        QueuedFrame& oFrame = m_qQueuedFrames.front();
+        {
+            lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock); // producers can keep queueing while we wait
+            oFrame.oFeaturesReady.wait();
+        }
+        aInputs = oFrame.aInputs;
+        std::swap(vFeatures,oFrame.vFeatures);
+        oFeaturesReady = std::move(oFrame.oFeaturesReady);
+        m_qQueuedFrames.pop_front();
+    }
+    m_oQueueSyncVar.notify_all();
+    oFeaturesReady.get(); // rethrows feature computation errors (if any) on the consumer thread
+    m_vLatestFeatPackInfo.resize(vFeatures.size());
+    for(size_t nFeatMapIdx=0; nFeatMapIdx<vFeatures.size(); ++nFeatMapIdx)
+        m_vLatestFeatPackInfo[nFeatMapIdx] = lv::MatInfo(vFeatures[nFeatMapIdx]);
+    if(m_vExpectedFeatPackInfo.empty())
+        m_vExpectedFeatPackInfo = m_vLatestFeatPackInfo;
+    lvAssert_(m_vLatestFeatPackInfo==m_vExpectedFeatPackInfo,"packed features info mismatch (should stay constant for all inputs)");
+    return true;
+}
+
 inline SegmMatcher::OutputLabelType SegmMatcher::GraphModelData::getRealLabel(InternalLabelType nLabel) const {
     lvDbgExceptionWatch;
     lvDbgAssert(nLabel<m_vStereoLabels.size());
@@ -2755,53 +3359,82 @@ inline SegmMatcher::ValueType SegmMatcher::GraphModelData::calcStereoUnaryMoveCo
 void SegmMatcher::GraphModelData::calcStereoMoveCosts(InternalLabelType nNewLabel) const {
     lvDbgExceptionWatch;
     lvDbgAssert(m_oGridSize.total()==m_vStereoNodeMap.size() && m_oGridSize.total()>1 && m_oGridSize==m_oStereoUnaryCosts.size);
+    lvDbgAssert(nNewLabel<m_nStereoLabels);
     const InternalLabelType* pCurrLabeling = ((InternalLabelType*)m_aaStereoLabelings[0][m_nPrimaryCamIdx].data);
-    // #### openmp here?
+    // unary funcs are views over a contiguous graph-node-major buffer, so all lookups below stream through raw data (no func indirection)
+    const ValueType* const pUnaryFuncsData = m_pStereoUnaryFuncsDataBase;
+    const size_t* const pGraphIdxToMapIdxLUT = m_vStereoGraphIdxToMapIdxLUT.data();
+    ValueType* const pUnaryCosts = (ValueType*)m_oStereoUnaryCosts.data;
+    const size_t nStereoLabels = m_nStereoLabels;
+    // reserved labels are never restricted; nodes without the new label in their candidate list are left out of the move
+    const bool bUseMoveRestriction = m_oParams.bUseCoarseMoveRestriction && nNewLabel<m_nRealStereoLabels;
+    lvDbgAssert(!m_oParams.bUseCoarseMoveRestriction || m_oGridSize==m_oStereoMoveMask.size);
+    lvDbgAssert(!bUseMoveRestriction || m_vStereoCandLabelOffsets.size()==m_nValidStereoGraphNodes+1u);
+    const size_t* const pCandLabelOffsets = m_vStereoCandLabelOffsets.data();
+    const InternalLabelType* const pCandLabels = m_vStereoCandLabels.data();
+    uchar* const pMoveMask = m_oStereoMoveMask.data;
+#if USING_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif //USING_OPENMP
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
-        const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
-        const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
-        const InternalLabelType& nCurrLabel = pCurrLabeling[nLUTNodeIdx];
-        lvIgnore(oNode); lvDbgAssert(oNode.bValidGraphNode);
-        lvDbgAssert(&nCurrLabel==&m_aaStereoLabelings[0][m_nPrimaryCamIdx](oNode.nRowIdx,oNode.nColIdx));
-        ValueType& tUnaryCost = ((ValueType*)m_oStereoUnaryCosts.data)[nLUTNodeIdx];
-        lvDbgAssert(&tUnaryCost==&m_oStereoUnaryCosts(oNode.nRowIdx,oNode.nColIdx));
-        tUnaryCost = calcStereoUnaryMoveCost(nGraphNodeIdx,nCurrLabel,nNewLabel);
+        const size_t nLUTNodeIdx = pGraphIdxToMapIdxLUT[nGraphNodeIdx];
+        const InternalLabelType nCurrLabel = pCurrLabeling[nLUTNodeIdx];
+        const ValueType* pUnaryFuncData = pUnaryFuncsData+nGraphNodeIdx*nStereoLabels;
+        lvDbgAssert(m_vStereoNodeMap[nLUTNodeIdx].bValidGraphNode && (!m_vStereoNodeMap[nLUTNodeIdx].pUnaryFunc || &(*m_vStereoNodeMap[nLUTNodeIdx].pUnaryFunc)(0)==pUnaryFuncData));
+        lvDbgAssert(nCurrLabel<nStereoLabels);
+        lvDbgAssert(!m_oParams.bUseCoarseMoveRestriction || nCurrLabel>=m_nRealStereoLabels || std::binary_search(pCandLabels+pCandLabelOffsets[nGraphNodeIdx],pCandLabels+pCandLabelOffsets[nGraphNodeIdx+1],nCurrLabel));
+        ValueType& tUnaryCost = pUnaryCosts[nLUTNodeIdx];
+        const bool bFixedNode = bUseMoveRestriction && nCurrLabel!=nNewLabel && !std::binary_search(pCandLabels+pCandLabelOffsets[nGraphNodeIdx],pCandLabels+pCandLabelOffsets[nGraphNodeIdx+1],nNewLabel);
+        if(pMoveMask)
+            pMoveMask[nLUTNodeIdx] = bFixedNode?uchar(0):uchar(255);
+        if(nCurrLabel!=nNewLabel && !bFixedNode) {
+            const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
+            const ValueType tAssocEnergyCost = calcRemoveAssocCost(oNode.nRowIdx,oNode.nColIdx,nCurrLabel)+calcAddAssocCost(oNode.nRowIdx,oNode.nColIdx,nNewLabel);
+            tUnaryCost = tAssocEnergyCost+pUnaryFuncData[nNewLabel]-pUnaryFuncData[nCurrLabel];
+        }
+        else
+            tUnaryCost = cost_cast(0);
+        lvDbgAssert(bFixedNode || tUnaryCost==calcStereoUnaryMoveCost(nGraphNodeIdx,nCurrLabel,nNewLabel));
     }
 }
 
 void SegmMatcher::GraphModelData::calcResegmMoveCosts(InternalLabelType nNewLabel) const {
     lvDbgExceptionWatch;
     lvDbgAssert(m_oResegmUnaryCosts.rows==int(m_oGridSize[0]*getTemporalLayerCount()*getCameraCount()) && m_oResegmUnaryCosts.cols==int(m_oGridSize[1]));
-    // #### openmp here?
+    lvDbgAssert(nNewLabel==s_nForegroundLabelIdx || nNewLabel==s_nBackgroundLabelIdx);
+    // unary funcs are views over a contiguous graph-node-major buffer, so the pass below is a branch-light streaming kernel
+    const ValueType* const pUnaryFuncsData = m_pResegmUnaryFuncsDataBase;
+    const size_t* const pGraphIdxToMapIdxLUT = m_vResegmGraphIdxToMapIdxLUT.data();
+    const InternalLabelType* const pCurrLabeling = (InternalLabelType*)m_oSuperStackedResegmLabeling.data;
+    ValueType* const pUnaryCosts = (ValueType*)m_oResegmUnaryCosts.data;
+#if SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST
+    const InternalLabelType* const pInitLabeling = (InternalLabelType*)m_oInitSuperStackedResegmLabeling.data;
+#endif //SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST
+#if USING_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif //USING_OPENMP
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
-        const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
-        const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
-        const InternalLabelType& nCurrLabel = ((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[nLUTNodeIdx];
-        lvDbgAssert(&nCurrLabel==&m_aaResegmLabelings[oNode.nLayerIdx][oNode.nCamIdx](oNode.nRowIdx,oNode.nColIdx));
+        const size_t nLUTNodeIdx = pGraphIdxToMapIdxLUT[nGraphNodeIdx];
+        const InternalLabelType nCurrLabel = pCurrLabeling[nLUTNodeIdx];
+        const ValueType* pUnaryFuncData = pUnaryFuncsData+nGraphNodeIdx*s_nResegmLabels;
+        lvDbgAssert(!m_vResegmNodeMap[nLUTNodeIdx].pUnaryFunc || &(*m_vResegmNodeMap[nLUTNodeIdx].pUnaryFunc)(0)==pUnaryFuncData);
         lvDbgAssert(nCurrLabel==s_nForegroundLabelIdx || nCurrLabel==s_nBackgroundLabelIdx);
-        ValueType& tUnaryCost = ((ValueType*)m_oResegmUnaryCosts.data)[nLUTNodeIdx];
-        lvDbgAssert(&tUnaryCost==&m_oResegmUnaryCosts(oNode.nRowIdx+int((oNode.nCamIdx*getTemporalLayerCount()+oNode.nLayerIdx)*m_oGridSize[0]),oNode.nColIdx));
-        if(nCurrLabel!=nNewLabel) {
-            const ExplicitFunction& vUnaryResegmLUT = *oNode.pUnaryFunc;
-        #if SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST
-            const ValueType tLayerCost = cost_cast(SEGMMATCH_UNARY_COST_TEMPORAL_CST*oNode.nLayerIdx);
-            const InternalLabelType& nInitLabel = ((InternalLabelType*)m_oInitSuperStackedResegmLabeling.data)[nLUTNodeIdx];
-            lvDbgAssert(nInitLabel==s_nForegroundLabelIdx || nInitLabel==s_nBackgroundLabelIdx);
-            const ValueType tEnergyCurr = vUnaryResegmLUT(nCurrLabel)+((nCurrLabel==nInitLabel)?cost_cast(0):tLayerCost);
-            const ValueType tEnergyModif = vUnaryResegmLUT(nNewLabel)+((nNewLabel==nInitLabel)?cost_cast(0):tLayerCost);
-        #else //!SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST
-            const ValueType tEnergyCurr = vUnaryResegmLUT(nCurrLabel);
-            const ValueType tEnergyModif = vUnaryResegmLUT(nNewLabel);
-        #endif //!SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST
-            tUnaryCost = tEnergyModif-tEnergyCurr;
-        }
-        else
-            tUnaryCost = cost_cast(0);
+        lvDbgAssert(&pUnaryCosts[nLUTNodeIdx]==&m_oResegmUnaryCosts(m_vResegmNodeMap[nLUTNodeIdx].nRowIdx+int((m_vResegmNodeMap[nLUTNodeIdx].nCamIdx*getTemporalLayerCount()+m_vResegmNodeMap[nLUTNodeIdx].nLayerIdx)*m_oGridSize[0]),m_vResegmNodeMap[nLUTNodeIdx].nColIdx));
+    #if SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST
+        const ValueType tLayerCost = cost_cast(SEGMMATCH_UNARY_COST_TEMPORAL_CST*m_vResegmNodeMap[nLUTNodeIdx].nLayerIdx);
+        const InternalLabelType nInitLabel = pInitLabeling[nLUTNodeIdx];
+        lvDbgAssert(nInitLabel==s_nForegroundLabelIdx || nInitLabel==s_nBackgroundLabelIdx);
+        const ValueType tEnergyCurr = pUnaryFuncData[nCurrLabel]+((nCurrLabel==nInitLabel)?cost_cast(0):tLayerCost);
+        const ValueType tEnergyModif = pUnaryFuncData[nNewLabel]+((nNewLabel==nInitLabel)?cost_cast(0):tLayerCost);
+    #else //!SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST
+        const ValueType tEnergyCurr = pUnaryFuncData[nCurrLabel];
+        const ValueType tEnergyModif = pUnaryFuncData[nNewLabel];
+    #endif //!SEGMMATCH_CONFIG_USE_TEMPORAL_U_CST
+        // both terms are equal when the labels match, so no branch is needed for the null move
+        pUnaryCosts[nLUTNodeIdx] = tEnergyModif-tEnergyCurr;
     }
 }
 
-#if (SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
-
 template<typename TNode>
 size_t SegmMatcher::GraphModelData::initMinimizer(sospd::SubmodularIBFS<ValueType,IndexType>& oMinimizer,
                                                   const std::vector<TNode>& vNodeMap,
@@ -2903,7 +3536,8 @@ void SegmMatcher::GraphModelData::solvePrimalDual(sospd::SubmodularIBFS<ValueTyp
                                                   InternalLabelType nAlphaLabel,
                                                   size_t nTotLabels,
                                                   bool bUpdateAssocs,
-                                                  TemporalArray<CamArray<size_t>>& aanChangedLabels) {
+                                                  TemporalArray<CamArray<size_t>>& aanChangedLabels,
+                                                  const uchar* pMoveMask) {
     lvDbgExceptionWatch;
     lvDbgAssert(!oDualMap.empty() && !oHeightMap.empty());
     const size_t nGraphNodes = vGraphIdxToMapIdxLUT.size();
@@ -2911,7 +3545,8 @@ void SegmMatcher::GraphModelData::solvePrimalDual(sospd::SubmodularIBFS<ValueTyp
     fixedVars.resize(nGraphNodes);
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<nGraphNodes; ++nGraphNodeIdx) {
         const size_t nLUTNodeIdx = vGraphIdxToMapIdxLUT[nGraphNodeIdx];
-        fixedVars[nGraphNodeIdx] = (((InternalLabelType*)oLabeling.data)[nLUTNodeIdx]==nAlphaLabel);
+        // nodes already labeled alpha and nodes left out of the move (null mask entry) both keep their current label
+        fixedVars[nGraphNodeIdx] = (((InternalLabelType*)oLabeling.data)[nLUTNodeIdx]==nAlphaLabel) || (pMoveMask && !pMoveMask[nLUTNodeIdx]);
     }
     std::array<InternalLabelType,s_nMaxOrder> label_buf,current_labels,fusion_labels;
     std::array<ValueType,s_nMaxOrder> current_lambda,fusion_lambda;
@@ -2936,8 +3571,9 @@ void SegmMatcher::GraphModelData::solvePrimalDual(sospd::SubmodularIBFS<ValueTyp
             for(size_t i = 0; i < nCliqueSize; ++i) {
                 lvDbgAssert(oClique.getGraphNodeIdx(i)==oMinimizer_c.Nodes()[i]);
                 lvDbgAssert(oClique.getLUTNodeIdx(i)==vGraphIdxToMapIdxLUT[oMinimizer_c.Nodes()[i]]);
-                current_labels[i] = ((InternalLabelType*)oLabeling.data)[vGraphIdxToMapIdxLUT[oMinimizer_c.Nodes()[i]]];
-                fusion_labels[i] = nAlphaLabel;
+                const size_t nLUTNodeIdx = vGraphIdxToMapIdxLUT[oMinimizer_c.Nodes()[i]];
+                current_labels[i] = ((InternalLabelType*)oLabeling.data)[nLUTNodeIdx];
+                fusion_labels[i] = (pMoveMask && !pMoveMask[nLUTNodeIdx])?current_labels[i]:nAlphaLabel;
                 current_lambda[i] = pLambdas[i*nTotLabels+current_labels[i]];
                 fusion_lambda[i] = pLambdas[i*nTotLabels+fusion_labels[i]];
             }
@@ -2972,6 +3608,10 @@ void SegmMatcher::GraphModelData::solvePrimalDual(sospd::SubmodularIBFS<ValueTyp
         const InternalLabelType nInitLabel = ((InternalLabelType*)oLabeling.data)[nLUTNodeIdx];
         const NodeInfo& oNode = vNodeMap[nLUTNodeIdx];
         ValueType tUnaryCost = -((ValueType*)oUnaryCostMap.data)[nLUTNodeIdx];
+        if(pMoveMask && !pMoveMask[nLUTNodeIdx]) {
+            oMinimizer.AddUnaryTerm((int)nGraphNodeIdx,0,0);
+            continue;
+        }
         for(const auto& p : oNode.vCliqueMemberLUT) {
             const size_t nCliqueIdx = p.first;
             lvDbgAssert__((int)nCliqueIdx<oDualMap.rows,"%d",(int)nCliqueIdx);
@@ -2998,8 +3638,8 @@ void SegmMatcher::GraphModelData::solvePrimalDual(sospd::SubmodularIBFS<ValueTyp
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<nGraphNodes; ++nGraphNodeIdx) {
         const int nMoveLabel = oMinimizer.GetLabel((int)nGraphNodeIdx);
         lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
-        if(nMoveLabel==1) { // node label changed to alpha
-            const size_t nLUTNodeIdx = vGraphIdxToMapIdxLUT[nGraphNodeIdx];
+        const size_t nLUTNodeIdx = vGraphIdxToMapIdxLUT[nGraphNodeIdx];
+        if(nMoveLabel==1 && (!pMoveMask || pMoveMask[nLUTNodeIdx])) { // node label changed to alpha
             InternalLabelType& nLabel = ((InternalLabelType*)oLabeling.data)[nLUTNodeIdx];
             if(nLabel!=nAlphaLabel) {
                 const NodeInfo& oNode = vNodeMap[nLUTNodeIdx];
@@ -3022,6 +3662,8 @@ void SegmMatcher::GraphModelData::solvePrimalDual(sospd::SubmodularIBFS<ValueTyp
         auto& oMinimizer_c = oMinimizer_cliques[nCliqueIdx];
         const std::vector<ValueType>& phiCi = oMinimizer_c.AlphaCi();
         for (size_t j = 0; j < phiCi.size(); ++j) {
+            if(pMoveMask && !pMoveMask[vGraphIdxToMapIdxLUT[oMinimizer_c.Nodes()[j]]])
+                continue; // nodes left out of the move never take alpha here, so their alpha duals stay as-is
             oDualMap((int)nCliqueIdx,(int)(j*nTotLabels+nAlphaLabel)) += phiCi[j];
             oHeightMap((int)oMinimizer_c.Nodes()[j],(int)nAlphaLabel) += phiCi[j];
         }
@@ -3066,8 +3708,6 @@ void SegmMatcher::GraphModelData::solvePrimalDual(sospd::SubmodularIBFS<ValueTyp
     }
 }
 
-#endif //(SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
-
 opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
     static_assert(s_nInputArraySize==4 && getCameraCount()==2,"hardcoded indices below will break");
     lvDbgExceptionWatch;
@@ -3093,6 +3733,9 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
         cv::waitKey(1);
     }
     const size_t nTemporalLayerCount = getTemporalLayerCount();
+    FrameTelemetry& oTelemetry = m_oTelemetry;
+    lv::StopWatch oStageTimer; // each 'tock' below charges the elapsed time to the stage that just ended
+    updateDirtyNodeMaps();
     // we only overwrite current stereo labeling temporal layer, others have been kept & shifted in 'apply'
     updateStereoModel(true); // quick-init for wta disparity map & offset cam estimation
     resetStereoLabelings();
@@ -3100,11 +3743,12 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
     computeOcclusionMaps();
     updateStereoModel(false); // second init allows proper usage of shape and occlusion maps in model
     resetStereoLabelings();
+    if(m_oParams.bUseCoarseMoveRestriction)
+        computeStereoCandidateLabels(); // candidates stay fixed for the whole frame, even if the model is updated after resegm passes
+    oTelemetry.dStereoUpdateTime += oStageTimer.tock();
     lvDbgAssert(m_nValidResegmGraphNodes==m_vResegmGraphIdxToMapIdxLUT.size());
     lvLog_(2,"Running inference for primary camera idx=%d...",(int)m_nPrimaryCamIdx);
-#if (SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF)
     using HOEReducer = HigherOrderEnergy<ValueType,s_nMaxOrder>;
-#endif //(SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF)
     cv::Mat_<InternalLabelType>& oCurrStereoLabeling = m_aaStereoLabelings[0][m_nPrimaryCamIdx];
 #if SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
     //calcStereoCosts(m_nPrimaryCamIdx);
@@ -3129,29 +3773,35 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
             weights_
     );*/
     // see if maxflow used in fastpd can be replaced by https://github.com/gerddie/maxflow?
-#elif SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF
-    constexpr int nMaxStereoEdgesPerNode = (s_nPairwOrients+s_nEpipolarCliqueEdges);
-    kolmogorov::qpbo::QPBO<ValueType> oStereoMinimizer((int)m_nValidStereoGraphNodes,(int)m_nValidStereoGraphNodes*nMaxStereoEdgesPerNode);
-    HOEReducer oStereoReducer;
-    size_t nStereoLabelOrderingIdx = 0;
-#elif SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF
+#else //!SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
     static_assert(std::is_integral<SegmMatcher::ValueType>::value,"sospd height weight redistr requires integer type");
-    constexpr bool bUseHeightAlphaExp = SEGMMATCH_CONFIG_USE_SOSPD_ALPHA_HEIGHTS_LABEL_ORDERING;
-    lvAssert_(!bUseHeightAlphaExp,"missing impl");
+    const bool bUseFGBZStereoInf = (m_oParams.eStereoInference==Inference_FGBZ);
     size_t nStereoLabelOrderingIdx = 0;
-    sospd::SubmodularIBFS<ValueType,IndexType> oStereoMinimizer;
-    const size_t nInternalStereoCliqueCount = initMinimizer(oStereoMinimizer,m_vStereoNodeMap,m_vStereoGraphIdxToMapIdxLUT);
-    lvAssert(nInternalStereoCliqueCount==m_nStereoCliqueCount);
-    const size_t nSetupStereoCliqueCount = setupPrimalDual<ExplicitScaledFunction>(m_vStereoNodeMap,m_vStereoGraphIdxToMapIdxLUT,oCurrStereoLabeling,m_oStereoDualMap,m_oStereoHeightMap,m_nStereoLabels,m_nStereoCliqueCount);
-    lvAssert(nSetupStereoCliqueCount==m_nStereoCliqueCount);
-#endif //SEGMMATCH_CONFIG_USE_..._STEREO_INF
-#if SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF
-    constexpr int nMaxResegmEdgesPerNode = (s_nPairwOrients+s_nTemporalCliqueEdges);
-    kolmogorov::qpbo::QPBO<ValueType> oResegmMinimizer((int)m_nValidResegmGraphNodes,(int)m_nValidResegmGraphNodes*nMaxResegmEdgesPerNode);
-    HOEReducer oResegmReducer;
-#elif SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF
-    static_assert(std::is_integral<SegmMatcher::ValueType>::value,"sospd height weight redistr requires integer type");
-#endif //SEGMMATCH_CONFIG_USE_..._RESEGM_INF
+    if(bUseFGBZStereoInf) {
+        constexpr int nMaxStereoEdgesPerNode = (s_nPairwOrients+s_nEpipolarCliqueEdges);
+        if(!m_oInfWorkspace.pStereoFGBZMinimizer)
+            m_oInfWorkspace.pStereoFGBZMinimizer = std::make_unique<kolmogorov::qpbo::QPBO<ValueType>>((int)m_nValidStereoGraphNodes,(int)m_nValidStereoGraphNodes*nMaxStereoEdgesPerNode);
+    }
+    else {
+        constexpr bool bUseHeightAlphaExp = SEGMMATCH_CONFIG_USE_SOSPD_ALPHA_HEIGHTS_LABEL_ORDERING;
+        lvAssert_(!bUseHeightAlphaExp,"missing impl");
+        if(!m_oInfWorkspace.pStereoSOSPDMinimizer) {
+            m_oInfWorkspace.pStereoSOSPDMinimizer = std::make_unique<sospd::SubmodularIBFS<ValueType,IndexType>>();
+            const size_t nInternalStereoCliqueCount = initMinimizer(*m_oInfWorkspace.pStereoSOSPDMinimizer,m_vStereoNodeMap,m_vStereoGraphIdxToMapIdxLUT);
+            lvAssert(nInternalStereoCliqueCount==m_nStereoCliqueCount);
+        }
+        const size_t nSetupStereoCliqueCount = setupPrimalDual<ExplicitScaledFunction>(m_vStereoNodeMap,m_vStereoGraphIdxToMapIdxLUT,oCurrStereoLabeling,m_oStereoDualMap,m_oStereoHeightMap,m_nStereoLabels,m_nStereoCliqueCount);
+        lvAssert(nSetupStereoCliqueCount==m_nStereoCliqueCount);
+    }
+    HOEReducer& oStereoReducer = m_oInfWorkspace.oStereoReducer;
+#endif //!SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
+    const bool bUseFGBZResegmInf = (m_oParams.eResegmInference==Inference_FGBZ);
+    if(bUseFGBZResegmInf) {
+        constexpr int nMaxResegmEdgesPerNode = (s_nPairwOrients+s_nTemporalCliqueEdges);
+        if(!m_oInfWorkspace.pResegmFGBZMinimizer)
+            m_oInfWorkspace.pResegmFGBZMinimizer = std::make_unique<kolmogorov::qpbo::QPBO<ValueType>>((int)m_nValidResegmGraphNodes,(int)m_nValidResegmGraphNodes*nMaxResegmEdgesPerNode);
+    }
+    HOEReducer& oResegmReducer = m_oInfWorkspace.oResegmReducer;
     size_t nStereoMoveIter=0, nResegmMoveIter=0, nConsecUnchangedStereoLabels=0;
     std::vector<int> vInitLabelCounts = lv::calcHistCounts(m_aaStereoLabelings[0][m_nPrimaryCamIdx],m_aROIs[m_nPrimaryCamIdx]);
     vInitLabelCounts.resize(m_nStereoLabels);
@@ -3160,14 +3810,39 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
     });
     lvDbgAssert(!m_vStereoLabelOrdering.empty() && m_vStereoLabelOrdering[0]==m_nDontCareLabelIdx);
     lvDbgAssert(lv::unique(m_vStereoLabelOrdering.begin(),m_vStereoLabelOrdering.end())==lv::make_range(InternalLabelType(0),InternalLabelType(m_nStereoLabels-1)));
+    if(m_oParams.bUseCoarseMoveRestriction) {
+        // real labels that are not a candidate for any node can never be assigned; skip their moves entirely
+        std::vector<uchar> vbUsedCandLabels(m_nStereoLabels,uchar(0));
+        for(const InternalLabelType nLabel : m_vStereoCandLabels)
+            vbUsedCandLabels[nLabel] = uchar(1);
+        m_vStereoLabelOrdering.erase(std::remove_if(m_vStereoLabelOrdering.begin(),m_vStereoLabelOrdering.end(),[&](InternalLabelType nLabel) {
+            return nLabel<m_nRealStereoLabels && !vbUsedCandLabels[nLabel];
+        }),m_vStereoLabelOrdering.end());
+        lvLog_(3,"Stereo move restriction kept %d/%d labels (avg %f candidates per node).",(int)m_vStereoLabelOrdering.size(),(int)m_nStereoLabels,double(m_vStereoCandLabels.size())/std::max(m_nValidStereoGraphNodes,size_t(1)));
+    }
+    size_t nStereoConvergenceMoveCount = m_vStereoLabelOrdering.size(); // consecutive moves without change required to stop
+    std::vector<size_t> vStereoLabelChangeCounts(m_nStereoLabels,size_t(0));
+    if(m_oParams.bUseTemporalWarmStart && m_nFramesProcessed>0u && m_vStereoLabelChangeScores.size()==m_nStereoLabels) {
+        // labels that flipped nodes recently go first (ties keep histogram order); only those must be swept to declare convergence
+        std::stable_sort(m_vStereoLabelOrdering.begin()+1,m_vStereoLabelOrdering.end(),[&](InternalLabelType a, InternalLabelType b) {
+            return m_vStereoLabelChangeScores[a]>m_vStereoLabelChangeScores[b];
+        });
+        const size_t nActiveStereoLabels = (size_t)std::count_if(m_vStereoLabelOrdering.begin()+1,m_vStereoLabelOrdering.end(),[&](InternalLabelType nLabel) {
+            return m_vStereoLabelChangeScores[nLabel]>SEGMMATCH_DEFAULT_WARM_START_MIN_SCORE;
+        });
+        nStereoConvergenceMoveCount = std::min(std::max(nActiveStereoLabels+1u,SEGMMATCH_DEFAULT_WARM_START_MIN_MOVES),m_vStereoLabelOrdering.size());
+        lvLog_(3,"Stereo warm start will converge after %d unchanged moves (%d active labels).",(int)nStereoConvergenceMoveCount,(int)nActiveStereoLabels);
+    }
     // note: sospd might not follow this label order if using alpha heights strategy (reimpl to use same strat in every solver?) ####
     lv::StopWatch oLocalTimer;
     ValueType tLastStereoEnergy=m_pStereoInf->value(),tLastResegmEnergy=std::numeric_limits<ValueType>::max();
     m_oSuperStackedResegmLabeling.copyTo(m_oInitSuperStackedResegmLabeling);
-    cv::Mat_<InternalLabelType> oPreStereoUpdateLabeling = m_oSuperStackedResegmLabeling.clone();
-    cv::Mat_<InternalLabelType> oPreResegmUpdateLabeling = m_oSuperStackedResegmLabeling.clone();
+    cv::Mat_<InternalLabelType>& oPreStereoUpdateLabeling = m_oInfWorkspace.oPreStereoUpdateLabeling;
+    cv::Mat_<InternalLabelType>& oPreResegmUpdateLabeling = m_oInfWorkspace.oPreResegmUpdateLabeling;
+    m_oSuperStackedResegmLabeling.copyTo(oPreStereoUpdateLabeling); // no realloc after first frame
+    m_oSuperStackedResegmLabeling.copyTo(oPreResegmUpdateLabeling);
     bool bJustUpdatedSegm = false;
-    while(nStereoMoveIter<m_nMaxStereoMoveCount && nConsecUnchangedStereoLabels<m_nStereoLabels) {
+    while(nStereoMoveIter<m_nMaxStereoMoveCount && nConsecUnchangedStereoLabels<nStereoConvergenceMoveCount) {
     #if SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
 
         // fastpd only works with shared+scaled pairwise costs, and no higher order terms
@@ -3199,81 +3874,91 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
         nStereoMoveIter += m_nRealStereoLabels;
         nConsecUnchangedStereoLabels = (nChangedStereoLabels>0)?0:nConsecUnchangedStereoLabels+m_nRealStereoLabels;
         const bool bResegmNext = true;
-    #elif SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF
-        // each iter below is a fusion move based on A. Fix's energy minimization method for higher-order MRFs
-        // see "A Graph Cut Algorithm for Higher-order Markov Random Fields" in ICCV2011 for more info (doi = 10.1109/ICCV.2011.6126347)
-        // (note: this approach is very generic, and not very well adapted to a dynamic MRF problem!)
+    #else //!SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
         const InternalLabelType nStereoAlphaLabel = m_vStereoLabelOrdering[nStereoLabelOrderingIdx];
         calcStereoMoveCosts(nStereoAlphaLabel);
-        oStereoReducer.Clear();
-        oStereoReducer.AddVars((int)m_nValidStereoGraphNodes);
-        if(lv::getVerbosity()>=5) {
-            cv::Mat oStereoUnaryCostsDisplay;
-            cv::normalize(m_oStereoUnaryCosts,oStereoUnaryCostsDisplay,255,0,cv::NORM_MINMAX,CV_8U,m_aROIs[m_nPrimaryCamIdx]);
-            cv::imshow("oStereoUnaryCostsDisplay",oStereoUnaryCostsDisplay);
-            cv::waitKey(1);
-        }
-        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
-            const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
-            const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
-            if(oNode.nUnaryFactID!=SIZE_MAX) {
-                const ValueType& tUnaryCost = ((ValueType*)m_oStereoUnaryCosts.data)[nLUTNodeIdx];
-                lvDbgAssert(&tUnaryCost==&m_oStereoUnaryCosts(oNode.nRowIdx,oNode.nColIdx));
-                oStereoReducer.AddUnaryTerm((int)nGraphNodeIdx,tUnaryCost);
-            }
-            for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
-                lv::gm::factorReducer<ExplicitScaledFunction>(oNode.aPairwCliques[nOrientIdx],oStereoReducer,nStereoAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data);
-        #if SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN
-            lv::gm::factorReducer<ExplicitScaledFunction>(oNode.oEpipolarClique,oStereoReducer,nStereoAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data);
-        #endif //SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN
-        }
-        oStereoMinimizer.Reset();
-        oStereoReducer.ToQuadratic(oStereoMinimizer);
-        oStereoMinimizer.Solve();
-        oStereoMinimizer.ComputeWeakPersistencies();
+        const uchar* pStereoMoveMask = m_oParams.bUseCoarseMoveRestriction?m_oStereoMoveMask.data:nullptr;
         size_t nChangedStereoLabels = 0;
-        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
-            const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
-            const int nRowIdx = m_vStereoNodeMap[nLUTNodeIdx].nRowIdx;
-            const int nColIdx = m_vStereoNodeMap[nLUTNodeIdx].nColIdx;
-            const int nMoveLabel = oStereoMinimizer.GetLabel((int)nGraphNodeIdx);
-            lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
-            if(nMoveLabel==1) { // node label changed to alpha
-                const InternalLabelType nOldLabel = oCurrStereoLabeling(nRowIdx,nColIdx);
-                if(nOldLabel<m_nDontCareLabelIdx)
-                    removeAssoc(nRowIdx,nColIdx,nOldLabel);
-                oCurrStereoLabeling(nRowIdx,nColIdx) = nStereoAlphaLabel;
-                if(nStereoAlphaLabel<m_nDontCareLabelIdx)
-                    addAssoc(nRowIdx,nColIdx,nStereoAlphaLabel);
-                ++nChangedStereoLabels;
+        if(bUseFGBZStereoInf) {
+            // each iter below is a fusion move based on A. Fix's energy minimization method for higher-order MRFs
+            // see "A Graph Cut Algorithm for Higher-order Markov Random Fields" in ICCV2011 for more info (doi = 10.1109/ICCV.2011.6126347)
+            // (note: this approach is very generic, and not very well adapted to a dynamic MRF problem!)
+            kolmogorov::qpbo::QPBO<ValueType>& oStereoMinimizer = *m_oInfWorkspace.pStereoFGBZMinimizer;
+            oStereoReducer.Clear();
+            oStereoReducer.AddVars((int)m_nValidStereoGraphNodes);
+            if(lv::getVerbosity()>=5) {
+                cv::Mat oStereoUnaryCostsDisplay;
+                cv::normalize(m_oStereoUnaryCosts,oStereoUnaryCostsDisplay,255,0,cv::NORM_MINMAX,CV_8U,m_aROIs[m_nPrimaryCamIdx]);
+                cv::imshow("oStereoUnaryCostsDisplay",oStereoUnaryCostsDisplay);
+                cv::waitKey(1);
+            }
+            for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+                const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
+                const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
+                if(oNode.nUnaryFactID!=SIZE_MAX) {
+                    const ValueType& tUnaryCost = ((ValueType*)m_oStereoUnaryCosts.data)[nLUTNodeIdx];
+                    lvDbgAssert(&tUnaryCost==&m_oStereoUnaryCosts(oNode.nRowIdx,oNode.nColIdx));
+                    oStereoReducer.AddUnaryTerm((int)nGraphNodeIdx,tUnaryCost);
+                }
+                for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
+                    lv::gm::factorReducer<ExplicitScaledFunction>(oNode.aPairwCliques[nOrientIdx],oStereoReducer,nStereoAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data,pStereoMoveMask);
+            #if SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN
+                lv::gm::factorReducer<ExplicitScaledFunction>(oNode.oEpipolarClique,oStereoReducer,nStereoAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data,pStereoMoveMask);
+            #endif //SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN
             }
+            oStereoMinimizer.Reset();
+            oStereoReducer.ToQuadratic(oStereoMinimizer);
+            oStereoMinimizer.Solve();
+            oStereoMinimizer.ComputeWeakPersistencies();
+            for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+                const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
+                const int nRowIdx = m_vStereoNodeMap[nLUTNodeIdx].nRowIdx;
+                const int nColIdx = m_vStereoNodeMap[nLUTNodeIdx].nColIdx;
+                if(pStereoMoveMask && !pStereoMoveMask[nLUTNodeIdx])
+                    continue; // fixed nodes have no terms left in the move, and keep their current label
+                const int nMoveLabel = oStereoMinimizer.GetLabel((int)nGraphNodeIdx);
+                lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
+                if(nMoveLabel<0)
+                    ++oTelemetry.nUnlabeledNodeCount;
+                else if(nMoveLabel==1) { // node label changed to alpha
+                    const InternalLabelType nOldLabel = oCurrStereoLabeling(nRowIdx,nColIdx);
+                    if(nOldLabel<m_nDontCareLabelIdx)
+                        removeAssoc(nRowIdx,nColIdx,nOldLabel);
+                    oCurrStereoLabeling(nRowIdx,nColIdx) = nStereoAlphaLabel;
+                    if(nStereoAlphaLabel<m_nDontCareLabelIdx)
+                        addAssoc(nRowIdx,nColIdx,nStereoAlphaLabel);
+                    ++nChangedStereoLabels;
+                }
+            }
+        }
+        else {
+            sospd::SubmodularIBFS<ValueType,IndexType>& oStereoMinimizer = *m_oInfWorkspace.pStereoSOSPDMinimizer;
+            const bool bStereoMoveCanFlipLabels = std::any_of(StereoGraphNodeIter(this,0),StereoGraphNodeIter(this,m_nValidStereoGraphNodes),[&](const StereoNodeInfo& oNode) {
+                return (((InternalLabelType*)oCurrStereoLabeling.data)[oNode.nMapIdx])!=nStereoAlphaLabel && (!pStereoMoveMask || pStereoMoveMask[oNode.nMapIdx]);
+            });
+            TemporalArray<CamArray<size_t>> aanChangedStereoLabels{};
+            if(!bStereoMoveCanFlipLabels)
+                ++oTelemetry.nSkippedMoveCount;
+            else
+                solvePrimalDual<ExplicitScaledFunction>(oStereoMinimizer,
+                                                        m_vStereoNodeMap,
+                                                        m_vStereoGraphIdxToMapIdxLUT,
+                                                        m_oStereoUnaryCosts,
+                                                        oCurrStereoLabeling,
+                                                        m_oStereoDualMap,
+                                                        m_oStereoHeightMap,
+                                                        nStereoAlphaLabel,
+                                                        m_nStereoLabels,true,
+                                                        aanChangedStereoLabels,
+                                                        pStereoMoveMask);
+            nChangedStereoLabels = aanChangedStereoLabels[0][m_nPrimaryCamIdx];
         }
+        vStereoLabelChangeCounts[nStereoAlphaLabel] += nChangedStereoLabels;
+        oTelemetry.nChangedStereoLabels += nChangedStereoLabels;
         ++nStereoLabelOrderingIdx %= m_vStereoLabelOrdering.size();
         nConsecUnchangedStereoLabels = (nChangedStereoLabels>0)?0:nConsecUnchangedStereoLabels+1;
         const bool bResegmNext = (nStereoMoveIter++%SEGMMATCH_DEFAULT_ITER_PER_RESEGM)==0;
-    #elif SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF
-        const InternalLabelType nStereoAlphaLabel = m_vStereoLabelOrdering[nStereoLabelOrderingIdx];
-        calcStereoMoveCosts(nStereoAlphaLabel);
-        const bool bStereoMoveCanFlipLabels = std::any_of(StereoGraphNodeIter(this,0),StereoGraphNodeIter(this,m_nValidStereoGraphNodes),[&](const StereoNodeInfo& oNode) {
-            return (((InternalLabelType*)oCurrStereoLabeling.data)[oNode.nMapIdx])!=nStereoAlphaLabel;
-        });
-        TemporalArray<CamArray<size_t>> aanChangedStereoLabels{};
-        if(bStereoMoveCanFlipLabels)
-            solvePrimalDual<ExplicitScaledFunction>(oStereoMinimizer,
-                                                    m_vStereoNodeMap,
-                                                    m_vStereoGraphIdxToMapIdxLUT,
-                                                    m_oStereoUnaryCosts,
-                                                    oCurrStereoLabeling,
-                                                    m_oStereoDualMap,
-                                                    m_oStereoHeightMap,
-                                                    nStereoAlphaLabel,
-                                                    m_nStereoLabels,true,
-                                                    aanChangedStereoLabels);
-        const bool bGotStereoLabelChange = aanChangedStereoLabels[0][m_nPrimaryCamIdx]>0;
-        ++nStereoLabelOrderingIdx %= m_vStereoLabelOrdering.size();
-        nConsecUnchangedStereoLabels = bGotStereoLabelChange?0:nConsecUnchangedStereoLabels+1;
-        const bool bResegmNext = (nStereoMoveIter++%SEGMMATCH_DEFAULT_ITER_PER_RESEGM)==0;
-    #endif //SEGMMATCH_CONFIG_USE_..._STEREO_INF
+    #endif //!SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
         if(lv::getVerbosity()>=3) {
             cv::Mat oCurrLabelingDisplay = getStereoDispMapDisplay(0,m_nPrimaryCamIdx);
             if(oCurrLabelingDisplay.size().area()<640*480)
@@ -3283,6 +3968,7 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
         }
         const ValueType tCurrStereoEnergy = m_pStereoInf->value();
         lvDbgAssert(tCurrStereoEnergy>=cost_cast(0));
+        oTelemetry.vStereoEnergies.push_back(tCurrStereoEnergy);
         std::stringstream ssStereoEnergyDiff;
         if((tCurrStereoEnergy-tLastStereoEnergy)==cost_cast(0))
             ssStereoEnergyDiff << "null";
@@ -3314,11 +4000,11 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
             size_t nTotChangedResegmLabels=0,nConsecUnchangedResegmLabels=0;
             constexpr std::array<InternalLabelType,2> anResegmLabels = {s_nForegroundLabelIdx,s_nBackgroundLabelIdx};
             const size_t nInitResegmMoveIter = nResegmMoveIter;
-        #if SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF
-            sospd::SubmodularIBFS<ValueType,IndexType> oResegmMinimizer;
+            sospd::SubmodularIBFS<ValueType,IndexType> oResegmSOSPDMinimizer; // resegm cliques are rebuilt for each pass
             size_t nInternalResegmCliqueCount = 0;
-        #endif //SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF
             TemporalArray<CamArray<size_t>> aanChangedResegmLabels{};
+            ++oTelemetry.nResegmPassCount;
+            oTelemetry.dStereoInfTime += oStageTimer.tock();
             while((++nResegmMoveIter-nInitResegmMoveIter)<=m_nMaxResegmMoveCount && nConsecUnchangedResegmLabels<s_nResegmLabels) {
                 const bool bInitResegmIter = (nResegmMoveIter-nInitResegmMoveIter)==1u;
                 const bool bNewResegmIter = ((nResegmMoveIter-nInitResegmMoveIter)%s_nResegmLabels)==1u;
@@ -3333,71 +4019,80 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
                     if(bNewResegmIter)
                         m_oSuperStackedResegmLabeling.copyTo(oPreResegmUpdateLabeling);
                 }
-            #if SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF
-                calcResegmMoveCosts(nResegmAlphaLabel);
-                oResegmReducer.Clear();
-                oResegmReducer.AddVars((int)m_nValidResegmGraphNodes);
-                for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
-                    const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
-                    const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
-                    if(oNode.nUnaryFactID!=SIZE_MAX) {
-                        const ValueType& tUnaryCost = ((ValueType*)m_oResegmUnaryCosts.data)[nLUTNodeIdx];
-                        lvDbgAssert(&tUnaryCost==&m_oResegmUnaryCosts(oNode.nRowIdx+int((oNode.nCamIdx*nTemporalLayerCount+oNode.nLayerIdx)*m_oGridSize[0]),oNode.nColIdx));
-                        oResegmReducer.AddUnaryTerm((int)nGraphNodeIdx,tUnaryCost);
+                oTelemetry.dResegmUpdateTime += oStageTimer.tock();
+                if(bUseFGBZResegmInf) {
+                    kolmogorov::qpbo::QPBO<ValueType>& oResegmMinimizer = *m_oInfWorkspace.pResegmFGBZMinimizer;
+                    calcResegmMoveCosts(nResegmAlphaLabel);
+                    oResegmReducer.Clear();
+                    oResegmReducer.AddVars((int)m_nValidResegmGraphNodes);
+                    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
+                        const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
+                        const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
+                        if(oNode.nUnaryFactID!=SIZE_MAX) {
+                            const ValueType& tUnaryCost = ((ValueType*)m_oResegmUnaryCosts.data)[nLUTNodeIdx];
+                            lvDbgAssert(&tUnaryCost==&m_oResegmUnaryCosts(oNode.nRowIdx+int((oNode.nCamIdx*nTemporalLayerCount+oNode.nLayerIdx)*m_oGridSize[0]),oNode.nColIdx));
+                            oResegmReducer.AddUnaryTerm((int)nGraphNodeIdx,tUnaryCost);
+                        }
+                        for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
+                            lv::gm::factorReducer<ExplicitFunction>(oNode.aPairwCliques[nOrientIdx],oResegmReducer,nResegmAlphaLabel,(InternalLabelType*)m_oSuperStackedResegmLabeling.data);
+                    #if SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
+                        lv::gm::factorReducer<ExplicitFunction>(oNode.oTemporalClique,oResegmReducer,nResegmAlphaLabel,(InternalLabelType*)m_oSuperStackedResegmLabeling.data);
+                    #endif //SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
                     }
-                    for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
-                        lv::gm::factorReducer<ExplicitFunction>(oNode.aPairwCliques[nOrientIdx],oResegmReducer,nResegmAlphaLabel,(InternalLabelType*)m_oSuperStackedResegmLabeling.data);
-                #if SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
-                    lv::gm::factorReducer<ExplicitFunction>(oNode.oTemporalClique,oResegmReducer,nResegmAlphaLabel,(InternalLabelType*)m_oSuperStackedResegmLabeling.data);
-                #endif //SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
-                }
-                oResegmMinimizer.Reset();
-                oResegmReducer.ToQuadratic(oResegmMinimizer);
-                oResegmMinimizer.Solve();
-                oResegmMinimizer.ComputeWeakPersistencies();
-                for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
-                    const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
-                    const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
-                    const int nMoveLabel = oResegmMinimizer.GetLabel((int)nGraphNodeIdx);
-                    lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
-                    if(nMoveLabel==1) { // node label changed to alpha
-                        ((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[nLUTNodeIdx] = nResegmAlphaLabel;
-                        ++aanChangedResegmLabels[oNode.nLayerIdx][oNode.nCamIdx];
+                    oResegmMinimizer.Reset();
+                    oResegmReducer.ToQuadratic(oResegmMinimizer);
+                    oResegmMinimizer.Solve();
+                    oResegmMinimizer.ComputeWeakPersistencies();
+                    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
+                        const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
+                        const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
+                        const int nMoveLabel = oResegmMinimizer.GetLabel((int)nGraphNodeIdx);
+                        lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
+                        if(nMoveLabel<0)
+                            ++oTelemetry.nUnlabeledNodeCount;
+                        else if(nMoveLabel==1) { // node label changed to alpha
+                            ((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[nLUTNodeIdx] = nResegmAlphaLabel;
+                            ++aanChangedResegmLabels[oNode.nLayerIdx][oNode.nCamIdx];
+                        }
                     }
                 }
-            #elif SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF
-                if(bNewResegmIter || SEGMMATCH_CONFIG_USE_CONT_RESEGM_UPDT) {
-                    if(bInitResegmIter) { // on the very first iteration, init minimizer with updated clique count
-                        nInternalResegmCliqueCount = initMinimizer(oResegmMinimizer,m_vResegmNodeMap,m_vResegmGraphIdxToMapIdxLUT);
-                        lvDbgAssert(nInternalResegmCliqueCount<=m_nResegmCliqueCount);
+                else {
+                    if(bNewResegmIter || SEGMMATCH_CONFIG_USE_CONT_RESEGM_UPDT) {
+                        if(bInitResegmIter) { // on the very first iteration, init minimizer with updated clique count
+                            nInternalResegmCliqueCount = initMinimizer(oResegmSOSPDMinimizer,m_vResegmNodeMap,m_vResegmGraphIdxToMapIdxLUT);
+                            lvDbgAssert(nInternalResegmCliqueCount<=m_nResegmCliqueCount);
+                        }
+                        const size_t nSetupResegmCliqueCount = setupPrimalDual<ExplicitFunction>(m_vResegmNodeMap,m_vResegmGraphIdxToMapIdxLUT,m_oSuperStackedResegmLabeling,m_oResegmDualMap,m_oResegmHeightMap,s_nResegmLabels,m_nResegmCliqueCount);
+                        lvAssert(nSetupResegmCliqueCount==nInternalResegmCliqueCount && nSetupResegmCliqueCount<=m_nResegmCliqueCount);
                     }
-                    const size_t nSetupResegmCliqueCount = setupPrimalDual<ExplicitFunction>(m_vResegmNodeMap,m_vResegmGraphIdxToMapIdxLUT,m_oSuperStackedResegmLabeling,m_oResegmDualMap,m_oResegmHeightMap,s_nResegmLabels,m_nResegmCliqueCount);
-                    lvAssert(nSetupResegmCliqueCount==nInternalResegmCliqueCount && nSetupResegmCliqueCount<=m_nResegmCliqueCount);
+                    calcResegmMoveCosts(nResegmAlphaLabel);
+                    const bool bResegmMoveCanFlipLabels = std::any_of(ResegmGraphNodeIter(this,0),ResegmGraphNodeIter(this,m_nValidResegmGraphNodes),[&](const ResegmNodeInfo& oNode) {
+                        return (((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[oNode.nLUTIdx])!=nResegmAlphaLabel;
+                    });
+                    //cv::Mat costtest;
+                    //m_oResegmUnaryCosts.convertTo(costtest,CV_32F);
+                    //cv::normalize(costtest,costtest,1,0,cv::NORM_MINMAX,-1,m_oSuperStackedROI);
+                    //cv::resize(costtest,costtest,cv::Size(),0.25,0.25);
+                    //cv::imshow("costtest",costtest);
+                    //cv::waitKey(1);
+                    if(!bResegmMoveCanFlipLabels)
+                        ++oTelemetry.nSkippedMoveCount;
+                    else
+                        solvePrimalDual<ExplicitFunction>(oResegmSOSPDMinimizer,
+                                                          m_vResegmNodeMap,
+                                                          m_vResegmGraphIdxToMapIdxLUT,
+                                                          m_oResegmUnaryCosts,
+                                                          m_oSuperStackedResegmLabeling,
+                                                          m_oResegmDualMap,
+                                                          m_oResegmHeightMap,
+                                                          nResegmAlphaLabel,
+                                                          s_nResegmLabels,false,
+                                                          aanChangedResegmLabels);
                 }
-                calcResegmMoveCosts(nResegmAlphaLabel);
-                const bool bResegmMoveCanFlipLabels = std::any_of(ResegmGraphNodeIter(this,0),ResegmGraphNodeIter(this,m_nValidResegmGraphNodes),[&](const ResegmNodeInfo& oNode) {
-                    return (((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[oNode.nLUTIdx])!=nResegmAlphaLabel;
-                });
-                //cv::Mat costtest;
-                //m_oResegmUnaryCosts.convertTo(costtest,CV_32F);
-                //cv::normalize(costtest,costtest,1,0,cv::NORM_MINMAX,-1,m_oSuperStackedROI);
-                //cv::resize(costtest,costtest,cv::Size(),0.25,0.25);
-                //cv::imshow("costtest",costtest);
-                //cv::waitKey(1);
-                if(bResegmMoveCanFlipLabels)
-                    solvePrimalDual<ExplicitFunction>(oResegmMinimizer,
-                                                      m_vResegmNodeMap,
-                                                      m_vResegmGraphIdxToMapIdxLUT,
-                                                      m_oResegmUnaryCosts,
-                                                      m_oSuperStackedResegmLabeling,
-                                                      m_oResegmDualMap,
-                                                      m_oResegmHeightMap,
-                                                      nResegmAlphaLabel,
-                                                      s_nResegmLabels,false,
-                                                      aanChangedResegmLabels);
-            #endif //SEGMMATCH_CONFIG_USE_..._RESEGM_INF
                 const ValueType tCurrResegmEnergy = m_pResegmInf->value();
                 lvDbgAssert(tCurrResegmEnergy>=cost_cast(0));
+                oTelemetry.vResegmEnergies.push_back(tCurrResegmEnergy);
+                oTelemetry.dResegmInfTime += oStageTimer.tock();
                 std::stringstream ssResegmEnergyDiff;
                 if((tCurrResegmEnergy-tLastResegmEnergy)==cost_cast(0))
                     ssResegmEnergyDiff << "null";
@@ -3434,8 +4129,10 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
                     }
                 }
             }
+            oTelemetry.dResegmInfTime += oStageTimer.tock();
+            oTelemetry.nChangedResegmLabels += nTotChangedResegmLabels;
             if(nTotChangedResegmLabels) {
-                calcShapeFeatures(m_aaResegmLabelings[0],m_avFeatures[0]); // only need to update latest labeling set for stereo
+                calcShapeFeatures(*m_pFeatExtractionCtx,m_aaResegmLabelings[0],m_avFeatures[0]); // only need to update latest labeling set for stereo
             #if SEGMMATCH_CONFIG_USE_FULL_DISP_RESETS
                 updateStereoModel(false);
                 resetStereoLabelings();
@@ -3450,6 +4147,7 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
             #endif //SEGMMATCH_CONFIG_USE_FULL_DISP_RESETS
                 bJustUpdatedSegm = true;
                 nConsecUnchangedStereoLabels = 0;
+                oTelemetry.dStereoUpdateTime += oStageTimer.tock();
             }
             const double dStereoIterChangeFraction = ((double)cv::countNonZero(oPreStereoUpdateLabeling^m_oSuperStackedResegmLabeling))/m_oSuperStackedResegmLabeling.total();
             //lvPrint(dStereoIterChangeFraction);
@@ -3460,6 +4158,15 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
             m_oSuperStackedResegmLabeling.copyTo(oPreStereoUpdateLabeling);
         }
     }
+    oTelemetry.dStereoInfTime += oStageTimer.tock();
+    oTelemetry.nStereoMoveCount = oTelemetry.vStereoEnergies.size();
+    oTelemetry.nResegmMoveCount = oTelemetry.vResegmEnergies.size();
+    if(m_oParams.bUseTemporalWarmStart) {
+        m_vStereoLabelChangeScores.resize(m_nStereoLabels,0.0f);
+        for(size_t nLabelIdx=0; nLabelIdx<m_nStereoLabels; ++nLabelIdx)
+            m_vStereoLabelChangeScores[nLabelIdx] = SEGMMATCH_DEFAULT_WARM_START_DECAY*m_vStereoLabelChangeScores[nLabelIdx] +
+                                                    (1.0f-SEGMMATCH_DEFAULT_WARM_START_DECAY)*float(vStereoLabelChangeCounts[nLabelIdx])/std::max(m_nValidStereoGraphNodes,size_t(1));
+    }
     // post-proc; update offset stereo labeling to latest proj result, and magic blur all the things (better smoothing than 4-cc!)
     for(size_t nCamIdx=0; nCamIdx<nCameraCount; ++nCamIdx) {
         if(nCamIdx!=m_nPrimaryCamIdx)
@@ -3469,6 +4176,7 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
         for(size_t nLayerIdx=0; nLayerIdx<nTemporalLayerCount; ++nLayerIdx)
             cv::medianBlur(m_aaResegmLabelings[nLayerIdx][nCamIdx],m_aaResegmLabelings[nLayerIdx][nCamIdx],5);
     }
+    oTelemetry.nModelBytes = calcModelByteCount();
     lvLog_(2,"Inference for primary camera idx=%d completed in %f second(s).",(int)m_nPrimaryCamIdx,oLocalTimer.tock());
     if(lv::getVerbosity()>=4)
         cv::waitKey(0);
@@ -17,115 +17,207 @@
 
 #include "litiv/imgproc.hpp"
 #include "litiv/features2d/MI.hpp"
+#include "litiv/features2d/registry.hpp"
 #include <opencv2/core/ocl.hpp>
 #if HAVE_CUDA
 #include "affinity.cuh"
 #endif //HAVE_CUDA
 
-void thinning_internal_ZhangSuen(cv::Mat& oInput, cv::Mat& oTempMarker, bool bIter) {
-    oTempMarker.create(oInput.size(),CV_8UC1);
-    oTempMarker = cv::Scalar_<uchar>(0);
-
-    const uchar* pAbove = nullptr;
-    const uchar* pCurr = oInput.ptr<uchar>(0);
-    const uchar* pBelow = oInput.ptr<uchar>(1);
-    const uchar* nw, *no, *ne;
-    const uchar* we, *me, *ea;
-    const uchar* sw, *so, *se;
-
-    for(int y=1; y<oInput.rows-1; ++y) {
-        // shift the rows up by one
-        pAbove = pCurr;
-        pCurr  = pBelow;
-        pBelow = oInput.ptr<uchar>(y+1);
-        uchar* pDst = oTempMarker.ptr<uchar>(y);
-
-        // initialize col pointers
-        no = &(pAbove[0]);
-        ne = &(pAbove[1]);
-        me = &(pCurr[0]);
-        ea = &(pCurr[1]);
-        so = &(pBelow[0]);
-        se = &(pBelow[1]);
-
-        for(int x=1; x<oInput.cols-1; ++x) {
-            // shift col pointers left by one (scan left to right)
-            nw = no;
-            no = ne;
-            ne = &(pAbove[x+1]);
-            we = me;
-            me = ea;
-            ea = &(pCurr[x+1]);
-            sw = so;
-            so = se;
-            se = &(pBelow[x+1]);
-
-            int A  = (!*no && *ne>0) + (!*ne && *ea>0) +
-                     (!*ea && *se>0) + (!*se && *so>0) +
-                     (!*so && *sw>0) + (!*sw && *we>0) +
-                     (!*we && *nw>0) + (!*nw && *no>0);
-            int B  = (*no>0)+(*ne>0)+(*ea>0)+(*se>0)+(*so>0)+(*sw>0)+(*we>0)+(*nw>0);
-            int m1 = !bIter?((*no>0)*(*ea>0)*(*so>0)):((*no>0)*(*ea>0)*(*we>0));
-            int m2 = !bIter?((*ea>0)*(*so>0)*(*we>0)):((*no>0)*(*so>0)*(*we>0));
-            if(A==1 && B>=2 && B<=6 && !m1 && !m2)
-                pDst[x] = UCHAR_MAX;
-        }
-    }
-    oInput &= ~oTempMarker;
-}
+namespace {
 
-void thinning_internal_LamLeeSuen(cv::Mat& oInput, bool bIter) {
-    for(int i=1; i<oInput.rows-1; ++i) {
-        for(int j=1; j<oInput.cols-1; ++j) {
-            if(!oInput.at<uchar>(i,j))
-                continue;
-            const std::array<uchar,8> anLUT{
-                oInput.at<uchar>(i+1,j  ),
-                oInput.at<uchar>(i+1,j-1),
-                oInput.at<uchar>(i  ,j-1),
-                oInput.at<uchar>(i-1,j-1),
-                oInput.at<uchar>(i-1,j  ),
-                oInput.at<uchar>(i-1,j+1),
-                oInput.at<uchar>(i  ,j+1),
-                oInput.at<uchar>(i+1,j+1)
-            };
-            size_t x_h = 0, n1 = 0, n2 = 0;
-            for(size_t k=0; k<4; ++k) {
-#if defined(_MSC_VER) || USE_IMGPROC_THINNING_MATLAB_IMPL_FIX
-                // G1:
-                x_h += bool(!anLUT[2*(k+1)-2] && (anLUT[2*(k+1)-1] || anLUT[(2*(k+1))%8]));
-                // G2:
-                n1 += bool(anLUT[2*(k+1)-2] || anLUT[2*(k+1)-1]);
-                n2 += bool(anLUT[2*(k+1)-1] || anLUT[(2*(k+1))%8]);
-#elif defined(__clang__)
-#pragma clang diagnostic push
-// but no warnings to push...?
-#elif (defined(__GNUC__) || defined(__GNUG__))
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#endif //(defined(__GNUC__) || defined(__GNUG__))
-                // G1:
-                x_h += bool(!anLUT[2*(k+1)-2] && (anLUT[2*(k+1)-1] || anLUT[2*(k+1)]));
-                // G2:
-                n1 += bool(anLUT[2*(k+1)-2] || anLUT[2*(k+1)-1]);
-                n2 += bool(anLUT[2*(k+1)-1] || anLUT[2*(k+1)]);
-#if defined(__clang__)
-#pragma clang diagnostic pop
-#elif (defined(__GNUC__) || defined(__GNUG__))
-#pragma GCC diagnostic pop
-#endif //(defined(__GNUC__) || defined(__GNUG__))
+    /// ground-distance tree used for closed-form EMD evaluation (minimum spanning tree of an EMD cost map, nodes stored in root-first order)
+    struct EMDTreeData {
+        std::vector<int> vnNodeOrder,vnParentNodes;
+        std::vector<float> vfEdgeCosts;
+        float fMaxCost;
+    };
+
+    /// builds the minimum spanning tree of a (symmetric) EMD cost map via Prim's algorithm
+    void buildEMDTree(const cv::Mat_<float>& oEMDCostMap, EMDTreeData& oTree) {
+        const int nBins = oEMDCostMap.rows;
+        oTree.vnNodeOrder.clear();
+        oTree.vnParentNodes.assign(size_t(nBins),-1);
+        oTree.vfEdgeCosts.assign(size_t(nBins),0.0f);
+        double dMaxCost;
+        cv::minMaxIdx(oEMDCostMap,nullptr,&dMaxCost);
+        oTree.fMaxCost = float(dMaxCost);
+        std::vector<float> vfMinCosts(size_t(nBins),std::numeric_limits<float>::max());
+        std::vector<bool> vbInTree(size_t(nBins),false);
+        vfMinCosts[0] = 0.0f;
+        for(int nIter=0; nIter<nBins; ++nIter) {
+            int nNextNode = -1;
+            for(int nBinIdx=0; nBinIdx<nBins; ++nBinIdx)
+                if(!vbInTree[nBinIdx] && (nNextNode<0 || vfMinCosts[nBinIdx]<vfMinCosts[nNextNode]))
+                    nNextNode = nBinIdx;
+            vbInTree[nNextNode] = true;
+            oTree.vnNodeOrder.push_back(nNextNode);
+            oTree.vfEdgeCosts[nNextNode] = vfMinCosts[nNextNode];
+            for(int nBinIdx=0; nBinIdx<nBins; ++nBinIdx) {
+                if(!vbInTree[nBinIdx] && oEMDCostMap(nNextNode,nBinIdx)<vfMinCosts[nBinIdx]) {
+                    vfMinCosts[nBinIdx] = oEMDCostMap(nNextNode,nBinIdx);
+                    oTree.vnParentNodes[nBinIdx] = nNextNode;
+                }
+            }
+        }
+    }
+
+    /// computes the closed-form tree-EMD between two histograms (each scaled by its inverse L1 norm), using a scratch buffer of tree size
+    float calcTreeEMD(const EMDTreeData& oTree, const float* pHist1, float fInvSum1, const float* pHist2, float fInvSum2, float* pFlows) {
+        if(fInvSum1==0.0f || fInvSum2==0.0f) // null histogram(s); nothing to move if both are empty, and no valid flow otherwise
+            return (fInvSum1==fInvSum2)?0.0f:oTree.fMaxCost;
+        const size_t nBins = oTree.vnNodeOrder.size();
+        for(size_t nBinIdx=0; nBinIdx<nBins; ++nBinIdx)
+            pFlows[nBinIdx] = pHist1[nBinIdx]*fInvSum1-pHist2[nBinIdx]*fInvSum2;
+        // each tree edge carries the net mass surplus of the subtree below it; children are visited before their parents
+        double dResult = 0.0;
+        for(size_t nOrderIdx=nBins-1; nOrderIdx>0; --nOrderIdx) {
+            const int nNode = oTree.vnNodeOrder[nOrderIdx];
+            dResult += oTree.vfEdgeCosts[nNode]*std::abs(pFlows[nNode]);
+            pFlows[oTree.vnParentNodes[nNode]] += pFlows[nNode];
+        }
+        return float(dResult);
+    }
+
+} // anonymous namespace
+
+namespace {
+
+    /// packs the binary 3x3 neighborhood of a pixel in a byte, with bits ordered as {S,SW,W,NW,N,NE,E,SE} (from LSB to MSB)
+    inline uchar getThinningNeighbCode(const uchar* pCenter, size_t nRowStep) {
+        return uchar((pCenter[nRowStep]!=0)|((pCenter[nRowStep-1]!=0)<<1)|((pCenter[-1]!=0)<<2)|((pCenter[-ptrdiff_t(nRowStep)-1]!=0)<<3)|
+                     ((pCenter[-ptrdiff_t(nRowStep)]!=0)<<4)|((pCenter[-ptrdiff_t(nRowStep)+1]!=0)<<5)|((pCenter[1]!=0)<<6)|((pCenter[nRowStep+1]!=0)<<7));
+    }
+
+    /// thinning deletion lookup table, indexed by sub-iteration parity and by packed 3x3 neighborhood code
+    using ThinningLUT = std::array<std::array<bool,256>,2>;
+
+    /// returns the deletion LUT for Zhang-Suen sub-iterations
+    const ThinningLUT& getThinningLUT_ZhangSuen() {
+        static const ThinningLUT s_aabLUT = [](){
+            ThinningLUT aabLUT;
+            for(size_t nCode=0; nCode<256; ++nCode) {
+                const auto x = [&](size_t nBit){return int((nCode>>nBit)&1);};
+                const int so=x(0), sw=x(1), we=x(2), nw=x(3), no=x(4), ne=x(5), ea=x(6), se=x(7);
+                const int A = (!no && ne) + (!ne && ea) + (!ea && se) + (!se && so) +
+                              (!so && sw) + (!sw && we) + (!we && nw) + (!nw && no);
+                const int B = no+ne+ea+se+so+sw+we+nw;
+                for(size_t nIter=0; nIter<2; ++nIter) {
+                    const int m1 = !nIter?(no*ea*so):(no*ea*we);
+                    const int m2 = !nIter?(ea*so*we):(no*so*we);
+                    aabLUT[nIter][nCode] = (A==1 && B>=2 && B<=6 && !m1 && !m2);
+                }
             }
-            size_t n_min = std::min(n1,n2);
-            if(x_h==1 && n_min>=2 && n_min<=3) {
+            return aabLUT;
+        }();
+        return s_aabLUT;
+    }
+
+    /// returns the deletion LUT for Lam-Lee-Suen sub-iterations (with x9==x1, as in Matlab's 'bwmorph' implementation)
+    const ThinningLUT& getThinningLUT_LamLeeSuen() {
+        static const ThinningLUT s_aabLUT = [](){
+            ThinningLUT aabLUT;
+            for(size_t nCode=0; nCode<256; ++nCode) {
+                const auto x = [&](size_t nBit){return bool((nCode>>(nBit%8))&1);};
+                size_t x_h = 0, n1 = 0, n2 = 0;
+                for(size_t k=0; k<4; ++k) {
+                    // G1:
+                    x_h += size_t(!x(2*k) && (x(2*k+1) || x(2*k+2)));
+                    // G2:
+                    n1 += size_t(x(2*k) || x(2*k+1));
+                    n2 += size_t(x(2*k+1) || x(2*k+2));
+                }
+                const size_t n_min = std::min(n1,n2);
+                const bool bG12 = (x_h==1 && n_min>=2 && n_min<=3);
                 // G3 || G3' :
-                if( (!bIter && !((anLUT[1] || anLUT[2] || !anLUT[7]) && anLUT[0])) ||
-                    (bIter && !((anLUT[5] || anLUT[6] || !anLUT[3]) && anLUT[4]))) {
-                    oInput.at<uchar>(i,j) = 0;
+                aabLUT[0][nCode] = bG12 && !((x(1) || x(2) || !x(7)) && x(0));
+                aabLUT[1][nCode] = bG12 && !((x(5) || x(6) || !x(3)) && x(4));
+            }
+            return aabLUT;
+        }();
+        return s_aabLUT;
+    }
+
+    /// active-front thinning: only the neighbors of deleted pixels are re-examined in the following sub-iterations
+    /// (sequential sub-iterations update the image in raster order, as if scanned in place; otherwise, all deletions are deferred)
+    template<bool bSequential>
+    void thinning_internal(cv::Mat& oImage, const ThinningLUT& aabLUT) {
+        lvDbgAssert(oImage.isContinuous() && oImage.type()==CV_8UC1 && oImage.rows>2 && oImage.cols>2);
+        const size_t nRowStep = (size_t)oImage.cols;
+        uchar* const pImage = oImage.data;
+        const auto lIsInterior = [&](size_t nIdx) {
+            const size_t nColIdx = nIdx%nRowStep;
+            return nIdx>nRowStep && nIdx<oImage.total()-nRowStep && nColIdx>0 && nColIdx<nRowStep-1;
+        };
+        // candidates for the current, next and second-next sub-iterations (duplicates are removed before each sub-iteration)
+        static thread_local std::array<std::vector<size_t>,3> s_avnCandidates;
+        static thread_local std::vector<size_t> s_vnDeletions;
+        for(auto& vnCandidates : s_avnCandidates)
+            vnCandidates.clear();
+        for(size_t nRowIdx=1; nRowIdx<(size_t)oImage.rows-1; ++nRowIdx) {
+            for(size_t nColIdx=1; nColIdx<nRowStep-1; ++nColIdx) {
+                const size_t nIdx = nRowIdx*nRowStep+nColIdx;
+                // only contour pixels can be deleted until one of their neighbors is (both LUTs reject full neighborhoods)
+                if(pImage[nIdx] && getThinningNeighbCode(pImage+nIdx,nRowStep)!=UCHAR_MAX)
+                    s_avnCandidates[0].push_back(nIdx);
+            }
+        }
+        s_avnCandidates[1] = s_avnCandidates[0];
+        const std::array<ptrdiff_t,8> anNeighbOffsets = {
+            -ptrdiff_t(nRowStep)-1,-ptrdiff_t(nRowStep),-ptrdiff_t(nRowStep)+1,-1,1,ptrdiff_t(nRowStep)-1,ptrdiff_t(nRowStep),ptrdiff_t(nRowStep)+1
+        };
+        std::priority_queue<size_t,std::vector<size_t>,std::greater<size_t>> oRasterQueue;
+        for(size_t nIter=0; !s_avnCandidates[0].empty() || !s_avnCandidates[1].empty(); ++nIter) {
+            const std::array<bool,256>& abLUT = aabLUT[nIter%2];
+            std::vector<size_t>& vnCurrCandidates = s_avnCandidates[0];
+            std::sort(vnCurrCandidates.begin(),vnCurrCandidates.end());
+            vnCurrCandidates.erase(std::unique(vnCurrCandidates.begin(),vnCurrCandidates.end()),vnCurrCandidates.end());
+            const auto lFlagNeighbors = [&](size_t nIdx) {
+                for(const ptrdiff_t nOffset : anNeighbOffsets) {
+                    const size_t nNeighbIdx = size_t(ptrdiff_t(nIdx)+nOffset);
+                    if(pImage[nNeighbIdx] && lIsInterior(nNeighbIdx)) {
+                        s_avnCandidates[1].push_back(nNeighbIdx);
+                        s_avnCandidates[2].push_back(nNeighbIdx);
+                        if(bSequential && nOffset>0) // neighbor has not been visited yet in the current scan
+                            oRasterQueue.push(nNeighbIdx);
+                    }
                 }
+            };
+            if(bSequential) {
+                // candidates must be visited in raster order, with late additions from the current sub-iteration
+                size_t nCandIdx = 0, nLastIdx = SIZE_MAX;
+                while(nCandIdx<vnCurrCandidates.size() || !oRasterQueue.empty()) {
+                    size_t nIdx;
+                    if(oRasterQueue.empty() || (nCandIdx<vnCurrCandidates.size() && vnCurrCandidates[nCandIdx]<oRasterQueue.top()))
+                        nIdx = vnCurrCandidates[nCandIdx++];
+                    else
+                        nIdx = oRasterQueue.top(), oRasterQueue.pop();
+                    if(nIdx==nLastIdx)
+                        continue;
+                    nLastIdx = nIdx;
+                    if(pImage[nIdx] && abLUT[getThinningNeighbCode(pImage+nIdx,nRowStep)]) {
+                        pImage[nIdx] = 0;
+                        lFlagNeighbors(nIdx);
+                    }
+                }
+            }
+            else {
+                // all candidates are evaluated on the same image state, and deletions are applied afterwards
+                s_vnDeletions.clear();
+                for(const size_t nIdx : vnCurrCandidates)
+                    if(pImage[nIdx] && abLUT[getThinningNeighbCode(pImage+nIdx,nRowStep)])
+                        s_vnDeletions.push_back(nIdx);
+                for(const size_t nIdx : s_vnDeletions)
+                    pImage[nIdx] = 0;
+                for(const size_t nIdx : s_vnDeletions)
+                    lFlagNeighbors(nIdx);
             }
+            std::swap(s_avnCandidates[0],s_avnCandidates[1]);
+            std::swap(s_avnCandidates[1],s_avnCandidates[2]);
+            s_avnCandidates[2].clear();
         }
     }
-}
+
+} // anonymous namespace
 
 void lv::thinning(const cv::Mat& oInput, cv::Mat& oOutput, ThinningMode eMode) {
     lvAssert_(!oInput.empty() && oInput.isContinuous(),"input image must be non-empty and continuous");
@@ -133,22 +225,10 @@ void lv::thinning(const cv::Mat& oInput, cv::Mat& oOutput, ThinningMode eMode) {
     lvAssert_(oInput.rows>3 && oInput.cols>3,"input image size must be greater than 3x3");
     oOutput.create(oInput.size(),CV_8UC1);
     oInput.copyTo(oOutput);
-    cv::Mat oPrevious(oInput.size(),CV_8UC1,cv::Scalar_<uchar>(0));
-    cv::Mat oTempMarker;
-    bool bEq;
-    do {
-        if(eMode==ThinningMode_ZhangSuen) {
-            thinning_internal_ZhangSuen(oOutput,oTempMarker,false);
-            thinning_internal_ZhangSuen(oOutput,oTempMarker,true);
-        }
-        else { //eMode==ThinningMode_LamLeeSuen
-            thinning_internal_LamLeeSuen(oOutput,false);
-            thinning_internal_LamLeeSuen(oOutput,true);
-        }
-        bEq = std::equal(oOutput.begin<uchar>(),oOutput.end<uchar>(),oPrevious.begin<uchar>());
-        oOutput.copyTo(oPrevious);
-    }
-    while(!bEq);
+    if(eMode==ThinningMode_ZhangSuen)
+        thinning_internal<false>(oOutput,getThinningLUT_ZhangSuen());
+    else //eMode==ThinningMode_LamLeeSuen
+        thinning_internal<true>(oOutput,getThinningLUT_LamLeeSuen());
 }
 
 std::vector<int> lv::calcHistCounts(const cv::Mat& oInput, const cv::Mat_<uchar>& oMask, int* pnTotCount) {
@@ -229,29 +309,93 @@ void lv::medianBlur(const cv::Mat& oInput, cv::Mat& oOutput, const cv::Mat_<ucha
     }
     if(oOutput.empty())
         oOutput.create(oInput.size(),CV_8UC1);
+    // constant-time masked median (Perreault & Hebert, 2007): per-column histograms are slid down each row band, and
+    // their sum is slid along each row; the window's fine (value) histograms are only updated for the coarse bins that
+    // actually contain a median, and are rebuilt from column histograms when they are too stale to be updated incrementally
     const int nOffset=nKernelSize/2, nRows=oInput.rows, nCols=oInput.cols;
+    lvAssert_(nKernelSize<=USHRT_MAX,"kernel size too large for column histograms");
+    constexpr int nCoarseBins=16, nFineBins=UCHAR_MAX+1, nFineBinsPerCoarseBin=nFineBins/nCoarseBins;
+    const int nBandRows = std::max(nKernelSize*4,64); // amortizes column histograms initialization over several rows
+    const int nBands = (nRows+nBandRows-1)/nBandRows;
 #if USING_OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
 #endif //USING_OPENMP
-    for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
-        static thread_local lv::AutoBuffer<uchar> aKernelBuffer;
-        aKernelBuffer.resize(size_t(nKernelSize*nKernelSize));
-        for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
-            int nKernelHits = 0;
-            for(int nOffsetRowIdx=std::max(nRowIdx-nOffset,0); nOffsetRowIdx<=std::min(nRowIdx+nOffset,nRows-1); ++nOffsetRowIdx) {
-                for(int nOffsetColIdx=std::max(nColIdx-nOffset,0); nOffsetColIdx<=std::min(nColIdx+nOffset,nCols-1); ++nOffsetColIdx) {
-                    const size_t nOffsetPxIdx = size_t(nOffsetRowIdx*nCols+nOffsetColIdx);
-                    if(oMask.data[nOffsetPxIdx])
-                        aKernelBuffer[nKernelHits++] = oInput.data[nOffsetPxIdx];
+    for(int nBandIdx=0; nBandIdx<nBands; ++nBandIdx) {
+        static thread_local std::vector<ushort> s_vnColCoarseHists,s_vnColFineHists;
+        s_vnColCoarseHists.assign(size_t(nCols*nCoarseBins),ushort(0));
+        s_vnColFineHists.assign(size_t(nCols*nFineBins),ushort(0));
+        const auto lUpdateColHists = [&](int nRowIdx, int nInc) {
+            const uchar* pInputRow = oInput.data+size_t(nRowIdx*nCols);
+            const uchar* pMaskRow = oMask.data+size_t(nRowIdx*nCols);
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                if(pMaskRow[nColIdx]) {
+                    s_vnColCoarseHists[nColIdx*nCoarseBins+pInputRow[nColIdx]/nFineBinsPerCoarseBin] += ushort(nInc);
+                    s_vnColFineHists[nColIdx*nFineBins+pInputRow[nColIdx]] += ushort(nInc);
                 }
             }
-            const int nPxIdx = nRowIdx*nCols+nColIdx;
-            if(nKernelHits>0) {
-                std::nth_element(aKernelBuffer.begin(),aKernelBuffer.begin()+(nKernelHits-1)/2,aKernelBuffer.begin()+nKernelHits);
-                oOutput.data[nPxIdx] = *(aKernelBuffer.begin()+(nKernelHits-1)/2);
+        };
+        const int nBandStartRowIdx = nBandIdx*nBandRows, nBandEndRowIdx = std::min(nBandStartRowIdx+nBandRows,nRows);
+        for(int nOffsetRowIdx=std::max(nBandStartRowIdx-nOffset,0); nOffsetRowIdx<std::min(nBandStartRowIdx+nOffset,nRows); ++nOffsetRowIdx)
+            lUpdateColHists(nOffsetRowIdx,1);
+        for(int nRowIdx=nBandStartRowIdx; nRowIdx<nBandEndRowIdx; ++nRowIdx) {
+            if(nRowIdx-nOffset-1>=0 && nRowIdx>nBandStartRowIdx)
+                lUpdateColHists(nRowIdx-nOffset-1,-1);
+            if(nRowIdx+nOffset<nRows)
+                lUpdateColHists(nRowIdx+nOffset,1);
+            std::array<int,nCoarseBins> anCoarseHist{};
+            std::array<std::array<int,nFineBinsPerCoarseBin>,nCoarseBins> aanFineHists;
+            std::array<int,nCoarseBins> anFineHistColIdxs; // column index at which each window fine histogram was last valid
+            anFineHistColIdxs.fill(-1);
+            const auto lUpdateFineHist = [&](int nCoarseBinIdx, int nColIdx, int nInc) {
+                if(nColIdx<0 || nColIdx>=nCols)
+                    return;
+                const ushort* pColFineHist = s_vnColFineHists.data()+nColIdx*nFineBins+nCoarseBinIdx*nFineBinsPerCoarseBin;
+                for(int nFineBinIdx=0; nFineBinIdx<nFineBinsPerCoarseBin; ++nFineBinIdx)
+                    aanFineHists[nCoarseBinIdx][nFineBinIdx] += nInc*int(pColFineHist[nFineBinIdx]);
+            };
+            for(int nOffsetColIdx=0; nOffsetColIdx<std::min(nOffset,nCols); ++nOffsetColIdx)
+                for(int nCoarseBinIdx=0; nCoarseBinIdx<nCoarseBins; ++nCoarseBinIdx)
+                    anCoarseHist[nCoarseBinIdx] += s_vnColCoarseHists[nOffsetColIdx*nCoarseBins+nCoarseBinIdx];
+            uchar* pOutputRow = oOutput.data+size_t(nRowIdx*nCols);
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                if(nColIdx-nOffset-1>=0)
+                    for(int nCoarseBinIdx=0; nCoarseBinIdx<nCoarseBins; ++nCoarseBinIdx)
+                        anCoarseHist[nCoarseBinIdx] -= s_vnColCoarseHists[(nColIdx-nOffset-1)*nCoarseBins+nCoarseBinIdx];
+                if(nColIdx+nOffset<nCols)
+                    for(int nCoarseBinIdx=0; nCoarseBinIdx<nCoarseBins; ++nCoarseBinIdx)
+                        anCoarseHist[nCoarseBinIdx] += s_vnColCoarseHists[(nColIdx+nOffset)*nCoarseBins+nCoarseBinIdx];
+                int nKernelHits = 0;
+                for(int nCoarseBinIdx=0; nCoarseBinIdx<nCoarseBins; ++nCoarseBinIdx)
+                    nKernelHits += anCoarseHist[nCoarseBinIdx];
+                if(nKernelHits==0) {
+                    pOutputRow[nColIdx] = nDefaultVal;
+                    continue;
+                }
+                // looks for the lower median, i.e. the element at index (n-1)/2 in the sorted window
+                int nCoarseBinIdx = 0, nRemainingHits = (nKernelHits-1)/2;
+                while(nRemainingHits>=anCoarseHist[nCoarseBinIdx])
+                    nRemainingHits -= anCoarseHist[nCoarseBinIdx++];
+                lvDbgAssert(nCoarseBinIdx<nCoarseBins);
+                int& nFineHistColIdx = anFineHistColIdxs[nCoarseBinIdx];
+                if(nFineHistColIdx<0 || (nColIdx-nFineHistColIdx)*2>nKernelSize) {
+                    aanFineHists[nCoarseBinIdx].fill(0);
+                    for(int nOffsetColIdx=nColIdx-nOffset; nOffsetColIdx<=nColIdx+nOffset; ++nOffsetColIdx)
+                        lUpdateFineHist(nCoarseBinIdx,nOffsetColIdx,1);
+                }
+                else {
+                    for(int nPrevColIdx=nFineHistColIdx+1; nPrevColIdx<=nColIdx; ++nPrevColIdx) {
+                        lUpdateFineHist(nCoarseBinIdx,nPrevColIdx-nOffset-1,-1);
+                        lUpdateFineHist(nCoarseBinIdx,nPrevColIdx+nOffset,1);
+                    }
+                }
+                nFineHistColIdx = nColIdx;
+                const std::array<int,nFineBinsPerCoarseBin>& anFineHist = aanFineHists[nCoarseBinIdx];
+                int nFineBinIdx = 0;
+                while(nRemainingHits>=anFineHist[nFineBinIdx])
+                    nRemainingHits -= anFineHist[nFineBinIdx++];
+                lvDbgAssert(nFineBinIdx<nFineBinsPerCoarseBin);
+                pOutputRow[nColIdx] = uchar(nCoarseBinIdx*nFineBinsPerCoarseBin+nFineBinIdx);
             }
-            else
-                oOutput.data[nPxIdx] = nDefaultVal;
         }
     }
 }
@@ -368,12 +512,8 @@ void lv::computeImageAffinity(const cv::Mat& oImage1, const cv::Mat& oImage2, in
     lvAssert_(nPatchSize>=1 && (nPatchSize%2)==1,"bad patch size");
     lvAssert_(nPatchSize<=oImage1.rows && nPatchSize<=oImage1.cols,"patch too large for input images");
     lvAssert_(vDispRange.size()>=1,"bad disparity range");
-    cv::Mat_<uchar> oImage1_uchar,oImage2_uchar;
-    if(eDist==lv::AffinityDist_MI) {
+    if(eDist==lv::AffinityDist_MI)
         lvAssert_(oImage1.type()==oImage2.type() && oImage1.type()==CV_8UC1,"bad input image types/depth");
-        oImage1_uchar = oImage1;
-        oImage2_uchar = oImage2;
-    }
     else /*if(eDist==lv::AffinityDist_SSD)*/
         lvAssert_(oImage1.type()==oImage2.type() && oImage1.channels()==1,"bad input image types/depth");
     const bool bValidROI1 = !oROI1.empty();
@@ -382,35 +522,116 @@ void lv::computeImageAffinity(const cv::Mat& oImage1, const cv::Mat& oImage2, in
     const int nCols = oImage1.cols;
     const int nPatchRadius = nPatchSize/2;
     const int nOffsets = int(vDispRange.size());
-    const std::array<int,3> anAffinityMapDims = {nRows-nPatchRadius*2,nCols-nPatchRadius*2,nOffsets};
+    const int nValidRows = nRows-nPatchRadius*2;
+    const std::array<int,3> anAffinityMapDims = {nValidRows,nCols-nPatchRadius*2,nOffsets};
     oAffinityMap.create(3,anAffinityMapDims.data());
     oAffinityMap = -1.0f; // default value for OOB pixels
-    thread_local lv::JointSparseHistData<uchar,uchar> oSparseHistData;
+    // note: both distances are evaluated per disparity offset, so that the cost of each lookup no longer depends on patch size
+    const auto lIsValidMatch = [&](int nRowIdx, int nColIdx, int nOffsetColIdx) {
+        return (!bValidROI1 || oROI1(nRowIdx,nColIdx)) && (!bValidROI2 || oROI2(nRowIdx,nOffsetColIdx));
+    };
+    if(eDist==lv::AffinityDist_SSD) {
+        // SSD: squared difference image computed once per offset, then box-filtered via its integral image into a disparity-major plane
+        cv::Mat_<double> oImage1_double,oImage2_double;
+        oImage1.convertTo(oImage1_double,CV_64F);
+        oImage2.convertTo(oImage2_double,CV_64F);
+        const int nValidCols = anAffinityMapDims[1];
+        const std::array<int,3> anPlaneMapDims = {nOffsets,nValidRows,nValidCols};
+        cv::Mat_<float> oAffinityPlanes(3,anPlaneMapDims.data(),-1.0f); // default value for OOB pixels; released on return (can be large for wide disp ranges)
 #if USING_OPENMP
-#ifdef _MSC_VER
-    #pragma omp parallel for // msvc only supports openmp 2.0
-#else //ndef(_MSC_VER)
-    #pragma omp parallel for collapse(3)
-#endif //ndef(_MSC_VER)
+        #pragma omp parallel for
 #endif //USING_OPENMP
-    for(int nRowIdx=nPatchRadius; nRowIdx<nRows-nPatchRadius; ++nRowIdx) {
-        for(int nColIdx=nPatchRadius; nColIdx<nCols-nPatchRadius; ++nColIdx) {
-            for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
-                const int nColOffset = vDispRange[nOffsetIdx];
-                const int nOffsetColIdx = nColIdx+nColOffset;
-                if((bValidROI1 && !oROI1(nRowIdx,nColIdx)) || nOffsetColIdx<nPatchRadius || nOffsetColIdx>=nCols-nPatchRadius || (bValidROI2 && !oROI2(nRowIdx,nOffsetColIdx)))
-                    continue;
-                const cv::Rect oWindow(nColIdx-nPatchRadius,nRowIdx-nPatchRadius,nPatchSize,nPatchSize);
-                const cv::Rect oOffsetWindow(nOffsetColIdx-nPatchRadius,nRowIdx-nPatchRadius,nPatchSize,nPatchSize);
-                if(eDist==lv::AffinityDist_MI) {
-                    const double dMutualInfoScore = lv::calcMutualInfo<1,true,true,false,false>(oImage1_uchar(oWindow),oImage2_uchar(oOffsetWindow),&oSparseHistData);
-                    oAffinityMap.at<float>(nRowIdx-nPatchRadius,nColIdx-nPatchRadius,nOffsetIdx) = std::max(float(1.0-dMutualInfoScore),0.0f);
-                }
-                else /*if(eDist==lv::AffinityDist_SSD)*/ {
-                    oAffinityMap.at<float>(nRowIdx-nPatchRadius,nColIdx-nPatchRadius,nOffsetIdx) = (float)cv::norm(oImage1(oWindow),oImage2(oOffsetWindow),cv::NORM_L2);
+        for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+            const int nColOffset = vDispRange[nOffsetIdx];
+            // overlapping column range (in image #1 coords) for which both pixels of a pair exist
+            const int nOverlapStartColIdx = std::max(0,-nColOffset), nOverlapEndColIdx = std::min(nCols,nCols-nColOffset);
+            if(nOverlapEndColIdx-nOverlapStartColIdx<nPatchSize)
+                continue;
+            static thread_local cv::Mat_<double> s_oSqrDiff,s_oSqrDiffIntegral;
+            cv::subtract(oImage1_double.colRange(nOverlapStartColIdx,nOverlapEndColIdx),oImage2_double.colRange(nOverlapStartColIdx+nColOffset,nOverlapEndColIdx+nColOffset),s_oSqrDiff);
+            cv::multiply(s_oSqrDiff,s_oSqrDiff,s_oSqrDiff);
+            cv::integral(s_oSqrDiff,s_oSqrDiffIntegral,CV_64F);
+            const int nStartColIdx = nOverlapStartColIdx+nPatchRadius, nEndColIdx = nOverlapEndColIdx-nPatchRadius;
+            for(int nRowIdx=nPatchRadius; nRowIdx<nRows-nPatchRadius; ++nRowIdx) {
+                const double* pIntegralTopRow = s_oSqrDiffIntegral.ptr<double>(nRowIdx-nPatchRadius);
+                const double* pIntegralBottomRow = s_oSqrDiffIntegral.ptr<double>(nRowIdx+nPatchRadius+1);
+                for(int nColIdx=nStartColIdx; nColIdx<nEndColIdx; ++nColIdx) {
+                    if(!lIsValidMatch(nRowIdx,nColIdx,nColIdx+nColOffset))
+                        continue;
+                    const int nLeftIdx = nColIdx-nPatchRadius-nOverlapStartColIdx, nRightIdx = nLeftIdx+nPatchSize;
+                    const double dSqrDiffSum = pIntegralBottomRow[nRightIdx]-pIntegralBottomRow[nLeftIdx]-pIntegralTopRow[nRightIdx]+pIntegralTopRow[nLeftIdx];
+                    oAffinityPlanes(nOffsetIdx,nRowIdx-nPatchRadius,nColIdx-nPatchRadius) = (float)std::sqrt(std::max(dSqrDiffSum,0.0));
                 }
             }
         }
+        // output rows are split between threads, so no two threads ever write to the same (offset-interleaved) cache lines
+#if USING_OPENMP
+        #pragma omp parallel for
+#endif //USING_OPENMP
+        for(int nRowIdx=0; nRowIdx<nValidRows; ++nRowIdx)
+            for(int nColIdx=0; nColIdx<nValidCols; ++nColIdx)
+                for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx)
+                    oAffinityMap(nRowIdx,nColIdx,nOffsetIdx) = oAffinityPlanes(nOffsetIdx,nRowIdx,nColIdx);
+        return;
+    }
+    // MI: joint/marginal histogram counts slid along each row (one column in, one column out), with entropies updated
+    //     via count*log2(count) sums; the score is identical to lv::calcMutualInfo<1,true,true> (normalized MI)
+    const int nPatchElems = nPatchSize*nPatchSize;
+    std::vector<double> vdCountLogs(size_t(nPatchElems+1));
+    vdCountLogs[0] = 0.0;
+    for(int nCount=1; nCount<=nPatchElems; ++nCount)
+        vdCountLogs[nCount] = nCount*std::log2(double(nCount));
+    const double dPatchElemsLog = std::log2(double(nPatchElems));
+    const cv::Mat_<uchar> oImage1_uchar = oImage1, oImage2_uchar = oImage2;
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nJobIdx=0; nJobIdx<nOffsets*nValidRows; ++nJobIdx) {
+        const int nOffsetIdx = nJobIdx/nValidRows;
+        const int nRowIdx = nJobIdx%nValidRows+nPatchRadius;
+        const int nColOffset = vDispRange[nOffsetIdx];
+        const int nStartColIdx = std::max(nPatchRadius,nPatchRadius-nColOffset), nEndColIdx = std::min(nCols-nPatchRadius,nCols-nPatchRadius-nColOffset);
+        if(nStartColIdx>=nEndColIdx)
+            continue;
+        static thread_local std::vector<int> s_vnJointCounts(size_t(UCHAR_MAX+1)*(UCHAR_MAX+1),0);
+        static thread_local std::array<std::array<int,UCHAR_MAX+1>,2> s_aanMargCounts = {};
+        std::array<double,2> adMargCountLogSums = {0.0,0.0};
+        double dJointCountLogSum = 0.0;
+        const auto lUpdateColumn = [&](int nColIdx, int nDelta) {
+            for(int nPatchRowIdx=nRowIdx-nPatchRadius; nPatchRowIdx<=nRowIdx+nPatchRadius; ++nPatchRowIdx) {
+                const uchar nVal1 = oImage1_uchar(nPatchRowIdx,nColIdx), nVal2 = oImage2_uchar(nPatchRowIdx,nColIdx+nColOffset);
+                int& nJointCount = s_vnJointCounts[size_t(nVal1)*(UCHAR_MAX+1)+nVal2];
+                int& nMargCount1 = s_aanMargCounts[0][nVal1];
+                int& nMargCount2 = s_aanMargCounts[1][nVal2];
+                dJointCountLogSum -= vdCountLogs[nJointCount];
+                adMargCountLogSums[0] -= vdCountLogs[nMargCount1];
+                adMargCountLogSums[1] -= vdCountLogs[nMargCount2];
+                nJointCount += nDelta; nMargCount1 += nDelta; nMargCount2 += nDelta;
+                lvDbgAssert(nJointCount>=0 && nMargCount1>=0 && nMargCount2>=0);
+                dJointCountLogSum += vdCountLogs[nJointCount];
+                adMargCountLogSums[0] += vdCountLogs[nMargCount1];
+                adMargCountLogSums[1] += vdCountLogs[nMargCount2];
+            }
+        };
+        for(int nColIdx=nStartColIdx-nPatchRadius; nColIdx<nStartColIdx+nPatchRadius; ++nColIdx)
+            lUpdateColumn(nColIdx,1);
+        for(int nColIdx=nStartColIdx; nColIdx<nEndColIdx; ++nColIdx) {
+            lUpdateColumn(nColIdx+nPatchRadius,1);
+            if(lIsValidMatch(nRowIdx,nColIdx,nColIdx+nColOffset)) {
+                // H(X) = log2(N) - sum(c*log2(c))/N, and MI(X,Y) = H(X) + H(Y) - H(X,Y)
+                const double dMargEntropy1 = std::max(dPatchElemsLog-adMargCountLogSums[0]/nPatchElems,0.0);
+                const double dMargEntropy2 = std::max(dPatchElemsLog-adMargCountLogSums[1]/nPatchElems,0.0);
+                const double dJointEntropy = dPatchElemsLog-dJointCountLogSum/nPatchElems;
+                double dMutualInfoScore = std::max(dMargEntropy1+dMargEntropy2-dJointEntropy,0.0);
+                if(dMargEntropy1>0.0 && dMargEntropy2>0.0)
+                    dMutualInfoScore /= std::sqrt(dMargEntropy1*dMargEntropy2);
+                oAffinityMap.at<float>(nRowIdx-nPatchRadius,nColIdx-nPatchRadius,nOffsetIdx) = std::max(float(1.0-dMutualInfoScore),0.0f);
+            }
+            lUpdateColumn(nColIdx-nPatchRadius,-1);
+        }
+        // remove the remaining columns so that the thread-local histograms are left empty for the next job
+        for(int nColIdx=nEndColIdx-nPatchRadius; nColIdx<nEndColIdx+nPatchRadius; ++nColIdx)
+            lUpdateColumn(nColIdx,-1);
     }
 }
 
@@ -422,10 +643,10 @@ void lv::computeDescriptorAffinity(const cv::Mat_<float>& oDescMap1, const cv::M
     lvAssert_(!oDescMap1.empty() && oDescMap1.size==oDescMap2.size && oDescMap1.dims==3 && oDescMap1.size[2]>1,"bad input desc map sizes");
     lvAssert_(oROI1.empty() || (oROI1.dims==2 && oROI1.rows==oDescMap1.size[0] && oROI1.cols==oDescMap1.size[1]),"bad ROI1 map size");
     lvAssert_(oROI2.empty() || (oROI2.dims==2 && oROI2.rows==oDescMap2.size[0] && oROI2.cols==oDescMap2.size[1]),"bad ROI2 map size");
-    lvAssert_(eDist==lv::AffinityDist_L2 || eDist==lv::AffinityDist_EMD,"unsupported distance type");
+    lvAssert_(eDist==lv::AffinityDist_L2 || eDist==lv::AffinityDist_EMD || eDist==lv::AffinityDist_EMDTree,"unsupported distance type");
     lvAssert_(nPatchSize>=1 && (nPatchSize%2)==1,"bad patch size");
     lvAssert_(!vDispRange.empty(),"bad disparity range");
-    if(eDist==lv::AffinityDist_EMD) {
+    if(eDist==lv::AffinityDist_EMD || eDist==lv::AffinityDist_EMDTree) {
         lvAssert_(!oEMDCostMap.empty() && oEMDCostMap.dims==2 && oEMDCostMap.rows==oEMDCostMap.cols,"bad emd cost map size");
         lvAssert_(oEMDCostMap.rows==oDescMap1.size[2],"bad emd cost map size for given desc size");
     }
@@ -461,44 +682,75 @@ void lv::computeDescriptorAffinity(const cv::Mat_<float>& oDescMap1, const cv::M
         return;
     }
 #endif //HAVE_CUDA
-    const bool bValidROI1 = !oROI1.empty();
-    const bool bValidROI2 = !oROI2.empty();
     const int nPatchRadius = nPatchSize/2;
-    oAffinityMap.create(3,anAffinityMapDims.data());
-    oAffinityMap = -1.0f; // default value for OOB pixels
-    cv::Mat_<float> oRawAffinity; // used to cache pixel-wise descriptor distances
-    static thread_local lv::AutoBuffer<float> s_aRawAffinityData;
-    if(nPatchSize>1) {
-        s_aRawAffinityData.resize(oAffinityMap.total());
-        oRawAffinity = cv::Mat_<float>(3,anAffinityMapDims.data(),s_aRawAffinityData.data());
+    // raw (per-pixel) distances are cached in disparity-major order, so that both the distance kernel and the patch aggregation run over contiguous rows
+    const std::array<int,3> anRawAffinityMapDims = {nOffsets,nRows,nCols};
+    cv::Mat_<float> oRawAffinity(3,anRawAffinityMapDims.data()); // local buffer, so that full-volume scratch memory is not kept alive per thread
+    lvDbgExceptionWatch;
+    if(eDist==lv::AffinityDist_L2)
+        lv::computeDescriptorRawAffinity(oDescMap1,oDescMap2,oRawAffinity,vDispRange,oROI1,oROI2);
+    else if(eDist==lv::AffinityDist_EMDTree) {
+        const bool bValidROI1 = !oROI1.empty();
+        const bool bValidROI2 = !oROI2.empty();
         oRawAffinity = -1.0f; // default value for OOB pixels
+        EMDTreeData oEMDTree;
+        buildEMDTree(oEMDCostMap,oEMDTree);
+        // histogram normalization factors are computed once per pixel, then reused for all disparities
+        std::array<cv::Mat_<float>,2> aInvSums = {cv::Mat_<float>(nRows,nCols),cv::Mat_<float>(nRows,nCols)};
+        for(size_t nMapIdx=0; nMapIdx<aInvSums.size(); ++nMapIdx) {
+            const cv::Mat_<float>& oDescMap = (nMapIdx==0)?oDescMap1:oDescMap2;
+#if USING_OPENMP
+            #pragma omp parallel for
+#endif //USING_OPENMP
+            for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+                for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                    const float* pDesc = oDescMap.ptr<float>(nRowIdx,nColIdx);
+                    const double dSum = std::accumulate(pDesc,pDesc+nDescSize,0.0);
+                    lvDbgAssert(std::all_of(pDesc,pDesc+nDescSize,[](float v){return v>=0.0f;}));
+                    aInvSums[nMapIdx](nRowIdx,nColIdx) = (dSum>0.0)?float(1.0/dSum):0.0f;
+                }
+            }
+        }
+#if USING_OPENMP
+        #pragma omp parallel for
+#endif //USING_OPENMP
+        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+            static thread_local lv::AutoBuffer<float> s_aFlowData;
+            s_aFlowData.resize(size_t(nDescSize));
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                if(bValidROI1 && !oROI1(nRowIdx,nColIdx))
+                    continue;
+                const float* pDesc = oDescMap1.ptr<float>(nRowIdx,nColIdx);
+                const float fInvSum = aInvSums[0](nRowIdx,nColIdx);
+                for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+                    const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
+                    if(nOffsetColIdx<0 || nOffsetColIdx>=nCols || (bValidROI2 && !oROI2(nRowIdx,nOffsetColIdx)))
+                        continue;
+                    oRawAffinity(nOffsetIdx,nRowIdx,nColIdx) = calcTreeEMD(oEMDTree,pDesc,fInvSum,oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx),aInvSums[1](nRowIdx,nOffsetColIdx),s_aFlowData.data());
+                    lvDbgAssert(oRawAffinity(nOffsetIdx,nRowIdx,nColIdx)>=0.0f);
+                }
+            }
+        }
     }
-    else
-        oRawAffinity = oAffinityMap;
-    lvDbgExceptionWatch;
+    else /*if(eDist==lv::AffinityDist_EMD)*/ {
+        const bool bValidROI1 = !oROI1.empty();
+        const bool bValidROI2 = !oROI2.empty();
+        oRawAffinity = -1.0f; // default value for OOB pixels
 #if USING_OPENMP
 #ifdef _MSC_VER
-    #pragma omp parallel for // msvc only supports openmp 2.0
+        #pragma omp parallel for // msvc only supports openmp 2.0
 #else //ndef(_MSC_VER)
-    #pragma omp parallel for collapse(2)
+        #pragma omp parallel for collapse(2)
 #endif //ndef(_MSC_VER)
 #endif //USING_OPENMP
-    for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
-        for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
-            if(bValidROI1 && !oROI1(nRowIdx,nColIdx))
-                continue;
-            float* pRawAffinityPtr = oRawAffinity.ptr<float>(nRowIdx,nColIdx);
-            for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
-                const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
-                if(nOffsetColIdx<0 || nOffsetColIdx>=nCols || (bValidROI2 && !oROI2(nRowIdx,nOffsetColIdx)))
+        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                if(bValidROI1 && !oROI1(nRowIdx,nColIdx))
                     continue;
-                if(eDist==lv::AffinityDist_L2) {
-                    const cv::Mat_<float> oDesc(1,nDescSize,const_cast<float*>(oDescMap1.ptr<float>(nRowIdx,nColIdx)));
-                    const cv::Mat_<float> oOffsetDesc(1,nDescSize,const_cast<float*>(oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx)));
-                    pRawAffinityPtr[nOffsetIdx] = float(cv::norm(oDesc,oOffsetDesc,cv::NORM_L2));
-                    lvDbgAssert(pRawAffinityPtr[nOffsetIdx]>=0.0f && pRawAffinityPtr[nOffsetIdx]<=(float)M_SQRT2);
-                }
-                else /*if(eDist==lv::AffinityDist_EMD)*/ {
+                for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+                    const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
+                    if(nOffsetColIdx<0 || nOffsetColIdx>=nCols || (bValidROI2 && !oROI2(nRowIdx,nOffsetColIdx)))
+                        continue;
                     const float* pDesc = oDescMap1.ptr<float>(nRowIdx,nColIdx);
                     const float* pOffsetDesc = oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx);
                     const cv::Mat_<float> oDesc(nDescSize,1,const_cast<float*>(pDesc));
@@ -511,38 +763,124 @@ void lv::computeDescriptorAffinity(const cv::Mat_<float>& oDescMap1, const cv::M
                         lvDbgAssert(v>=0.0f);
                         return v==0.0f;
                     }),"opencv emd cannot handle null descriptors");
-                    pRawAffinityPtr[nOffsetIdx] = cv::EMD(oDesc,oOffsetDesc,-1,oEMDCostMap);
-                    lvDbgAssert(pRawAffinityPtr[nOffsetIdx]>=0.0f);
+                    oRawAffinity(nOffsetIdx,nRowIdx,nColIdx) = cv::EMD(oDesc,oOffsetDesc,-1,oEMDCostMap);
+                    lvDbgAssert(oRawAffinity(nOffsetIdx,nRowIdx,nColIdx)>=0.0f);
                 }
             }
         }
     }
-    if(nPatchSize==1)
-        return;
+    oAffinityMap.create(3,anAffinityMapDims.data());
     lvDbgExceptionWatch;
+    if(nPatchSize==1) {
 #if USING_OPENMP
-#ifdef _MSC_VER
-    #pragma omp parallel for // msvc only supports openmp 2.0
-#else //ndef(_MSC_VER)
-    #pragma omp parallel for collapse(3)
-#endif //ndef(_MSC_VER)
+        #pragma omp parallel for
 #endif //USING_OPENMP
-    for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
-        for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
-            for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
-                size_t nValidCount = size_t(0);
-                double afAccumAff = 0.0f;
-                for(int nPatchRowIdx=std::max(nRowIdx-nPatchRadius,0); nPatchRowIdx<=std::min(nRowIdx+nPatchRadius,nRows-1); ++nPatchRowIdx) {
-                    for(int nPatchColIdx=std::max(nColIdx-nPatchRadius,0); nPatchColIdx<=std::min(nColIdx+nPatchRadius,nCols-1); ++nPatchColIdx) {
-                        const float* pRawAffinityPtr = oRawAffinity.ptr<float>(nPatchRowIdx,nPatchColIdx);
-                        if(pRawAffinityPtr[nOffsetIdx]!=-1.0f) {
-                            afAccumAff += pRawAffinityPtr[nOffsetIdx];
-                            ++nValidCount;
-                        }
-                    }
+        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx)
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx)
+                for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx)
+                    oAffinityMap(nRowIdx,nColIdx,nOffsetIdx) = oRawAffinity(nOffsetIdx,nRowIdx,nColIdx);
+        return;
+    }
+    // patch aggregation uses per-offset summed-area tables of valid raw values (in double) & of validity counts, so each output costs O(1);
+    // aggregated values overwrite their own raw plane (already fully summed in the table), and are interleaved in the output map afterwards
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+        static thread_local cv::Mat_<double> s_oValueSAT;
+        static thread_local cv::Mat_<int> s_oCountSAT;
+        s_oValueSAT.create(nRows+1,nCols+1);
+        s_oCountSAT.create(nRows+1,nCols+1);
+        std::fill_n(s_oValueSAT.ptr<double>(0),nCols+1,0.0);
+        std::fill_n(s_oCountSAT.ptr<int>(0),nCols+1,0);
+        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+            const float* pRawAffinityPtr = oRawAffinity.ptr<float>(nOffsetIdx,nRowIdx);
+            const double* pPrevValueSATRow = s_oValueSAT.ptr<double>(nRowIdx);
+            const int* pPrevCountSATRow = s_oCountSAT.ptr<int>(nRowIdx);
+            double* pValueSATRow = s_oValueSAT.ptr<double>(nRowIdx+1);
+            int* pCountSATRow = s_oCountSAT.ptr<int>(nRowIdx+1);
+            double dRowValueSum = 0.0;
+            int nRowCount = 0;
+            pValueSATRow[0] = 0.0;
+            pCountSATRow[0] = 0;
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                if(pRawAffinityPtr[nColIdx]!=-1.0f) {
+                    dRowValueSum += pRawAffinityPtr[nColIdx];
+                    ++nRowCount;
+                }
+                pValueSATRow[nColIdx+1] = pPrevValueSATRow[nColIdx+1]+dRowValueSum;
+                pCountSATRow[nColIdx+1] = pPrevCountSATRow[nColIdx+1]+nRowCount;
+            }
+        }
+        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+            const int nPatchRowStartIdx = std::max(nRowIdx-nPatchRadius,0), nPatchRowEndIdx = std::min(nRowIdx+nPatchRadius,nRows-1)+1;
+            const double* pTopValueSATRow = s_oValueSAT.ptr<double>(nPatchRowStartIdx);
+            const double* pBottomValueSATRow = s_oValueSAT.ptr<double>(nPatchRowEndIdx);
+            const int* pTopCountSATRow = s_oCountSAT.ptr<int>(nPatchRowStartIdx);
+            const int* pBottomCountSATRow = s_oCountSAT.ptr<int>(nPatchRowEndIdx);
+            float* pAffinityPtr = oRawAffinity.ptr<float>(nOffsetIdx,nRowIdx);
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                const int nPatchColStartIdx = std::max(nColIdx-nPatchRadius,0), nPatchColEndIdx = std::min(nColIdx+nPatchRadius,nCols-1)+1;
+                const int nValidCount = pBottomCountSATRow[nPatchColEndIdx]-pBottomCountSATRow[nPatchColStartIdx]-pTopCountSATRow[nPatchColEndIdx]+pTopCountSATRow[nPatchColStartIdx];
+                if(nValidCount) {
+                    const double dAccumAff = pBottomValueSATRow[nPatchColEndIdx]-pBottomValueSATRow[nPatchColStartIdx]-pTopValueSATRow[nPatchColEndIdx]+pTopValueSATRow[nPatchColStartIdx];
+                    pAffinityPtr[nColIdx] = float(std::max(dAccumAff,0.0)/nValidCount);
                 }
-                if(nValidCount)
-                    oAffinityMap.at<float>(nRowIdx,nColIdx,nOffsetIdx) = float(afAccumAff/nValidCount);
+                else
+                    pAffinityPtr[nColIdx] = -1.0f; // default value for OOB pixels
+            }
+        }
+    }
+    // output rows are split between threads, so no two threads ever write to the same (offset-interleaved) cache lines
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx)
+        for(int nColIdx=0; nColIdx<nCols; ++nColIdx)
+            for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx)
+                oAffinityMap(nRowIdx,nColIdx,nOffsetIdx) = oRawAffinity(nOffsetIdx,nRowIdx,nColIdx);
+}
+
+void lv::computeDescriptorRawAffinity(const cv::Mat_<float>& oDescMap1, const cv::Mat_<float>& oDescMap2, cv::Mat_<float>& oRawAffinityMap,
+                                      const std::vector<int>& vDispRange, const cv::Mat_<uchar>& oROI1, const cv::Mat_<uchar>& oROI2) {
+    lvAssert_(!oDescMap1.empty() && oDescMap1.size==oDescMap2.size && oDescMap1.dims==3 && oDescMap1.size[2]>1,"bad input desc map sizes");
+    lvAssert_(oDescMap1.step.p[1]==oDescMap2.step.p[1] && oDescMap1.step.p[2]==sizeof(float),"descriptors must be contiguous in input maps");
+    lvAssert_(oROI1.empty() || (oROI1.dims==2 && oROI1.rows==oDescMap1.size[0] && oROI1.cols==oDescMap1.size[1]),"bad ROI1 map size");
+    lvAssert_(oROI2.empty() || (oROI2.dims==2 && oROI2.rows==oDescMap2.size[0] && oROI2.cols==oDescMap2.size[1]),"bad ROI2 map size");
+    lvAssert_(!vDispRange.empty(),"bad disparity range");
+    const int nRows = oDescMap1.size[0];
+    const int nCols = oDescMap1.size[1];
+    const int nDescSize = oDescMap1.size[2];
+    const int nOffsets = int(vDispRange.size());
+    const size_t nDescStep = oDescMap1.step.p[1]/sizeof(float);
+    const bool bValidROI1 = !oROI1.empty();
+    const bool bValidROI2 = !oROI2.empty();
+    const std::array<int,3> anRawAffinityMapDims = {nOffsets,nRows,nCols};
+    oRawAffinityMap.create(3,anRawAffinityMapDims.data());
+    lvAssert_(oRawAffinityMap.isContinuous(),"raw affinity map must be continuous");
+    const lv::L2SqrDist32fKernel pL2SqrDistKernel = lv::getL2SqrDist32fKernel(); // variant selected at runtime for the host cpu
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nJobIdx=0; nJobIdx<nOffsets*nRows; ++nJobIdx) {
+        const int nOffsetIdx = nJobIdx/nRows;
+        const int nRowIdx = nJobIdx%nRows;
+        const int nColOffset = vDispRange[nOffsetIdx];
+        float* pRawAffinityPtr = oRawAffinityMap.ptr<float>(nOffsetIdx,nRowIdx);
+        // the pairs of a given row & disparity are contiguous in both maps, so the kernel streams through them without any header/bounds overhead
+        const int nStartColIdx = std::max(0,-nColOffset), nEndColIdx = std::max(nStartColIdx,std::min(nCols,nCols-nColOffset));
+        std::fill(pRawAffinityPtr,pRawAffinityPtr+nStartColIdx,-1.0f); // default value for OOB pixels
+        std::fill(pRawAffinityPtr+nEndColIdx,pRawAffinityPtr+nCols,-1.0f);
+        const float* pDesc = oDescMap1.ptr<float>(nRowIdx)+nStartColIdx*nDescStep;
+        const float* pOffsetDesc = oDescMap2.ptr<float>(nRowIdx)+(nStartColIdx+nColOffset)*nDescStep;
+        const uchar* pROI1 = bValidROI1?oROI1.ptr<uchar>(nRowIdx):nullptr;
+        const uchar* pROI2 = bValidROI2?oROI2.ptr<uchar>(nRowIdx):nullptr;
+        for(int nColIdx=nStartColIdx; nColIdx<nEndColIdx; ++nColIdx, pDesc+=nDescStep, pOffsetDesc+=nDescStep) {
+            if((pROI1 && !pROI1[nColIdx]) || (pROI2 && !pROI2[nColIdx+nColOffset]))
+                pRawAffinityPtr[nColIdx] = -1.0f;
+            else {
+                pRawAffinityPtr[nColIdx] = std::sqrt(pL2SqrDistKernel(pDesc,pOffsetDesc,size_t(nDescSize)));
+                lvDbgAssert(pRawAffinityPtr[nColIdx]>=0.0f && pRawAffinityPtr[nColIdx]<=(float)M_SQRT2+1e-5f);
             }
         }
     }
@@ -607,6 +945,135 @@ void lv::computeDescriptorAffinity(const cv::cuda::GpuMat& oDescMap1, const cv::
 
 #endif //HAVE_CUDA
 
+namespace {
+
+    /// fetches an 8-bit input value for integral image computation, with fused masking/binarization
+    template<bool bUseMask, bool bBinary>
+    inline uchar getIntegralInputVal(const uchar* pInputRow, const uchar* pMaskRow, int nColIdx, int nChIdx, int nChannels) {
+        const uchar nVal = bBinary?uchar(pInputRow[nColIdx*nChannels+nChIdx]!=0):pInputRow[nColIdx*nChannels+nChIdx];
+        return (bUseMask && !pMaskRow[nColIdx])?uchar(0):nVal;
+    }
+
+    /// computes one row of an integral image (first output element must be zero-initialized) from the previous row's sums
+    template<typename TSum, bool bUseMask, bool bBinary>
+    void integral_row(const uchar* pInputRow, const uchar* pMaskRow, const TSum* pPrevSumRow, TSum* pSumRow, int nCols, int nChannels) {
+        int nColIdx = 0;
+        pSumRow += nChannels; // first (padding) column is always zero
+        pPrevSumRow += nChannels;
+    #if HAVE_SSE2
+        if(nChannels==1) {
+            const __m128i aZeroVec = _mm_setzero_si128();
+            __m128i aCarryVec = _mm_setzero_si128();
+            for(; nColIdx+16<=nCols; nColIdx+=16) {
+                __m128i aInputVec = _mm_loadu_si128((const __m128i*)(pInputRow+nColIdx));
+                if(bBinary)
+                    aInputVec = _mm_andnot_si128(_mm_cmpeq_epi8(aInputVec,aZeroVec),_mm_set1_epi8(1));
+                if(bUseMask)
+                    aInputVec = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pMaskRow+nColIdx)),aZeroVec),aInputVec);
+                __m128i aPrefixVecs[2] = {_mm_unpacklo_epi8(aInputVec,aZeroVec),_mm_unpackhi_epi8(aInputVec,aZeroVec)};
+                lv::unroll<2u>([&](size_t nIdx) {
+                    // in-register prefix sum over 8x16-bit lanes (max value = 8*255, no overflow)
+                    aPrefixVecs[nIdx] = _mm_add_epi16(aPrefixVecs[nIdx],_mm_slli_si128(aPrefixVecs[nIdx],2));
+                    aPrefixVecs[nIdx] = _mm_add_epi16(aPrefixVecs[nIdx],_mm_slli_si128(aPrefixVecs[nIdx],4));
+                    aPrefixVecs[nIdx] = _mm_add_epi16(aPrefixVecs[nIdx],_mm_slli_si128(aPrefixVecs[nIdx],8));
+                });
+                lv::unroll<4u>([&](size_t nIdx) {
+                    const __m128i aPrefixVec = (nIdx%2)?_mm_unpackhi_epi16(aPrefixVecs[nIdx/2],aZeroVec):_mm_unpacklo_epi16(aPrefixVecs[nIdx/2],aZeroVec);
+                    const __m128i aRowSumVec = _mm_add_epi32(aPrefixVec,aCarryVec);
+                    if(nIdx%2)
+                        aCarryVec = _mm_shuffle_epi32(aRowSumVec,_MM_SHUFFLE(3,3,3,3));
+                    TSum* pCurrSum = pSumRow+nColIdx+nIdx*4;
+                    const TSum* pCurrPrevSum = pPrevSumRow+nColIdx+nIdx*4;
+                    if(std::is_same<TSum,int>::value)
+                        _mm_storeu_si128((__m128i*)pCurrSum,_mm_add_epi32(aRowSumVec,_mm_loadu_si128((const __m128i*)pCurrPrevSum)));
+                    else
+                        _mm_storeu_ps((float*)pCurrSum,_mm_add_ps(_mm_cvtepi32_ps(aRowSumVec),_mm_loadu_ps((const float*)pCurrPrevSum)));
+                });
+            }
+            TSum tRowSum = (TSum)_mm_cvtsi128_si32(aCarryVec);
+            for(; nColIdx<nCols; ++nColIdx) {
+                tRowSum += (TSum)getIntegralInputVal<bUseMask,bBinary>(pInputRow,pMaskRow,nColIdx,0,1);
+                pSumRow[nColIdx] = pPrevSumRow[nColIdx]+tRowSum;
+            }
+            return;
+        }
+    #endif //HAVE_SSE2
+        std::array<TSum,4> atRowSums{};
+        lvDbgAssert(nChannels<=(int)atRowSums.size());
+        for(; nColIdx<nCols; ++nColIdx) {
+            for(int nChIdx=0; nChIdx<nChannels; ++nChIdx) {
+                atRowSums[nChIdx] += (TSum)getIntegralInputVal<bUseMask,bBinary>(pInputRow,pMaskRow,nColIdx,nChIdx,nChannels);
+                pSumRow[nColIdx*nChannels+nChIdx] = pPrevSumRow[nColIdx*nChannels+nChIdx]+atRowSums[nChIdx];
+            }
+        }
+    }
+
+    /// computes a full integral image with fused masking/binarization; integer sums are split in parallel row bands
+    /// (band-local sums first, then carry fix-up), while float sums keep the sequential accumulation order of cv::integral
+    template<typename TSum, bool bUseMask, bool bBinary>
+    void integral_internal(const cv::Mat& oInput, const cv::Mat& oMask, cv::Mat& oIntegralImg) {
+        const int nRows = oInput.rows, nCols = oInput.cols, nChannels = oInput.channels();
+        const int nSumRowStep = (nCols+1)*nChannels;
+        lvDbgAssert(oIntegralImg.isContinuous() && oIntegralImg.rows==nRows+1 && oIntegralImg.cols==nCols+1 && nChannels<=4);
+        TSum* pIntegral = (TSum*)oIntegralImg.data;
+        std::fill(pIntegral,pIntegral+nSumRowStep,TSum(0));
+        const int nBandRows = std::is_same<TSum,int>::value?64:nRows;
+        const int nBands = (nRows+nBandRows-1)/nBandRows;
+    #if USING_OPENMP
+        #pragma omp parallel for
+    #endif //USING_OPENMP
+        for(int nBandIdx=0; nBandIdx<nBands; ++nBandIdx) {
+            for(int nRowIdx=nBandIdx*nBandRows; nRowIdx<std::min((nBandIdx+1)*nBandRows,nRows); ++nRowIdx) {
+                TSum* pSumRow = pIntegral+(nRowIdx+1)*nSumRowStep;
+                std::fill(pSumRow,pSumRow+nChannels,TSum(0));
+                const TSum* pPrevSumRow = (nRowIdx==nBandIdx*nBandRows)?pIntegral:pSumRow-nSumRowStep; // bands start from the zero row
+                integral_row<TSum,bUseMask,bBinary>(oInput.ptr<uchar>(nRowIdx),bUseMask?oMask.ptr<uchar>(nRowIdx):nullptr,pPrevSumRow,pSumRow,nCols,nChannels);
+            }
+        }
+        if(nBands<=1)
+            return;
+        lvDbgAssert((std::is_same<TSum,int>::value));
+        // carries are accumulated sequentially on the last row of each band, then added to all band rows in parallel
+        static thread_local std::vector<TSum> s_vtBandCarries;
+        std::vector<TSum>& vtBandCarries = s_vtBandCarries; // bound on the calling thread; omp workers have their own (empty) instances
+        vtBandCarries.assign(size_t(nBands*nSumRowStep),TSum(0));
+        for(int nBandIdx=1; nBandIdx<nBands; ++nBandIdx) {
+            const TSum* pPrevCarry = vtBandCarries.data()+(nBandIdx-1)*nSumRowStep;
+            const TSum* pPrevBandLastRow = pIntegral+(nBandIdx*nBandRows)*nSumRowStep;
+            TSum* pCarry = vtBandCarries.data()+nBandIdx*nSumRowStep;
+            for(int nElemIdx=0; nElemIdx<nSumRowStep; ++nElemIdx)
+                pCarry[nElemIdx] = pPrevCarry[nElemIdx]+pPrevBandLastRow[nElemIdx];
+        }
+    #if USING_OPENMP
+        #pragma omp parallel for
+    #endif //USING_OPENMP
+        for(int nRowIdx=nBandRows; nRowIdx<nRows; ++nRowIdx) {
+            const TSum* pCarry = vtBandCarries.data()+(nRowIdx/nBandRows)*nSumRowStep;
+            TSum* pSumRow = pIntegral+(nRowIdx+1)*nSumRowStep;
+            int nElemIdx = 0;
+        #if HAVE_AVX2
+            for(; nElemIdx+8<=nSumRowStep; nElemIdx+=8)
+                _mm256_storeu_si256((__m256i*)(pSumRow+nElemIdx),_mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(pSumRow+nElemIdx)),_mm256_loadu_si256((const __m256i*)(pCarry+nElemIdx))));
+        #elif HAVE_SSE2
+            for(; nElemIdx+4<=nSumRowStep; nElemIdx+=4)
+                _mm_storeu_si128((__m128i*)(pSumRow+nElemIdx),_mm_add_epi32(_mm_loadu_si128((const __m128i*)(pSumRow+nElemIdx)),_mm_loadu_si128((const __m128i*)(pCarry+nElemIdx))));
+        #endif //HAVE_SSE2
+            for(; nElemIdx<nSumRowStep; ++nElemIdx)
+                pSumRow[nElemIdx] += pCarry[nElemIdx];
+        }
+    }
+
+    /// dispatches integral image computation based on output depth
+    template<bool bUseMask, bool bBinary>
+    void integral_internal(const cv::Mat& oInput, const cv::Mat& oMask, cv::Mat& oIntegralImg, int nOutDepth) {
+        if(nOutDepth==CV_32S)
+            integral_internal<int,bUseMask,bBinary>(oInput,oMask,oIntegralImg);
+        else //nOutDepth==CV_32F
+            integral_internal<float,bUseMask,bBinary>(oInput,oMask,oIntegralImg);
+    }
+
+} // anonymous namespace
+
 void lv::integral(const cv::Mat& oInput, cv::Mat& oIntegralImg, int nOutDepth) {
     lvAssert_(!oInput.empty() && oInput.depth()==CV_8U && oInput.dims==2 && oInput.isContinuous(),"invalid input matrix");
     lvAssert_(nOutDepth==CV_32S || nOutDepth==CV_32F,"invalid requested output matrix depth");
@@ -658,43 +1125,48 @@ void lv::integral(const cv::Mat& oInput, cv::Mat& oIntegralImg, int nOutDepth) {
         return;
     }
 #endif //HAVE_NEON
-    cv::integral(oInput,oIntegralImg,nOutDepth); // redirect to opencv's impl by default; accelerated via ocl & sse2
+    if(oInput.channels()>4) {
+        cv::integral(oInput,oIntegralImg,nOutDepth); // redirect to opencv's impl for unusual channel counts
+        return;
+    }
+    integral_internal<false,false>(oInput,cv::Mat(),oIntegralImg,nOutDepth);
 }
 
 void lv::integral(const cv::Mat& oInput, cv::Mat& oIntegralImg, const cv::Mat_<uchar>& oMask, int nOutDepth) {
     lvAssert_(!oInput.empty() && oInput.depth()==CV_8U && oInput.dims==2 && oInput.isContinuous(),"invalid input matrix");
     lvAssert_(oMask.empty() || (oMask.dims==2 && oMask.size()==oInput.size() && oMask.isContinuous()),"invalid input mask");
-    if(oMask.empty())
-        lv::integral(oInput,oIntegralImg,nOutDepth);
-    else {
-        static thread_local cv::Mat oMaskedInput;
-        oInput.copyTo(oMaskedInput);
-        oMaskedInput.setTo(cv::Scalar_<uchar>::all(0),oMask==0);
-        lv::integral(oMaskedInput,oIntegralImg,nOutDepth);
+    if(oMask.empty() || oInput.channels()>4) {
+        if(oMask.empty())
+            lv::integral(oInput,oIntegralImg,nOutDepth);
+        else {
+            static thread_local cv::Mat oMaskedInput;
+            oInput.copyTo(oMaskedInput);
+            oMaskedInput.setTo(cv::Scalar_<uchar>::all(0),oMask==0);
+            lv::integral(oMaskedInput,oIntegralImg,nOutDepth);
+        }
+        return;
     }
+    lvAssert_(nOutDepth==CV_32S || nOutDepth==CV_32F,"invalid requested output matrix depth");
+    if(oInput.rows+1!=oIntegralImg.rows || oInput.cols+1!=oIntegralImg.cols || oInput.channels()!=oIntegralImg.channels() || oIntegralImg.depth()!=nOutDepth || !oIntegralImg.isContinuous())
+        oIntegralImg.create(oInput.rows+1,oInput.cols+1,CV_MAKE_TYPE(nOutDepth,oInput.channels()));
+    integral_internal<true,false>(oInput,oMask,oIntegralImg,nOutDepth);
 }
 
 void lv::binaryIntegral(const cv::Mat& oInput, cv::Mat& oIntegralImg, const cv::Mat_<uchar>& oMask, int nOutDepth, bool bForceConvertBinary) {
     lvAssert_(!oInput.empty() && oInput.type()==CV_8UC1 && oInput.dims==2 && oInput.isContinuous(),"invalid input matrix");
     lvAssert_(oMask.empty() || (oMask.dims==2 && oMask.size()==oInput.size() && oMask.isContinuous()),"invalid input mask");
-    // could optimize more... (lower level impl?)
-    if(bForceConvertBinary) {
-        static thread_local cv::Mat_<uchar> oBinaryInput;
-        oBinaryInput.create(oInput.size());
-        oBinaryInput = 0u;
-        oBinaryInput.setTo(1u,oInput!=0u);
-        if(!oMask.empty())
-            oBinaryInput.setTo(0u,oMask==0u);
-        lv::integral(oBinaryInput,oIntegralImg,nOutDepth);
-    }
-    else if(oMask.empty())
-        lv::integral(oInput,oIntegralImg,nOutDepth);
-    else {
-        static thread_local cv::Mat_<uchar> oBinaryInput;
-        oInput.copyTo(oBinaryInput);
-        oBinaryInput.setTo(0u,oMask==0u);
-        lv::integral(oBinaryInput,oIntegralImg,nOutDepth);
+    if(!bForceConvertBinary) {
+        lv::integral(oInput,oIntegralImg,oMask,nOutDepth);
+        return;
     }
+    lvAssert_(nOutDepth==CV_32S || nOutDepth==CV_32F,"invalid requested output matrix depth");
+    if(oInput.rows+1!=oIntegralImg.rows || oInput.cols+1!=oIntegralImg.cols || oIntegralImg.channels()!=1 || oIntegralImg.depth()!=nOutDepth || !oIntegralImg.isContinuous())
+        oIntegralImg.create(oInput.rows+1,oInput.cols+1,CV_MAKE_TYPE(nOutDepth,1));
+    // binarization and masking are fused in the summation loop; no temporary input copy is needed
+    if(oMask.empty())
+        integral_internal<false,true>(oInput,cv::Mat(),oIntegralImg,nOutDepth);
+    else
+        integral_internal<true,true>(oInput,oMask,oIntegralImg,nOutDepth);
 }
 
 void lv::computeTemporalAbsDiff(const cv::Mat& oImage1, const cv::Mat& oImage2, const cv::Mat& oFlow, cv::Mat& oOutput, int nSmoothKernelSize) {
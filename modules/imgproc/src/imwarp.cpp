@@ -39,12 +39,13 @@ inline TValue interp(double x, double y, TValue v11, TValue v12, TValue v21, TVa
     return TValue((v11*(1.0-y)+v12*y)*(1.0-x) + (v21*(1.0-y)+v22*y)*x);
 }
 
-ImageWarper::ImageWarper() : m_bInitialized(false) {}
+ImageWarper::ImageWarper() : m_bInitialized(false), m_dRemapRatio(0.0) {}
 
 ImageWarper::ImageWarper(const std::vector<cv::Point2d>& vSourcePts, const cv::Size& oSourceSize,
                          const std::vector<cv::Point2d>& vDestPts, const cv::Size& oDestSize,
                          int nGridSize, WarpModes eMode) :
-        m_bInitialized(false) {
+        m_bInitialized(false),
+        m_dRemapRatio(0.0) {
     lvDbgExceptionWatch;
     initialize(vSourcePts,oSourceSize,vDestPts,oDestSize,nGridSize,eMode);
 }
@@ -65,6 +66,8 @@ void ImageWarper::initialize(const std::vector<cv::Point2d>& vSourcePts, const c
     m_vSourcePts = vSourcePts;
     m_vDestPts = vDestPts;
     m_bInitialized = computeTransform();
+    if(m_bInitialized)
+        computeDenseDeltas();
 }
 
 void ImageWarper::warp(const cv::Mat& oInput, cv::Mat& oOutput, double dRatio) {
@@ -73,10 +76,29 @@ void ImageWarper::warp(const cv::Mat& oInput, cv::Mat& oOutput, double dRatio) {
     lvAssert_(!oInput.empty() && oInput.size()==m_oSourceSize,"bad input image size");
     lvAssert_(oInput.depth()==CV_8U,"implementation only supports 8u mats for now");
     lvAssert_(oInput.isContinuous(),"input matrix data must be a continuous block");
-    lvAssert_(!m_oDeltaX.empty() && !m_oDeltaY.empty(),"initialize failed");
-    oOutput.create(m_oDestSize,oInput.type());
-    const int nChannels = oInput.channels();
-    for(int nRowIdx=0; nRowIdx<m_oDestSize.height; nRowIdx+=m_nGridSize) {
+    lvAssert_(!m_oDenseDeltaX.empty() && !m_oDenseDeltaY.empty(),"initialize failed");
+    updateRemapTable(dRatio);
+    // sample coords are clamped in the table, so border replication is never actually needed beyond the last row/col
+    cv::remap(oInput,oOutput,m_oRemapCoordMap,m_oRemapCoeffMap,cv::INTER_LINEAR,cv::BORDER_REPLICATE);
+}
+
+void ImageWarper::warp(const std::vector<cv::Mat>& voInputs, std::vector<cv::Mat>& voOutputs, double dRatio) {
+    lvDbgExceptionWatch;
+    voOutputs.resize(voInputs.size());
+    for(size_t nImageIdx=0u; nImageIdx<voInputs.size(); ++nImageIdx)
+        warp(voInputs[nImageIdx],voOutputs[nImageIdx],dRatio);
+}
+
+void ImageWarper::computeDenseDeltas() {
+    lvAssert_(!m_oDeltaX.empty() && !m_oDeltaY.empty() && m_oDeltaX.size()==m_oDestSize && m_oDeltaY.size()==m_oDestSize,"bad transformation grid");
+    m_oDenseDeltaX.create(m_oDestSize);
+    m_oDenseDeltaY.create(m_oDestSize);
+    const int nGridRows = (m_oDestSize.height+m_nGridSize-1)/m_nGridSize;
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nGridRowIdx=0; nGridRowIdx<nGridRows; ++nGridRowIdx) {
+        const int nRowIdx = nGridRowIdx*m_nGridSize;
         for(int nColIdx=0; nColIdx<m_oDestSize.width; nColIdx+=m_nGridSize) {
             int nNextRowIdx = nRowIdx+m_nGridSize;
             int nNextColIdx = nColIdx+m_nGridSize;
@@ -94,29 +116,36 @@ void ImageWarper::warp(const cv::Mat& oInput, cv::Mat& oOutput, double dRatio) {
                 for(int nCellColIdx=0; nCellColIdx<nCellWidth; ++nCellColIdx) {
                     const double dCellX = double(nCellRowIdx)/nCellHeight;
                     const double dCellY = double(nCellColIdx)/nCellWidth;
-                    const double dDeltaX = interp(dCellX,dCellY,m_oDeltaX(nRowIdx,nColIdx),m_oDeltaX(nRowIdx,nNextColIdx),m_oDeltaX(nNextRowIdx,nColIdx),m_oDeltaX(nNextRowIdx,nNextColIdx));
-                    const double dDeltaY = interp(dCellX,dCellY,m_oDeltaY(nRowIdx,nColIdx),m_oDeltaY(nRowIdx,nNextColIdx),m_oDeltaY(nNextRowIdx,nColIdx),m_oDeltaY(nNextRowIdx,nNextColIdx));
-                    const double dOffsetColIdx = std::max(std::min(nColIdx+nCellColIdx+dDeltaX*dRatio,m_oSourceSize.width-1.0),0.0);
-                    const double dOffsetRowIdx = std::max(std::min(nRowIdx+nCellRowIdx+dDeltaY*dRatio,m_oSourceSize.height-1.0),0.0);
-                    const int nInputRowIdxLow = (int)dOffsetRowIdx;
-                    const int nInputColIdxLow = (int)dOffsetColIdx;
-                    const int nInputRowIdxHigh = (int)std::ceil(dOffsetRowIdx);
-                    const int nInputColIdxHigh = (int)std::ceil(dOffsetColIdx);
-                    for(int nChIdx=0; nChIdx<nChannels; ++nChIdx)
-                        oOutput.ptr<uchar>(nRowIdx+nCellRowIdx,nColIdx+nCellColIdx)[nChIdx] =
-                            interp(
-                                dOffsetRowIdx-nInputRowIdxLow,
-                                dOffsetColIdx-nInputColIdxLow,
-                                oInput.ptr<uchar>(nInputRowIdxLow,nInputColIdxLow)[nChIdx],
-                                oInput.ptr<uchar>(nInputRowIdxLow,nInputColIdxHigh)[nChIdx],
-                                oInput.ptr<uchar>(nInputRowIdxHigh,nInputColIdxLow)[nChIdx],
-                                oInput.ptr<uchar>(nInputRowIdxHigh,nInputColIdxHigh)[nChIdx]
-                            );
+                    m_oDenseDeltaX(nRowIdx+nCellRowIdx,nColIdx+nCellColIdx) = (float)interp(dCellX,dCellY,m_oDeltaX(nRowIdx,nColIdx),m_oDeltaX(nRowIdx,nNextColIdx),m_oDeltaX(nNextRowIdx,nColIdx),m_oDeltaX(nNextRowIdx,nNextColIdx));
+                    m_oDenseDeltaY(nRowIdx+nCellRowIdx,nColIdx+nCellColIdx) = (float)interp(dCellX,dCellY,m_oDeltaY(nRowIdx,nColIdx),m_oDeltaY(nRowIdx,nNextColIdx),m_oDeltaY(nNextRowIdx,nColIdx),m_oDeltaY(nNextRowIdx,nNextColIdx));
                 }
             }
+        }
+    }
+    m_oRemapCoordMap.release();
+    m_oRemapCoeffMap.release();
+}
 
+void ImageWarper::updateRemapTable(double dRatio) {
+    if(!m_oRemapCoordMap.empty() && dRatio==m_dRemapRatio)
+        return;
+    cv::Mat_<float> oMapX(m_oDestSize),oMapY(m_oDestSize);
+    const float fRatio = (float)dRatio, fMaxColIdx = float(m_oSourceSize.width-1), fMaxRowIdx = float(m_oSourceSize.height-1);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nRowIdx=0; nRowIdx<m_oDestSize.height; ++nRowIdx) {
+        const float* pDeltaX = m_oDenseDeltaX.ptr<float>(nRowIdx);
+        const float* pDeltaY = m_oDenseDeltaY.ptr<float>(nRowIdx);
+        float* pMapX = oMapX.ptr<float>(nRowIdx);
+        float* pMapY = oMapY.ptr<float>(nRowIdx);
+        for(int nColIdx=0; nColIdx<m_oDestSize.width; ++nColIdx) {
+            pMapX[nColIdx] = std::max(std::min(nColIdx+pDeltaX[nColIdx]*fRatio,fMaxColIdx),0.0f);
+            pMapY[nColIdx] = std::max(std::min(nRowIdx+pDeltaY[nColIdx]*fRatio,fMaxRowIdx),0.0f);
         }
     }
+    cv::convertMaps(oMapX,oMapY,m_oRemapCoordMap,m_oRemapCoeffMap,CV_16SC2);
+    m_dRemapRatio = dRatio;
 }
 
 bool ImageWarper::computeTransform() {
@@ -1,5 +1,7 @@
 
 #include "litiv/imgproc.hpp"
+#include "litiv/imgproc/imwarp.hpp"
+#include "litiv/features2d.hpp"
 #include "litiv/test.hpp"
 
 TEST(calcMedianValue,regression) {
@@ -31,6 +33,75 @@ TEST(calcMedianValue,regression) {
     ASSERT_EQ(lv::calcMedianValue(vTestMat6),0);
 }
 
+namespace {
+
+    // full-image reference implementation (repeated raster scans until convergence)
+    void thinning_reference(cv::Mat_<uchar>& oImage, lv::ThinningMode eMode) {
+        const auto lGetNeighbs = [&](int i, int j) {
+            // ordered as {S,SW,W,NW,N,NE,E,SE}
+            return std::array<bool,9>{oImage(i+1,j)>0,oImage(i+1,j-1)>0,oImage(i,j-1)>0,oImage(i-1,j-1)>0,oImage(i-1,j)>0,oImage(i-1,j+1)>0,oImage(i,j+1)>0,oImage(i+1,j+1)>0,oImage(i+1,j)>0};
+        };
+        bool bChanged = true;
+        while(bChanged) {
+            bChanged = false;
+            for(int nIter=0; nIter<2; ++nIter) {
+                cv::Mat_<uchar> oMarker(oImage.size(),uchar(0));
+                for(int i=1; i<oImage.rows-1; ++i) {
+                    for(int j=1; j<oImage.cols-1; ++j) {
+                        if(!oImage(i,j))
+                            continue;
+                        const std::array<bool,9> x = lGetNeighbs(i,j);
+                        if(eMode==lv::ThinningMode_ZhangSuen) {
+                            int A = 0, B = 0;
+                            for(int k=0; k<8; ++k)
+                                A += (!x[k] && x[k+1]), B += x[k];
+                            const bool m1 = !nIter?(x[4]&&x[6]&&x[0]):(x[4]&&x[6]&&x[2]);
+                            const bool m2 = !nIter?(x[6]&&x[0]&&x[2]):(x[4]&&x[0]&&x[2]);
+                            oMarker(i,j) = uchar(A==1 && B>=2 && B<=6 && !m1 && !m2);
+                        }
+                        else {
+                            int x_h = 0, n1 = 0, n2 = 0;
+                            for(int k=0; k<4; ++k)
+                                x_h += (!x[2*k] && (x[2*k+1] || x[2*k+2])), n1 += (x[2*k] || x[2*k+1]), n2 += (x[2*k+1] || x[2*k+2]);
+                            const int n_min = std::min(n1,n2);
+                            if(x_h==1 && n_min>=2 && n_min<=3 && ((!nIter && !((x[1] || x[2] || !x[7]) && x[0])) || (nIter && !((x[5] || x[6] || !x[3]) && x[4]))))
+                                oImage(i,j) = 0, bChanged = true; // in-place (sequential) scan
+                        }
+                    }
+                }
+                if(eMode==lv::ThinningMode_ZhangSuen) {
+                    bChanged |= cv::countNonZero(oMarker&oImage)>0;
+                    oImage.setTo(0,oMarker);
+                }
+            }
+        }
+    }
+
+} // anonymous namespace
+
+TEST(thinning,regression) {
+    cv::RNG oRNG(13);
+    for(size_t nTestIdx=0; nTestIdx<50; ++nTestIdx) {
+        cv::Mat_<uchar> oInput(oRNG.uniform(4,100),oRNG.uniform(4,100),uchar(0));
+        for(int nBlobIdx=oRNG.uniform(1,10); nBlobIdx>0; --nBlobIdx)
+            cv::circle(oInput,cv::Point(oRNG.uniform(0,oInput.cols),oRNG.uniform(0,oInput.rows)),oRNG.uniform(1,20),cv::Scalar_<uchar>(UCHAR_MAX),-1);
+        if(nTestIdx%2) {
+            cv::Mat_<uchar> oHoles(oInput.size());
+            oRNG.fill(oHoles,cv::RNG::UNIFORM,0,8);
+            oInput.setTo(0,oHoles==0);
+        }
+        for(lv::ThinningMode eMode : {lv::ThinningMode_ZhangSuen,lv::ThinningMode_LamLeeSuen}) {
+            cv::Mat_<uchar> oRefOutput = oInput.clone();
+            thinning_reference(oRefOutput,eMode);
+            cv::Mat oOutput;
+            lv::thinning(oInput,oOutput,eMode);
+            ASSERT_EQ(oOutput.size(),oInput.size());
+            ASSERT_EQ(oOutput.type(),CV_8UC1);
+            ASSERT_EQ(cv::countNonZero(oOutput!=oRefOutput),0);
+        }
+    }
+}
+
 TEST(medianBlur,regression) {
     for(size_t n=0u; n<50u; ++n) {
         cv::Mat_<uchar> vTestMat((rand()%100)+1,(rand()%100)+1),oMask(vTestMat.size());
@@ -64,6 +135,34 @@ TEST(medianBlur,regression) {
     ASSERT_EQ((int)oOutput(5,6),55);
 }
 
+TEST(medianBlur,regression_masked) {
+    for(size_t n=0u; n<50u; ++n) {
+        cv::Mat_<uchar> oInput((rand()%150)+1,(rand()%150)+1),oMask(oInput.size());
+        cv::randu(oInput,0u,256u);
+        cv::randu(oMask,0u,256u);
+        oMask = oMask>(rand()%256);
+        const int nKernelSize = (((rand()%15)+1)*2)+1, nOffset = nKernelSize/2;
+        cv::Mat_<uchar> oOutput;
+        lv::medianBlur(oInput,oOutput,oMask,nKernelSize,uchar(7));
+        std::vector<uchar> vKernelVals;
+        for(int i=0; i<oInput.rows; ++i) {
+            for(int j=0; j<oInput.cols; ++j) {
+                vKernelVals.clear();
+                for(int i2=std::max(i-nOffset,0); i2<=std::min(i+nOffset,oInput.rows-1); ++i2)
+                    for(int j2=std::max(j-nOffset,0); j2<=std::min(j+nOffset,oInput.cols-1); ++j2)
+                        if(oMask(i2,j2))
+                            vKernelVals.push_back(oInput(i2,j2));
+                if(vKernelVals.empty()) {
+                    ASSERT_EQ((int)oOutput(i,j),7) << "i=" << i << ", j=" << j;
+                    continue;
+                }
+                std::nth_element(vKernelVals.begin(),vKernelVals.begin()+(vKernelVals.size()-1)/2,vKernelVals.end());
+                ASSERT_EQ(oOutput(i,j),vKernelVals[(vKernelVals.size()-1)/2]) << "i=" << i << ", j=" << j;
+            }
+        }
+    }
+}
+
 TEST(binaryMedianBlur,regression) {
     for(size_t i=0u; i<200u; ++i) {
         cv::Mat_<uchar> oMask,oInput((rand()%100)+1,(rand()%100)+1);
@@ -311,6 +410,38 @@ TEST(gmm_learn,regression_badmask_local) {
     }
 }
 
+TEST(gmm_learn,regression_incremental) {
+    const cv::Mat oInput = cv::imread(SAMPLES_DATA_ROOT "/108073.jpg");
+    ASSERT_TRUE(!oInput.empty() && oInput.size()==cv::Size(481,321) && oInput.channels()==3);
+    cv::Mat oMask(oInput.size(),CV_8UC1,cv::Scalar_<uchar>(0));
+    oMask(cv::Rect(9,124,377,111)) = 255;
+    cv::Mat oROI(oInput.size(),CV_8UC1,cv::Scalar_<uchar>(0));
+    oROI(cv::Rect(0,80,481,200)) = 255;
+    lv::GMM<5,3> oBGModel,oFGModel,oBGModel_incr,oFGModel_incr;
+    lv::initGaussianMixtureParams(oInput,oMask,oBGModel,oFGModel,oROI);
+    cv::Mat oAssignMap(oInput.size(),CV_32SC1,cv::Scalar_<int>(-1));
+    lv::assignGaussianMixtureComponents(oInput,oMask,oAssignMap,oBGModel,oFGModel,oROI);
+    lv::learnGaussianMixtureParams(oInput,oMask,oAssignMap,oBGModel,oFGModel,oROI);
+    lv::learnGaussianMixtureParams(oInput,oMask,oAssignMap,oBGModel_incr,oFGModel_incr,oROI);
+    for(size_t nIterIdx=0; nIterIdx<3; ++nIterIdx) {
+        const cv::Mat oPrevMask = oMask.clone(), oPrevAssignMap = oAssignMap.clone();
+        oMask(cv::Rect(int(40+nIterIdx*60),100,50,60)) = uchar(nIterIdx%2?0:255);
+        lv::assignGaussianMixtureComponents(oInput,oMask,oAssignMap,oBGModel,oFGModel,oROI);
+        for(int nRowIdx=0; nRowIdx<oInput.rows; ++nRowIdx)
+            for(int nColIdx=0; nColIdx<oInput.cols; ++nColIdx)
+                if(oROI.at<uchar>(nRowIdx,nColIdx))
+                    ASSERT_EQ(oAssignMap.at<int>(nRowIdx,nColIdx),int(oMask.at<uchar>(nRowIdx,nColIdx)?oFGModel.getBestComponent(oInput.ptr<uchar>(nRowIdx,nColIdx)):oBGModel.getBestComponent(oInput.ptr<uchar>(nRowIdx,nColIdx))));
+                else
+                    ASSERT_EQ(oAssignMap.at<int>(nRowIdx,nColIdx),-1);
+        lv::learnGaussianMixtureParams(oInput,oMask,oAssignMap,oBGModel,oFGModel,oROI);
+        lv::updateGaussianMixtureParams(oInput,oMask,oAssignMap,oPrevMask,oPrevAssignMap,oBGModel_incr,oFGModel_incr,oROI);
+        for(size_t nModelIdx=0; nModelIdx<size_t(120); ++nModelIdx) {
+            ASSERT_DOUBLE_EQ(oBGModel.getModelData()[nModelIdx],oBGModel_incr.getModelData()[nModelIdx]) << "nIterIdx=" << nIterIdx << ", nModelIdx=" << nModelIdx;
+            ASSERT_DOUBLE_EQ(oFGModel.getModelData()[nModelIdx],oFGModel_incr.getModelData()[nModelIdx]) << "nIterIdx=" << nIterIdx << ", nModelIdx=" << nModelIdx;
+        }
+    }
+}
+
 #if USING_OFDIS
 
 #include "litiv/3rdparty/ofdis/ofdis.hpp"
@@ -556,6 +687,301 @@ TEST(descriptor_affinity,regression_L2_dasc) {
 
 #endif //ndef(_MSC_VER)
 
+TEST(descriptor_affinity,regression_raw_L2) {
+    cv::RNG oRNG(13);
+    const std::array<int,3> anDescMapDims = {17,29,37};
+    cv::Mat_<float> oDescMap1(3,anDescMapDims.data()),oDescMap2(3,anDescMapDims.data());
+    oRNG.fill(oDescMap1,cv::RNG::UNIFORM,0.0f,1.0f);
+    oRNG.fill(oDescMap2,cv::RNG::UNIFORM,0.0f,1.0f);
+    cv::Mat_<uchar> oROI1(anDescMapDims[0],anDescMapDims[1],uchar(255)),oROI2(anDescMapDims[0],anDescMapDims[1],uchar(255));
+    oROI1(cv::Rect(2,3,5,4)) = uchar(0);
+    oROI2(cv::Rect(20,8,6,7)) = uchar(0);
+    const std::vector<int> vDispRange = {-40,-5,0,1,7,28};
+    cv::Mat_<float> oRawAffMap;
+    lv::computeDescriptorRawAffinity(oDescMap1,oDescMap2,oRawAffMap,vDispRange,oROI1,oROI2);
+    ASSERT_EQ(oRawAffMap.dims,3);
+    ASSERT_EQ(oRawAffMap.size[0],(int)vDispRange.size());
+    ASSERT_EQ(oRawAffMap.size[1],anDescMapDims[0]);
+    ASSERT_EQ(oRawAffMap.size[2],anDescMapDims[1]);
+    cv::Mat_<float> oAffMap;
+    lv::computeDescriptorAffinity(oDescMap1,oDescMap2,1,oAffMap,vDispRange,lv::AffinityDist_L2,oROI1,oROI2,cv::Mat(),false);
+    for(int nOffsetIdx=0; nOffsetIdx<(int)vDispRange.size(); ++nOffsetIdx) {
+        for(int nRowIdx=0; nRowIdx<anDescMapDims[0]; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<anDescMapDims[1]; ++nColIdx) {
+                const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
+                const float fVal = oRawAffMap(nOffsetIdx,nRowIdx,nColIdx);
+                ASSERT_EQ(fVal,oAffMap(nRowIdx,nColIdx,nOffsetIdx));
+                if(!oROI1(nRowIdx,nColIdx) || nOffsetColIdx<0 || nOffsetColIdx>=anDescMapDims[1] || !oROI2(nRowIdx,nOffsetColIdx)) {
+                    ASSERT_EQ(fVal,-1.0f);
+                    continue;
+                }
+                const cv::Mat_<float> oDesc(1,anDescMapDims[2],oDescMap1.ptr<float>(nRowIdx,nColIdx));
+                const cv::Mat_<float> oOffsetDesc(1,anDescMapDims[2],oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx));
+                ASSERT_NEAR(fVal,(float)cv::norm(oDesc,oOffsetDesc,cv::NORM_L2),1e-4f);
+            }
+        }
+    }
+}
+
+TEST(descriptor_affinity,regression_patch_aggreg) {
+    cv::RNG oRNG(17);
+    const std::array<int,3> anDescMapDims = {23,31,8};
+    cv::Mat_<float> oDescMap1(3,anDescMapDims.data()),oDescMap2(3,anDescMapDims.data());
+    oRNG.fill(oDescMap1,cv::RNG::UNIFORM,0.0f,1.0f);
+    oRNG.fill(oDescMap2,cv::RNG::UNIFORM,0.0f,1.0f);
+    cv::Mat_<uchar> oROI1(anDescMapDims[0],anDescMapDims[1],uchar(255)),oROI2(anDescMapDims[0],anDescMapDims[1],uchar(255));
+    oROI1(cv::Rect(0,0,9,8)) = uchar(0);
+    oROI2(cv::Rect(12,4,10,13)) = uchar(0);
+    const std::vector<int> vDispRange = {-6,0,2,30};
+    cv::Mat_<float> oRawAffMap;
+    lv::computeDescriptorRawAffinity(oDescMap1,oDescMap2,oRawAffMap,vDispRange,oROI1,oROI2);
+    for(int nPatchSize : {3,7,15}) {
+        const int nPatchRadius = nPatchSize/2;
+        cv::Mat_<float> oAffMap;
+        lv::computeDescriptorAffinity(oDescMap1,oDescMap2,nPatchSize,oAffMap,vDispRange,lv::AffinityDist_L2,oROI1,oROI2,cv::Mat(),false);
+        for(int nRowIdx=0; nRowIdx<anDescMapDims[0]; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<anDescMapDims[1]; ++nColIdx) {
+                for(int nOffsetIdx=0; nOffsetIdx<(int)vDispRange.size(); ++nOffsetIdx) {
+                    size_t nValidCount = 0;
+                    double dAccumAff = 0.0;
+                    for(int nPatchRowIdx=std::max(nRowIdx-nPatchRadius,0); nPatchRowIdx<=std::min(nRowIdx+nPatchRadius,anDescMapDims[0]-1); ++nPatchRowIdx) {
+                        for(int nPatchColIdx=std::max(nColIdx-nPatchRadius,0); nPatchColIdx<=std::min(nColIdx+nPatchRadius,anDescMapDims[1]-1); ++nPatchColIdx) {
+                            if(oRawAffMap(nOffsetIdx,nPatchRowIdx,nPatchColIdx)!=-1.0f) {
+                                dAccumAff += oRawAffMap(nOffsetIdx,nPatchRowIdx,nPatchColIdx);
+                                ++nValidCount;
+                            }
+                        }
+                    }
+                    if(nValidCount)
+                        ASSERT_NEAR(oAffMap(nRowIdx,nColIdx,nOffsetIdx),float(dAccumAff/nValidCount),1e-5f) << "patch=" << nPatchSize;
+                    else
+                        ASSERT_EQ(oAffMap(nRowIdx,nColIdx,nOffsetIdx),-1.0f) << "patch=" << nPatchSize;
+                }
+            }
+        }
+    }
+}
+
+TEST(descriptor_affinity,regression_emdtree) {
+    cv::RNG oRNG(21);
+    const std::array<int,3> anDescMapDims = {5,13,12};
+    cv::Mat_<float> oDescMap1(3,anDescMapDims.data()),oDescMap2(3,anDescMapDims.data());
+    oRNG.fill(oDescMap1,cv::RNG::UNIFORM,0.0f,1.0f);
+    oRNG.fill(oDescMap2,cv::RNG::UNIFORM,0.0f,1.0f);
+    std::fill_n(oDescMap1.ptr<float>(1,2),anDescMapDims[2],0.0f); // null descriptors must be supported
+    std::fill_n(oDescMap2.ptr<float>(1,2),anDescMapDims[2],0.0f);
+    std::fill_n(oDescMap2.ptr<float>(3,4),anDescMapDims[2],0.0f);
+    const std::vector<int> vDispRange = {-2,0,1,5};
+    // with a 1d (line) ground distance, the tree EMD is exact, and equal to the closed-form EMD-L1
+    cv::Mat_<float> oLineCostMap(anDescMapDims[2],anDescMapDims[2]);
+    for(int nBinIdx1=0; nBinIdx1<anDescMapDims[2]; ++nBinIdx1)
+        for(int nBinIdx2=0; nBinIdx2<anDescMapDims[2]; ++nBinIdx2)
+            oLineCostMap(nBinIdx1,nBinIdx2) = float(std::abs(nBinIdx1-nBinIdx2));
+    cv::Mat_<float> oAffMap;
+    lv::computeDescriptorAffinity(oDescMap1,oDescMap2,1,oAffMap,vDispRange,lv::AffinityDist_EMDTree,cv::Mat(),cv::Mat(),oLineCostMap,false);
+    for(int nRowIdx=0; nRowIdx<anDescMapDims[0]; ++nRowIdx) {
+        for(int nColIdx=0; nColIdx<anDescMapDims[1]; ++nColIdx) {
+            for(int nOffsetIdx=0; nOffsetIdx<(int)vDispRange.size(); ++nOffsetIdx) {
+                const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
+                if(nOffsetColIdx<0 || nOffsetColIdx>=anDescMapDims[1]) {
+                    ASSERT_EQ(oAffMap(nRowIdx,nColIdx,nOffsetIdx),-1.0f);
+                    continue;
+                }
+                std::vector<float> vDesc1(oDescMap1.ptr<float>(nRowIdx,nColIdx),oDescMap1.ptr<float>(nRowIdx,nColIdx)+anDescMapDims[2]);
+                std::vector<float> vDesc2(oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx),oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx)+anDescMapDims[2]);
+                const float fSum1 = std::accumulate(vDesc1.begin(),vDesc1.end(),0.0f), fSum2 = std::accumulate(vDesc2.begin(),vDesc2.end(),0.0f);
+                if(fSum1==0.0f || fSum2==0.0f) {
+                    ASSERT_EQ(oAffMap(nRowIdx,nColIdx,nOffsetIdx),(fSum1==fSum2)?0.0f:float(anDescMapDims[2]-1));
+                    continue;
+                }
+                for(float& fVal : vDesc1)
+                    fVal /= fSum1;
+                for(float& fVal : vDesc2)
+                    fVal /= fSum2;
+                ASSERT_NEAR(oAffMap(nRowIdx,nColIdx,nOffsetIdx),(float)lv::EMDL1dist(vDesc1,vDesc2),1e-4f);
+            }
+        }
+    }
+    // with a generic (metric) ground distance, the tree EMD is an upper bound of the exact EMD
+    std::vector<cv::Point2f> vBinCenters(size_t(anDescMapDims[2]));
+    for(cv::Point2f& oPt : vBinCenters)
+        oPt = cv::Point2f(oRNG.uniform(0.0f,1.0f),oRNG.uniform(0.0f,1.0f));
+    cv::Mat_<float> oCostMap(anDescMapDims[2],anDescMapDims[2]);
+    for(int nBinIdx1=0; nBinIdx1<anDescMapDims[2]; ++nBinIdx1)
+        for(int nBinIdx2=0; nBinIdx2<anDescMapDims[2]; ++nBinIdx2)
+            oCostMap(nBinIdx1,nBinIdx2) = (float)cv::norm(vBinCenters[nBinIdx1]-vBinCenters[nBinIdx2]);
+    for(cv::Mat_<float>* pDescMap : {&oDescMap1,&oDescMap2}) {
+        for(int nRowIdx=0; nRowIdx<anDescMapDims[0]; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<anDescMapDims[1]; ++nColIdx) {
+                float* pDesc = pDescMap->ptr<float>(nRowIdx,nColIdx);
+                const float fSum = std::accumulate(pDesc,pDesc+anDescMapDims[2],0.0f);
+                if(fSum>0.0f) // exact EMD only matches full flows with equal masses
+                    std::transform(pDesc,pDesc+anDescMapDims[2],pDesc,[&](float v){return v/fSum;});
+            }
+        }
+    }
+    cv::Mat_<float> oTreeAffMap,oExactAffMap;
+    cv::Mat_<uchar> oROI(anDescMapDims[0],anDescMapDims[1],uchar(255));
+    oROI(1,2) = oROI(3,4) = uchar(0);
+    lv::computeDescriptorAffinity(oDescMap1,oDescMap2,1,oTreeAffMap,vDispRange,lv::AffinityDist_EMDTree,oROI,oROI,oCostMap,false);
+    lv::computeDescriptorAffinity(oDescMap1,oDescMap2,1,oExactAffMap,vDispRange,lv::AffinityDist_EMD,oROI,oROI,oCostMap,false);
+    ASSERT_TRUE(oTreeAffMap.isContinuous() && oExactAffMap.isContinuous());
+    const float* pTreeAff = oTreeAffMap.ptr<float>(0,0);
+    const float* pExactAff = oExactAffMap.ptr<float>(0,0);
+    for(size_t nElemIdx=0; nElemIdx<oTreeAffMap.total(); ++nElemIdx) {
+        ASSERT_EQ(pTreeAff[nElemIdx]==-1.0f,pExactAff[nElemIdx]==-1.0f);
+        ASSERT_GE(pTreeAff[nElemIdx]+1e-4f,pExactAff[nElemIdx]);
+    }
+}
+
+TEST(image_affinity,regression_ssd_mi) {
+    cv::RNG oRNG(7);
+    cv::Mat_<uchar> oImage1(31,43),oImage2(31,43);
+    oRNG.fill(oImage1,cv::RNG::UNIFORM,0,8); // few intensity levels, so that the MI histograms are not all unique
+    oRNG.fill(oImage2,cv::RNG::UNIFORM,0,8);
+    cv::Mat_<uchar> oROI1(oImage1.size(),uchar(255)),oROI2(oImage2.size(),uchar(255));
+    oROI1(cv::Rect(3,5,7,9)) = uchar(0);
+    oROI2(cv::Rect(20,10,9,4)) = uchar(0);
+    const std::vector<int> vDispRange = {-11,-2,0,3,9,40};
+    for(int nPatchSize : {1,5,9}) {
+        const int nPatchRadius = nPatchSize/2;
+        for(lv::AffinityDistType eDist : {lv::AffinityDist_SSD,lv::AffinityDist_MI}) {
+            cv::Mat_<float> oAffMap;
+            lv::computeImageAffinity(oImage1,oImage2,nPatchSize,oAffMap,vDispRange,eDist,oROI1,oROI2);
+            ASSERT_EQ(oAffMap.dims,3);
+            ASSERT_EQ(oAffMap.size[0],oImage1.rows-nPatchRadius*2);
+            ASSERT_EQ(oAffMap.size[1],oImage1.cols-nPatchRadius*2);
+            ASSERT_EQ(oAffMap.size[2],(int)vDispRange.size());
+            for(int nRowIdx=nPatchRadius; nRowIdx<oImage1.rows-nPatchRadius; ++nRowIdx) {
+                for(int nColIdx=nPatchRadius; nColIdx<oImage1.cols-nPatchRadius; ++nColIdx) {
+                    for(int nOffsetIdx=0; nOffsetIdx<(int)vDispRange.size(); ++nOffsetIdx) {
+                        const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
+                        const float fVal = oAffMap(nRowIdx-nPatchRadius,nColIdx-nPatchRadius,nOffsetIdx);
+                        if(!oROI1(nRowIdx,nColIdx) || nOffsetColIdx<nPatchRadius || nOffsetColIdx>=oImage1.cols-nPatchRadius || !oROI2(nRowIdx,nOffsetColIdx)) {
+                            ASSERT_EQ(fVal,-1.0f);
+                            continue;
+                        }
+                        const cv::Rect oWindow(nColIdx-nPatchRadius,nRowIdx-nPatchRadius,nPatchSize,nPatchSize);
+                        const cv::Rect oOffsetWindow(nOffsetColIdx-nPatchRadius,nRowIdx-nPatchRadius,nPatchSize,nPatchSize);
+                        if(eDist==lv::AffinityDist_SSD)
+                            ASSERT_NEAR(fVal,(float)cv::norm(oImage1(oWindow),oImage2(oOffsetWindow),cv::NORM_L2),0.001f);
+                        else
+                            ASSERT_NEAR(fVal,std::max(float(1.0-lv::calcMutualInfo<1,true,true>(oImage1(oWindow),oImage2(oOffsetWindow))),0.0f),0.0001f);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(edges_lbsp,regression_multithreshold) {
+    cv::RNG oRNG(11);
+    for(int nChannels : {1,3}) {
+        cv::Mat oImage(128,160,CV_8UC(nChannels),cv::Scalar::all(0));
+        const cv::Rect oInnerRect(32,32,oImage.cols-64,oImage.rows-64); // flat border keeps all edges far from the map boundaries
+        cv::Mat oInnerImage = oImage(oInnerRect);
+        for(size_t nShapeIdx=0; nShapeIdx<12; ++nShapeIdx) {
+            const cv::Scalar vColor(oRNG.uniform(0,256),oRNG.uniform(0,256),oRNG.uniform(0,256));
+            const cv::Point oCenter(oRNG.uniform(0,oInnerRect.width),oRNG.uniform(0,oInnerRect.height));
+            if(nShapeIdx%2)
+                cv::circle(oInnerImage,oCenter,oRNG.uniform(3,20),vColor,-1);
+            else
+                cv::rectangle(oInnerImage,cv::Rect(oCenter,cv::Size(oRNG.uniform(3,30),oRNG.uniform(3,30))),vColor,-1);
+        }
+        cv::Mat oNoise(oInnerRect.size(),oImage.type());
+        oRNG.fill(oNoise,cv::RNG::UNIFORM,0,24);
+        oInnerImage += oNoise;
+        for(double dHystLowThrshFactor : {0.25,EDGLBSP_DEFAULT_HYST_LOW_THRSH_FACT,0.75}) {
+            EdgeDetectorLBSP oDetector(EDGLBSP_DEFAULT_LEVEL_COUNT,dHystLowThrshFactor);
+            cv::Mat oEdgeMask;
+            oDetector.apply(oImage,oEdgeMask);
+            ASSERT_EQ(oEdgeMask.size(),oImage.size());
+            ASSERT_EQ(oEdgeMask.type(),CV_8UC1);
+            cv::Mat oRefEdgeMask(oImage.size(),CV_8UC1,cv::Scalar_<uchar>(0)),oTempEdgeMask;
+            for(size_t nThreshold=0; nThreshold<LBSP::MAX_GRAD_MAG; ++nThreshold) {
+                oDetector.apply_threshold(oImage,oTempEdgeMask,double(nThreshold)/LBSP::MAX_GRAD_MAG);
+                oRefEdgeMask += oTempEdgeMask/double(LBSP::MAX_GRAD_MAG);
+            }
+            ASSERT_GT(cv::countNonZero(oRefEdgeMask),0);
+            ASSERT_EQ(cv::countNonZero(oEdgeMask!=oRefEdgeMask),0);
+        }
+    }
+}
+
+namespace {
+
+    struct ImageWarper_test : ImageWarper {
+        using ImageWarper::ImageWarper;
+        using ImageWarper::m_oDeltaX;
+        using ImageWarper::m_oDeltaY;
+    };
+
+} // anonymous namespace
+
+TEST(imwarp,regression) {
+    cv::RNG oRNG(17);
+    const cv::Size oSize(97,71);
+    std::vector<cv::Mat> voInputs(3);
+    for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx) {
+        voInputs[nImageIdx].create(oSize,nImageIdx?CV_8UC3:CV_8UC1);
+        oRNG.fill(voInputs[nImageIdx],cv::RNG::UNIFORM,0,256);
+        cv::GaussianBlur(voInputs[nImageIdx],voInputs[nImageIdx],cv::Size(5,5),0);
+    }
+    std::vector<cv::Point2d> vSourcePts,vDestPts;
+    for(size_t nPtIdx=0; nPtIdx<8; ++nPtIdx) {
+        vSourcePts.emplace_back(oRNG.uniform(0.0,oSize.width-1.0),oRNG.uniform(0.0,oSize.height-1.0));
+        vDestPts.push_back(vSourcePts.back()+cv::Point2d(oRNG.uniform(-5.0,5.0),oRNG.uniform(-5.0,5.0)));
+    }
+    for(ImageWarper::WarpModes eMode : {ImageWarper::RIGID,ImageWarper::SIMILARITY}) {
+        ImageWarper_test oWarper(vSourcePts,oSize,vDestPts,oSize,7,eMode);
+        ASSERT_TRUE(oWarper.isInitialized());
+        for(double dRatio : {0.0,1.0,0.5,1.0}) {
+            std::vector<cv::Mat> voOutputs;
+            oWarper.warp(voInputs,voOutputs,dRatio);
+            ASSERT_EQ(voOutputs.size(),voInputs.size());
+            for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx) {
+                const cv::Mat& oInput = voInputs[nImageIdx];
+                const cv::Mat& oOutput = voOutputs[nImageIdx];
+                ASSERT_EQ(oOutput.size(),oSize);
+                ASSERT_EQ(oOutput.type(),oInput.type());
+                cv::Mat oSingleOutput;
+                oWarper.warp(oInput,oSingleOutput,dRatio);
+                ASSERT_TRUE(lv::isEqual<uchar>(oSingleOutput,oOutput));
+                if(dRatio==0.0) {
+                    ASSERT_TRUE(lv::isEqual<uchar>(oInput,oOutput));
+                    continue;
+                }
+                // compares against a direct (double-precision) evaluation of the grid-interpolated warp
+                const int nGridSize = 7;
+                for(int nRowIdx=0; nRowIdx<oSize.height; ++nRowIdx) {
+                    for(int nColIdx=0; nColIdx<oSize.width; ++nColIdx) {
+                        const int nGridRowIdx = (nRowIdx/nGridSize)*nGridSize, nGridColIdx = (nColIdx/nGridSize)*nGridSize;
+                        const int nNextGridRowIdx = std::min(nGridRowIdx+nGridSize,oSize.height-1), nNextGridColIdx = std::min(nGridColIdx+nGridSize,oSize.width-1);
+                        const double dCellX = double(nRowIdx-nGridRowIdx)/(nNextGridRowIdx-nGridRowIdx+(nGridRowIdx+nGridSize>=oSize.height?1:0));
+                        const double dCellY = double(nColIdx-nGridColIdx)/(nNextGridColIdx-nGridColIdx+(nGridColIdx+nGridSize>=oSize.width?1:0));
+                        const auto lInterpDelta = [&](const cv::Mat_<double>& oDelta) {
+                            return (oDelta(nGridRowIdx,nGridColIdx)*(1.0-dCellY)+oDelta(nGridRowIdx,nNextGridColIdx)*dCellY)*(1.0-dCellX) +
+                                   (oDelta(nNextGridRowIdx,nGridColIdx)*(1.0-dCellY)+oDelta(nNextGridRowIdx,nNextGridColIdx)*dCellY)*dCellX;
+                        };
+                        const double dOffsetColIdx = std::max(std::min(nColIdx+lInterpDelta(oWarper.m_oDeltaX)*dRatio,oSize.width-1.0),0.0);
+                        const double dOffsetRowIdx = std::max(std::min(nRowIdx+lInterpDelta(oWarper.m_oDeltaY)*dRatio,oSize.height-1.0),0.0);
+                        const int nRowLow = (int)dOffsetRowIdx, nColLow = (int)dOffsetColIdx;
+                        const int nRowHigh = (int)std::ceil(dOffsetRowIdx), nColHigh = (int)std::ceil(dOffsetColIdx);
+                        const double dRowFrac = dOffsetRowIdx-nRowLow, dColFrac = dOffsetColIdx-nColLow;
+                        for(int nChIdx=0; nChIdx<oInput.channels(); ++nChIdx) {
+                            const double dExpected =
+                                (oInput.ptr<uchar>(nRowLow,nColLow)[nChIdx]*(1.0-dColFrac)+oInput.ptr<uchar>(nRowLow,nColHigh)[nChIdx]*dColFrac)*(1.0-dRowFrac) +
+                                (oInput.ptr<uchar>(nRowHigh,nColLow)[nChIdx]*(1.0-dColFrac)+oInput.ptr<uchar>(nRowHigh,nColHigh)[nChIdx]*dColFrac)*dRowFrac;
+                            // fixed-point coords and coeffs (1/32 px) can shift the result by a few levels on sharp gradients
+                            ASSERT_NEAR((double)oOutput.ptr<uchar>(nRowIdx,nColIdx)[nChIdx],dExpected,4.0) << "r=" << nRowIdx << ", c=" << nColIdx;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 TEST(integral,regression) {
     for(size_t i=0u; i<200u; ++i) {
         cv::Mat oTestMat((rand()%500)+1,(rand()%500)+1,CV_8UC((rand()%4)+1));
@@ -567,6 +993,69 @@ TEST(integral,regression) {
     }
 }
 
+TEST(integral,regression_float) {
+    // sums are kept below 2^24 so that float accumulation stays exact
+    for(size_t i=0u; i<50u; ++i) {
+        cv::Mat oTestMat((rand()%200)+1,(rand()%200)+1,CV_8UC((rand()%4)+1));
+        cv::randu(oTestMat,0,256);
+        cv::Mat oLocalOutput,oCVOutput;
+        lv::integral(oTestMat,oLocalOutput,CV_32F);
+        cv::integral(oTestMat,oCVOutput,CV_32F);
+        ASSERT_TRUE(lv::isEqual<float>(oLocalOutput,oCVOutput));
+    }
+}
+
+TEST(integral,regression_bands) {
+    // integer sums are split in 64-row bands which get processed by omp workers when enabled; carries must reach all bands
+    for(size_t i=0u; i<50u; ++i) {
+        cv::Mat oTestMat((rand()%448)+65,(rand()%300)+1,CV_8UC((rand()%4)+1));
+        cv::randu(oTestMat,0,256);
+        cv::Mat oLocalOutput,oCVOutput;
+        lv::integral(oTestMat,oLocalOutput,CV_32S);
+        cv::integral(oTestMat,oCVOutput,CV_32S);
+        ASSERT_TRUE(lv::isEqual<int>(oLocalOutput,oCVOutput));
+        if(oTestMat.channels()==1) {
+            cv::Mat_<uchar> oMask(oTestMat.size());
+            cv::randu(oMask,0,256);
+            oMask = oMask>128u;
+            cv::Mat oMaskedTestMat(oTestMat.size(),oTestMat.type(),cv::Scalar::all(0));
+            oTestMat.copyTo(oMaskedTestMat,oMask);
+            lv::binaryIntegral(oTestMat,oLocalOutput,oMask,CV_32S,true);
+            cv::integral((oMaskedTestMat!=0)/UCHAR_MAX,oCVOutput,CV_32S);
+            ASSERT_TRUE(lv::isEqual<int>(oLocalOutput,oCVOutput));
+        }
+    }
+}
+
+TEST(integral,regression_masked) {
+    for(size_t i=0u; i<100u; ++i) {
+        cv::Mat oTestMat((rand()%200)+1,(rand()%200)+1,CV_8UC((rand()%4)+1));
+        cv::randu(oTestMat,0,256);
+        cv::Mat_<uchar> oMask(oTestMat.size());
+        cv::randu(oMask,0,256);
+        oMask = oMask>128u;
+        const int nOutDepth = (i%2)?CV_32S:CV_32F;
+        const auto lIsEqual = [nOutDepth](const cv::Mat& a, const cv::Mat& b) {
+            return (nOutDepth==CV_32S)?lv::isEqual<int>(a,b):lv::isEqual<float>(a,b);
+        };
+        cv::Mat oLocalOutput,oCVOutput,oMaskedTestMat(oTestMat.size(),oTestMat.type(),cv::Scalar::all(0));
+        lv::integral(oTestMat,oLocalOutput,oMask,nOutDepth);
+        oTestMat.copyTo(oMaskedTestMat,oMask);
+        cv::integral(oMaskedTestMat,oCVOutput,nOutDepth);
+        ASSERT_TRUE(lIsEqual(oLocalOutput,oCVOutput));
+        if(oTestMat.channels()==1) {
+            cv::Mat oBinaryTestMat = (oMaskedTestMat!=0)/UCHAR_MAX;
+            cv::integral(oBinaryTestMat,oCVOutput,nOutDepth);
+            lv::binaryIntegral(oTestMat,oLocalOutput,oMask,nOutDepth,true);
+            ASSERT_TRUE(lIsEqual(oLocalOutput,oCVOutput));
+            oBinaryTestMat = (oTestMat!=0)/UCHAR_MAX;
+            cv::integral(oBinaryTestMat,oCVOutput,nOutDepth);
+            lv::binaryIntegral(oTestMat,oLocalOutput,cv::Mat(),nOutDepth,true);
+            ASSERT_TRUE(lIsEqual(oLocalOutput,oCVOutput));
+        }
+    }
+}
+
 namespace {
 
     void medianBlur_perftest(benchmark::State& st) {
@@ -582,6 +1071,21 @@ namespace {
         }
     }
 
+    void medianBlur_masked_perftest(benchmark::State& st) {
+        const volatile int nMatSize = st.range(0);
+        const volatile int nKernelSize = st.range(1);
+        std::unique_ptr<uint8_t[]> aVals = lv::test::genarray<uint8_t>((size_t)nMatSize*nMatSize,0u,255u);
+        std::unique_ptr<uint8_t[]> aMaskVals = lv::test::genarray<uint8_t>((size_t)nMatSize*nMatSize,0u,1u);
+        cv::Mat_<uchar> oOutput(nMatSize,nMatSize);
+        while(st.KeepRunning()) {
+            benchmark::DoNotOptimize(aVals.get());
+            cv::Mat oInput(nMatSize,nMatSize,CV_8UC1,aVals.get());
+            cv::Mat oMask(nMatSize,nMatSize,CV_8UC1,aMaskVals.get());
+            lv::medianBlur(oInput,oOutput,oMask,nKernelSize);
+            benchmark::DoNotOptimize(oOutput.data);
+        }
+    }
+
     void binaryMedianBlur_conv_perftest(benchmark::State& st) {
         const volatile int nMatSize = st.range(0);
         const volatile int nKernelSize = st.range(1);
@@ -627,21 +1131,31 @@ namespace {
 }
 
 BENCHMARK(medianBlur_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(medianBlur_masked_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_conv_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_raw_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryConsensus_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 
 BENCHMARK(medianBlur_perftest)->Args({200,5})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(medianBlur_masked_perftest)->Args({200,5})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_conv_perftest)->Args({200,5})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_raw_perftest)->Args({200,5})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryConsensus_perftest)->Args({200,5})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 
 BENCHMARK(medianBlur_perftest)->Args({400,7})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(medianBlur_masked_perftest)->Args({400,7})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_conv_perftest)->Args({400,7})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_raw_perftest)->Args({400,7})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryConsensus_perftest)->Args({400,7})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 
 BENCHMARK(medianBlur_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(medianBlur_masked_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_conv_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_raw_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryConsensus_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+
+BENCHMARK(medianBlur_perftest)->Args({800,21})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(medianBlur_masked_perftest)->Args({800,21})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+
+BENCHMARK(medianBlur_perftest)->Args({800,31})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(medianBlur_masked_perftest)->Args({800,31})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
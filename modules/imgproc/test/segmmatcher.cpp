@@ -0,0 +1,268 @@
+
+#include "litiv/imgproc.hpp"
+#include "litiv/test.hpp"
+
+#if HAVE_OPENGM && HAVE_BOOST
+
+namespace {
+
+    /// synthetic rectified stereo pair with a textured background plane and a textured foreground box at known disparities
+    struct SyntheticStereoPair {
+        SyntheticStereoPair(int nCols, int nRows, int nBGDispOffset, int nFGDispOffset, int nFGShift=0) :
+                nBGDisp(nBGDispOffset),nFGDisp(nFGDispOffset) {
+            lvAssert_(nCols>0 && nRows>0 && nBGDisp>=0 && nFGDisp>nBGDisp && nFGDisp<nCols/4 && std::abs(nFGShift)<nCols/4,"bad synthetic pair parameters");
+            cv::RNG oRNG(42u); // fixed seed, so that all runs process the exact same data
+            const auto lGenTexture = [&](int nTexRows, int nTexCols) {
+                cv::Mat oTexture(nTexRows,nTexCols,CV_8UC3);
+                oRNG.fill(oTexture,cv::RNG::UNIFORM,0,256);
+                cv::GaussianBlur(oTexture,oTexture,cv::Size(5,5),0); // keeps some low freq structure for descriptors/gradients
+                return oTexture;
+            };
+            const cv::Mat oBGTexture = lGenTexture(nRows,nCols+nBGDisp);
+            const cv::Rect oFGBox(nCols/3+nFGShift,nRows/4,nCols/3,nRows/2);
+            const cv::Mat oFGTexture = lGenTexture(oFGBox.height,oFGBox.width);
+            // left pixel (x,y) with disparity 'd' is found at (x-d,y) in the right image
+            const cv::Rect oRightFGBox(oFGBox.x-nFGDisp,oFGBox.y,oFGBox.width,oFGBox.height);
+            cv::Mat oLeftImg = oBGTexture(cv::Rect(0,0,nCols,nRows)).clone();
+            cv::Mat oRightImg = oBGTexture(cv::Rect(nBGDisp,0,nCols,nRows)).clone();
+            oFGTexture.copyTo(oLeftImg(oFGBox));
+            oFGTexture.copyTo(oRightImg(oRightFGBox));
+            cv::Mat oLeftMask(nRows,nCols,CV_8UC1,cv::Scalar_<uchar>(0)),oRightMask(nRows,nCols,CV_8UC1,cv::Scalar_<uchar>(0));
+            oLeftMask(oFGBox) = cv::Scalar_<uchar>(255);
+            oRightMask(oRightFGBox) = cv::Scalar_<uchar>(255);
+            aInputs[SegmMatcher::InputPack_LeftImg] = oLeftImg;
+            aInputs[SegmMatcher::InputPack_LeftMask] = oLeftMask;
+            aInputs[SegmMatcher::InputPack_RightImg] = oRightImg;
+            aInputs[SegmMatcher::InputPack_RightMask] = oRightMask;
+            for(size_t nCamIdx=0; nCamIdx<SegmMatcher::getCameraCount(); ++nCamIdx)
+                aROIs[nCamIdx] = cv::Mat(nRows,nCols,CV_8UC1,cv::Scalar_<uchar>(255));
+        }
+        const int nBGDisp,nFGDisp;
+        SegmMatcher::MatArrayIn aInputs;
+        std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+    };
+
+    /// returns whether two output arrays hold the exact same labelings
+    bool isEqualOutput(const SegmMatcher::MatArrayOut& aOutputs1, const SegmMatcher::MatArrayOut& aOutputs2) {
+        for(size_t nOutputIdx=0; nOutputIdx<aOutputs1.size(); ++nOutputIdx)
+            if(lv::MatInfo(aOutputs1[nOutputIdx])!=lv::MatInfo(aOutputs2[nOutputIdx]) || cv::norm(aOutputs1[nOutputIdx],aOutputs2[nOutputIdx],cv::NORM_INF)!=0.0)
+                return false;
+        return true;
+    }
+
+    constexpr int s_nSynthBGDisp = 2;
+    constexpr int s_nSynthFGDisp = 8;
+    constexpr size_t s_nSynthMaxDisp = 16;
+
+} // anonymous namespace
+
+TEST(SegmMatcher,telemetry) {
+    const SyntheticStereoPair oPair(96,72,s_nSynthBGDisp,s_nSynthFGDisp);
+    SegmMatcher oMatcher(0,s_nSynthMaxDisp);
+    oMatcher.initialize(oPair.aROIs);
+    const std::string sTelemetryPath = "segmmatcher_telemetry_test.csv";
+    oMatcher.setTelemetryOutputPath(sTelemetryPath);
+    SegmMatcher::MatArrayOut aOutputs;
+    const size_t nTestFrames = 2;
+    for(size_t nFrameIdx=0; nFrameIdx<nTestFrames; ++nFrameIdx) {
+        oMatcher.apply(oPair.aInputs,aOutputs);
+        const SegmMatcher::FrameTelemetry& oTelemetry = oMatcher.getLastFrameTelemetry();
+        ASSERT_EQ(oTelemetry.nFrameIdx,nFrameIdx);
+        ASSERT_GT(oTelemetry.nStereoMoveCount,size_t(0));
+        ASSERT_EQ(oTelemetry.vStereoEnergies.size(),oTelemetry.nStereoMoveCount);
+        ASSERT_EQ(oTelemetry.vResegmEnergies.size(),oTelemetry.nResegmMoveCount);
+        ASSERT_EQ(oTelemetry.nResegmPassCount>0u,oTelemetry.nResegmMoveCount>0u);
+        ASSERT_GT(oTelemetry.nModelBytes,size_t(0));
+        ASSERT_GT(oTelemetry.dTotalTime,0.0);
+        const double dStageTimeSum = oTelemetry.dFeaturesTime+oTelemetry.dStereoUpdateTime+oTelemetry.dResegmUpdateTime+oTelemetry.dStereoInfTime+oTelemetry.dResegmInfTime;
+        ASSERT_GT(dStageTimeSum,0.0);
+        ASSERT_LE(dStageTimeSum,oTelemetry.dTotalTime);
+        for(size_t nOutputIdx=0; nOutputIdx<aOutputs.size(); ++nOutputIdx)
+            ASSERT_EQ(aOutputs[nOutputIdx].size(),oPair.aInputs[nOutputIdx].size());
+    }
+    oMatcher.setTelemetryOutputPath(""); // stops appending to the file
+    std::ifstream oTelemetryInput(sTelemetryPath);
+    ASSERT_TRUE(oTelemetryInput.is_open());
+    size_t nLineCount = 0;
+    for(std::string sLine; std::getline(oTelemetryInput,sLine);)
+        if(!sLine.empty())
+            ++nLineCount;
+    ASSERT_EQ(nLineCount,nTestFrames+1); // header + one row per frame
+    oTelemetryInput.close();
+    std::remove(sTelemetryPath.c_str());
+}
+
+TEST(SegmMatcher,regression_queued) {
+    // foreground box moves a few pixels per frame so that temporal features (flow, diffs) are non-trivial
+    std::vector<SyntheticStereoPair> vSequence;
+    for(int nFrameIdx=0; nFrameIdx<5; ++nFrameIdx)
+        vSequence.emplace_back(96,72,s_nSynthBGDisp,s_nSynthFGDisp,nFrameIdx*2);
+    std::vector<SegmMatcher::MatArrayOut> vSeqOutputs;
+    {
+        SegmMatcher oMatcher(0,s_nSynthMaxDisp);
+        oMatcher.initialize(vSequence[0].aROIs);
+        for(const SyntheticStereoPair& oPair : vSequence) {
+            SegmMatcher::MatArrayOut aOutputs;
+            oMatcher.apply(oPair.aInputs,aOutputs);
+            for(cv::Mat& oOutput : aOutputs)
+                oOutput = oOutput.clone();
+            vSeqOutputs.push_back(aOutputs);
+        }
+    }
+    SegmMatcher oMatcher(0,s_nSynthMaxDisp);
+    oMatcher.initialize(vSequence[0].aROIs);
+    SegmMatcher::MatArrayOut aOutputs;
+    ASSERT_FALSE(oMatcher.applyQueued(aOutputs));
+    size_t nNextOutputIdx = 0;
+    oMatcher.queueInputs(vSequence[0].aInputs,2);
+    for(size_t nFrameIdx=1; nFrameIdx<vSequence.size(); ++nFrameIdx) {
+        oMatcher.queueInputs(vSequence[nFrameIdx].aInputs,2);
+        ASSERT_TRUE(oMatcher.applyQueued(aOutputs));
+        ASSERT_TRUE(isEqualOutput(aOutputs,vSeqOutputs[nNextOutputIdx])) << "frame idx = " << nNextOutputIdx;
+        ++nNextOutputIdx;
+    }
+    ASSERT_TRUE(oMatcher.applyQueued(aOutputs));
+    ASSERT_TRUE(isEqualOutput(aOutputs,vSeqOutputs[nNextOutputIdx])) << "frame idx = " << nNextOutputIdx;
+    ++nNextOutputIdx;
+    ASSERT_EQ(nNextOutputIdx,vSequence.size());
+    ASSERT_FALSE(oMatcher.applyQueued(aOutputs));
+}
+
+TEST(SegmMatcher,regression_incremental_updates) {
+    // foreground box moves for a few frames, then stops; stale terms from the moving frames must not survive once it stops
+    std::vector<SyntheticStereoPair> vSequence;
+    for(int nFGShift : {0,2,4,6,6,6,6})
+        vSequence.emplace_back(96,72,s_nSynthBGDisp,s_nSynthFGDisp,nFGShift);
+    SegmMatcher::Params oFullParams,oIncrParams;
+    oFullParams.bUseIncrementalUpdates = false;
+    oIncrParams.bUseIncrementalUpdates = true;
+    SegmMatcher oFullMatcher(0,s_nSynthMaxDisp,oFullParams),oIncrMatcher(0,s_nSynthMaxDisp,oIncrParams);
+    oFullMatcher.initialize(vSequence[0].aROIs);
+    oIncrMatcher.initialize(vSequence[0].aROIs);
+    SegmMatcher::MatArrayOut aFullOutputs,aIncrOutputs;
+    for(size_t nFrameIdx=0; nFrameIdx<vSequence.size(); ++nFrameIdx) {
+        oFullMatcher.apply(vSequence[nFrameIdx].aInputs,aFullOutputs);
+        oIncrMatcher.apply(vSequence[nFrameIdx].aInputs,aIncrOutputs);
+        const SegmMatcher::FrameTelemetry& oFullTelemetry = oFullMatcher.getLastFrameTelemetry();
+        const SegmMatcher::FrameTelemetry& oIncrTelemetry = oIncrMatcher.getLastFrameTelemetry();
+        ASSERT_EQ(oFullTelemetry.vStereoEnergies,oIncrTelemetry.vStereoEnergies) << "frame idx = " << nFrameIdx;
+        ASSERT_EQ(oFullTelemetry.vResegmEnergies,oIncrTelemetry.vResegmEnergies) << "frame idx = " << nFrameIdx;
+        ASSERT_TRUE(isEqualOutput(aFullOutputs,aIncrOutputs)) << "frame idx = " << nFrameIdx;
+    }
+}
+
+TEST(SegmMatcher,regression_move_restriction) {
+    const SyntheticStereoPair oPair(96,72,s_nSynthBGDisp,s_nSynthFGDisp);
+    SegmMatcher::Params oFullParams,oRestrParams;
+    oFullParams.bUseCoarseMoveRestriction = false;
+    oRestrParams.bUseCoarseMoveRestriction = true;
+    SegmMatcher oFullMatcher(0,s_nSynthMaxDisp,oFullParams),oRestrMatcher(0,s_nSynthMaxDisp,oRestrParams);
+    oFullMatcher.initialize(oPair.aROIs);
+    oRestrMatcher.initialize(oPair.aROIs);
+    SegmMatcher::MatArrayOut aFullOutputs,aRestrOutputs;
+    // ratio of left image pixels (away from the box edges) whose disparity is within one label of the ground truth
+    const auto lGetDispAccuracy = [&](const SegmMatcher::MatArrayOut& aOutputs) {
+        cv::Mat_<int> oDispMap;
+        aOutputs[SegmMatcher::OutputPack_LeftDisp].convertTo(oDispMap,CV_32S);
+        const cv::Rect oFGBox(oDispMap.cols/3,oDispMap.rows/4,oDispMap.cols/3,oDispMap.rows/2);
+        const cv::Rect oFGInnerBox(oFGBox.x+2,oFGBox.y+2,oFGBox.width-4,oFGBox.height-4);
+        const cv::Rect oFGOuterBox(oFGBox.x-s_nSynthFGDisp-2,oFGBox.y-2,oFGBox.width+s_nSynthFGDisp+4,oFGBox.height+4);
+        size_t nGoodCount=0,nTotCount=0;
+        for(int nRowIdx=0; nRowIdx<oDispMap.rows; ++nRowIdx) {
+            for(int nColIdx=(int)s_nSynthMaxDisp; nColIdx<oDispMap.cols; ++nColIdx) {
+                const cv::Point oPt(nColIdx,nRowIdx);
+                if(!oFGInnerBox.contains(oPt) && oFGOuterBox.contains(oPt))
+                    continue;
+                const int nGTDisp = oFGInnerBox.contains(oPt)?oPair.nFGDisp:oPair.nBGDisp;
+                nGoodCount += size_t(std::abs(oDispMap(nRowIdx,nColIdx)-nGTDisp)<=1);
+                ++nTotCount;
+            }
+        }
+        return double(nGoodCount)/std::max(nTotCount,size_t(1));
+    };
+    for(size_t nFrameIdx=0; nFrameIdx<2; ++nFrameIdx) {
+        oFullMatcher.apply(oPair.aInputs,aFullOutputs);
+        oRestrMatcher.apply(oPair.aInputs,aRestrOutputs);
+        const SegmMatcher::FrameTelemetry& oFullTelemetry = oFullMatcher.getLastFrameTelemetry();
+        const SegmMatcher::FrameTelemetry& oRestrTelemetry = oRestrMatcher.getLastFrameTelemetry();
+        ASSERT_FALSE(oFullTelemetry.vStereoEnergies.empty());
+        ASSERT_FALSE(oRestrTelemetry.vStereoEnergies.empty());
+        // nodes outside their candidate sets are fixed to their current label, so the restricted solution can only be slightly worse than the full one
+        const double dFullEnergy = (double)oFullTelemetry.vStereoEnergies.back();
+        const double dRestrEnergy = (double)oRestrTelemetry.vStereoEnergies.back();
+        ASSERT_LE(dRestrEnergy,dFullEnergy+std::abs(dFullEnergy)*0.1) << "frame idx = " << nFrameIdx;
+        for(size_t nOutputIdx=0; nOutputIdx<aRestrOutputs.size(); ++nOutputIdx)
+            ASSERT_EQ(lv::MatInfo(aRestrOutputs[nOutputIdx]),lv::MatInfo(aFullOutputs[nOutputIdx]));
+        ASSERT_GE(lGetDispAccuracy(aRestrOutputs),lGetDispAccuracy(aFullOutputs)-0.05) << "frame idx = " << nFrameIdx;
+    }
+}
+
+namespace {
+
+    void SegmMatcher_calcFeatures_perftest(benchmark::State& st) {
+        const SyntheticStereoPair oPair((int)st.range(0),(int)st.range(0)*3/4,s_nSynthBGDisp,s_nSynthFGDisp);
+        SegmMatcher oMatcher(0,(size_t)st.range(1));
+        oMatcher.initialize(oPair.aROIs);
+        cv::Mat oFeaturesPacket;
+        while(st.KeepRunning()) {
+            oMatcher.calcFeatures(oPair.aInputs,&oFeaturesPacket);
+            benchmark::DoNotOptimize(oFeaturesPacket.data);
+        }
+    }
+
+    /// runs full frames with precomputed features; the third arg selects the timed stage (0=apply, 1=model updates, 2=inference)
+    void SegmMatcher_apply_perftest(benchmark::State& st) {
+        const SyntheticStereoPair oPair((int)st.range(0),(int)st.range(0)*3/4,s_nSynthBGDisp,s_nSynthFGDisp);
+        SegmMatcher oMatcher(0,(size_t)st.range(1));
+        oMatcher.initialize(oPair.aROIs);
+        cv::Mat oFeaturesPacket;
+        oMatcher.calcFeatures(oPair.aInputs,&oFeaturesPacket);
+        SegmMatcher::MatArrayOut aOutputs;
+        oMatcher.setNextFeatures(oFeaturesPacket);
+        oMatcher.apply(oPair.aInputs,aOutputs); // first frame has no temporal history; only steady-state frames are timed
+        SegmMatcher::FrameTelemetry oTelemetrySum{};
+        size_t nFrameCount = 0;
+        while(st.KeepRunning()) {
+            oMatcher.setNextFeatures(oFeaturesPacket);
+            lv::StopWatch oTimer;
+            oMatcher.apply(oPair.aInputs,aOutputs);
+            const double dApplyTime = oTimer.elapsed();
+            benchmark::DoNotOptimize(aOutputs[SegmMatcher::OutputPack_LeftDisp].data);
+            const SegmMatcher::FrameTelemetry& oTelemetry = oMatcher.getLastFrameTelemetry();
+            if(st.range(2)==1)
+                st.SetIterationTime(oTelemetry.dStereoUpdateTime+oTelemetry.dResegmUpdateTime);
+            else if(st.range(2)==2)
+                st.SetIterationTime(oTelemetry.dStereoInfTime+oTelemetry.dResegmInfTime);
+            else
+                st.SetIterationTime(dApplyTime);
+            oTelemetrySum.dStereoUpdateTime += oTelemetry.dStereoUpdateTime;
+            oTelemetrySum.dResegmUpdateTime += oTelemetry.dResegmUpdateTime;
+            oTelemetrySum.dStereoInfTime += oTelemetry.dStereoInfTime;
+            oTelemetrySum.dResegmInfTime += oTelemetry.dResegmInfTime;
+            oTelemetrySum.nStereoMoveCount += oTelemetry.nStereoMoveCount;
+            oTelemetrySum.nResegmMoveCount += oTelemetry.nResegmMoveCount;
+            oTelemetrySum.nModelBytes = oTelemetry.nModelBytes;
+            ++nFrameCount;
+        }
+        if(nFrameCount>0) {
+            // benchmark lib version in use has no custom counters; stage averages are reported in the label instead
+            const double dMs = 1000.0/nFrameCount;
+            st.SetLabel(cv::format("upd(s/r)=%.2f/%.2fms inf(s/r)=%.2f/%.2fms moves(s/r)=%.1f/%.1f mem=%zuKB",
+                                   oTelemetrySum.dStereoUpdateTime*dMs,oTelemetrySum.dResegmUpdateTime*dMs,
+                                   oTelemetrySum.dStereoInfTime*dMs,oTelemetrySum.dResegmInfTime*dMs,
+                                   double(oTelemetrySum.nStereoMoveCount)/nFrameCount,double(oTelemetrySum.nResegmMoveCount)/nFrameCount,
+                                   oTelemetrySum.nModelBytes/1024));
+        }
+    }
+
+}
+
+BENCHMARK(SegmMatcher_calcFeatures_perftest)->Args({96,16})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(SegmMatcher_apply_perftest)->Args({96,16,0})->UseManualTime()->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(SegmMatcher_apply_perftest)->Args({96,16,1})->UseManualTime()->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(SegmMatcher_apply_perftest)->Args({96,16,2})->UseManualTime()->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+
+BENCHMARK(SegmMatcher_calcFeatures_perftest)->Args({192,32})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(SegmMatcher_apply_perftest)->Args({192,32,0})->UseManualTime()->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+
+#endif //HAVE_OPENGM && HAVE_BOOST
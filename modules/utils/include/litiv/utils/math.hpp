@@ -370,6 +370,149 @@ namespace lv {
         }
     }
 
+    /// computes the squared L2 distance between two contiguous float arrays (vectorized via AVX/FMA or SSE2 if possible)
+    inline float L2sqrdist_32f(const float* a, const float* b, size_t nElements) {
+        lvDbgAssert_(a && b,"invalid buffer pointers");
+        size_t nIdx = 0;
+        float fResult = 0.0f;
+    #if HAVE_AVX
+        if(nElements>=8) {
+            __m256 afAccum = _mm256_setzero_ps();
+            for(; nIdx+8<=nElements; nIdx+=8) {
+                const __m256 afDiff = _mm256_sub_ps(_mm256_loadu_ps(a+nIdx),_mm256_loadu_ps(b+nIdx));
+            #if defined(__FMA__)
+                afAccum = _mm256_fmadd_ps(afDiff,afDiff,afAccum);
+            #else //!defined(__FMA__)
+                afAccum = _mm256_add_ps(afAccum,_mm256_mul_ps(afDiff,afDiff));
+            #endif //!defined(__FMA__)
+            }
+            const __m128 afAccum4 = _mm_add_ps(_mm256_castps256_ps128(afAccum),_mm256_extractf128_ps(afAccum,1));
+            const __m128 afAccum2 = _mm_add_ps(afAccum4,_mm_movehl_ps(afAccum4,afAccum4));
+            fResult = _mm_cvtss_f32(_mm_add_ss(afAccum2,_mm_shuffle_ps(afAccum2,afAccum2,1)));
+        }
+    #elif HAVE_SSE2
+        if(nElements>=4) {
+            __m128 afAccum = _mm_setzero_ps();
+            for(; nIdx+4<=nElements; nIdx+=4) {
+                const __m128 afDiff = _mm_sub_ps(_mm_loadu_ps(a+nIdx),_mm_loadu_ps(b+nIdx));
+                afAccum = _mm_add_ps(afAccum,_mm_mul_ps(afDiff,afDiff));
+            }
+            const __m128 afAccum2 = _mm_add_ps(afAccum,_mm_movehl_ps(afAccum,afAccum));
+            fResult = _mm_cvtss_f32(_mm_add_ss(afAccum2,_mm_shuffle_ps(afAccum2,afAccum2,1)));
+        }
+    #endif //HAVE_SSE2
+        for(; nIdx<nElements; ++nIdx)
+            fResult += L2sqrdist(a[nIdx],b[nIdx]);
+        return fResult;
+    }
+
+    /// computes the L1 norm, squared L2 norm and element count of a contiguous float array, optionally skipping negative (i.e. invalid) values (vectorized via AVX or SSE2 if possible)
+    template<bool bSkipNegative=false>
+    inline void calcNorms_32f(const float* a, size_t nElements, float& fL1Norm, float& fL2SqrNorm, size_t& nValidElements) {
+        lvDbgAssert_(a,"invalid buffer pointer");
+        size_t nIdx = 0;
+        float fValidCount = 0.0f;
+        fL1Norm = fL2SqrNorm = 0.0f;
+    #if HAVE_AVX
+        if(nElements>=8) {
+            const __m256 afZero = _mm256_setzero_ps(), afOne = _mm256_set1_ps(1.0f), afAbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+            __m256 afL1Accum = afZero, afL2Accum = afZero, afCountAccum = afZero;
+            for(; nIdx+8<=nElements; nIdx+=8) {
+                __m256 afVals = _mm256_loadu_ps(a+nIdx);
+                if(bSkipNegative) {
+                    const __m256 afValidMask = _mm256_cmp_ps(afVals,afZero,_CMP_GE_OQ);
+                    afVals = _mm256_and_ps(afVals,afValidMask);
+                    afCountAccum = _mm256_add_ps(afCountAccum,_mm256_and_ps(afOne,afValidMask));
+                }
+                else
+                    afVals = _mm256_and_ps(afVals,afAbsMask);
+                afL1Accum = _mm256_add_ps(afL1Accum,afVals);
+            #if defined(__FMA__)
+                afL2Accum = _mm256_fmadd_ps(afVals,afVals,afL2Accum);
+            #else //!defined(__FMA__)
+                afL2Accum = _mm256_add_ps(afL2Accum,_mm256_mul_ps(afVals,afVals));
+            #endif //!defined(__FMA__)
+            }
+            const auto lHorizSum = [](__m256 afAccum) {
+                const __m128 afAccum4 = _mm_add_ps(_mm256_castps256_ps128(afAccum),_mm256_extractf128_ps(afAccum,1));
+                const __m128 afAccum2 = _mm_add_ps(afAccum4,_mm_movehl_ps(afAccum4,afAccum4));
+                return _mm_cvtss_f32(_mm_add_ss(afAccum2,_mm_shuffle_ps(afAccum2,afAccum2,1)));
+            };
+            fL1Norm = lHorizSum(afL1Accum);
+            fL2SqrNorm = lHorizSum(afL2Accum);
+            fValidCount = bSkipNegative?lHorizSum(afCountAccum):float(nIdx);
+        }
+    #elif HAVE_SSE2
+        if(nElements>=4) {
+            const __m128 afZero = _mm_setzero_ps(), afOne = _mm_set1_ps(1.0f), afAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+            __m128 afL1Accum = afZero, afL2Accum = afZero, afCountAccum = afZero;
+            for(; nIdx+4<=nElements; nIdx+=4) {
+                __m128 afVals = _mm_loadu_ps(a+nIdx);
+                if(bSkipNegative) {
+                    const __m128 afValidMask = _mm_cmpge_ps(afVals,afZero);
+                    afVals = _mm_and_ps(afVals,afValidMask);
+                    afCountAccum = _mm_add_ps(afCountAccum,_mm_and_ps(afOne,afValidMask));
+                }
+                else
+                    afVals = _mm_and_ps(afVals,afAbsMask);
+                afL1Accum = _mm_add_ps(afL1Accum,afVals);
+                afL2Accum = _mm_add_ps(afL2Accum,_mm_mul_ps(afVals,afVals));
+            }
+            const auto lHorizSum = [](__m128 afAccum) {
+                const __m128 afAccum2 = _mm_add_ps(afAccum,_mm_movehl_ps(afAccum,afAccum));
+                return _mm_cvtss_f32(_mm_add_ss(afAccum2,_mm_shuffle_ps(afAccum2,afAccum2,1)));
+            };
+            fL1Norm = lHorizSum(afL1Accum);
+            fL2SqrNorm = lHorizSum(afL2Accum);
+            fValidCount = bSkipNegative?lHorizSum(afCountAccum):float(nIdx);
+        }
+    #endif //HAVE_SSE2
+        nValidElements = size_t(fValidCount);
+        for(; nIdx<nElements; ++nIdx) {
+            if(bSkipNegative && !(a[nIdx]>=0.0f))
+                continue;
+            fL1Norm += std::abs(a[nIdx]);
+            fL2SqrNorm += a[nIdx]*a[nIdx];
+            ++nValidElements;
+        }
+    }
+
+    /// computes Hoyer's sparseness metric over a contiguous float array, optionally skipping negative (i.e. invalid) values (returns 0 if fewer than two valid values remain, or if they are all null)
+    template<bool bSkipNegative=false>
+    inline float sparseness_32f(const float* a, size_t nElements) {
+        // see 'lv::sparseness' below for the generic (cv::norm-based) version; 'sparse'-valued vectors will have output close to 1, 'uniform'-valued vectors close to 0
+        float fL1Norm,fL2SqrNorm;
+        size_t nValidElements;
+        calcNorms_32f<bSkipNegative>(a,nElements,fL1Norm,fL2SqrNorm,nValidElements);
+        if(nValidElements<2u || fL2SqrNorm<=0.0f)
+            return 0.0f;
+        const float fSizeRoot = std::sqrt(float(nValidElements));
+        return (fSizeRoot-fL1Norm/std::sqrt(fL2SqrNorm))/(fSizeRoot-1.0f);
+    }
+
+    /// performs 'root-sift'-like descriptor value adjustment (L1-normalization + per-elem square root) on a contiguous non-negative float array (vectorized via AVX or SSE2 if possible)
+    inline void rootSIFT_32f(float* aDesc, size_t nDescSize) {
+        // equivalent to 'lv::rootSIFT<float>' with its default config (no final L2-normalization, no negative bins)
+        float fL1Norm,fL2SqrNorm;
+        size_t nValidElements;
+        calcNorms_32f(aDesc,nDescSize,fL1Norm,fL2SqrNorm,nValidElements);
+        const float fInvL1Norm = float(1.0/(double(fL1Norm)+DBL_EPSILON));
+        size_t nIdx = 0;
+    #if HAVE_AVX
+        const __m256 afInvL1Norm8 = _mm256_set1_ps(fInvL1Norm);
+        for(; nIdx+8<=nDescSize; nIdx+=8)
+            _mm256_storeu_ps(aDesc+nIdx,_mm256_sqrt_ps(_mm256_mul_ps(_mm256_loadu_ps(aDesc+nIdx),afInvL1Norm8)));
+    #elif HAVE_SSE2
+        const __m128 afInvL1Norm4 = _mm_set1_ps(fInvL1Norm);
+        for(; nIdx+4<=nDescSize; nIdx+=4)
+            _mm_storeu_ps(aDesc+nIdx,_mm_sqrt_ps(_mm_mul_ps(_mm_loadu_ps(aDesc+nIdx),afInvL1Norm4)));
+    #endif //HAVE_SSE2
+        for(; nIdx<nDescSize; ++nIdx) {
+            lvDbgAssert_(aDesc[nIdx]>=0.0f,"cannot handle negative descriptor bins");
+            aDesc[nIdx] = std::sqrt(aDesc[nIdx]*fInvL1Norm);
+        }
+    }
+
 #if USE_CVCORE_WITH_UTILS
 
     /// computes the squared L2 distance between two opencv vectors
@@ -734,6 +877,29 @@ namespace lv {
         return hdist<nChannels,Tin,Tout>(a,b.data());
     }
 
+    /// computes the element-wise hamming distances between two 16-bit unsigned integer arrays (vectorized via nibble-LUT popcounts if possible)
+    inline void hdist_16ui(const uint16_t* anBuffer1, const uint16_t* anBuffer2, uint8_t* anOutput, size_t nCount) {
+        lvDbgAssert_(anBuffer1 && anBuffer2 && anOutput,"invalid buffer pointers");
+        size_t nIdx = 0;
+    #if HAVE_AVX2
+        for(; nIdx+32<=nCount; nIdx+=32) {
+            const __m256i anDist1 = lv::popcount_16ui(_mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(anBuffer1+nIdx)),_mm256_loadu_si256((const __m256i*)(anBuffer2+nIdx))));
+            const __m256i anDist2 = lv::popcount_16ui(_mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(anBuffer1+nIdx+16)),_mm256_loadu_si256((const __m256i*)(anBuffer2+nIdx+16))));
+            // packus works within 128-bit lanes, so the 64-bit quarters must be reordered after packing
+            _mm256_storeu_si256((__m256i*)(anOutput+nIdx),_mm256_permute4x64_epi64(_mm256_packus_epi16(anDist1,anDist2),_MM_SHUFFLE(3,1,2,0)));
+        }
+    #endif //HAVE_AVX2
+    #if HAVE_SSSE3
+        for(; nIdx+16<=nCount; nIdx+=16) {
+            const __m128i anDist1 = lv::popcount_16ui(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(anBuffer1+nIdx)),_mm_loadu_si128((const __m128i*)(anBuffer2+nIdx))));
+            const __m128i anDist2 = lv::popcount_16ui(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(anBuffer1+nIdx+8)),_mm_loadu_si128((const __m128i*)(anBuffer2+nIdx+8))));
+            _mm_storeu_si128((__m128i*)(anOutput+nIdx),_mm_packus_epi16(anDist1,anDist2));
+        }
+    #endif //HAVE_SSSE3
+        for(; nIdx<nCount; ++nIdx)
+            anOutput[nIdx] = hdist<uint16_t,uint8_t>(anBuffer1[nIdx],anBuffer2[nIdx]);
+    }
+
     /// computes the gradient magnitude distance between two N-byte vectors
     template<typename T>
     inline auto gdist(T a, T b) {
@@ -1167,14 +1333,33 @@ namespace lv {
         /// returns the best-fitting component for a given sample
         template<typename TVal>
         size_t getBestComponent(const TVal* aSample) const;
-        /// initializes learning mode (enables 'addSample' to learn new model params)
-        void initLearning();
+        /// fills 'anBestComps' at the given indices with the best-fitting components of the indexed samples (log-domain scoring over vectorizable sample blocks)
+        template<typename TVal, typename TIdx>
+        void getBestComponents(const TVal* aSamples, const TIdx* anSampleIdxs, size_t nSamples, int* anBestComps) const;
+        /// sample statistics accumulator used to split (or incrementally update) model param estimation
+        struct SampleStats {
+            /// resets all accumulated sums/products/counts to zero
+            void reset();
+            /// adds a data sample to a specific component
+            template<typename TVal>
+            void add(size_t nCompIdx, const TVal* aSample);
+            /// removes a (previously added) data sample from a specific component
+            template<typename TVal>
+            void remove(size_t nCompIdx, const TVal* aSample);
+            double aSums[nComps][nDims];
+            double aProds[nComps][nDims][nDims];
+            int64_t anCounts[nComps];
+        };
+        /// initializes learning mode (enables 'addSample' to learn new model params); previous samples are kept if 'bResetStats' is false
+        void initLearning(bool bResetStats=true);
         /// adds a new data sample to a specific component for model param estimation
         template<typename TVal>
         void addSample(size_t nCompIdx, const std::array<TVal,nDims>& aSample);
         /// adds a new data sample to a specific component for model param estimation
         template<typename TVal>
         void addSample(size_t nCompIdx, const TVal* aSample);
+        /// adds (or removes, if counts are negative) pre-accumulated sample statistics for model param estimation
+        void addSampleStats(const SampleStats& oStats);
         /// disables learning mode, and estimates ideal model params using added samples
         void endLearning();
         /// returns the number of gaussian components in the mixture model (templated param)
@@ -1297,11 +1482,113 @@ size_t lv::GMM<nComps,nDims>::getBestComponent(const TVal* aSample) const {
 }
 
 template<size_t nComps, size_t nDims>
-void lv::GMM<nComps,nDims>::initLearning() {
-    std::fill_n(&m_aSampleSums[0][0],nComps*nDims,0.0);
-    std::fill_n(&m_aSampleProds[0][0][0],nComps*nDims*nDims,0.0);
-    std::fill_n(&m_nSampleCounts[0],nComps,size_t(0));
-    m_nTotSampleCount = size_t(0);
+template<typename TVal, typename TIdx>
+void lv::GMM<nComps,nDims>::getBestComponents(const TVal* aSamples, const TIdx* anSampleIdxs, size_t nSamples, int* anBestComps) const {
+    lvDbgAssert(!m_bLearningModeOn);
+    lvDbgAssert(aSamples!=nullptr && anSampleIdxs!=nullptr && anBestComps!=nullptr);
+    // samples are scored in structure-of-arrays blocks in the log domain (log(w_k)-0.5*mahalanobis), so that the
+    // inner loops run over samples without any transcendental call and can be auto-vectorized; since exp() is
+    // monotonic, the argmax matches getBestComponent() up to rounding, except where all densities underflow
+    constexpr size_t nBlockSize = 64;
+    alignas(32) double aBlockSamples[nDims][nBlockSize];
+    alignas(32) double aBlockDiffs[nDims][nBlockSize];
+    alignas(32) double aMaxScores[nBlockSize],aCurrScores[nBlockSize];
+    alignas(32) int anBlockBestComps[nBlockSize];
+    // log-domain normalization factors are derived once per call from the cached pdf factors (model data may be overwritten externally)
+    std::array<double,nComps> aLogPDFFactors;
+    lv::unroll<nComps>([&](size_t nCompIdx){
+        aLogPDFFactors[nCompIdx] = (m_aCoeffs[nCompIdx]>0)?std::log(m_aGaussPDFFactors[nCompIdx]):-std::numeric_limits<double>::infinity();
+    });
+    const auto lScoreBlock = [&](size_t nCompIdx, size_t nBlockSamples, double* aScores) {
+        if(m_aCoeffs[nCompIdx]>0) {
+            lvDbgAssert(m_aCovMatDeterms[nCompIdx]>std::numeric_limits<double>::epsilon());
+            const double* aMean = m_aMeans+nDims*nCompIdx;
+            const double* aInvCovMat = m_aInvCovMats+nCompIdx*nDims*nDims;
+            lv::unroll<nDims>([&](size_t nDimIdx){
+                const double dMean = aMean[nDimIdx];
+                for(size_t nBlockIdx=0; nBlockIdx<nBlockSamples; ++nBlockIdx)
+                    aBlockDiffs[nDimIdx][nBlockIdx] = aBlockSamples[nDimIdx][nBlockIdx]-dMean;
+            });
+            std::fill_n(aScores,nBlockSamples,0.0);
+            lv::unroll<nDims>([&](size_t nDimIdx1){
+                lv::unroll<nDims>([&](size_t nDimIdx2){
+                    const double dInvCov = -0.5*aInvCovMat[nDimIdx2*nDims+nDimIdx1];
+                    for(size_t nBlockIdx=0; nBlockIdx<nBlockSamples; ++nBlockIdx)
+                        aScores[nBlockIdx] += aBlockDiffs[nDimIdx1][nBlockIdx]*aBlockDiffs[nDimIdx2][nBlockIdx]*dInvCov;
+                });
+            });
+            const double dLogPDFFactor = aLogPDFFactors[nCompIdx];
+            for(size_t nBlockIdx=0; nBlockIdx<nBlockSamples; ++nBlockIdx)
+                aScores[nBlockIdx] += dLogPDFFactor;
+        }
+        else
+            std::fill_n(aScores,nBlockSamples,-std::numeric_limits<double>::infinity());
+    };
+    for(size_t nBlockStartIdx=0; nBlockStartIdx<nSamples; nBlockStartIdx+=nBlockSize) {
+        const size_t nBlockSamples = std::min(nBlockSize,nSamples-nBlockStartIdx);
+        for(size_t nBlockIdx=0; nBlockIdx<nBlockSamples; ++nBlockIdx) {
+            const TVal* aSample = aSamples+size_t(anSampleIdxs[nBlockStartIdx+nBlockIdx])*nDims;
+            lv::unroll<nDims>([&](size_t nDimIdx){aBlockSamples[nDimIdx][nBlockIdx] = double(aSample[nDimIdx]);});
+        }
+        // same component visiting order and strict comparison as getBestComponent() to break exact ties identically
+        lScoreBlock(nComps-1,nBlockSamples,aMaxScores);
+        std::fill_n(anBlockBestComps,nBlockSamples,int(nComps-1));
+        lv::unroll<nComps-1>([&](size_t nCompIdx){
+            lScoreBlock(nCompIdx,nBlockSamples,aCurrScores);
+            for(size_t nBlockIdx=0; nBlockIdx<nBlockSamples; ++nBlockIdx) {
+                const bool bBetter = aCurrScores[nBlockIdx]>aMaxScores[nBlockIdx];
+                anBlockBestComps[nBlockIdx] = bBetter?int(nCompIdx):anBlockBestComps[nBlockIdx];
+                aMaxScores[nBlockIdx] = bBetter?aCurrScores[nBlockIdx]:aMaxScores[nBlockIdx];
+            }
+        });
+        for(size_t nBlockIdx=0; nBlockIdx<nBlockSamples; ++nBlockIdx)
+            anBestComps[anSampleIdxs[nBlockStartIdx+nBlockIdx]] = anBlockBestComps[nBlockIdx];
+    }
+}
+
+template<size_t nComps, size_t nDims>
+void lv::GMM<nComps,nDims>::SampleStats::reset() {
+    std::fill_n(&aSums[0][0],nComps*nDims,0.0);
+    std::fill_n(&aProds[0][0][0],nComps*nDims*nDims,0.0);
+    std::fill_n(&anCounts[0],nComps,int64_t(0));
+}
+
+template<size_t nComps, size_t nDims>
+template<typename TVal>
+void lv::GMM<nComps,nDims>::SampleStats::add(size_t nCompIdx, const TVal* aSample) {
+    lvDbgAssert(nCompIdx<nComps);
+    lvDbgAssert(aSample!=nullptr);
+    lv::unroll<nDims>([&](size_t nDimIdx1){
+        aSums[nCompIdx][nDimIdx1] += double(aSample[nDimIdx1]);
+        lv::unroll<nDims>([&](size_t nDimIdx2){
+            aProds[nCompIdx][nDimIdx1][nDimIdx2] += double(aSample[nDimIdx1])*double(aSample[nDimIdx2]);
+        });
+    });
+    ++anCounts[nCompIdx];
+}
+
+template<size_t nComps, size_t nDims>
+template<typename TVal>
+void lv::GMM<nComps,nDims>::SampleStats::remove(size_t nCompIdx, const TVal* aSample) {
+    lvDbgAssert(nCompIdx<nComps);
+    lvDbgAssert(aSample!=nullptr);
+    lv::unroll<nDims>([&](size_t nDimIdx1){
+        aSums[nCompIdx][nDimIdx1] -= double(aSample[nDimIdx1]);
+        lv::unroll<nDims>([&](size_t nDimIdx2){
+            aProds[nCompIdx][nDimIdx1][nDimIdx2] -= double(aSample[nDimIdx1])*double(aSample[nDimIdx2]);
+        });
+    });
+    --anCounts[nCompIdx];
+}
+
+template<size_t nComps, size_t nDims>
+void lv::GMM<nComps,nDims>::initLearning(bool bResetStats) {
+    if(bResetStats) {
+        std::fill_n(&m_aSampleSums[0][0],nComps*nDims,0.0);
+        std::fill_n(&m_aSampleProds[0][0][0],nComps*nDims*nDims,0.0);
+        std::fill_n(&m_nSampleCounts[0],nComps,size_t(0));
+        m_nTotSampleCount = size_t(0);
+    }
     m_bLearningModeOn = true;
 }
 
@@ -1327,6 +1614,22 @@ void lv::GMM<nComps,nDims>::addSample(size_t nCompIdx, const TVal* aSample) {
     ++m_nTotSampleCount;
 }
 
+template<size_t nComps, size_t nDims>
+void lv::GMM<nComps,nDims>::addSampleStats(const SampleStats& oStats) {
+    lvDbgAssert(m_bLearningModeOn);
+    lv::unroll<nComps>([&](size_t nCompIdx){
+        lv::unroll<nDims>([&](size_t nDimIdx1){
+            m_aSampleSums[nCompIdx][nDimIdx1] += oStats.aSums[nCompIdx][nDimIdx1];
+            lv::unroll<nDims>([&](size_t nDimIdx2){
+                m_aSampleProds[nCompIdx][nDimIdx1][nDimIdx2] += oStats.aProds[nCompIdx][nDimIdx1][nDimIdx2];
+            });
+        });
+        lvDbgAssert(int64_t(m_nSampleCounts[nCompIdx])+oStats.anCounts[nCompIdx]>=int64_t(0));
+        m_nSampleCounts[nCompIdx] = size_t(int64_t(m_nSampleCounts[nCompIdx])+oStats.anCounts[nCompIdx]);
+        m_nTotSampleCount = size_t(int64_t(m_nTotSampleCount)+oStats.anCounts[nCompIdx]);
+    });
+}
+
 template<size_t nComps, size_t nDims>
 void lv::GMM<nComps,nDims>::endLearning() {
     lvDbgAssert(m_bLearningModeOn);
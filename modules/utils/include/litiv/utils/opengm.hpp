@@ -309,17 +309,20 @@ namespace lv {
             static constexpr TIndex s_nCliqueSize = TIndex(0);
         };
 
-        /// higher-order term reducer (used by FGBZ solver w/ QPBO-compatible interface)
+        /// higher-order term reducer (used by FGBZ solver w/ QPBO-compatible interface); nodes with a null move mask entry keep their current label
         template<typename TFunc, size_t nOrder, typename TValue, typename TIndex, typename TLabel, typename ReducerType>
-        inline void factorReducer(const Clique<nOrder,TValue,TIndex,TLabel>& oClique, ReducerType& oReducer, TLabel nAlphaLabel, const TLabel* aLabeling) {
+        inline void factorReducer(const Clique<nOrder,TValue,TIndex,TLabel>& oClique, ReducerType& oReducer, TLabel nAlphaLabel, const TLabel* aLabeling, const uint8_t* aMoveMask=nullptr) {
             if(oClique) {
                 std::array<typename ReducerType::VarId,nOrder> aTermEnergyLUT;
                 std::array<TLabel,nOrder> aCliqueLabels;
                 std::array<TValue,(1u<<nOrder)> aCliqueCoeffs{};
                 constexpr size_t nAssignCount = 1UL<<nOrder;
                 for(size_t nAssignIdx=0; nAssignIdx<nAssignCount; ++nAssignIdx) {
-                    for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx)
-                        aCliqueLabels[nVarIdx] = (nAssignIdx&(1<<nVarIdx))?nAlphaLabel:aLabeling[oClique.m_anLUTNodeIdxs[nVarIdx]];
+                    for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx) {
+                        const TIndex nLUTNodeIdx = oClique.m_anLUTNodeIdxs[nVarIdx];
+                        // fixed nodes see the same label in both move states, so all terms involving them cancel out below
+                        aCliqueLabels[nVarIdx] = ((nAssignIdx&(1<<nVarIdx)) && (!aMoveMask || aMoveMask[nLUTNodeIdx]))?nAlphaLabel:aLabeling[nLUTNodeIdx];
+                    }
                     for(size_t nAssignSubsetIdx=1; nAssignSubsetIdx<nAssignCount; ++nAssignSubsetIdx) {
                         if(!(nAssignIdx&~nAssignSubsetIdx)) {
                             int nParityBit = 0;
@@ -130,6 +130,44 @@ namespace lv {
 
 #endif //HAVE_SSE2
 
+#if HAVE_SSSE3
+
+    /// returns the per-byte population count of the provided 16-byte array (uses 4-bit nibble lookups via pshufb)
+    inline __m128i popcount_8ui(const __m128i& anBuffer) {
+        const __m128i anNibbleLUT = _mm_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m128i anNibbleMask = _mm_set1_epi8(0x0F);
+        const __m128i anLowCounts = _mm_shuffle_epi8(anNibbleLUT,_mm_and_si128(anBuffer,anNibbleMask));
+        const __m128i anHighCounts = _mm_shuffle_epi8(anNibbleLUT,_mm_and_si128(_mm_srli_epi16(anBuffer,4),anNibbleMask));
+        return _mm_add_epi8(anLowCounts,anHighCounts);
+    }
+
+    /// returns the per-word population count of the provided 8x16-bit array (each count is stored in its word's low byte)
+    inline __m128i popcount_16ui(const __m128i& anBuffer) {
+        const __m128i anByteCounts = popcount_8ui(anBuffer);
+        return _mm_and_si128(_mm_add_epi8(anByteCounts,_mm_srli_epi16(anByteCounts,8)),_mm_set1_epi16(0x00FF));
+    }
+
+#endif //HAVE_SSSE3
+
+#if HAVE_AVX2
+
+    /// returns the per-byte population count of the provided 32-byte array (uses 4-bit nibble lookups via vpshufb)
+    inline __m256i popcount_8ui(const __m256i& anBuffer) {
+        const __m256i anNibbleLUT = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m256i anNibbleMask = _mm256_set1_epi8(0x0F);
+        const __m256i anLowCounts = _mm256_shuffle_epi8(anNibbleLUT,_mm256_and_si256(anBuffer,anNibbleMask));
+        const __m256i anHighCounts = _mm256_shuffle_epi8(anNibbleLUT,_mm256_and_si256(_mm256_srli_epi16(anBuffer,4),anNibbleMask));
+        return _mm256_add_epi8(anLowCounts,anHighCounts);
+    }
+
+    /// returns the per-word population count of the provided 16x16-bit array (each count is stored in its word's low byte)
+    inline __m256i popcount_16ui(const __m256i& anBuffer) {
+        const __m256i anByteCounts = popcount_8ui(anBuffer);
+        return _mm256_and_si256(_mm256_add_epi8(anByteCounts,_mm256_srli_epi16(anByteCounts,8)),_mm256_set1_epi16(0x00FF));
+    }
+
+#endif //HAVE_AVX2
+
 #if HAVE_SSE4_1
 
     /// returns the minimum value of the provided 16-unsigned-byte array
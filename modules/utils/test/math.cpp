@@ -999,6 +999,35 @@ TEST(rootSIFT,regression) {
 
 #endif //def(HAVE_OPENCV_XFEATURES2D)
 
+TEST(rootSIFT_32f,regression) {
+    for(size_t nDescSize : {1,3,8,17,64,129}) {
+        std::unique_ptr<float[]> aDesc = lv::test::genarray<float>(nDescSize,0.0f,10.0f);
+        std::vector<float> vDescRef(aDesc.get(),aDesc.get()+nDescSize);
+        lv::rootSIFT(vDescRef.data(),nDescSize);
+        lv::rootSIFT_32f(aDesc.get(),nDescSize);
+        for(size_t nIdx=0; nIdx<nDescSize; ++nIdx)
+            ASSERT_NEAR(aDesc[nIdx],vDescRef[nIdx],1e-5f) << "with size = " << nDescSize;
+    }
+}
+
+TEST(sparseness_32f,regression) {
+    for(size_t nVecSize : {2,5,8,13,64,127}) {
+        std::unique_ptr<float[]> aVec = lv::test::genarray<float>(nVecSize,-1.0f,5.0f);
+        std::vector<float> vAbsVec(nVecSize),vValidVec;
+        for(size_t nIdx=0; nIdx<nVecSize; ++nIdx) {
+            vAbsVec[nIdx] = std::abs(aVec[nIdx]);
+            if(aVec[nIdx]>=0.0f)
+                vValidVec.push_back(aVec[nIdx]);
+        }
+        ASSERT_NEAR(lv::sparseness_32f(aVec.get(),nVecSize),(float)lv::sparseness(vAbsVec.data(),nVecSize),1e-4f) << "with size = " << nVecSize;
+        const float fValidSparsenessRef = vValidVec.size()>1?(float)lv::sparseness(vValidVec.data(),vValidVec.size()):0.0f;
+        ASSERT_NEAR(lv::sparseness_32f<true>(aVec.get(),nVecSize),fValidSparsenessRef,1e-4f) << "with size = " << nVecSize;
+    }
+    const std::vector<float> vNullVec(10,0.0f),vSparseVec = {0.0f,0.0f,3.0f,0.0f,-1.0f};
+    ASSERT_EQ(lv::sparseness_32f(vNullVec.data(),vNullVec.size()),0.0f);
+    ASSERT_NEAR(lv::sparseness_32f<true>(vSparseVec.data(),vSparseVec.size()),1.0f,1e-6f);
+}
+
 namespace {
     template<typename T>
     struct find_nn_index_fixture : testing::Test {
@@ -1060,4 +1089,43 @@ TEST(expand_bits,regression) {
     EXPECT_EQ(uint32_t(lv::expand_bits<4>(0)),uint32_t(0));
     EXPECT_EQ(uint32_t(lv::expand_bits<4>(0b1111)),uint32_t(0b0001000100010001));
     EXPECT_EQ(uint32_t(lv::expand_bits<4>(0b101010)),uint32_t(0b000100000001000000010000));
-}
\ No newline at end of file
+}
+TEST(GMM,regression_best_components) {
+    constexpr size_t nSamples = 10000;
+    std::vector<uchar> vSamples(nSamples*3);
+    for(size_t nSampleIdx=0; nSampleIdx<nSamples; ++nSampleIdx) {
+        // samples are drawn around a few random centers so that the model gets distinct, overlapping components
+        const int nCenterIdx = rand()%5;
+        for(size_t nDimIdx=0; nDimIdx<3; ++nDimIdx)
+            vSamples[nSampleIdx*3+nDimIdx] = cv::saturate_cast<uchar>(40*nCenterIdx+int(nDimIdx)*10+rand()%60-30);
+    }
+    lv::GMM<5,3> oModel;
+    oModel.initLearning();
+    for(size_t nSampleIdx=0; nSampleIdx<nSamples; ++nSampleIdx)
+        oModel.addSample(size_t(rand()%2?(vSamples[nSampleIdx*3]/52):(rand()%5)),vSamples.data()+nSampleIdx*3);
+    oModel.endLearning();
+    std::vector<uint32_t> vnSampleIdxs(nSamples);
+    std::iota(vnSampleIdxs.begin(),vnSampleIdxs.end(),uint32_t(0));
+    std::vector<int> vnBestComps(nSamples,-1);
+    oModel.getBestComponents(vSamples.data(),vnSampleIdxs.data(),nSamples,vnBestComps.data());
+    for(size_t nSampleIdx=0; nSampleIdx<nSamples; ++nSampleIdx) {
+        const uchar* aSample = vSamples.data()+nSampleIdx*3;
+        const size_t nScalarBestComp = oModel.getBestComponent(aSample);
+        ASSERT_GE(vnBestComps[nSampleIdx],0);
+        if(size_t(vnBestComps[nSampleIdx])!=nScalarBestComp) {
+            // log-domain scoring may only disagree with the exp-domain argmax on rounding-level ties
+            const double dScalarProb = oModel(nScalarBestComp,aSample), dBlockProb = oModel(size_t(vnBestComps[nSampleIdx]),aSample);
+            ASSERT_NEAR(dBlockProb,dScalarProb,dScalarProb*1e-9) << "nSampleIdx=" << nSampleIdx;
+        }
+    }
+    // scoring on a sample subset must only touch the indexed entries
+    const std::vector<int> vnFullBestComps = vnBestComps;
+    std::fill(vnBestComps.begin(),vnBestComps.end(),-1);
+    oModel.getBestComponents(vSamples.data(),vnSampleIdxs.data()+nSamples/2,nSamples/4,vnBestComps.data());
+    for(size_t nSampleIdx=0; nSampleIdx<nSamples; ++nSampleIdx) {
+        if(nSampleIdx>=nSamples/2 && nSampleIdx<nSamples/2+nSamples/4)
+            ASSERT_EQ(vnBestComps[nSampleIdx],vnFullBestComps[nSampleIdx]) << "nSampleIdx=" << nSampleIdx;
+        else
+            ASSERT_EQ(vnBestComps[nSampleIdx],-1) << "nSampleIdx=" << nSampleIdx;
+    }
+}
@@ -1,5 +1,6 @@
 
 #include "litiv/utils/simd.hpp"
+#include "litiv/utils/math.hpp"
 #include "litiv/test.hpp"
 
 #if HAVE_MMX
@@ -272,4 +273,104 @@ TEST(hmax_32si,regression) {
     }
 }
 
-#endif //HAVE_SSE4_1
\ No newline at end of file
+#endif //HAVE_SSE4_1
+
+#if HAVE_SSSE3
+
+TEST(popcount_8ui,regression_128bit) {
+    union {
+        uint8_t n[16];
+        __m128i a;
+    } uData,uRes;
+    for(size_t i=0; i<1000; ++i) {
+        for(size_t j=0; j<16; ++j)
+            uData.n[j] = uint8_t(rand()%256);
+        uRes.a = lv::popcount_8ui(uData.a);
+        for(size_t j=0; j<16; ++j)
+            ASSERT_EQ(uRes.n[j],lv::popcount(uData.n[j]));
+    }
+}
+
+TEST(popcount_16ui,regression_128bit) {
+    union {
+        uint16_t n[8];
+        __m128i a;
+    } uData,uRes;
+    for(size_t i=0; i<1000; ++i) {
+        for(size_t j=0; j<8; ++j)
+            uData.n[j] = uint16_t(rand()%65536);
+        uRes.a = lv::popcount_16ui(uData.a);
+        for(size_t j=0; j<8; ++j)
+            ASSERT_EQ(uRes.n[j],uint16_t(lv::popcount(uData.n[j])));
+    }
+}
+
+#endif //HAVE_SSSE3
+
+#if HAVE_AVX2
+
+TEST(popcount_8ui,regression_256bit) {
+    union {
+        uint8_t n[32];
+        __m256i a;
+    } uData,uRes;
+    for(size_t i=0; i<1000; ++i) {
+        for(size_t j=0; j<32; ++j)
+            uData.n[j] = uint8_t(rand()%256);
+        uRes.a = lv::popcount_8ui(uData.a);
+        for(size_t j=0; j<32; ++j)
+            ASSERT_EQ(uRes.n[j],lv::popcount(uData.n[j]));
+    }
+}
+
+TEST(popcount_16ui,regression_256bit) {
+    union {
+        uint16_t n[16];
+        __m256i a;
+    } uData,uRes;
+    for(size_t i=0; i<1000; ++i) {
+        for(size_t j=0; j<16; ++j)
+            uData.n[j] = uint16_t(rand()%65536);
+        uRes.a = lv::popcount_16ui(uData.a);
+        for(size_t j=0; j<16; ++j)
+            ASSERT_EQ(uRes.n[j],uint16_t(lv::popcount(uData.n[j])));
+    }
+}
+
+#endif //HAVE_AVX2
+
+TEST(hdist_16ui,regression) {
+    for(size_t nCount : {size_t(0),size_t(1),size_t(15),size_t(16),size_t(31),size_t(32),size_t(33),size_t(1000)}) {
+        const std::unique_ptr<uint16_t[]> anBuffer1 = lv::test::genarray<uint16_t>(nCount,0,65535);
+        const std::unique_ptr<uint16_t[]> anBuffer2 = lv::test::genarray<uint16_t>(nCount,0,65535);
+        std::vector<uint8_t> vnOutput(nCount+1,uint8_t(255));
+        lv::hdist_16ui(anBuffer1.get(),anBuffer2.get(),vnOutput.data(),nCount);
+        for(size_t n=0; n<nCount; ++n)
+            ASSERT_EQ(vnOutput[n],(lv::hdist<uint16_t,uint8_t>(anBuffer1[n],anBuffer2[n]))) << "nCount=" << nCount << ", n=" << n;
+        ASSERT_EQ(vnOutput[nCount],uint8_t(255)) << "kernel wrote past the end of the output buffer";
+    }
+}
+
+namespace {
+
+    template<bool bUseSIMD>
+    void hdist_16ui_perftest(benchmark::State& st) {
+        const volatile size_t nArraySize = size_t(st.range(0));
+        const std::unique_ptr<uint16_t[]> anBuffer1 = lv::test::genarray<uint16_t>(nArraySize,0,65535);
+        const std::unique_ptr<uint16_t[]> anBuffer2 = lv::test::genarray<uint16_t>(nArraySize,0,65535);
+        std::unique_ptr<uint8_t[]> anOutput(new uint8_t[nArraySize]);
+        while(st.KeepRunning()) {
+            const size_t nCurrArraySize = nArraySize;
+            if(bUseSIMD)
+                lv::hdist_16ui(anBuffer1.get(),anBuffer2.get(),anOutput.get(),nCurrArraySize);
+            else
+                for(size_t n=0; n<nCurrArraySize; ++n)
+                    anOutput[n] = lv::hdist<uint16_t,uint8_t>(anBuffer1[n],anBuffer2[n]);
+            benchmark::DoNotOptimize(anOutput.get());
+        }
+    }
+
+}
+
+BENCHMARK_TEMPLATE1(hdist_16ui_perftest,true)->Args({640*480*3})->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE1(hdist_16ui_perftest,false)->Args({640*480*3})->Repetitions(10)->ReportAggregatesOnly(true);